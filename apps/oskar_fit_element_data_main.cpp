@@ -10,19 +10,45 @@
 #include "telescope/station/element/oskar_element.h"
 #include "utility/oskar_dir.h"
 #include "utility/oskar_get_error_string.h"
+#include "utility/oskar_get_num_procs.h"
+#include "utility/oskar_thread.h"
 #include "utility/oskar_version_string.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <iomanip>
 #include <sstream>
+#include <vector>
 
 using namespace oskar;
 using std::string;
+using std::vector;
 
 static const char app[] = "oskar_fit_element_data";
 
+struct FitJob
+{
+    double frequency_hz;
+    string input_cst_file, input_scalar_file;
+    bool operator<(const FitJob& other) const
+    {
+        return frequency_hz < other.frequency_hz;
+    }
+};
+
+struct ThreadArgs
+{
+    const vector<FitJob>* jobs;
+    int first, last, port, ignore_at_pole, ignore_below_horizon;
+    double closeness, closeness_inc;
+    oskar_Element* element;
+    const char* failed_file;
+    int status;
+};
+
+static void* fit_jobs(void* arg);
 static string construct_element_pathname(string output_dir,
         int port, int element_type_index, double frequency_hz);
 
@@ -70,13 +96,16 @@ int main(int argc, char** argv)
 
     // Get the main settings.
     s->begin_group("element_fit");
-    string input_cst_file = s->to_string("input_cst_file", &e);
-    string input_scalar_file = s->to_string("input_scalar_file", &e);
+    int num_cst_files = 0, num_scalar_files = 0, num_freqs = 0;
+    const char* const* cst_files =
+            s->to_string_list("input_cst_file", &num_cst_files, &e);
+    const char* const* scalar_files =
+            s->to_string_list("input_scalar_file", &num_scalar_files, &e);
+    const double* freqs = s->to_double_list("frequency_hz", &num_freqs, &e);
     string output_dir = s->to_string("output_directory", &e);
     string pol_type = s->to_string("pol_type", &e);
     // string coordinate_system = s->to_string("coordinate_system", &e);
     int element_type_index = s->to_int("element_type_index", &e);
-    double frequency_hz = s->to_double("frequency_hz", &e);
     double average_fractional_error =
             s->to_double("average_fractional_error", &e);
     double average_fractional_error_factor_increase =
@@ -86,8 +115,7 @@ int main(int argc, char** argv)
     int port = pol_type == "X" ? 1 : pol_type == "Y" ? 2 : 0;
 
     // Check that the input and output files have been set.
-    if ((input_cst_file.empty() && input_scalar_file.empty()) ||
-            output_dir.empty())
+    if ((num_cst_files == 0 && num_scalar_files == 0) || output_dir.empty())
     {
         oskar_log_error(log, "Specify input and output file names.");
         oskar_log_free(log);
@@ -95,55 +123,111 @@ int main(int argc, char** argv)
         return EXIT_FAILURE;
     }
 
-    // Create an element model.
-    oskar_Element* element = oskar_element_create(OSKAR_DOUBLE, OSKAR_CPU, &e);
+    // Check there is one frequency for each input file.
+    if ((num_cst_files > 0 && num_cst_files != num_freqs) ||
+            (num_scalar_files > 0 && num_scalar_files != num_freqs))
+    {
+        oskar_log_error(log, "Specify one frequency for each input file.");
+        oskar_log_free(log);
+        SettingsTree::free(s);
+        return EXIT_FAILURE;
+    }
+
+    // Sort the input files by frequency.
+    vector<FitJob> jobs(num_freqs);
+    for (int i = 0; i < num_freqs; ++i)
+    {
+        jobs[i].frequency_hz = freqs[i];
+        if (num_cst_files > 0) jobs[i].input_cst_file = cst_files[i];
+        if (num_scalar_files > 0) jobs[i].input_scalar_file = scalar_files[i];
+    }
+    std::stable_sort(jobs.begin(), jobs.end());
+
+    // Split the frequencies into contiguous ranges, one per thread.
+    // Each thread fits its own element model, so the spline workspaces
+    // are not shared, and each fitting thread itself uses a thread for
+    // each of up to four surfaces.
+    int num_threads = oskar_get_num_procs() / 4;
+    if (num_threads < 1) num_threads = 1;
+    if (num_threads > num_freqs) num_threads = num_freqs;
+    vector<ThreadArgs> args(num_threads);
+    vector<oskar_Thread*> threads(num_threads);
+    for (int t = 0; t < num_threads; ++t)
+    {
+        ThreadArgs& a = args[t];
+        a.jobs = &jobs;
+        a.first = (int) ((long) t * num_freqs / num_threads);
+        a.last = (int) ((long) (t + 1) * num_freqs / num_threads);
+        a.port = port;
+        a.ignore_at_pole = ignore_at_pole;
+        a.ignore_below_horizon = ignore_below_horizon;
+        a.closeness = average_fractional_error;
+        a.closeness_inc = average_fractional_error_factor_increase;
+        a.element = oskar_element_create(OSKAR_DOUBLE, OSKAR_CPU, &e);
+        a.failed_file = 0;
+        a.status = 0;
+    }
 
-    // Load the CST text file for the correct port, if specified (X=1, Y=2).
-    if (!input_cst_file.empty())
+    // Fit the surfaces. The log is not thread-safe, so the fitting threads
+    // do not use it, and the results are reported below instead.
+    if (!e)
     {
         oskar_log_line(log, 'M', ' ');
-        oskar_log_message(log, 'M', 0, "Loading CST element pattern: %s",
-                input_cst_file.c_str());
-        oskar_element_load_cst(element, port, frequency_hz,
-                input_cst_file.c_str(), average_fractional_error,
-                average_fractional_error_factor_increase,
-                ignore_at_pole, ignore_below_horizon, log, &e);
-
-        // Construct the output file name based on the settings.
-        if (port == 0)
+        oskar_log_message(log, 'M', 0, "Fitting data at %d frequencies "
+                "using %d thread(s)...", num_freqs, num_threads);
+        for (int t = 0; t < num_threads; ++t)
+            threads[t] = oskar_thread_create(fit_jobs, (void*)&args[t], 0);
+        for (int t = 0; t < num_threads; ++t)
         {
-            string output = construct_element_pathname(output_dir, 1,
-                    element_type_index, frequency_hz);
-            oskar_element_write(element, output.c_str(), 1,
-                    frequency_hz, log, &e);
-            output = construct_element_pathname(output_dir, 2,
-                    element_type_index, frequency_hz);
-            oskar_element_write(element, output.c_str(), 2,
-                    frequency_hz, log, &e);
-        }
-        else
-        {
-            string output = construct_element_pathname(output_dir, port,
-                    element_type_index, frequency_hz);
-            oskar_element_write(element, output.c_str(), port,
-                    frequency_hz, log, &e);
+            oskar_thread_join(threads[t]);
+            oskar_thread_free(threads[t]);
+            if (args[t].status && !e)
+            {
+                e = args[t].status;
+                oskar_log_error(log, "Failed to fit element data in '%s'",
+                        args[t].failed_file);
+            }
         }
     }
 
-    // Load the scalar text file, if specified.
-    if (!input_scalar_file.empty())
+    // Report the fits and write the fitted data for each frequency.
+    for (int t = 0; t < num_threads && !e; ++t)
     {
-        oskar_log_message(log, 'M', 0, "Loading scalar element pattern: %s",
-                input_scalar_file.c_str());
-        oskar_element_load_scalar(element, frequency_hz,
-                input_scalar_file.c_str(), average_fractional_error,
-                average_fractional_error_factor_increase,
-                ignore_at_pole, ignore_below_horizon, log, &e);
-
-        // Construct the output file name based on the settings.
-        string output = construct_element_pathname(output_dir, 0,
-                element_type_index, frequency_hz);
-        oskar_element_write(element, output.c_str(), 0, frequency_hz, log, &e);
+        oskar_Element* element = args[t].element;
+        for (int i = args[t].first; i < args[t].last; ++i)
+        {
+            const double frequency_hz = jobs[i].frequency_hz;
+
+            // Construct the output file names based on the settings.
+            // (X=1, Y=2, or both if 0.)
+            if (!jobs[i].input_cst_file.empty())
+            {
+                oskar_log_line(log, 'M', ' ');
+                oskar_log_message(log, 'M', 0, "Fitted CST element "
+                        "pattern: %s", jobs[i].input_cst_file.c_str());
+                oskar_element_log_fit(element, port == 0 ? 1 : port,
+                        frequency_hz, log);
+                for (int p = 1; p <= 2; ++p)
+                {
+                    if (port != 0 && port != p) continue;
+                    string output = construct_element_pathname(output_dir, p,
+                            element_type_index, frequency_hz);
+                    oskar_element_write(element, output.c_str(), p,
+                            frequency_hz, log, &e);
+                }
+            }
+            if (!jobs[i].input_scalar_file.empty())
+            {
+                oskar_log_line(log, 'M', ' ');
+                oskar_log_message(log, 'M', 0, "Fitted scalar element "
+                        "pattern: %s", jobs[i].input_scalar_file.c_str());
+                oskar_element_log_fit(element, 0, frequency_hz, log);
+                string output = construct_element_pathname(output_dir, 0,
+                        element_type_index, frequency_hz);
+                oskar_element_write(element, output.c_str(), 0,
+                        frequency_hz, log, &e);
+            }
+        }
     }
 
     // Check for errors.
@@ -151,13 +235,45 @@ int main(int argc, char** argv)
             oskar_get_error_string(e));
 
     // Free memory.
-    oskar_element_free(element, &e);
+    for (int t = 0; t < num_threads; ++t)
+        oskar_element_free(args[t].element, &e);
     oskar_log_free(log);
     SettingsTree::free(s);
     return e ? EXIT_FAILURE : EXIT_SUCCESS;
 }
 
 
+static void* fit_jobs(void* arg)
+{
+    ThreadArgs* a = (ThreadArgs*) arg;
+    for (int i = a->first; i < a->last && !a->status; ++i)
+    {
+        const FitJob& job = (*a->jobs)[i];
+
+        // Load the CST text file for the correct port, if specified.
+        if (!job.input_cst_file.empty())
+        {
+            a->failed_file = job.input_cst_file.c_str();
+            oskar_element_load_cst(a->element, a->port, job.frequency_hz,
+                    a->failed_file, a->closeness, a->closeness_inc,
+                    a->ignore_at_pole, a->ignore_below_horizon,
+                    0, &a->status);
+            if (a->status) break;
+        }
+
+        // Load the scalar text file, if specified.
+        if (!job.input_scalar_file.empty())
+        {
+            a->failed_file = job.input_scalar_file.c_str();
+            oskar_element_load_scalar(a->element, job.frequency_hz,
+                    a->failed_file, a->closeness, a->closeness_inc,
+                    a->ignore_at_pole, a->ignore_below_horizon,
+                    0, &a->status);
+        }
+    }
+    return 0;
+}
+
 static string construct_element_pathname(string output_dir,
         int port, int element_type_index, double frequency_hz)
 {
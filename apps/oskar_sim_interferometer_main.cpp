@@ -17,12 +17,44 @@
 #include <cstdio>
 #include <cstdlib>
 
+#ifdef OSKAR_HAVE_MPI
+// Use only the C interface to MPI.
+#define OMPI_SKIP_MPICXX
+#define MPICH_SKIP_MPICXX
+#include <mpi.h>
+#endif
+
 using namespace oskar;
 
 static const char app[] = "oskar_sim_interferometer";
 
+#ifdef OSKAR_HAVE_MPI
+// Initialises MPI, and finalises it when it goes out of scope.
+// Only one thread in each process makes MPI calls at any one time.
+struct MpiScope
+{
+    int rank, size, thread_support;
+    MpiScope(int* argc, char*** argv) : rank(0), size(1), thread_support(0)
+    {
+        MPI_Init_thread(argc, argv, MPI_THREAD_SERIALIZED, &thread_support);
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &size);
+    }
+    ~MpiScope() { MPI_Finalize(); }
+};
+#endif
+
 int main(int argc, char** argv)
 {
+#ifdef OSKAR_HAVE_MPI
+    MpiScope mpi(&argc, &argv);
+    if (mpi.size > 1 && mpi.thread_support < MPI_THREAD_SERIALIZED)
+    {
+        oskar_log_error(0, "The MPI library does not support "
+                "MPI_THREAD_SERIALIZED.");
+        return EXIT_FAILURE;
+    }
+#endif
     OptionParser opt(app, oskar_version_string(), oskar_app_settings(app));
     opt.add_settings_options();
     opt.add_flag("-q", "Suppress printing.", false, "--quiet");
@@ -60,6 +92,14 @@ int main(int argc, char** argv)
             oskar_settings_to_interferometer(s, NULL, &status);
     oskar_Log* log = oskar_interferometer_log(sim);
     int priority = opt.is_set("-q") ? OSKAR_LOG_WARNING : OSKAR_LOG_STATUS;
+#ifdef OSKAR_HAVE_MPI
+    // Only the first process writes a log.
+    if (mpi.rank > 0)
+    {
+        priority = OSKAR_LOG_WARNING;
+        oskar_log_set_file_priority(log, OSKAR_LOG_NONE);
+    }
+#endif
     oskar_log_set_term_priority(log, priority);
 
     // Write settings to log.
@@ -6,6 +6,8 @@
 #include "log/oskar_log.h"
 #include "settings/oskar_option_parser.h"
 #include "utility/oskar_get_error_string.h"
+#include "utility/oskar_get_num_procs.h"
+#include "utility/oskar_thread.h"
 #include "utility/oskar_version_string.h"
 #include "vis/oskar_vis_block.h"
 #include "vis/oskar_vis_header.h"
@@ -17,6 +19,21 @@
 
 using namespace std;
 
+struct ThreadArgs
+{
+    int thread_id, num_readers, num_in_files, num_blocks;
+    const char* const* in_files;
+    oskar_Binary** files;
+    oskar_VisHeader** headers;
+    oskar_VisBlock** partial[2];
+    oskar_VisBlock** scratch;
+    oskar_Binary* out_file;
+    oskar_Barrier *barrier_all, *barrier_readers;
+    const char* failed_file;
+    int* status;
+};
+
+static void* run_blocks(void* arg);
 static bool is_compatible(
         const oskar_VisHeader* vis1, const oskar_VisHeader* vis2);
 
@@ -29,6 +46,8 @@ int main(int argc, char** argv)
     opt.add_required("OSKAR visibility files...");
     opt.add_flag("-o", "Output visibility file name", 1, "out.vis", false, "--output");
     opt.add_flag("-q", "Disable log messages", false, "--quiet");
+    opt.add_flag("-t", "Number of reader threads (0 for all cores)", 1, "0",
+            false, "--threads");
     opt.add_example("oskar_vis_add file1.vis file2.vis");
     opt.add_example("oskar_vis_add file1.vis file2.vis -o combined.vis");
     opt.add_example("oskar_vis_add -q file1.vis file2.vis file3.vis");
@@ -40,11 +59,14 @@ int main(int argc, char** argv)
     const char* const* in_files = opt.get_input_files(2, &num_in_files);
     const char* out_path = opt.get_string("-o");
     const bool verbose = opt.is_set("-q") ? false : true;
+    int num_readers = opt.get_int("-t");
     if (num_in_files < 2)
     {
         opt.error("Please provide 2 or more visibility files to combine.");
         return EXIT_FAILURE;
     }
+    if (num_readers <= 0) num_readers = oskar_get_num_procs();
+    if (num_readers > num_in_files) num_readers = num_in_files;
 
     // Print if verbose.
     if (verbose)
@@ -58,7 +80,7 @@ int main(int argc, char** argv)
     // Read all the visibility headers and check consistency.
     oskar_Binary **files = 0, *out_file = 0;
     oskar_VisHeader** headers = 0;
-    oskar_VisBlock *block0 = 0, *block1 = 0;
+    oskar_VisBlock **partial[2] = {0, 0}, **scratch = 0;
     files = (oskar_Binary**) calloc(num_in_files, sizeof(oskar_Binary*));
     headers = (oskar_VisHeader**) calloc(num_in_files, sizeof(oskar_VisHeader*));
     for (int i = 0; i < num_in_files; ++i)
@@ -81,13 +103,27 @@ int main(int argc, char** argv)
         }
     }
 
+    // Create double-buffered partial sums and a scratch block per reader.
+    for (int j = 0; j < 2; ++j)
+        partial[j] = (oskar_VisBlock**) calloc(
+                num_readers, sizeof(oskar_VisBlock*));
+    scratch = (oskar_VisBlock**) calloc(num_readers, sizeof(oskar_VisBlock*));
+    if (!status)
+    {
+        for (int t = 0; t < num_readers; ++t)
+        {
+            partial[0][t] = oskar_vis_block_create_from_header(
+                    OSKAR_CPU, headers[0], &status);
+            partial[1][t] = oskar_vis_block_create_from_header(
+                    OSKAR_CPU, headers[0], &status);
+            scratch[t] = oskar_vis_block_create_from_header(
+                    OSKAR_CPU, headers[0], &status);
+        }
+    }
+
     // Write the output file using the first header.
     if (!status)
     {
-        block0 = oskar_vis_block_create_from_header(
-                OSKAR_CPU, headers[0], &status);
-        block1 = oskar_vis_block_create_from_header(
-                OSKAR_CPU, headers[0], &status);
         oskar_mem_clear_contents(oskar_vis_header_settings(
                 headers[0]), &status);
         oskar_mem_clear_contents(oskar_vis_header_telescope_path(
@@ -99,46 +135,146 @@ int main(int argc, char** argv)
                     out_path);
     }
 
-    // Loop over each block in each file.
-    const int num_blocks = oskar_vis_header_num_blocks(headers[0]);
-    for (int b = 0; (b < num_blocks) && !status; ++b)
+    // Thread 0 writes the output, threads 1 to n read and reduce the inputs.
+    if (!status)
     {
-        // Read reference block.
-        oskar_vis_block_read(block0, headers[0], files[0], b, &status);
-
-        // Read blocks from other files and combine them.
-        for (int i = 1; (i < num_in_files) && !status; ++i)
+        const int num_threads = num_readers + 1;
+        oskar_Barrier* barrier_all = oskar_barrier_create(num_threads);
+        oskar_Barrier* barrier_readers = oskar_barrier_create(num_readers);
+        oskar_Thread** threads =
+                (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
+        ThreadArgs* args =
+                (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
+        if (verbose)
+            printf("Using %d reader thread(s).\n", num_readers);
+        for (int i = 0; i < num_threads; ++i)
         {
-            oskar_vis_block_read(block1, headers[i], files[i], b, &status);
-            if (status)
-            {
-                oskar_log_error(0, "Failed to read visibility block in '%s'",
-                        in_files[i]);
-                break;
-            }
-            oskar_Mem* b0 = oskar_vis_block_cross_correlations(block0);
-            const oskar_Mem* b1 =
-                    oskar_vis_block_cross_correlations_const(block1);
-            oskar_mem_add(b0, b0, b1, 0, 0, 0, oskar_mem_length(b0), &status);
+            args[i].thread_id = i;
+            args[i].num_readers = num_readers;
+            args[i].num_in_files = num_in_files;
+            args[i].num_blocks = oskar_vis_header_num_blocks(headers[0]);
+            args[i].in_files = in_files;
+            args[i].files = files;
+            args[i].headers = headers;
+            args[i].partial[0] = partial[0];
+            args[i].partial[1] = partial[1];
+            args[i].scratch = scratch;
+            args[i].out_file = out_file;
+            args[i].barrier_all = barrier_all;
+            args[i].barrier_readers = barrier_readers;
+            args[i].status = &status;
         }
-
-        // Write combined block.
-        oskar_vis_block_write(block0, out_file, b, &status);
+        for (int i = 0; i < num_threads; ++i)
+            threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
+        for (int i = 0; i < num_threads; ++i)
+        {
+            oskar_thread_join(threads[i]);
+            oskar_thread_free(threads[i]);
+        }
+        for (int i = 0; i < num_threads; ++i)
+        {
+            if (args[i].failed_file)
+                oskar_log_error(0, "Failed to read visibility "
+                        "block in '%s'", args[i].failed_file);
+        }
+        free(threads);
+        free(args);
+        oskar_barrier_free(barrier_all);
+        oskar_barrier_free(barrier_readers);
     }
 
     // Free memory and close files.
-    oskar_vis_block_free(block0, &status);
-    oskar_vis_block_free(block1, &status);
+    for (int t = 0; t < num_readers; ++t)
+    {
+        oskar_vis_block_free(partial[0][t], &status);
+        oskar_vis_block_free(partial[1][t], &status);
+        oskar_vis_block_free(scratch[t], &status);
+    }
+    free(partial[0]);
+    free(partial[1]);
+    free(scratch);
     for (int i = 0; i < num_in_files; ++i)
     {
         oskar_vis_header_free(headers[i], &status);
         oskar_binary_free(files[i]);
     }
+    free(files);
+    free(headers);
     oskar_binary_free(out_file);
 
     return status ? EXIT_FAILURE : EXIT_SUCCESS;
 }
 
+static void add_blocks(oskar_VisBlock* out, const oskar_VisBlock* in,
+        int* status)
+{
+    oskar_Mem* b0 = oskar_vis_block_cross_correlations(out);
+    const oskar_Mem* b1 = oskar_vis_block_cross_correlations_const(in);
+    oskar_mem_add(b0, b0, b1, 0, 0, 0, oskar_mem_length(b0), status);
+}
+
+static void* run_blocks(void* arg)
+{
+    ThreadArgs* a = (ThreadArgs*) arg;
+    int* status = a->status;
+    const int reader_id = a->thread_id - 1;
+
+    /* Loop over visibility blocks, reading and combining one block at a
+     * time. Reading and file output are overlapped by using double
+     * buffering, and a dedicated thread is used for file output.
+     *
+     * Each reader thread accumulates a strided subset of the input files
+     * into its own partial sum, and the partial sums are then combined
+     * using a pairwise tree reduction into the partial sum of reader 0.
+     *
+     * No write is launched on the first loop counter (as no data are
+     * ready yet) and no read is performed for the last loop counter.
+     */
+    for (int b = 0; b < a->num_blocks + 1; ++b)
+    {
+        if (a->thread_id == 0 && b > 0)
+        {
+            oskar_vis_block_write(a->partial[(b - 1) % 2][0],
+                    a->out_file, b - 1, status);
+        }
+        if (reader_id >= 0 && b < a->num_blocks)
+        {
+            oskar_VisBlock** partial = a->partial[b % 2];
+            oskar_VisBlock* sum = partial[reader_id];
+            for (int i = reader_id; i < a->num_in_files; i += a->num_readers)
+            {
+                oskar_VisBlock* block = (i == reader_id) ?
+                        sum : a->scratch[reader_id];
+                int read_status = 0;
+                if (*status) break;
+                oskar_vis_block_read(block, a->headers[i], a->files[i], b,
+                        &read_status);
+                if (read_status)
+                {
+                    /* Logged by the main thread after the join. */
+                    a->failed_file = a->in_files[i];
+                    *status = read_status;
+                    break;
+                }
+                if (block != sum) add_blocks(sum, block, status);
+            }
+
+            /* Tree reduction of the partial sums. */
+            for (int stride = 1; stride < a->num_readers; stride *= 2)
+            {
+                oskar_barrier_wait(a->barrier_readers);
+                if (reader_id % (2 * stride) == 0 &&
+                        reader_id + stride < a->num_readers && !*status)
+                    add_blocks(sum, partial[reader_id + stride], status);
+            }
+        }
+
+        /* Synchronise before moving to the next block. */
+        oskar_barrier_wait(a->barrier_all);
+    }
+    return 0;
+}
+
 static bool is_compatible(const oskar_VisHeader* v1, const oskar_VisHeader* v2)
 {
     if (oskar_vis_header_num_channels_total(v1) !=
@@ -0,0 +1,639 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "settings/oskar_option_parser.h"
+#include "binary/oskar_binary.h"
+#include "correlate/oskar_cross_correlate.h"
+#include "correlate/oskar_cross_correlate_phase.h"
+#include "imager/oskar_imager.h"
+#include "interferometer/oskar_evaluate_jones_K.h"
+#include "interferometer/oskar_jones.h"
+#include "math/oskar_cmath.h"
+#include "math/oskar_dft_c2r.h"
+#include "math/oskar_fft.h"
+#include "mem/oskar_binary_read_mem.h"
+#include "mem/oskar_binary_write_mem.h"
+#include "sky/oskar_sky.h"
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_device.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+#include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_header.h"
+#include "oskar_version.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+struct Context
+{
+    int prec, location, niter;
+    oskar_Timer* tmr;
+    string tmp_dir;
+};
+
+struct Result
+{
+    string name, size;
+    vector<double> times;
+};
+
+typedef void (*BenchmarkFunction)(const Context& c, Result& r, int* status);
+
+struct Benchmark
+{
+    const char* name;
+    BenchmarkFunction run;
+    bool cpu_only;
+};
+
+// Times a single statement for each iteration.
+#define TIME_ITERATIONS(C, R, STATUS, STATEMENT) \
+    for (int iter_ = 0; iter_ < (C).niter && !*(STATUS); ++iter_) { \
+        oskar_timer_start((C).tmr); \
+        STATEMENT; \
+        (R).times.push_back(oskar_timer_elapsed((C).tmr)); \
+    }
+
+static string format_size(const char* fmt, ...);
+
+/* Station beam of a 32 x 32 aperture array of isotropic elements. */
+static void bench_station_beam(const Context& c, Result& r, int* status)
+{
+    const int dim = 32, num_elements = dim * dim, num_points = 65536;
+    r.size = format_size("%d elements, %d directions",
+            num_elements, num_points);
+    oskar_Station* station = oskar_station_create(c.prec, OSKAR_CPU,
+            num_elements, status);
+    oskar_station_resize_element_types(station, 1, status);
+    oskar_element_set_element_type(oskar_station_element(station, 0),
+            "Isotropic", status);
+    oskar_station_set_position(station, 0.0, 0.5 * M_PI, 0.0, 0.0, 0.0, 0.0);
+    oskar_station_set_phase_centre(station, OSKAR_COORDS_RADEC,
+            0.0, 0.5 * M_PI);
+    for (int i = 0; i < num_elements; ++i)
+    {
+        const double enu[] = {
+                4.0 * (i % dim - dim / 2), 4.0 * (i / dim - dim / 2), 0.0
+        };
+        oskar_station_set_element_coords(station, 0, i, enu, enu, status);
+    }
+    oskar_Station* st = oskar_station_create_copy(station, c.location, status);
+    oskar_StationWork* work = oskar_station_work_create(c.prec,
+            c.location, status);
+    oskar_Mem* dir[3];
+    for (int i = 0; i < 3; ++i)
+        dir[i] = oskar_mem_create(c.prec, c.location, num_points, status);
+    oskar_mem_random_range(dir[0], -0.5, 0.5, status);
+    oskar_mem_random_range(dir[1], -0.5, 0.5, status);
+    oskar_mem_random_range(dir[2], 0.7, 1.0, status);
+    oskar_Mem* beam = oskar_mem_create(c.prec | OSKAR_COMPLEX, c.location,
+            num_points, status);
+    const oskar_Mem* const coords[] = {dir[0], dir[1], dir[2]};
+    TIME_ITERATIONS(c, r, status, oskar_station_beam(st, work,
+            OSKAR_COORDS_ENU_DIR, num_points, coords, 0.0, 0.5 * M_PI,
+            OSKAR_COORDS_RADEC, 0.0, 0.5 * M_PI, 0, 0.0, 100e6,
+            0, beam, status))
+    for (int i = 0; i < 3; ++i) oskar_mem_free(dir[i], status);
+    oskar_mem_free(beam, status);
+    oskar_station_work_free(work, status);
+    oskar_station_free(st, status);
+    oskar_station_free(station, status);
+}
+
+/* Polarised dipole element pattern. */
+static void bench_element(const Context& c, Result& r, int* status)
+{
+    const int num_points = 1000000;
+    r.size = format_size("%d directions", num_points);
+    oskar_Element* element = oskar_element_create(c.prec, c.location, status);
+    oskar_element_set_element_type(element, "Dipole", status);
+    oskar_Mem *dir[3], *theta, *phi_x, *phi_y, *out;
+    for (int i = 0; i < 3; ++i)
+        dir[i] = oskar_mem_create(c.prec, c.location, num_points, status);
+    oskar_mem_random_range(dir[0], -0.5, 0.5, status);
+    oskar_mem_random_range(dir[1], -0.5, 0.5, status);
+    oskar_mem_random_range(dir[2], 0.7, 1.0, status);
+    theta = oskar_mem_create(c.prec, c.location, num_points, status);
+    phi_x = oskar_mem_create(c.prec, c.location, num_points, status);
+    phi_y = oskar_mem_create(c.prec, c.location, num_points, status);
+    out = oskar_mem_create(c.prec | OSKAR_COMPLEX | OSKAR_MATRIX,
+            c.location, num_points, status);
+    TIME_ITERATIONS(c, r, status, oskar_element_evaluate(element, 0, 0,
+            0.0, 0.5 * M_PI, 0, num_points, dir[0], dir[1], dir[2], 100e6,
+            theta, phi_x, phi_y, 0, out, status))
+    for (int i = 0; i < 3; ++i) oskar_mem_free(dir[i], status);
+    oskar_mem_free(theta, status);
+    oskar_mem_free(phi_x, status);
+    oskar_mem_free(phi_y, status);
+    oskar_mem_free(out, status);
+    oskar_element_free(element, status);
+}
+
+/* Interferometer phase (Jones K). */
+static void bench_jones_k(const Context& c, Result& r, int* status)
+{
+    const int num_stations = 512, num_sources = 4096;
+    r.size = format_size("%d stations, %d sources",
+            num_stations, num_sources);
+    oskar_Jones* K = oskar_jones_create(c.prec | OSKAR_COMPLEX, c.location,
+            num_stations, num_sources, status);
+    oskar_Mem *lmn[3], *uvw[3];
+    oskar_Mem* filter = oskar_mem_create(c.prec, c.location, num_sources,
+            status);
+    oskar_mem_set_value_real(filter, 1.0, 0, num_sources, status);
+    for (int i = 0; i < 3; ++i)
+    {
+        lmn[i] = oskar_mem_create(c.prec, c.location, num_sources, status);
+        uvw[i] = oskar_mem_create(c.prec, c.location, num_stations, status);
+        oskar_mem_random_range(lmn[i], -0.5, 0.5, status);
+        oskar_mem_random_range(uvw[i], -1000.0, 1000.0, status);
+    }
+    TIME_ITERATIONS(c, r, status, oskar_evaluate_jones_K(K, num_sources,
+            lmn[0], lmn[1], lmn[2], uvw[0], uvw[1], uvw[2], 100e6,
+            filter, 0.0, 2.0, 0, status))
+    oskar_mem_free(filter, status);
+    for (int i = 0; i < 3; ++i)
+    {
+        oskar_mem_free(lmn[i], status);
+        oskar_mem_free(uvw[i], status);
+    }
+    oskar_jones_free(K, status);
+}
+
+/* Complex-to-real 3D DFT, as used by the DFT imager (SINCOS_FP). */
+static void bench_dft_c2r(const Context& c, Result& r, int* status)
+{
+    const int num_in = 4096, num_out = 16384;
+    r.size = format_size("%d inputs, %d outputs", num_in, num_out);
+    oskar_Mem *in[3], *out[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        in[i] = oskar_mem_create(c.prec, c.location, num_in, status);
+        out[i] = oskar_mem_create(c.prec, c.location, num_out, status);
+        oskar_mem_random_range(in[i], -1000.0, 1000.0, status);
+        oskar_mem_random_range(out[i], -0.5, 0.5, status);
+    }
+    oskar_Mem* data = oskar_mem_create(c.prec | OSKAR_COMPLEX, c.location,
+            num_in, status);
+    oskar_Mem* weight = oskar_mem_create(c.prec, c.location, num_in, status);
+    oskar_Mem* output = oskar_mem_create(c.prec, c.location, num_out, status);
+    oskar_mem_random_range(data, -1.0, 1.0, status);
+    oskar_mem_set_value_real(weight, 1.0, 0, num_in, status);
+    TIME_ITERATIONS(c, r, status, oskar_dft_c2r(num_in, 2.0 * M_PI,
+            in[0], in[1], in[2], data, weight, num_out,
+            out[0], out[1], out[2], output, status))
+    for (int i = 0; i < 3; ++i)
+    {
+        oskar_mem_free(in[i], status);
+        oskar_mem_free(out[i], status);
+    }
+    oskar_mem_free(data, status);
+    oskar_mem_free(weight, status);
+    oskar_mem_free(output, status);
+}
+
+/* Polarised cross-correlation of point sources. */
+static void correlate(const Context& c, Result& r, bool fused, int* status)
+{
+    const int num_stations = 256, num_sources = 1024;
+    r.size = format_size("%d stations, %d sources",
+            num_stations, num_sources);
+    const int type = c.prec | OSKAR_COMPLEX | OSKAR_MATRIX;
+    oskar_Telescope* tel = oskar_telescope_create(c.prec, c.location,
+            num_stations, status);
+    oskar_Jones* J = oskar_jones_create(type, c.location,
+            num_stations, num_sources, status);
+    oskar_Mem* vis = oskar_mem_create(type, c.location,
+            oskar_telescope_num_baselines(tel), status);
+    oskar_Mem *dir[3], *ext[3], *flux[4], *uvw[3];
+    for (int i = 0; i < 4; ++i)
+    {
+        flux[i] = oskar_mem_create(c.prec, c.location, num_sources, status);
+        oskar_mem_random_range(flux[i], 0.1, 1.0, status);
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        dir[i] = oskar_mem_create(c.prec, c.location, num_sources, status);
+        ext[i] = oskar_mem_create(c.prec, c.location, num_sources, status);
+        uvw[i] = oskar_mem_create(c.prec, c.location, num_stations, status);
+        oskar_mem_random_range(dir[i], 0.1, 0.9, status);
+        oskar_mem_random_range(uvw[i], 1.0, 5.0, status);
+        oskar_mem_random_range(
+                oskar_telescope_station_true_offset_ecef_metres(tel, i),
+                0.1, 1000.0, status);
+    }
+    oskar_mem_random_range(oskar_jones_mem(J), 1.0, 5.0, status);
+    if (fused)
+    {
+        TIME_ITERATIONS(c, r, status, oskar_cross_correlate_phase(0,
+                num_sources, J, flux, dir, ext, tel, uvw, 0.0, 100e6, 0, 0,
+                vis, status))
+    }
+    else
+    {
+        TIME_ITERATIONS(c, r, status, oskar_cross_correlate(0,
+                num_sources, J, flux, dir, ext, tel, uvw, 0.0, 100e6, 0,
+                vis, status))
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        oskar_mem_free(dir[i], status);
+        oskar_mem_free(ext[i], status);
+        oskar_mem_free(uvw[i], status);
+    }
+    for (int i = 0; i < 4; ++i) oskar_mem_free(flux[i], status);
+    oskar_mem_free(vis, status);
+    oskar_jones_free(J, status);
+    oskar_telescope_free(tel, status);
+}
+
+static void bench_cross_correlate(const Context& c, Result& r, int* status)
+{
+    correlate(c, r, false, status);
+}
+
+static void bench_cross_correlate_phase(const Context& c, Result& r,
+        int* status)
+{
+    correlate(c, r, true, status);
+}
+
+/* Image made by the given algorithm, including finalisation. */
+static void image(const Context& c, Result& r, const char* algorithm,
+        int size, double fov_deg, int num_vis, double w_max, int* status)
+{
+    r.size = format_size("%d visibilities, %d x %d image",
+            num_vis, size, size);
+    oskar_Mem* uu = oskar_mem_create(c.prec, OSKAR_CPU, num_vis, status);
+    oskar_Mem* vv = oskar_mem_create(c.prec, OSKAR_CPU, num_vis, status);
+    oskar_Mem* ww = oskar_mem_create(c.prec, OSKAR_CPU, num_vis, status);
+    oskar_Mem* amp = oskar_mem_create(c.prec | OSKAR_COMPLEX, OSKAR_CPU,
+            num_vis, status);
+    oskar_Mem* weight = oskar_mem_create(c.prec, OSKAR_CPU, num_vis, status);
+    oskar_Mem* img = oskar_mem_create(c.prec, OSKAR_CPU, size * size, status);
+    // Keep all (u,v) coordinates, in wavelengths, inside the grid.
+    const double uv_max = 0.4 * size / (fov_deg * M_PI / 180.0);
+    oskar_mem_random_range(uu, -uv_max, uv_max, status);
+    oskar_mem_random_range(vv, -uv_max, uv_max, status);
+    oskar_mem_random_range(ww, -w_max, w_max, status);
+    oskar_mem_random_range(amp, -1.0, 1.0, status);
+    oskar_mem_set_value_real(weight, 1.0, 0, num_vis, status);
+    for (int i = 0; i < c.niter && !*status; ++i)
+    {
+        // Visibility frequency is chosen so that wavelength is 1 metre.
+        oskar_Imager* im = oskar_imager_create(c.prec, status);
+        oskar_imager_set_algorithm(im, algorithm, status);
+        oskar_imager_set_fov(im, fov_deg);
+        oskar_imager_set_size(im, size, status);
+        oskar_imager_set_weighting(im, "Natural", status);
+        if (c.location == OSKAR_CPU)
+            oskar_imager_set_gpus(im, 0, 0, status);
+        oskar_imager_set_vis_frequency(im, 299792458.0, 1.0, 1);
+        oskar_timer_start(c.tmr);
+        oskar_imager_update(im, num_vis, 0, 0, 1, uu, vv, ww, amp, weight,
+                0, status);
+        oskar_imager_finalise(im, 1, &img, 0, 0, status);
+        r.times.push_back(oskar_timer_elapsed(c.tmr));
+        oskar_imager_free(im, status);
+    }
+    oskar_mem_free(uu, status);
+    oskar_mem_free(vv, status);
+    oskar_mem_free(ww, status);
+    oskar_mem_free(amp, status);
+    oskar_mem_free(weight, status);
+    oskar_mem_free(img, status);
+}
+
+static void bench_image_fft(const Context& c, Result& r, int* status)
+{
+    image(c, r, "FFT", 2048, 4.0, 1000000, 0.0, status);
+}
+
+static void bench_image_wstack(const Context& c, Result& r, int* status)
+{
+    image(c, r, "W-stacking", 1024, 4.0, 200000, 200.0, status);
+}
+
+static void bench_image_wproj(const Context& c, Result& r, int* status)
+{
+    image(c, r, "W-projection", 256, 10.0, 200000, 100.0, status);
+}
+
+static void bench_image_dft(const Context& c, Result& r, int* status)
+{
+    image(c, r, "DFT 2D", 128, 4.0, 20000, 0.0, status);
+}
+
+/* 2D complex-to-complex FFT. */
+static void bench_fft(const Context& c, Result& r, int* status)
+{
+    const int size = 2048;
+    r.size = format_size("%d x %d", size, size);
+    oskar_FFT* fft = oskar_fft_create(c.prec, c.location, 2, size, 0, status);
+    oskar_Mem* data = oskar_mem_create(c.prec | OSKAR_COMPLEX, c.location,
+            size * size, status);
+    oskar_mem_random_range(data, -1.0, 1.0, status);
+    TIME_ITERATIONS(c, r, status, oskar_fft_exec(fft, data, status))
+    oskar_mem_free(data, status);
+    oskar_fft_free(fft);
+}
+
+/* Text sky model load. */
+static void bench_sky_load(const Context& c, Result& r, int* status)
+{
+    const int num_sources = 200000;
+    r.size = format_size("%d sources", num_sources);
+    const string filename = c.tmp_dir + "oskar_benchmark_sky.txt";
+    oskar_Sky* sky = oskar_sky_create(c.prec, OSKAR_CPU, num_sources, status);
+    oskar_mem_random_range(oskar_sky_ra_rad(sky), 0.0, 2.0 * M_PI, status);
+    oskar_mem_random_range(oskar_sky_dec_rad(sky), -0.5 * M_PI, 0.5 * M_PI,
+            status);
+    oskar_mem_random_range(oskar_sky_I(sky), 0.1, 10.0, status);
+    oskar_sky_save(sky, filename.c_str(), status);
+    oskar_sky_free(sky, status);
+    for (int i = 0; i < c.niter && !*status; ++i)
+    {
+        oskar_timer_start(c.tmr);
+        sky = oskar_sky_load(filename.c_str(), c.prec, status);
+        r.times.push_back(oskar_timer_elapsed(c.tmr));
+        oskar_sky_free(sky, status);
+    }
+    remove(filename.c_str());
+}
+
+/* Binary file write and read of a large block of data. */
+static void binary(const Context& c, Result& r, bool write, int* status)
+{
+    const int num_elements = 8 * 1024 * 1024;
+    const string filename = c.tmp_dir + "oskar_benchmark_data.bin";
+    r.size = format_size("%d MiB",
+            num_elements * (c.prec == OSKAR_DOUBLE ? 8 : 4) / (1024 * 1024));
+    oskar_Mem* data = oskar_mem_create(c.prec, OSKAR_CPU, num_elements,
+            status);
+    oskar_mem_random_range(data, -1.0, 1.0, status);
+    if (!write)
+    {
+        oskar_Binary* h = oskar_binary_create(filename.c_str(), 'w', status);
+        oskar_binary_write_mem(h, data, 1, 1, 0, 0, status);
+        oskar_binary_free(h);
+    }
+    for (int i = 0; i < c.niter && !*status; ++i)
+    {
+        oskar_timer_start(c.tmr);
+        oskar_Binary* h = oskar_binary_create(filename.c_str(),
+                write ? 'w' : 'r', status);
+        if (write)
+            oskar_binary_write_mem(h, data, 1, 1, 0, 0, status);
+        else
+            oskar_binary_read_mem(h, data, 1, 1, 0, status);
+        oskar_binary_free(h);
+        r.times.push_back(oskar_timer_elapsed(c.tmr));
+    }
+    oskar_mem_free(data, status);
+    remove(filename.c_str());
+}
+
+static void bench_binary_write(const Context& c, Result& r, int* status)
+{
+    binary(c, r, true, status);
+}
+
+static void bench_binary_read(const Context& c, Result& r, int* status)
+{
+    binary(c, r, false, status);
+}
+
+/* System noise added to a polarised visibility block. */
+static void bench_noise(const Context& c, Result& r, int* status)
+{
+    const int num_stations = 256, num_times = 8, num_channels = 4;
+    r.size = format_size("%d stations, %d times, %d channels",
+            num_stations, num_times, num_channels);
+    const int type = c.prec | OSKAR_COMPLEX | OSKAR_MATRIX;
+    oskar_Telescope* tel = oskar_telescope_create(c.prec, OSKAR_CPU,
+            num_stations, status);
+    oskar_telescope_resize_station_array(tel, 1, status);
+    oskar_telescope_set_enable_noise(tel, 1, 1);
+    oskar_telescope_set_noise_freq(tel, 100e6, 1e6, num_channels, status);
+    oskar_telescope_set_noise_rms(tel, 1.0, 2.0, status);
+    oskar_VisHeader* hdr = oskar_vis_header_create(type, c.prec,
+            num_times, num_times, num_channels, num_channels,
+            num_stations, 1, 1, status);
+    oskar_vis_header_set_freq_start_hz(hdr, 100e6);
+    oskar_vis_header_set_freq_inc_hz(hdr, 1e6);
+    oskar_vis_header_set_channel_bandwidth_hz(hdr, 10e3);
+    oskar_vis_header_set_time_average_sec(hdr, 1.0);
+    oskar_VisBlock* blk = oskar_vis_block_create_from_header(
+            OSKAR_CPU, hdr, status);
+    oskar_Mem* work = oskar_mem_create(c.prec, OSKAR_CPU, 0, status);
+    TIME_ITERATIONS(c, r, status, oskar_vis_block_add_system_noise(
+            blk, hdr, tel, work, status))
+    oskar_mem_free(work, status);
+    oskar_vis_block_free(blk, status);
+    oskar_vis_header_free(hdr, status);
+    oskar_telescope_free(tel, status);
+}
+
+static const Benchmark benchmarks[] = {
+        {"station_beam",          bench_station_beam,          false},
+        {"element_dipole",        bench_element,               false},
+        {"jones_k",               bench_jones_k,               false},
+        {"dft_c2r",               bench_dft_c2r,               false},
+        {"cross_correlate",       bench_cross_correlate,       false},
+        {"cross_correlate_phase", bench_cross_correlate_phase, true},
+        {"image_fft",             bench_image_fft,             false},
+        {"image_wstack",          bench_image_wstack,          false},
+        {"image_wproj",           bench_image_wproj,           false},
+        {"image_dft_2d",          bench_image_dft,             false},
+        {"fft_2d",                bench_fft,                   false},
+        {"sky_load",              bench_sky_load,              true},
+        {"binary_write",          bench_binary_write,          true},
+        {"binary_read",           bench_binary_read,           true},
+        {"system_noise",          bench_noise,                 true}
+};
+
+static double min_time(const vector<double>& t)
+{
+    return t.empty() ? 0.0 : *std::min_element(t.begin(), t.end());
+}
+
+static double mean_time(const vector<double>& t)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < t.size(); ++i) sum += t[i];
+    return t.empty() ? 0.0 : sum / t.size();
+}
+
+static string format_size(const char* fmt, ...)
+{
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    return string(buf);
+}
+
+static bool write_json(const char* filename, const Context& c,
+        const vector<Result>& results)
+{
+    FILE* f = fopen(filename, "w");
+    if (!f) return false;
+    fprintf(f, "{\n");
+    fprintf(f, "  \"oskar_version\": \"%s\",\n", OSKAR_VERSION_STR);
+    fprintf(f, "  \"precision\": \"%s\",\n",
+            c.prec == OSKAR_DOUBLE ? "double" : "single");
+    fprintf(f, "  \"location\": \"%s\",\n", c.location == OSKAR_CPU ? "CPU" :
+            (c.location == OSKAR_GPU ? "GPU" : "OpenCL"));
+    fprintf(f, "  \"num_iterations\": %d,\n", c.niter);
+    fprintf(f, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& r = results[i];
+        const vector<double>& t = r.times;
+        fprintf(f, "    {\"name\": \"%s\", \"size\": \"%s\", "
+                "\"min_sec\": %.6e, \"mean_sec\": %.6e, \"max_sec\": %.6e}%s\n",
+                r.name.c_str(), r.size.c_str(), min_time(t), mean_time(t),
+                t.empty() ? 0.0 : *std::max_element(t.begin(), t.end()),
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return true;
+}
+
+// Returns the minimum time for the named benchmark in a JSON results file
+// written by write_json(), or a negative value if it is not present.
+static double baseline_time(const string& json, const string& name)
+{
+    const string key = "\"name\": \"" + name + "\"";
+    size_t pos = json.find(key);
+    if (pos == string::npos) return -1.0;
+    pos = json.find("\"min_sec\":", pos);
+    if (pos == string::npos) return -1.0;
+    return strtod(json.c_str() + pos + 10, 0);
+}
+
+static bool read_file(const char* filename, string& contents)
+{
+    FILE* f = fopen(filename, "rb");
+    if (!f) return false;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) contents.append(buf, n);
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_benchmark", OSKAR_VERSION_STR);
+    opt.add_flag("-sp", "Use single precision (default: double precision)");
+    opt.add_flag("-g", "Run on the GPU (default: CPU)");
+    opt.add_flag("-cl", "Run using OpenCL (default: CPU)");
+    opt.add_flag("-n", "Number of iterations", 1, "3", false);
+    opt.add_flag("-f", "Only run benchmarks with names containing this "
+            "string.", 1);
+    opt.add_flag("-l", "List the benchmarks and exit.");
+    opt.add_flag("-o", "Write results to this JSON file.", 1);
+    opt.add_flag("-b", "Compare results against this baseline JSON file.", 1);
+    opt.add_flag("-t", "Fractional slow-down allowed before a benchmark "
+            "is reported as a regression.", 1, "0.1", false);
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+    const int num_benchmarks = sizeof(benchmarks) / sizeof(Benchmark);
+    if (opt.is_set("-l"))
+    {
+        for (int i = 0; i < num_benchmarks; ++i)
+            printf("%s\n", benchmarks[i].name);
+        return EXIT_SUCCESS;
+    }
+
+    // Set up the benchmark context.
+    int status = 0;
+    Context c;
+    c.prec = opt.is_set("-sp") ? OSKAR_SINGLE : OSKAR_DOUBLE;
+    c.location = opt.is_set("-g") ? OSKAR_GPU :
+            (opt.is_set("-cl") ? OSKAR_CL : OSKAR_CPU);
+    c.niter = opt.get_int("-n");
+    const char* tmp = getenv("TMPDIR");
+    c.tmp_dir = tmp ? string(tmp) + "/" : string();
+    const string filter = opt.is_set("-f") ? opt.get_string("-f") : string();
+    string baseline;
+    if (opt.is_set("-b") && !read_file(opt.get_string("-b"), baseline))
+    {
+        fprintf(stderr, "ERROR: Cannot read baseline file '%s'\n",
+                opt.get_string("-b"));
+        return EXIT_FAILURE;
+    }
+    const double tolerance = opt.get_double("-t");
+    oskar_device_set_require_double_precision(c.prec == OSKAR_DOUBLE);
+    oskar_Timer* tmr_cpu = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_Timer* tmr_dev = oskar_timer_create(c.location);
+
+    // Run the benchmarks.
+    vector<Result> results;
+    int num_regressions = 0;
+    printf("%-22s %-38s %10s %10s %s\n", "Benchmark", "Size",
+            "Min [s]", "Mean [s]", baseline.empty() ? "" : "  Baseline ratio");
+    for (int i = 0; i < num_benchmarks; ++i)
+    {
+        const Benchmark& b = benchmarks[i];
+        if (!filter.empty() && !strstr(b.name, filter.c_str())) continue;
+        if (b.cpu_only && c.location != OSKAR_CPU) continue;
+        Result r;
+        r.name = b.name;
+        c.tmr = b.cpu_only ? tmr_cpu : tmr_dev;
+        b.run(c, r, &status);
+        if (status)
+        {
+            fprintf(stderr, "ERROR: Benchmark '%s' failed with code %i: %s\n",
+                    b.name, status, oskar_get_error_string(status));
+            break;
+        }
+        printf("%-22s %-38s %10.4f %10.4f", b.name, r.size.c_str(),
+                min_time(r.times), mean_time(r.times));
+        if (!baseline.empty())
+        {
+            const double t_ref = baseline_time(baseline, r.name);
+            if (t_ref > 0.0)
+            {
+                const double ratio = min_time(r.times) / t_ref;
+                const bool regressed = ratio > 1.0 + tolerance;
+                if (regressed) num_regressions++;
+                printf("  %6.3f%s", ratio, regressed ? "  REGRESSION" : "");
+            }
+            else
+                printf("  (not in baseline)");
+        }
+        printf("\n");
+        fflush(stdout);
+        results.push_back(r);
+    }
+    oskar_timer_free(tmr_cpu);
+    oskar_timer_free(tmr_dev);
+
+    // Write results.
+    if (opt.is_set("-o") && !write_json(opt.get_string("-o"), c, results))
+    {
+        fprintf(stderr, "ERROR: Cannot write results file '%s'\n",
+                opt.get_string("-o"));
+        return EXIT_FAILURE;
+    }
+    if (num_regressions > 0)
+        printf("%d benchmark(s) slower than baseline by more than %.0f%%.\n",
+                num_regressions, 100.0 * tolerance);
+    return (status || num_regressions > 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,84 @@
+#!/bin/bash
+
+###############################################################################
+#
+# Description:
+#   Tests distributed interferometer simulations using MPI.
+#
+# Method:
+#   1. Generate an OSKAR visibility binary file using a single process.
+#   2. Generate the same visibilities using several processes with mpirun,
+#      distributing first the visibility blocks and then the sky chunks.
+#   3. Compare the visibility statistics with those from the single process.
+#
+# OSKAR must have been built with MPI support (-DFIND_MPI=ON).
+# The number of processes can be given as the first argument (default 3).
+#
+###############################################################################
+
+source @OSKAR_BINARY_DIR@/apps/test/test_utility.sh
+
+num_procs=${1:-3}
+mpirun_cmd="mpirun -n $num_procs"
+if [ "$(id -u)" = "0" ]; then
+    mpirun_cmd="mpirun --allow-run-as-root --oversubscribe -n $num_procs"
+fi
+
+echo "Running OSKAR MPI interferometer simulation test"
+echo ""
+echo "  * Example data directory = $example_data_dir"
+echo "  * Number of processes    = $num_procs"
+echo ""
+
+# Move into the example data directory
+cd "${example_data_dir}" || exit
+
+app_sim=${oskar_app_path}/oskar_sim_interferometer
+ini_sim=oskar_sim_interferometer_mpi.ini
+cp oskar_sim_interferometer.ini $ini_sim
+set_setting $app_sim $ini_sim sky/oskar_sky_model/file sky.osm
+set_setting $app_sim $ini_sim telescope/input_directory telescope.tm
+set_setting $app_sim $ini_sim simulator/double_precision true
+set_setting $app_sim $ini_sim simulator/max_sources_per_chunk 1
+set_setting $app_sim $ini_sim interferometer/max_time_samples_per_block 4
+set_setting $app_sim $ini_sim interferometer/correlation_type Both
+set_setting $app_sim $ini_sim interferometer/noise/enable true
+set_setting $app_sim $ini_sim interferometer/noise/freq "Observation settings"
+set_setting $app_sim $ini_sim interferometer/noise/rms "Range"
+set_setting $app_sim $ini_sim interferometer/noise/rms/start 1
+set_setting $app_sim $ini_sim interferometer/noise/rms/end 1
+
+# Run the reference simulation using one process.
+set_setting $app_sim $ini_sim interferometer/oskar_vis_filename mpi_ref.vis
+run_sim_interferometer -q $ini_sim
+run_vis_stats mpi_ref.vis > mpi_ref_stats.txt
+
+# Run the distributed simulations, and compare the results.
+failed=0
+for mode in "Blocks" "Sky chunks"; do
+    set_setting $app_sim $ini_sim simulator/mpi_distribution "$mode"
+    set_setting $app_sim $ini_sim interferometer/oskar_vis_filename mpi_test.vis
+    rm -f mpi_test.vis
+    if ! $mpirun_cmd "$app_sim" -q $ini_sim; then
+        echo "ERROR: mpirun failed (distributing $mode)."
+        exit_ 1
+    fi
+    run_vis_stats mpi_test.vis > mpi_test_stats.txt
+    if diff -q mpi_ref_stats.txt mpi_test_stats.txt > /dev/null; then
+        echo "  + Distributing $mode: OK"
+    else
+        echo "  + Distributing $mode: FAILED"
+        diff mpi_ref_stats.txt mpi_test_stats.txt
+        failed=1
+    fi
+done
+
+echo ""
+echo "-------------------------------------------------------------------------"
+if [ $failed != 0 ]; then
+    echo "Test FAILED: visibilities differ from those made by one process."
+    exit_ 1
+fi
+echo "Test passed."
+echo "-------------------------------------------------------------------------"
+echo ""
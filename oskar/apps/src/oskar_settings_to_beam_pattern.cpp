@@ -50,8 +50,12 @@ oskar_BeamPattern* oskar_settings_to_beam_pattern(oskar::SettingsTree* s,
 
     // Set simulator settings.
     s->begin_group("simulator");
-    oskar_beam_pattern_set_max_chunk_size(h,
-            s->to_int("max_sources_per_chunk", status));
+    if (s->starts_with("max_sources_per_chunk", "auto", status))
+        oskar_log_warning(log_, "Automatic chunk size applies only to the "
+                "interferometer simulator: using the default chunk size.");
+    else
+        oskar_beam_pattern_set_max_chunk_size(h,
+                s->to_int("max_sources_per_chunk", status));
     if (!s->to_int("use_gpus", status))
         oskar_beam_pattern_set_gpus(h, 0, 0, status);
     else
@@ -139,6 +143,8 @@ oskar_BeamPattern* oskar_settings_to_beam_pattern(oskar::SettingsTree* s,
             s->to_int("average_time_and_channel", status));
     oskar_beam_pattern_set_separate_time_and_channel(h,
             s->to_int("separate_time_and_channel", status));
+    oskar_beam_pattern_set_binary_output(h,
+            s->to_int("binary_file", status));
     s->end_group();
 
     // Set output files.
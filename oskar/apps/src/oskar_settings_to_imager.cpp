@@ -107,11 +107,19 @@ oskar_Imager* oskar_settings_to_imager(oskar::SettingsTree* s,
                 s->to_int("fft/support", status),
                 s->to_int("fft/oversample", status), status);
     }
+    else if (s->starts_with("algorithm", "W-s", status) ||
+            s->starts_with("algorithm", "w-s", status))
+    {
+        oskar_imager_set_grid_kernel(h, "ES",
+                s->to_int("fft/support", status), 0, status);
+    }
     if (!s->starts_with("wproj/num_w_planes", "auto", status))
         oskar_imager_set_num_w_planes(h,
                 s->to_int("wproj/num_w_planes", status));
     oskar_imager_set_fft_on_gpu(h, s->to_int("fft/use_gpu", status));
     oskar_imager_set_grid_on_gpu(h, s->to_int("fft/grid_on_gpu", status));
+    oskar_imager_set_w_kernel_cache_dir(h,
+            s->to_string("wproj/w_kernel_cache_dir", status), status);
     oskar_imager_set_generate_w_kernels_on_gpu(h,
             s->to_int("wproj/generate_w_kernels_on_gpu", status));
     if (s->first_letter("direction", status) == 'R')
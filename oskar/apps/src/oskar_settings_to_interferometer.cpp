@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2020, The OSKAR Developers.
+ * Copyright (c) 2017-2021, The OSKAR Developers.
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
@@ -26,8 +26,11 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
 
     // Set simulator settings.
     s->begin_group("simulator");
-    oskar_interferometer_set_max_sources_per_chunk(h,
-            s->to_int("max_sources_per_chunk", status));
+    if (s->starts_with("max_sources_per_chunk", "auto", status))
+        oskar_interferometer_set_max_sources_per_chunk(h, 0);
+    else
+        oskar_interferometer_set_max_sources_per_chunk(h,
+                s->to_int("max_sources_per_chunk", status));
     oskar_interferometer_set_settings_path(h, s->file_name());
     if (!s->to_int("use_gpus", status))
         oskar_interferometer_set_gpus(h, 0, 0, status);
@@ -52,6 +55,12 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
     else
         oskar_interferometer_set_num_devices(h,
                 s->to_int("num_devices", status));
+    oskar_interferometer_set_cpu_shared_memory(h,
+            s->to_int("cpu_shared_memory", status));
+    oskar_interferometer_set_fused_correlation(h,
+            s->to_int("fused_correlation", status));
+    oskar_interferometer_set_mpi_distribution(h,
+            s->to_string("mpi_distribution", status), status);
     oskar_log_set_keep_file(log_, s->to_int("keep_log_file", status));
     oskar_log_set_file_priority(log_,
             s->to_int("write_status_to_log_file", status) ?
@@ -62,6 +71,8 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
     s->begin_group("sky");
     oskar_interferometer_set_horizon_clip(h,
             s->to_int("advanced/apply_horizon_clip", status));
+    oskar_interferometer_set_sort_sky_by_locality(h,
+            s->to_int("advanced/sort_by_locality", status));
     oskar_interferometer_set_zero_failed_gaussians(h,
             s->to_int("advanced/zero_failed_gaussians", status));
     oskar_interferometer_set_source_flux_range(h,
@@ -86,6 +97,11 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
             s->to_int("force_polarised_ms", status));
     oskar_interferometer_set_ignore_w_components(h,
             s->to_int("ignore_w_components", status));
+    oskar_interferometer_set_bda(h,
+            s->to_int("bda/enable", status),
+            s->to_double("bda/max_fact", status),
+            s->to_double("bda/fov_deg", status),
+            s->to_double("bda/max_time_sec", status));
     s->end_group();
 
     // Set observation settings.
@@ -59,6 +59,9 @@ oskar_Sky* oskar_settings_to_sky(SettingsTree* s, oskar_Log* log, int* status)
     const int type = s->to_int("simulator/double_precision", status) ?
             OSKAR_DOUBLE : OSKAR_SINGLE;
     oskar_Sky* sky = oskar_sky_create(type, OSKAR_CPU, 0, status);
+    const int max_sources_per_chunk =
+            s->contains("simulator/max_sources_per_chunk") ?
+            s->to_int("simulator/max_sources_per_chunk", status) : 0;
     s->begin_group("observation");
     double ra0  = s->to_double("phase_centre_ra_deg", status) * D2R;
     double dec0 = s->to_double("phase_centre_dec_deg", status) * D2R;
@@ -134,6 +137,15 @@ oskar_Sky* oskar_settings_to_sky(SettingsTree* s, oskar_Log* log, int* status)
         oskar_sky_write(sky, filename, status);
     }
 
+    /* Write columnar binary file. */
+    filename = s->to_string("output_columnar_file", status);
+    if (filename && strlen(filename) > 0 && !*status)
+    {
+        oskar_log_message(log, 'M', 1,
+                "Writing sky model columnar file: %s", filename);
+        oskar_sky_write_columns(sky, filename, max_sources_per_chunk, status);
+    }
+
     s->clear_group();
     return sky;
 }
@@ -155,7 +167,24 @@ static void load_osm(oskar_Sky* sky, SettingsTree* s,
         oskar_log_message(log, 'M', 0,
                 "Loading OSKAR sky model file '%s' ...", files[i]);
 
-        /* Try to read sky model as a binary file first. */
+        /* Map each chunk of a columnar file, and filter it in place. */
+        const int num_chunks = oskar_sky_columns_num_chunks(files[i], status);
+        for (int c = 0; c < num_chunks; ++c)
+        {
+            oskar_Sky* t = oskar_sky_read_columns(files[i], c,
+                    OSKAR_CPU, status);
+            set_up_filter(t, s, ra0, dec0, log, status);
+            set_up_extended(t, s, status);
+            if (!*status) oskar_sky_append(sky, t, status);
+            oskar_sky_free(t, status);
+        }
+        if (num_chunks > 0)
+        {
+            if (!*status) oskar_log_message(log, 'M', 1, "done.");
+            continue;
+        }
+
+        /* Otherwise try to read sky model as a binary file. */
         /* If this fails, read it as an ASCII file. */
         oskar_Sky* t = oskar_sky_read(files[i],
                 OSKAR_CPU, &binary_file_error);
@@ -49,9 +49,26 @@ oskar_Telescope* oskar_settings_to_telescope(SettingsTree* s,
                     "enable_numerical", status));
 
     /************************************************************************/
-    /* Load telescope model folders to define the stations. */
-    oskar_telescope_load(t,
-            s->to_string("telescope/input_directory", status), log, status);
+    /* Load telescope model folders to define the stations,
+     * or a snapshot of them if one has been made since they last changed. */
+    const char* dir = s->to_string("telescope/input_directory", status);
+    const char* snapshot = s->to_string("telescope/snapshot_file", status);
+    if (oskar_telescope_load_snapshot(t, snapshot, dir, status))
+        oskar_log_message(log, 'M', 0,
+                "Loaded telescope model snapshot '%s'.", snapshot);
+    else
+    {
+        oskar_telescope_load(t, dir, log, status);
+        if (*status) return t;
+        if (snapshot && strlen(snapshot) > 0)
+        {
+            int snapshot_status = 0;
+            oskar_telescope_save_snapshot(t, snapshot, dir, &snapshot_status);
+            if (snapshot_status)
+                oskar_log_warning(log, "Unable to save telescope model "
+                        "snapshot to '%s'.", snapshot);
+        }
+    }
     if (*status) return t;
 
     /* Return if no stations were found. */
@@ -70,6 +87,9 @@ oskar_Telescope* oskar_settings_to_telescope(SettingsTree* s,
     oskar_telescope_set_gaussian_station_beam_width(t,
             s->to_double("telescope/gaussian_beam/fwhm_deg", status),
             s->to_double("telescope/gaussian_beam/ref_freq_hz", status));
+    oskar_telescope_set_station_beam_interp_tolerance(t,
+            s->to_double("telescope/station_beam_interpolation_tolerance",
+                    status));
     if (s->contains("observation"))
     {
         if (s->starts_with("observation/mode", "Drift", status))
@@ -6,9 +6,11 @@
 #include <gtest/gtest.h>
 
 #include "apps/oskar_apps.h"
+#include "math/oskar_cmath.h"
 #include "utility/oskar_get_error_string.h"
 #include "utility/oskar_version_string.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <string>
@@ -207,3 +209,120 @@ TEST(apps, test_interferometer_modes)
     // Free settings.
     SettingsTree::free(sim_settings);
 }
+
+TEST(apps, test_interferometer_chunk_sizes)
+{
+    int status = 0;
+    printf("OSKAR %s: Testing interferometer chunk sizes...\n",
+            oskar_version_string());
+
+    // Create a telescope model directory.
+    const char* tel_model_dir = "apps_test_telescope.tm";
+    create_telescope_model(tel_model_dir, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Create a sky model covering the whole sky, so that the horizon clip
+    // leaves chunks of very different sizes.
+    const int num_sources = 3000;
+    oskar_Sky* sky = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_sources, &status);
+    srand(2);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        const double ra = 2.0 * M_PI * rand() / (double)RAND_MAX;
+        const double dec = asin(2.0 * rand() / (double)RAND_MAX - 1.0);
+        oskar_sky_set_source(sky, i, ra, dec, 1.0 + i % 7, 0.0, 0.0, 0.0,
+                100e6, -0.7, 0.0, 0.0, 0.0, 0.0, &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Set base parameters.
+    string test_name = "apps_test_interferometer_chunk_sizes";
+    const char* sim_par[] = {
+            "simulator/double_precision", "true",
+            "simulator/use_gpus", "false",
+            "simulator/num_devices", "2",
+            "sky/advanced/sort_by_locality", "true",
+            "observation/phase_centre_ra_deg", "20.0",
+            "observation/phase_centre_dec_deg", "-30.0",
+            "observation/start_frequency_hz", "100e6",
+            "observation/num_channels", "2",
+            "observation/frequency_inc_hz", "20e6",
+            "observation/start_time_utc", "2000-01-01 12:00:00.0",
+            "observation/length", "06:00:00.0",
+            "observation/num_time_steps", "6",
+            "telescope/input_directory", tel_model_dir,
+            "telescope/station_type", "Gaussian beam",
+            "telescope/gaussian_beam/fwhm_deg", "60.0",
+            "telescope/gaussian_beam/ref_freq_hz", "100e6",
+            "interferometer/max_time_samples_per_block", "6",
+            NULL, NULL
+    };
+
+    // Compare results from one chunk with those from small chunks,
+    // which will be merged after clipping, and with automatic chunks.
+    const char* chunk_sizes[] = {"3000", "150", "auto"};
+    const int num_chunk_sizes = sizeof(chunk_sizes) / sizeof(char*);
+    oskar_Mem* vis[3] = {0, 0, 0};
+    oskar_Telescope* tel = 0;
+    for (int i = 0; i < num_chunk_sizes; ++i)
+    {
+        // Create settings.
+        SettingsTree* sim_settings =
+                oskar_app_settings_tree(app_interferometer, 0);
+        ASSERT_TRUE(sim_settings->set_values(0, sim_par));
+        ASSERT_TRUE(sim_settings->set_value(
+                "simulator/max_sources_per_chunk", chunk_sizes[i]));
+        string vis_name = test_name + "_" + chunk_sizes[i] + ".vis";
+        ASSERT_TRUE(sim_settings->set_value(
+                "interferometer/oskar_vis_filename", vis_name.c_str()));
+
+        // Run visibility simulation.
+        oskar_Interferometer* sim = oskar_settings_to_interferometer(
+                sim_settings, 0, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        if (!tel)
+            tel = oskar_settings_to_telescope(sim_settings, 0, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        oskar_interferometer_set_telescope_model(sim, tel, &status);
+        oskar_interferometer_set_sky_model(sim, sky, &status);
+        oskar_interferometer_run(sim, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        oskar_interferometer_free(sim, &status);
+        SettingsTree::free(sim_settings);
+
+        // Read the visibilities back.
+        oskar_Binary* h = oskar_binary_create(vis_name.c_str(), 'r', &status);
+        oskar_VisHeader* hdr = oskar_vis_header_read(h, &status);
+        oskar_VisBlock* blk = oskar_vis_block_create_from_header(
+                OSKAR_CPU, hdr, &status);
+        oskar_vis_block_read(blk, hdr, h, 0, &status);
+        vis[i] = oskar_mem_create_copy(
+                oskar_vis_block_cross_correlations(blk), OSKAR_CPU, &status);
+        oskar_vis_block_free(blk, &status);
+        oskar_vis_header_free(hdr, &status);
+        oskar_binary_free(h);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+
+    // Check the visibilities are the same.
+    const size_t num_values = 2 * oskar_mem_length(vis[0]) *
+            (oskar_mem_is_matrix(vis[0]) ? 4 : 1);
+    const double* ref = oskar_mem_double_const(vis[0], &status);
+    double max_abs = 0.0;
+    for (size_t j = 0; j < num_values; ++j)
+        max_abs = std::max(max_abs, fabs(ref[j]));
+    ASSERT_GT(max_abs, 0.0);
+    for (int i = 1; i < num_chunk_sizes; ++i)
+    {
+        ASSERT_EQ(oskar_mem_length(vis[0]), oskar_mem_length(vis[i]));
+        const double* v = oskar_mem_double_const(vis[i], &status);
+        for (size_t j = 0; j < num_values; ++j)
+            ASSERT_NEAR(ref[j], v[j], 1e-10 * max_abs) << chunk_sizes[i];
+    }
+    for (int i = 0; i < num_chunk_sizes; ++i)
+        oskar_mem_free(vis[i], &status);
+    oskar_sky_free(sky, &status);
+    oskar_telescope_free(tel, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
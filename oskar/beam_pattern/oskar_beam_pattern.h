@@ -45,6 +45,25 @@ struct oskar_BeamPattern;
 typedef struct oskar_BeamPattern oskar_BeamPattern;
 #endif
 
+/* Tags used in beam pattern binary files. */
+enum OSKAR_BEAM_PATTERN_TAGS
+{
+    OSKAR_BEAM_PATTERN_TAG_IMAGE_SIZE         = 1,  /* int[2] */
+    OSKAR_BEAM_PATTERN_TAG_NUM_PIXELS         = 2,  /* int */
+    OSKAR_BEAM_PATTERN_TAG_MAX_CHUNK_SIZE     = 3,  /* int */
+    OSKAR_BEAM_PATTERN_TAG_NUM_CHUNKS         = 4,  /* int */
+    OSKAR_BEAM_PATTERN_TAG_NUM_TIMES          = 5,  /* int */
+    OSKAR_BEAM_PATTERN_TAG_NUM_CHANNELS       = 6,  /* int */
+    OSKAR_BEAM_PATTERN_TAG_TIME_START_MJD_UTC = 7,  /* double */
+    OSKAR_BEAM_PATTERN_TAG_TIME_INC_SEC       = 8,  /* double */
+    OSKAR_BEAM_PATTERN_TAG_FREQ_START_HZ      = 9,  /* double */
+    OSKAR_BEAM_PATTERN_TAG_FREQ_INC_HZ        = 10, /* double */
+    OSKAR_BEAM_PATTERN_TAG_DATA_PRODUCT_NAME  = 11, /* char[], per product */
+    /* Tags 12-20 are reserved for future use. */
+    OSKAR_BEAM_PATTERN_TAG_BLOCK_INDEX        = 21, /* int[], per block */
+    OSKAR_BEAM_PATTERN_TAG_BLOCK_DATA         = 22  /* real[], per block */
+};
+
 #ifdef __cplusplus
 }
 #endif
@@ -101,6 +101,9 @@ OSKAR_EXPORT
 void oskar_beam_pattern_set_cross_power_raw_text(oskar_BeamPattern* h,
         int flag);
 
+OSKAR_EXPORT
+void oskar_beam_pattern_set_binary_output(oskar_BeamPattern* h, int flag);
+
 OSKAR_EXPORT
 void oskar_beam_pattern_set_coordinate_frame(oskar_BeamPattern* h, char option);
 
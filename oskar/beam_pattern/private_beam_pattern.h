@@ -3,6 +3,7 @@
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
+#include <binary/oskar_binary.h>
 #include <log/oskar_log.h>
 #include <mem/oskar_mem.h>
 #include <telescope/oskar_telescope.h>
@@ -36,6 +37,10 @@ struct DeviceData
     oskar_Mem* cross_power_channel_avg[2];
     oskar_Mem* cross_power_channel_and_time_avg[2];
 
+    /* Work unit held in each host buffer (-1 if free), and whether
+     * it is ready to write. Guarded by the work condition variable. */
+    int buffer_unit[2], buffer_ready[2];
+
     /* Device memory. */
     int previous_chunk_index;
     oskar_Telescope* tel;
@@ -56,6 +61,7 @@ struct DataProduct
     int i_station;
     int time_average;
     int channel_average;
+    int binary; /* True if written to the binary file. */
     fitsfile* fits_file;
     FILE* text_file;
 };
@@ -78,6 +84,7 @@ struct oskar_BeamPattern
     int cross_power_amp_fits, cross_power_phase_fits;
     int cross_power_real_fits, cross_power_imag_fits;
     int ixr_txt, ixr_fits;
+    int binary_output;
     int average_time_and_channel, separate_time_and_channel;
     int set_cellsize;
     int stokes[2]; /* Stokes I true/false, Stokes custom true/false. */
@@ -90,9 +97,9 @@ struct oskar_BeamPattern
 
     /* State. */
     oskar_Mutex* mutex;
-    oskar_Barrier* barrier;
+    oskar_ConditionVar* work_cond;
     oskar_Log* log;
-    int i_global, status;
+    int num_units, i_unit_next, status;
 
     /* Input data. */
     int source_coord_type, num_pixels;
@@ -100,8 +107,12 @@ struct oskar_BeamPattern
     oskar_Telescope* tel;
 
     /* Temporary arrays. */
-    oskar_Mem* pix; /* Real-valued pixel array to write to file. */
-    oskar_Mem* ctemp; /* Complex-valued array used for reordering. */
+    oskar_Mem* pix; /* Real-valued pixel arrays, one per data product. */
+
+    /* Binary output file, and data for the current block. */
+    oskar_Binary* binary_file;
+    int binary_block, binary_block_size;
+    oskar_Mem *binary_data, *binary_index;
 
     /* Settings log data. */
     char* settings_log;
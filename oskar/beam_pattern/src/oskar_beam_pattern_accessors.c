@@ -79,6 +79,12 @@ void oskar_beam_pattern_set_average_single_axis(oskar_BeamPattern* h,
 }
 
 
+void oskar_beam_pattern_set_binary_output(oskar_BeamPattern* h, int flag)
+{
+    h->binary_output = flag;
+}
+
+
 void oskar_beam_pattern_set_coordinate_frame(oskar_BeamPattern* h, char option)
 {
     h->coord_frame_type = option;
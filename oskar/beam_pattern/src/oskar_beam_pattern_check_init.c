@@ -30,6 +30,7 @@ extern "C" {
 static void set_up_host_data(oskar_BeamPattern* h, int *status);
 static void create_averaged_products(oskar_BeamPattern* h, int ta, int ca,
         int* status);
+static void create_binary_file(oskar_BeamPattern* h, int* status);
 static void set_up_device_data(oskar_BeamPattern* h, int* status);
 static void write_axis(fitsfile* fptr, int axis_id, const char* ctype,
         const char* ctype_comment, double crval, double cdelt, double crpix,
@@ -87,15 +88,6 @@ static void set_up_host_data(oskar_BeamPattern* h, int *status)
     /* Work out how many pixel chunks have to be processed. */
     h->num_chunks = (h->num_pixels + h->max_chunk_size - 1) / h->max_chunk_size;
 
-    /* Create scratch arrays for output pixel data. */
-    if (!h->pix)
-    {
-        h->pix = oskar_mem_create(h->prec, OSKAR_CPU,
-                h->max_chunk_size, status);
-        h->ctemp = oskar_mem_create(h->prec | OSKAR_COMPLEX, OSKAR_CPU,
-                h->max_chunk_size, status);
-    }
-
     /* Get the contents of the log at this point so we can write a
      * reasonable file header. Replace newlines with zeros. */
     h->settings_log_length = 0;
@@ -177,6 +169,107 @@ static void set_up_host_data(oskar_BeamPattern* h, int *status)
         *status = OSKAR_ERR_FILE_IO;
         oskar_log_error(h->log, "No output file(s) selected.");
     }
+
+    /* Create scratch arrays for output pixel data, one per data product
+     * converted together. Products are converted together only if they
+     * have the same averaging mode and polarisation input type. */
+    if (!h->pix && !*status)
+    {
+        int i, j, max_products = 0;
+        for (i = 0; i < h->num_data_products; ++i)
+        {
+            const DataProduct* p = &h->data_products[i];
+            int num_products = 0;
+            for (j = 0; j < h->num_data_products; ++j)
+            {
+                const DataProduct* q = &h->data_products[j];
+                if (q->time_average == p->time_average &&
+                        q->channel_average == p->channel_average &&
+                        q->stokes_in == p->stokes_in)
+                    num_products++;
+            }
+            if (num_products > max_products) max_products = num_products;
+        }
+        h->pix = oskar_mem_create(h->prec, OSKAR_CPU,
+                (size_t)max_products * h->max_chunk_size, status);
+    }
+
+    /* Create the binary file, if required. */
+    create_binary_file(h, status);
+}
+
+
+static void create_binary_file(oskar_BeamPattern* h, int* status)
+{
+    int i, num_products = 0;
+    char* name;
+    const unsigned char grp = OSKAR_TAG_GROUP_BEAM_PATTERN;
+    if (*status || h->binary_file) return;
+
+    /* Check if any data products are to be written to the binary file. */
+    for (i = 0; i < h->num_data_products; ++i)
+        if (h->data_products[i].binary) num_products++;
+    if (num_products == 0) return;
+
+    /* Create the file. */
+    name = (char*) calloc(strlen(h->root_path) + 5, 1);
+    sprintf(name, "%s.bin", h->root_path);
+    h->binary_file = oskar_binary_create(name, 'w', status);
+    free(name);
+    if (*status) return;
+
+    /* Write the header. */
+    const int image_size[] = {h->width, h->height};
+    oskar_binary_write(h->binary_file, OSKAR_INT, grp,
+            OSKAR_BEAM_PATTERN_TAG_IMAGE_SIZE, 0,
+            sizeof(image_size), image_size, status);
+    oskar_binary_write_int(h->binary_file, grp,
+            OSKAR_BEAM_PATTERN_TAG_NUM_PIXELS, 0, h->num_pixels, status);
+    oskar_binary_write_int(h->binary_file, grp,
+            OSKAR_BEAM_PATTERN_TAG_MAX_CHUNK_SIZE, 0, h->max_chunk_size,
+            status);
+    oskar_binary_write_int(h->binary_file, grp,
+            OSKAR_BEAM_PATTERN_TAG_NUM_CHUNKS, 0, h->num_chunks, status);
+    oskar_binary_write_int(h->binary_file, grp,
+            OSKAR_BEAM_PATTERN_TAG_NUM_TIMES, 0, h->num_time_steps, status);
+    oskar_binary_write_int(h->binary_file, grp,
+            OSKAR_BEAM_PATTERN_TAG_NUM_CHANNELS, 0, h->num_channels, status);
+    oskar_binary_write_double(h->binary_file, grp,
+            OSKAR_BEAM_PATTERN_TAG_TIME_START_MJD_UTC, 0,
+            h->time_start_mjd_utc, status);
+    oskar_binary_write_double(h->binary_file, grp,
+            OSKAR_BEAM_PATTERN_TAG_TIME_INC_SEC, 0, h->time_inc_sec, status);
+    oskar_binary_write_double(h->binary_file, grp,
+            OSKAR_BEAM_PATTERN_TAG_FREQ_START_HZ, 0, h->freq_start_hz, status);
+    oskar_binary_write_double(h->binary_file, grp,
+            OSKAR_BEAM_PATTERN_TAG_FREQ_INC_HZ, 0, h->freq_inc_hz, status);
+
+    /* Write the name of each data product, indexed by data product.
+     * This is the file name it would have had, without the root path. */
+    for (i = 0; i < h->num_data_products; ++i)
+    {
+        const DataProduct* p = &h->data_products[i];
+        const size_t root_len = strlen(h->root_path) + 1;
+        if (!p->binary) continue;
+        name = construct_filename(h, p->type, p->stokes_in, p->stokes_out,
+                p->i_station, p->time_average, p->channel_average, 0);
+        oskar_binary_write(h->binary_file, OSKAR_CHAR, grp,
+                OSKAR_BEAM_PATTERN_TAG_DATA_PRODUCT_NAME, i,
+                strlen(name + root_len) + 1, name + root_len, status);
+        free(name);
+    }
+
+    /* Create arrays for a block of data, written once per work unit
+     * (one chunk at one time and channel). Averaged data products are
+     * written in the block of the last unit that contributes to them.
+     * The block index holds the chunk index, the number of pixels and the
+     * number of data products, then the data product, time and channel
+     * indices of each set of pixels in the block. */
+    h->binary_block = h->binary_block_size = 0;
+    h->binary_data = oskar_mem_create(h->prec, OSKAR_CPU,
+            (size_t)num_products * h->max_chunk_size, status);
+    h->binary_index = oskar_mem_create(OSKAR_INT, OSKAR_CPU,
+            3 + 3 * num_products, status);
 }
 
 
@@ -421,7 +514,8 @@ static char* construct_filename(oskar_BeamPattern* h, int data_product_type,
     if (stokes_out >= 0)
         start += SNPRINTF(name + start, buflen - start, "_%s",
                 stokes_type_to_string(stokes_out));
-    start += SNPRINTF(name + start, buflen - start, ".%s", ext);
+    if (ext)
+        start += SNPRINTF(name + start, buflen - start, ".%s", ext);
     return name;
 }
 
@@ -439,6 +533,15 @@ static void new_fits_file(oskar_BeamPattern* h, int data_product_type,
     if ((stokes_in > I || stokes_out > I) && h->pol_mode != OSKAR_POL_MODE_FULL)
         return;
 
+    /* Write to the binary file instead, if required. */
+    if (h->binary_output)
+    {
+        i = data_product_index(h, data_product_type, stokes_in, stokes_out,
+                i_station, time_average, channel_average);
+        h->data_products[i].binary = 1;
+        return;
+    }
+
     /* Construct the filename. */
     name = construct_filename(h, data_product_type, stokes_in, stokes_out,
             i_station, time_average, channel_average, "fits");
@@ -610,6 +713,8 @@ static void set_up_device_data(oskar_BeamPattern* h, int* status)
             d->z    = oskar_mem_create(h->prec, dev_loc, 1 + max_src, status);
             d->tel  = oskar_telescope_create_copy(h->tel, dev_loc, status);
             d->work = oskar_station_work_create(h->prec, dev_loc, status);
+            oskar_station_work_set_weights_cache_size(d->work,
+                    OSKAR_STATION_WORK_WEIGHTS_CACHE_SIZE, status);
             oskar_station_work_set_tec_screen_common_params(d->work,
                     oskar_telescope_ionosphere_screen_type(d->tel),
                     oskar_telescope_tec_screen_height_km(d->tel),
@@ -641,18 +746,19 @@ static void set_up_device_data(oskar_BeamPattern* h, int* status)
                         beam_type, dev_loc, max_size, status);
                 oskar_mem_clear_contents(d->auto_power[i_stokes_type], status);
 
-                /* Host memory. */
+                /* Host memory.
+                 * Averages are only accumulated by the first device. */
                 d->auto_power_cpu[i_stokes_type][0] = oskar_mem_create(
                         beam_type, OSKAR_CPU, max_size, status);
                 d->auto_power_cpu[i_stokes_type][1] = oskar_mem_create(
                         beam_type, OSKAR_CPU, max_size, status);
-                if (h->average_single_axis == 'T')
+                if (i == 0 && h->average_single_axis == 'T')
                     d->auto_power_time_avg[i_stokes_type] = oskar_mem_create(
                             beam_type, OSKAR_CPU, max_size, status);
-                if (h->average_single_axis == 'C')
+                if (i == 0 && h->average_single_axis == 'C')
                     d->auto_power_channel_avg[i_stokes_type] = oskar_mem_create(
                             beam_type, OSKAR_CPU, max_size, status);
-                if (h->average_time_and_channel)
+                if (i == 0 && h->average_time_and_channel)
                     d->auto_power_channel_and_time_avg[i_stokes_type] =
                             oskar_mem_create(beam_type, OSKAR_CPU,
                                     max_size, status);
@@ -674,18 +780,19 @@ static void set_up_device_data(oskar_BeamPattern* h, int* status)
                         beam_type, dev_loc, max_src, status);
                 oskar_mem_clear_contents(d->cross_power[i_stokes_type], status);
 
-                /* Host memory. */
+                /* Host memory.
+                 * Averages are only accumulated by the first device. */
                 d->cross_power_cpu[i_stokes_type][0] = oskar_mem_create(
                         beam_type, OSKAR_CPU, max_src, status);
                 d->cross_power_cpu[i_stokes_type][1] = oskar_mem_create(
                         beam_type, OSKAR_CPU, max_src, status);
-                if (h->average_single_axis == 'T')
+                if (i == 0 && h->average_single_axis == 'T')
                     d->cross_power_time_avg[i_stokes_type] = oskar_mem_create(
                             beam_type, OSKAR_CPU, max_src, status);
-                if (h->average_single_axis == 'C')
+                if (i == 0 && h->average_single_axis == 'C')
                     d->cross_power_channel_avg[i_stokes_type] = oskar_mem_create(
                             beam_type, OSKAR_CPU, max_src, status);
-                if (h->average_time_and_channel)
+                if (i == 0 && h->average_time_and_channel)
                     d->cross_power_channel_and_time_avg[i_stokes_type] =
                             oskar_mem_create(beam_type, OSKAR_CPU,
                                     max_src, status);
@@ -26,8 +26,12 @@ void oskar_beam_pattern_reset_cache(oskar_BeamPattern* h, int* status)
     oskar_mem_free(h->y, status);
     oskar_mem_free(h->z, status);
     oskar_mem_free(h->pix, status);
-    oskar_mem_free(h->ctemp, status);
-    h->lon_rad = h->lat_rad = h->x = h->y = h->z = h->pix = h->ctemp = NULL;
+    oskar_mem_free(h->binary_data, status);
+    oskar_mem_free(h->binary_index, status);
+    h->lon_rad = h->lat_rad = h->x = h->y = h->z = h->pix = NULL;
+    h->binary_data = h->binary_index = NULL;
+    oskar_binary_free(h->binary_file);
+    h->binary_file = NULL;
 
     /* Close files and free data products. */
     for (i = 0; i < h->num_data_products; ++i)
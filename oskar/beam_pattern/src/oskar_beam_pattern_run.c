@@ -10,6 +10,7 @@
 #include "correlate/oskar_evaluate_cross_power.h"
 #include "math/oskar_cmath.h"
 #include "math/private_cond2_2x2.h"
+#include "mem/oskar_binary_write_mem.h"
 #include "utility/oskar_device.h"
 #include "utility/oskar_file_exists.h"
 #include "utility/oskar_get_error_string.h"
@@ -30,13 +31,22 @@ extern "C" {
 #endif
 
 static void* run_blocks(void* arg);
-static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
+static void unit_indices(const oskar_BeamPattern* h, int i_unit,
+        int* i_chunk, int* i_time, int* i_channel);
+static void sim_units(oskar_BeamPattern* h, int device_id, int* status);
+static void write_units(oskar_BeamPattern* h, int* status);
+static void sim_chunks(oskar_BeamPattern* h, int i_chunk, int i_time,
         int i_channel, int i_active, int device_id, int* status);
-static void write_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
-        int i_channel, int i_active, int* status);
+static void write_chunks(oskar_BeamPattern* h, int i_chunk, int i_time,
+        int i_channel, int i_device, int i_active, int* status);
 static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
         int i_channel, int num_pix, int channel_average, int time_average,
         const oskar_Mem* in, int chunk_desc, int stokes_in, int* status);
+static int convert_pixels(const oskar_BeamPattern* h, const DataProduct* p,
+        int num_pix, const oskar_Mem* in, int chunk_desc, oskar_Mem* ctemp,
+        oskar_Mem* pix, int* status);
+static void write_binary_block(oskar_BeamPattern* h, int i_chunk,
+        int num_pix, int* status);
 static void complex_to_amp(const oskar_Mem* complex_in, const int offset,
         const int stride, const int num_points, oskar_Mem* output, int* status);
 static void complex_to_phase(const oskar_Mem* complex_in, const int offset,
@@ -57,7 +67,7 @@ static unsigned int disp_width(unsigned int value);
 struct ThreadArgs
 {
     oskar_BeamPattern* h;
-    int num_threads, thread_id;
+    int thread_id;
 };
 typedef struct ThreadArgs ThreadArgs;
 
@@ -82,15 +92,22 @@ void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
     tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
     oskar_timer_resume(tmr);
 
+    /* Set up the work queue. */
+    h->num_units = h->num_chunks * h->num_time_steps * h->num_channels;
+    h->i_unit_next = 0;
+    for (i = 0; i < h->num_devices; ++i)
+    {
+        h->d[i].buffer_unit[0] = h->d[i].buffer_unit[1] = -1;
+        h->d[i].buffer_ready[0] = h->d[i].buffer_ready[1] = 0;
+    }
+
     /* Set up worker threads. */
     const int num_threads = h->num_devices + 1;
-    oskar_barrier_set_num_threads(h->barrier, num_threads);
     threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
     args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
     for (i = 0; i < num_threads; ++i)
     {
         args[i].h = h;
-        args[i].num_threads = num_threads;
         args[i].thread_id = i;
     }
 
@@ -161,94 +178,151 @@ void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
 
 static void* run_blocks(void* arg)
 {
-    oskar_BeamPattern* h;
-    int i_inner, i_outer, num_inner, num_outer, c, t, f, *status;
-
-    /* Loop indices for previous iteration (accessed only by thread 0). */
-    int cp = 0, tp = 0, fp = 0;
-
     /* Get thread function arguments. */
-    h = ((ThreadArgs*)arg)->h;
-    status = &(h->status);
-    const int num_threads = ((ThreadArgs*)arg)->num_threads;
+    oskar_BeamPattern* h = ((ThreadArgs*)arg)->h;
+    int* status = &(h->status);
     const int thread_id = ((ThreadArgs*)arg)->thread_id;
     const int device_id = thread_id - 1;
 
 #ifdef _OPENMP
-    /* Disable any nested parallelism. */
+    /* Disable any nested parallelism.
+     * Only the file writer thread converts data products in parallel,
+     * using the cores not taken by the CPU compute threads. */
+    int num_writer_threads = 1;
+    if (thread_id == 0)
+    {
+        const int num_cpu_threads = h->num_devices - h->num_gpus;
+        num_writer_threads = omp_get_num_procs() -
+                (num_cpu_threads > 0 ? num_cpu_threads : 0);
+        if (num_writer_threads < 1) num_writer_threads = 1;
+    }
     omp_set_nested(0);
-    omp_set_num_threads(1);
+    omp_set_num_threads(num_writer_threads);
 #endif
 
     if (device_id >= 0 && device_id < h->num_gpus)
         oskar_device_set(h->dev_loc, h->gpu_ids[device_id], status);
 
-    /* Set ranges of inner and outer loops based on averaging mode. */
+    /* Thread 0 is used for file writes.
+     * Threads 1 to n (mapped to compute devices) do the simulation. */
+    if (thread_id == 0)
+        write_units(h, status);
+    else
+        sim_units(h, device_id, status);
+    return 0;
+}
+
+
+static void unit_indices(const oskar_BeamPattern* h, int i_unit,
+        int* i_chunk, int* i_time, int* i_channel)
+{
+    /* Units are ordered by chunk, then by time and channel.
+     * Time is on the inner loop only if averaging over time alone. */
+    const int num_per_chunk = h->num_time_steps * h->num_channels;
+    const int i_inner_outer = i_unit % num_per_chunk;
+    *i_chunk = i_unit / num_per_chunk;
     if (h->average_single_axis != 'T')
     {
-        num_outer = h->num_time_steps;
-        num_inner = h->num_channels; /* Channel on inner loop. */
+        *i_time = i_inner_outer / h->num_channels;
+        *i_channel = i_inner_outer % h->num_channels; /* Channel inner. */
     }
     else
     {
-        num_outer = h->num_channels;
-        num_inner = h->num_time_steps; /* Time on inner loop. */
+        *i_channel = i_inner_outer / h->num_time_steps;
+        *i_time = i_inner_outer % h->num_time_steps; /* Time inner. */
     }
+}
+
+
+static void sim_units(oskar_BeamPattern* h, int device_id, int* status)
+{
+    DeviceData* d = &h->d[device_id];
 
-    /* Loop over image pixel chunks, running simulation and file writing one
-     * chunk at a time. Simulation and file output are overlapped by using
-     * double buffering, and a dedicated thread is used for file output.
-     *
-     * Thread 0 is used for file writes.
-     * Threads 1 to n (mapped to compute devices) do the simulation.
-     */
-    for (c = 0; c < h->num_chunks; c += h->num_devices)
+    /* Take units from the shared queue while there are any left.
+     * Each device has two host buffers, so it can simulate one unit
+     * while the previous one is being written. */
+    for (;;)
     {
-        for (i_outer = 0; i_outer < num_outer; ++i_outer)
+        int i_unit = -1, i_active = -1, c = 0, t = 0, f = 0;
+
+        /* Wait for a free host buffer, then claim the next unit. */
+        oskar_condition_lock(h->work_cond);
+        while (!*status && h->i_unit_next < h->num_units)
         {
-            for (i_inner = 0; i_inner < num_inner; ++i_inner)
+            i_active = (d->buffer_unit[0] < 0) ? 0 :
+                    ((d->buffer_unit[1] < 0) ? 1 : -1);
+            if (i_active >= 0)
             {
-                /* Set time and channel indices based on averaging mode. */
-                if (h->average_single_axis != 'T')
-                {
-                    t = i_outer;
-                    f = i_inner;
-                }
-                else
-                {
-                    f = i_outer;
-                    t = i_inner;
-                }
-                if (thread_id > 0 || num_threads == 1)
-                    sim_chunks(h, c, t, f, h->i_global & 1, device_id, status);
-                if (thread_id == 0 && h->i_global > 0)
-                    write_chunks(h, cp, tp, fp, h->i_global & 1, status);
-
-                /* Barrier 1: Set indices of the previous chunk(s). */
-                oskar_barrier_wait(h->barrier);
-                if (thread_id == 0)
+                i_unit = h->i_unit_next++;
+                d->buffer_unit[i_active] = i_unit;
+                d->buffer_ready[i_active] = 0;
+                break;
+            }
+            oskar_condition_wait(h->work_cond);
+        }
+        oskar_condition_unlock(h->work_cond);
+        if (i_unit < 0) break;
+
+        /* Simulate the unit, and flag it as ready to write.
+         * Notify the writer even on error, so it does not wait forever. */
+        unit_indices(h, i_unit, &c, &t, &f);
+        sim_chunks(h, c, t, f, i_active, device_id, status);
+        oskar_condition_lock(h->work_cond);
+        d->buffer_ready[i_active] = 1;
+        oskar_condition_notify_all(h->work_cond);
+        oskar_condition_unlock(h->work_cond);
+    }
+}
+
+
+static void write_units(oskar_BeamPattern* h, int* status)
+{
+    int i_unit;
+
+    /* Write units in order, as text files are written sequentially and
+     * averaged data are accumulated one unit at a time. */
+    for (i_unit = 0; i_unit < h->num_units; ++i_unit)
+    {
+        int i, i_device = -1, i_active = -1, c = 0, t = 0, f = 0;
+
+        /* Wait for the device holding this unit to finish it. */
+        oskar_condition_lock(h->work_cond);
+        while (!*status)
+        {
+            for (i = 0; i < 2 * h->num_devices; ++i)
+            {
+                const DeviceData* d = &h->d[i / 2];
+                if (d->buffer_unit[i % 2] == i_unit && d->buffer_ready[i % 2])
                 {
-                    cp = c;
-                    tp = t;
-                    fp = f;
-                    h->i_global++;
+                    i_device = i / 2;
+                    i_active = i % 2;
+                    break;
                 }
-
-                /* Barrier 2: Check sim and write are done. */
-                oskar_barrier_wait(h->barrier);
             }
+            if (i_device >= 0) break;
+            oskar_condition_wait(h->work_cond);
         }
+        oskar_condition_unlock(h->work_cond);
+        if (*status) break;
+
+        /* Write the unit and release its buffer. */
+        unit_indices(h, i_unit, &c, &t, &f);
+        write_chunks(h, c, t, f, i_device, i_active, status);
+        oskar_condition_lock(h->work_cond);
+        h->d[i_device].buffer_unit[i_active] = -1;
+        oskar_condition_notify_all(h->work_cond);
+        oskar_condition_unlock(h->work_cond);
     }
 
-    /* Write the very last chunk(s). */
-    if (thread_id == 0)
-        write_chunks(h, cp, tp, fp, h->i_global & 1, status);
-
-    return 0;
+    /* Wake any simulation threads still waiting for a buffer,
+     * in case of error. */
+    oskar_condition_lock(h->work_cond);
+    oskar_condition_notify_all(h->work_cond);
+    oskar_condition_unlock(h->work_cond);
 }
 
 
-static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
+static void sim_chunks(oskar_BeamPattern* h, int i_chunk, int i_time,
         int i_channel, int i_active, int device_id, int* status)
 {
     DeviceData* d;
@@ -257,13 +331,10 @@ static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
     int *models_evaluated = 0, *model_offsets = 0;
     if (*status) return;
 
-    /* Get chunk index from GPU ID and chunk start,
-     * and return immediately if it's out of range. */
+    /* Get the device data. */
     d = &h->d[device_id];
     const int* type_map = oskar_mem_int_const(
             oskar_telescope_station_type_map_const(d->tel), status);
-    const int i_chunk = i_chunk_start + device_id;
-    if (i_chunk >= h->num_chunks) return;
 
     /* Get time and frequency values. */
     oskar_timer_resume(d->tmr_compute);
@@ -405,162 +476,161 @@ static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
 }
 
 
-static void write_chunks(oskar_BeamPattern* h, int i_chunk_start,
-        int i_time, int i_channel, int i_active, int* status)
+static void write_chunks(oskar_BeamPattern* h, int i_chunk, int i_time,
+        int i_channel, int i_device, int i_active, int* status)
 {
-    int i, chunk_sources, stokes;
+    int chunk_sources, stokes;
     if (*status) return;
 
-    /* Write inactive chunk(s) from all GPUs. */
+    /* Write the chunk from the active buffer of the given device.
+     * Units are written in order, so averaged data for all devices are
+     * accumulated in the buffers of the first device. */
     oskar_timer_resume(h->tmr_write);
-    for (i = 0; i < h->num_devices; ++i)
-    {
-        DeviceData* d = &h->d[i];
+    const DeviceData* d = &h->d[i_device];
+    const DeviceData* avg = &h->d[0];
 
-        /* Get chunk index from GPU ID & chunk start. Stop if out of range. */
-        const int i_chunk = i_chunk_start + i;
-        if (i_chunk >= h->num_chunks || *status) break;
+    /* Get the size of the chunk. */
+    chunk_sources = h->max_chunk_size;
+    if ((i_chunk + 1) * h->max_chunk_size > h->num_pixels)
+        chunk_sources = h->num_pixels - i_chunk * h->max_chunk_size;
+    const int chunk_size = chunk_sources * h->num_active_stations;
 
-        /* Get the size of the chunk. */
-        chunk_sources = h->max_chunk_size;
-        if ((i_chunk + 1) * h->max_chunk_size > h->num_pixels)
-            chunk_sources = h->num_pixels - i_chunk * h->max_chunk_size;
-        const int chunk_size = chunk_sources * h->num_active_stations;
+    /* Write non-averaged raw data, if required. */
+    write_pixels(h, i_chunk, i_time, i_channel, chunk_sources, 0, 0,
+            d->jones_data_cpu[i_active], JONES_DATA, -1, status);
 
-        /* Write non-averaged raw data, if required. */
+    /* Loop over Stokes parameter types. */
+    for (stokes = 0; stokes < 2; ++stokes)
+    {
+        /* Write non-averaged data, if required. */
         write_pixels(h, i_chunk, i_time, i_channel, chunk_sources, 0, 0,
-                d->jones_data_cpu[!i_active], JONES_DATA, -1, status);
-
-        /* Loop over Stokes parameter types. */
-        for (stokes = 0; stokes < 2; ++stokes)
+                d->auto_power_cpu[stokes][i_active],
+                AUTO_POWER_DATA, stokes, status);
+        write_pixels(h, i_chunk, i_time, i_channel, chunk_sources, 0, 0,
+                d->cross_power_cpu[stokes][i_active],
+                CROSS_POWER_DATA, stokes, status);
+
+        /* Time-average the data if required. */
+        if (avg->auto_power_time_avg[stokes])
+            oskar_mem_add(avg->auto_power_time_avg[stokes],
+                    avg->auto_power_time_avg[stokes],
+                    d->auto_power_cpu[stokes][i_active],
+                    0, 0, 0, chunk_size, status);
+        if (avg->cross_power_time_avg[stokes])
+            oskar_mem_add(avg->cross_power_time_avg[stokes],
+                    avg->cross_power_time_avg[stokes],
+                    d->cross_power_cpu[stokes][i_active],
+                    0, 0, 0, chunk_sources, status);
+
+        /* Channel-average the data if required. */
+        if (avg->auto_power_channel_avg[stokes])
+            oskar_mem_add(avg->auto_power_channel_avg[stokes],
+                    avg->auto_power_channel_avg[stokes],
+                    d->auto_power_cpu[stokes][i_active],
+                    0, 0, 0, chunk_size, status);
+        if (avg->cross_power_channel_avg[stokes])
+            oskar_mem_add(avg->cross_power_channel_avg[stokes],
+                    avg->cross_power_channel_avg[stokes],
+                    d->cross_power_cpu[stokes][i_active],
+                    0, 0, 0, chunk_sources, status);
+
+        /* Channel- and time-average the data if required. */
+        if (avg->auto_power_channel_and_time_avg[stokes])
+            oskar_mem_add(avg->auto_power_channel_and_time_avg[stokes],
+                    avg->auto_power_channel_and_time_avg[stokes],
+                    d->auto_power_cpu[stokes][i_active],
+                    0, 0, 0, chunk_size, status);
+        if (avg->cross_power_channel_and_time_avg[stokes])
+            oskar_mem_add(avg->cross_power_channel_and_time_avg[stokes],
+                    avg->cross_power_channel_and_time_avg[stokes],
+                    d->cross_power_cpu[stokes][i_active],
+                    0, 0, 0, chunk_sources, status);
+
+        /* Write time-averaged data. */
+        if (i_time == h->num_time_steps - 1)
         {
-            /* Write non-averaged data, if required. */
-            write_pixels(h, i_chunk, i_time, i_channel, chunk_sources, 0, 0,
-                    d->auto_power_cpu[stokes][!i_active],
-                    AUTO_POWER_DATA, stokes, status);
-            write_pixels(h, i_chunk, i_time, i_channel, chunk_sources, 0, 0,
-                    d->cross_power_cpu[stokes][!i_active],
-                    CROSS_POWER_DATA, stokes, status);
-
-            /* Time-average the data if required. */
-            if (d->auto_power_time_avg[stokes])
-                oskar_mem_add(d->auto_power_time_avg[stokes],
-                        d->auto_power_time_avg[stokes],
-                        d->auto_power_cpu[stokes][!i_active],
-                        0, 0, 0, chunk_size, status);
-            if (d->cross_power_time_avg[stokes])
-                oskar_mem_add(d->cross_power_time_avg[stokes],
-                        d->cross_power_time_avg[stokes],
-                        d->cross_power_cpu[stokes][!i_active],
-                        0, 0, 0, chunk_sources, status);
-
-            /* Channel-average the data if required. */
-            if (d->auto_power_channel_avg[stokes])
-                oskar_mem_add(d->auto_power_channel_avg[stokes],
-                        d->auto_power_channel_avg[stokes],
-                        d->auto_power_cpu[stokes][!i_active],
-                        0, 0, 0, chunk_size, status);
-            if (d->cross_power_channel_avg[stokes])
-                oskar_mem_add(d->cross_power_channel_avg[stokes],
-                        d->cross_power_channel_avg[stokes],
-                        d->cross_power_cpu[stokes][!i_active],
-                        0, 0, 0, chunk_sources, status);
-
-            /* Channel- and time-average the data if required. */
-            if (d->auto_power_channel_and_time_avg[stokes])
-                oskar_mem_add(d->auto_power_channel_and_time_avg[stokes],
-                        d->auto_power_channel_and_time_avg[stokes],
-                        d->auto_power_cpu[stokes][!i_active],
-                        0, 0, 0, chunk_size, status);
-            if (d->cross_power_channel_and_time_avg[stokes])
-                oskar_mem_add(d->cross_power_channel_and_time_avg[stokes],
-                        d->cross_power_channel_and_time_avg[stokes],
-                        d->cross_power_cpu[stokes][!i_active],
-                        0, 0, 0, chunk_sources, status);
-
-            /* Write time-averaged data. */
-            if (i_time == h->num_time_steps - 1)
+            if (avg->auto_power_time_avg[stokes])
             {
-                if (d->auto_power_time_avg[stokes])
-                {
-                    oskar_mem_scale_real(d->auto_power_time_avg[stokes],
-                            1.0 / h->num_time_steps, 0, chunk_size, status);
-                    write_pixels(h, i_chunk, 0, i_channel, chunk_sources, 0, 1,
-                            d->auto_power_time_avg[stokes],
-                            AUTO_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(d->auto_power_time_avg[stokes],
-                            status);
-                }
-                if (d->cross_power_time_avg[stokes])
-                {
-                    oskar_mem_scale_real(d->cross_power_time_avg[stokes],
-                            1.0 / h->num_time_steps, 0, chunk_sources, status);
-                    write_pixels(h, i_chunk, 0, i_channel, chunk_sources, 0, 1,
-                            d->cross_power_time_avg[stokes],
-                            CROSS_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(d->cross_power_time_avg[stokes],
-                            status);
-                }
+                oskar_mem_scale_real(avg->auto_power_time_avg[stokes],
+                        1.0 / h->num_time_steps, 0, chunk_size, status);
+                write_pixels(h, i_chunk, 0, i_channel, chunk_sources, 0, 1,
+                        avg->auto_power_time_avg[stokes],
+                        AUTO_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(avg->auto_power_time_avg[stokes],
+                        status);
             }
+            if (avg->cross_power_time_avg[stokes])
+            {
+                oskar_mem_scale_real(avg->cross_power_time_avg[stokes],
+                        1.0 / h->num_time_steps, 0, chunk_sources, status);
+                write_pixels(h, i_chunk, 0, i_channel, chunk_sources, 0, 1,
+                        avg->cross_power_time_avg[stokes],
+                        CROSS_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(avg->cross_power_time_avg[stokes],
+                        status);
+            }
+        }
 
-            /* Write channel-averaged data. */
-            if (i_channel == h->num_channels - 1)
+        /* Write channel-averaged data. */
+        if (i_channel == h->num_channels - 1)
+        {
+            if (avg->auto_power_channel_avg[stokes])
             {
-                if (d->auto_power_channel_avg[stokes])
-                {
-                    oskar_mem_scale_real(d->auto_power_channel_avg[stokes],
-                            1.0 / h->num_channels, 0, chunk_size, status);
-                    write_pixels(h, i_chunk, i_time, 0, chunk_sources, 1, 0,
-                            d->auto_power_channel_avg[stokes],
-                            AUTO_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(d->auto_power_channel_avg[stokes],
-                            status);
-                }
-                if (d->cross_power_channel_avg[stokes])
-                {
-                    oskar_mem_scale_real(d->cross_power_channel_avg[stokes],
-                            1.0 / h->num_channels, 0, chunk_sources, status);
-                    write_pixels(h, i_chunk, i_time, 0, chunk_sources, 1, 0,
-                            d->cross_power_channel_avg[stokes],
-                            CROSS_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(
-                            d->cross_power_channel_avg[stokes], status);
-                }
+                oskar_mem_scale_real(avg->auto_power_channel_avg[stokes],
+                        1.0 / h->num_channels, 0, chunk_size, status);
+                write_pixels(h, i_chunk, i_time, 0, chunk_sources, 1, 0,
+                        avg->auto_power_channel_avg[stokes],
+                        AUTO_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(avg->auto_power_channel_avg[stokes],
+                        status);
+            }
+            if (avg->cross_power_channel_avg[stokes])
+            {
+                oskar_mem_scale_real(avg->cross_power_channel_avg[stokes],
+                        1.0 / h->num_channels, 0, chunk_sources, status);
+                write_pixels(h, i_chunk, i_time, 0, chunk_sources, 1, 0,
+                        avg->cross_power_channel_avg[stokes],
+                        CROSS_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(
+                        avg->cross_power_channel_avg[stokes], status);
             }
+        }
 
-            /* Write channel- and time-averaged data. */
-            if ((i_time == h->num_time_steps - 1) &&
-                    (i_channel == h->num_channels - 1))
+        /* Write channel- and time-averaged data. */
+        if ((i_time == h->num_time_steps - 1) &&
+                (i_channel == h->num_channels - 1))
+        {
+            if (avg->auto_power_channel_and_time_avg[stokes])
             {
-                if (d->auto_power_channel_and_time_avg[stokes])
-                {
-                    oskar_mem_scale_real(
-                            d->auto_power_channel_and_time_avg[stokes],
-                            1.0 / (h->num_channels * h->num_time_steps),
-                            0, chunk_size, status);
-                    write_pixels(h, i_chunk, 0, 0, chunk_sources, 1, 1,
-                            d->auto_power_channel_and_time_avg[stokes],
-                            AUTO_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(
-                            d->auto_power_channel_and_time_avg[stokes],
-                            status);
-                }
-                if (d->cross_power_channel_and_time_avg[stokes])
-                {
-                    oskar_mem_scale_real(
-                            d->cross_power_channel_and_time_avg[stokes],
-                            1.0 / (h->num_channels * h->num_time_steps),
-                            0, chunk_sources, status);
-                    write_pixels(h, i_chunk, 0, 0, chunk_sources, 1, 1,
-                            d->cross_power_channel_and_time_avg[stokes],
-                            CROSS_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(
-                            d->cross_power_channel_and_time_avg[stokes],
-                            status);
-                }
+                oskar_mem_scale_real(
+                        avg->auto_power_channel_and_time_avg[stokes],
+                        1.0 / (h->num_channels * h->num_time_steps),
+                        0, chunk_size, status);
+                write_pixels(h, i_chunk, 0, 0, chunk_sources, 1, 1,
+                        avg->auto_power_channel_and_time_avg[stokes],
+                        AUTO_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(
+                        avg->auto_power_channel_and_time_avg[stokes],
+                        status);
+            }
+            if (avg->cross_power_channel_and_time_avg[stokes])
+            {
+                oskar_mem_scale_real(
+                        avg->cross_power_channel_and_time_avg[stokes],
+                        1.0 / (h->num_channels * h->num_time_steps),
+                        0, chunk_sources, status);
+                write_pixels(h, i_chunk, 0, 0, chunk_sources, 1, 1,
+                        avg->cross_power_channel_and_time_avg[stokes],
+                        CROSS_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(
+                        avg->cross_power_channel_and_time_avg[stokes],
+                        status);
             }
         }
     }
+
+    /* Write all binary data for this work unit together. */
+    write_binary_block(h, i_chunk, chunk_sources, status);
     oskar_timer_pause(h->tmr_write);
 }
 
@@ -569,117 +639,204 @@ static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
         int i_channel, int num_pix, int channel_average, int time_average,
         const oskar_Mem* in, int chunk_desc, int stokes_in, int* status)
 {
-    int i;
-    if (!in) return;
+    int i, j, num_jobs = 0, *jobs = 0, *converted = 0;
+    if (!in || *status) return;
 
-    /* Loop over data products. */
-    const int num_pol = h->pol_mode == OSKAR_POL_MODE_FULL ? 4 : 1;
+    /* Find the data products to generate from this data.
+     * Raw data are written directly, as they don't go via pixels. */
+    jobs = (int*) calloc(h->num_data_products, sizeof(int));
+    converted = (int*) calloc(h->num_data_products, sizeof(int));
     for (i = 0; i < h->num_data_products; ++i)
     {
-        fitsfile* f;
-        FILE* t;
-        int dp, stokes_out, i_station, off;
-
-        /* Get data product info. */
-        f          = h->data_products[i].fits_file;
-        t          = h->data_products[i].text_file;
-        dp         = h->data_products[i].type;
-        stokes_out = h->data_products[i].stokes_out;
-        i_station  = h->data_products[i].i_station;
+        const DataProduct* p = &h->data_products[i];
 
         /* Check averaging mode and polarisation input type. */
-        if (h->data_products[i].time_average != time_average ||
-                h->data_products[i].channel_average != channel_average ||
-                h->data_products[i].stokes_in != stokes_in)
+        if (p->time_average != time_average ||
+                p->channel_average != channel_average ||
+                p->stokes_in != stokes_in)
             continue;
 
-        /* Treat raw data output as special case, as it doesn't go via pix. */
-        if (dp == RAW_COMPLEX && chunk_desc == JONES_DATA && t)
+        /* Treat raw data output as special case. */
+        if (p->type == RAW_COMPLEX && chunk_desc == JONES_DATA &&
+                p->text_file)
         {
             oskar_Mem* station_data;
-            station_data = oskar_mem_create_alias(in, i_station * num_pix,
-                    num_pix, status);
-            oskar_mem_save_ascii(t, 1, 0, num_pix, status, station_data);
+            station_data = oskar_mem_create_alias(in,
+                    p->i_station * num_pix, num_pix, status);
+            oskar_mem_save_ascii(p->text_file, 1, 0, num_pix, status,
+                    station_data);
             oskar_mem_free(station_data, status);
             continue;
         }
-        if (dp == CROSS_POWER_RAW_COMPLEX &&
-                chunk_desc == CROSS_POWER_DATA && t)
+        if (p->type == CROSS_POWER_RAW_COMPLEX &&
+                chunk_desc == CROSS_POWER_DATA && p->text_file)
         {
-            oskar_mem_save_ascii(t, 1, 0, num_pix, status, in);
+            oskar_mem_save_ascii(p->text_file, 1, 0, num_pix, status, in);
             continue;
         }
+        jobs[num_jobs++] = i;
+    }
 
-        /* Convert complex values to pixel data. */
-        oskar_mem_clear_contents(h->pix, status);
-        if (chunk_desc == JONES_DATA && dp == AMP)
-        {
-            off = i_station * num_pix * num_pol;
-            if (stokes_out == XX || stokes_out == -1)
-                complex_to_amp(in, off, num_pol, num_pix, h->pix, status);
-            else if (stokes_out == XY)
-                complex_to_amp(in, off + 1, num_pol, num_pix, h->pix, status);
-            else if (stokes_out == YX)
-                complex_to_amp(in, off + 2, num_pol, num_pix, h->pix, status);
-            else if (stokes_out == YY)
-                complex_to_amp(in, off + 3, num_pol, num_pix, h->pix, status);
-            else continue;
-        }
-        else if (chunk_desc == JONES_DATA && dp == PHASE)
+    /* Convert complex values to pixel data for each data product,
+     * in parallel. Each data product has its own part of the pixel array. */
+#pragma omp parallel private(j)
+    {
+        oskar_Mem *ctemp, *pix;
+        int thread_status = 0;
+        ctemp = oskar_mem_create(h->prec | OSKAR_COMPLEX, OSKAR_CPU,
+                num_pix, &thread_status);
+#pragma omp for schedule(dynamic, 1)
+        for (j = 0; j < num_jobs; ++j)
         {
-            off = i_station * num_pix * num_pol;
-            if (stokes_out == XX || stokes_out == -1)
-                complex_to_phase(in, off, num_pol, num_pix, h->pix, status);
-            else if (stokes_out == XY)
-                complex_to_phase(in, off + 1, num_pol, num_pix, h->pix, status);
-            else if (stokes_out == YX)
-                complex_to_phase(in, off + 2, num_pol, num_pix, h->pix, status);
-            else if (stokes_out == YY)
-                complex_to_phase(in, off + 3, num_pol, num_pix, h->pix, status);
-            else continue;
+            pix = oskar_mem_create_alias(h->pix,
+                    (size_t)j * h->max_chunk_size, num_pix, &thread_status);
+            converted[j] = convert_pixels(h, &h->data_products[jobs[j]],
+                    num_pix, in, chunk_desc, ctemp, pix, &thread_status);
+            oskar_mem_free(pix, &thread_status);
         }
-        else if (chunk_desc == JONES_DATA && dp == IXR)
-            jones_to_ixr(in, i_station * num_pix, num_pix, h->pix, status);
-        else if (chunk_desc == AUTO_POWER_DATA ||
-                chunk_desc == CROSS_POWER_DATA)
+        oskar_mem_free(ctemp, &thread_status);
+        if (thread_status)
         {
-            off = i_station * num_pix; /* Station offset. */
-            if (off < 0 || chunk_desc == CROSS_POWER_DATA) off = 0;
-            if (chunk_desc == CROSS_POWER_DATA && (dp & AUTO_POWER))
-                continue;
-            if (chunk_desc == AUTO_POWER_DATA && (dp & CROSS_POWER))
-                continue;
-            if (stokes_out >= I && stokes_out <= V)
-                oskar_convert_linear_to_stokes(num_pix, off, in,
-                        stokes_out, h->ctemp, status);
-            else continue;
-            if (dp & AMP)
-                complex_to_amp(h->ctemp, 0, 1, num_pix, h->pix, status);
-            else if (dp & PHASE)
-                complex_to_phase(h->ctemp, 0, 1, num_pix, h->pix, status);
-            else if (dp & REAL)
-                complex_to_real(h->ctemp, 0, 1, num_pix, h->pix, status);
-            else if (dp & IMAG)
-                complex_to_imag(h->ctemp, 0, 1, num_pix, h->pix, status);
-            else continue;
+#pragma omp critical
+            *status = thread_status;
         }
-        else continue;
+    }
+
+    /* Write the pixel data for each data product. */
+    for (j = 0; j < num_jobs && !*status; ++j)
+    {
+        DataProduct* p = &h->data_products[jobs[j]];
+        if (!converted[j]) continue;
+        const size_t offset = (size_t)j * h->max_chunk_size;
+        void* pix = oskar_mem_char(h->pix) +
+                offset * oskar_mem_element_size(h->prec);
 
         /* Check for FITS file. */
-        if (f && h->width && h->height)
+        if (p->fits_file && h->width && h->height)
         {
             long firstpix[4];
             firstpix[0] = 1 + (i_chunk * h->max_chunk_size) % h->width;
             firstpix[1] = 1 + (i_chunk * h->max_chunk_size) / h->width;
             firstpix[2] = 1 + i_channel;
             firstpix[3] = 1 + i_time;
-            fits_write_pix(f, (h->prec == OSKAR_DOUBLE ? TDOUBLE : TFLOAT),
-                    firstpix, num_pix, oskar_mem_void(h->pix), status);
+            fits_write_pix(p->fits_file,
+                    (h->prec == OSKAR_DOUBLE ? TDOUBLE : TFLOAT),
+                    firstpix, num_pix, pix, status);
         }
 
         /* Check for text file. */
-        if (t) oskar_mem_save_ascii(t, 1, 0, num_pix, status, h->pix);
+        if (p->text_file)
+        {
+            oskar_Mem* data = oskar_mem_create_alias(h->pix, offset,
+                    num_pix, status);
+            oskar_mem_save_ascii(p->text_file, 1, 0, num_pix, status, data);
+            oskar_mem_free(data, status);
+        }
+
+        /* Add to the binary data block for this chunk. */
+        if (p->binary)
+        {
+            int* index = oskar_mem_int(h->binary_index, status);
+            const int k = h->binary_block_size++;
+            index[3 + 3 * k] = jobs[j];
+            index[4 + 3 * k] = i_time;
+            index[5 + 3 * k] = i_channel;
+            oskar_mem_copy_contents(h->binary_data, h->pix,
+                    (size_t)k * num_pix, offset, num_pix, status);
+        }
+    }
+    free(jobs);
+    free(converted);
+}
+
+
+static int convert_pixels(const oskar_BeamPattern* h, const DataProduct* p,
+        int num_pix, const oskar_Mem* in, int chunk_desc, oskar_Mem* ctemp,
+        oskar_Mem* pix, int* status)
+{
+    int off;
+    const int dp = p->type, stokes_out = p->stokes_out;
+    const int i_station = p->i_station;
+    const int num_pol = h->pol_mode == OSKAR_POL_MODE_FULL ? 4 : 1;
+    if (chunk_desc == JONES_DATA && dp == AMP)
+    {
+        off = i_station * num_pix * num_pol;
+        if (stokes_out == XX || stokes_out == -1)
+            complex_to_amp(in, off, num_pol, num_pix, pix, status);
+        else if (stokes_out == XY)
+            complex_to_amp(in, off + 1, num_pol, num_pix, pix, status);
+        else if (stokes_out == YX)
+            complex_to_amp(in, off + 2, num_pol, num_pix, pix, status);
+        else if (stokes_out == YY)
+            complex_to_amp(in, off + 3, num_pol, num_pix, pix, status);
+        else return 0;
+    }
+    else if (chunk_desc == JONES_DATA && dp == PHASE)
+    {
+        off = i_station * num_pix * num_pol;
+        if (stokes_out == XX || stokes_out == -1)
+            complex_to_phase(in, off, num_pol, num_pix, pix, status);
+        else if (stokes_out == XY)
+            complex_to_phase(in, off + 1, num_pol, num_pix, pix, status);
+        else if (stokes_out == YX)
+            complex_to_phase(in, off + 2, num_pol, num_pix, pix, status);
+        else if (stokes_out == YY)
+            complex_to_phase(in, off + 3, num_pol, num_pix, pix, status);
+        else return 0;
+    }
+    else if (chunk_desc == JONES_DATA && dp == IXR)
+    {
+        oskar_mem_clear_contents(pix, status);
+        jones_to_ixr(in, i_station * num_pix, num_pix, pix, status);
     }
+    else if (chunk_desc == AUTO_POWER_DATA ||
+            chunk_desc == CROSS_POWER_DATA)
+    {
+        off = i_station * num_pix; /* Station offset. */
+        if (off < 0 || chunk_desc == CROSS_POWER_DATA) off = 0;
+        if (chunk_desc == CROSS_POWER_DATA && (dp & AUTO_POWER))
+            return 0;
+        if (chunk_desc == AUTO_POWER_DATA && (dp & CROSS_POWER))
+            return 0;
+        if (stokes_out >= I && stokes_out <= V)
+            oskar_convert_linear_to_stokes(num_pix, off, in,
+                    stokes_out, ctemp, status);
+        else return 0;
+        if (dp & AMP)
+            complex_to_amp(ctemp, 0, 1, num_pix, pix, status);
+        else if (dp & PHASE)
+            complex_to_phase(ctemp, 0, 1, num_pix, pix, status);
+        else if (dp & REAL)
+            complex_to_real(ctemp, 0, 1, num_pix, pix, status);
+        else if (dp & IMAG)
+            complex_to_imag(ctemp, 0, 1, num_pix, pix, status);
+        else return 0;
+    }
+    else return 0;
+    return 1;
+}
+
+
+static void write_binary_block(oskar_BeamPattern* h, int i_chunk,
+        int num_pix, int* status)
+{
+    int* index;
+    if (!h->binary_file || h->binary_block_size == 0 || *status) return;
+
+    /* Write the block index and the pixel data for all data products
+     * in this work unit, then reset the block. */
+    index = oskar_mem_int(h->binary_index, status);
+    index[0] = i_chunk;
+    index[1] = num_pix;
+    index[2] = h->binary_block_size;
+    oskar_binary_write_mem(h->binary_file, h->binary_index,
+            OSKAR_TAG_GROUP_BEAM_PATTERN, OSKAR_BEAM_PATTERN_TAG_BLOCK_INDEX,
+            h->binary_block, 3 + 3 * h->binary_block_size, status);
+    oskar_binary_write_mem(h->binary_file, h->binary_data,
+            OSKAR_TAG_GROUP_BEAM_PATTERN, OSKAR_BEAM_PATTERN_TAG_BLOCK_DATA,
+            h->binary_block, (size_t)num_pix * h->binary_block_size, status);
+    h->binary_block++;
+    h->binary_block_size = 0;
 }
 
 
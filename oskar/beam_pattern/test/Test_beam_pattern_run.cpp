@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "beam_pattern/oskar_beam_pattern.h"
+#include "binary/oskar_binary.h"
+#include "log/oskar_log.h"
+#include "math/oskar_cmath.h"
+#include "mem/oskar_binary_read_mem.h"
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_dir.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const int image_size = 8;
+static const int num_times = 3;
+static const int num_channels = 2;
+
+static oskar_Telescope* create_telescope(const char* dir, int* status)
+{
+    FILE* f;
+    char* path;
+    oskar_dir_mkpath(dir);
+    path = oskar_dir_get_path(dir, "position.txt");
+    f = fopen(path, "w");
+    fprintf(f, "0.0, -50.0\n");
+    fclose(f);
+    free(path);
+    path = oskar_dir_get_path(dir, "layout.txt");
+    f = fopen(path, "w");
+    fprintf(f, "0.0, 0.0\n100.0, 20.0\n-30.0, 80.0\n");
+    fclose(f);
+    free(path);
+    path = oskar_dir_get_path(dir, "station");
+    oskar_dir_mkpath(path);
+    free(path);
+    path = oskar_dir_get_path(dir, "station/layout.txt");
+    f = fopen(path, "w");
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 4; ++j)
+            fprintf(f, "%.1f, %.1f\n", 1.5 * i, 1.5 * j);
+    fclose(f);
+    free(path);
+    oskar_Telescope* tel = oskar_telescope_create(OSKAR_DOUBLE,
+            OSKAR_CPU, 0, status);
+    oskar_telescope_set_enable_numerical_patterns(tel, 0);
+    oskar_telescope_load(tel, dir, NULL, status);
+    oskar_telescope_set_phase_centre(tel, OSKAR_COORDS_RADEC,
+            20.0 * M_PI / 180.0, -30.0 * M_PI / 180.0);
+    return tel;
+}
+
+static void run_beam_pattern(const oskar_Telescope* tel, const char* root,
+        int num_devices, int max_chunk_size, int binary, int* status)
+{
+    oskar_BeamPattern* h = oskar_beam_pattern_create(OSKAR_DOUBLE, status);
+    oskar_log_set_file_priority(oskar_beam_pattern_log(h), OSKAR_LOG_NONE);
+    oskar_log_set_term_priority(oskar_beam_pattern_log(h), OSKAR_LOG_NONE);
+    oskar_beam_pattern_set_gpus(h, 0, 0, status);
+    oskar_beam_pattern_set_num_devices(h, num_devices);
+    oskar_beam_pattern_set_max_chunk_size(h, max_chunk_size);
+    oskar_beam_pattern_set_observation_frequency(h, 100e6, 20e6,
+            num_channels);
+    oskar_beam_pattern_set_observation_time(h, 51544.5, 3600.0, num_times);
+    oskar_beam_pattern_set_image_size(h, image_size, image_size);
+    oskar_beam_pattern_set_image_fov(h, 90.0, 90.0);
+    oskar_beam_pattern_set_root_path(h, root);
+    oskar_beam_pattern_set_station_ids(h, -1, 0);
+    oskar_beam_pattern_set_separate_time_and_channel(h, 1);
+    oskar_beam_pattern_set_average_time_and_channel(h, 1);
+    oskar_beam_pattern_set_average_single_axis(h, 'T');
+    oskar_beam_pattern_set_voltage_amp_fits(h, 1);
+    oskar_beam_pattern_set_auto_power_fits(h, 1);
+    oskar_beam_pattern_set_cross_power_amp_fits(h, 1);
+    oskar_beam_pattern_set_binary_output(h, binary);
+    oskar_beam_pattern_set_telescope_model(h, tel, status);
+    oskar_beam_pattern_run(h, status);
+    oskar_beam_pattern_free(h, status);
+}
+
+static void remove_fits_files(const char* root)
+{
+    int num_items = 0;
+    char** items = 0;
+    const std::string wildcard = std::string(root) + "_*.fits";
+    oskar_dir_items(".", wildcard.c_str(), 1, 0, &num_items, &items);
+    for (int i = 0; i < num_items; ++i)
+    {
+        remove(items[i]);
+        free(items[i]);
+    }
+    free(items);
+}
+
+static oskar_Mem* read_fits(const std::string& name, int num_pixels,
+        int i_time, int i_channel, int* status)
+{
+    int num_axes = 0, *axis_size = 0;
+    double* axis_inc = 0;
+    const int start_index[] = {0, 0, i_channel, i_time};
+    oskar_Mem* data = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_pixels, status);
+    oskar_mem_read_fits(data, 0, num_pixels, name.c_str(), 4, start_index,
+            &num_axes, &axis_size, &axis_inc, status);
+    free(axis_size);
+    free(axis_inc);
+    return data;
+}
+
+static std::vector<std::string> fits_files(const char* root)
+{
+    int num_items = 0;
+    char** items = 0;
+    std::vector<std::string> names;
+    const std::string wildcard = std::string(root) + "_*.fits";
+    oskar_dir_items(".", wildcard.c_str(), 1, 0, &num_items, &items);
+    for (int i = 0; i < num_items; ++i)
+    {
+        names.push_back(std::string(items[i]).substr(strlen(root)));
+        free(items[i]);
+    }
+    free(items);
+    return names;
+}
+
+TEST(beam_pattern_run, binary_file)
+{
+    int status = 0;
+    const char* tel_dir = "temp_test_beam_pattern_binary.tm";
+    const char* root = "temp_test_beam_pattern_binary";
+    const int num_pixels = image_size * image_size;
+    const int max_chunk_size = 24;
+    const int num_chunks = (num_pixels + max_chunk_size - 1) / max_chunk_size;
+    oskar_Telescope* tel = create_telescope(tel_dir, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Binary output replaces FITS output, so run the same beam pattern
+    // once for each.
+    run_beam_pattern(tel, root, 1, max_chunk_size, 0, &status);
+    run_beam_pattern(tel, root, 1, max_chunk_size, 1, &status);
+    oskar_telescope_free(tel, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check the header tags.
+    int value = 0, size[2] = {0, 0};
+    double value_d = 0.0;
+    const unsigned char grp = OSKAR_TAG_GROUP_BEAM_PATTERN;
+    const std::string bin_name = std::string(root) + ".bin";
+    oskar_Binary* f = oskar_binary_create(bin_name.c_str(), 'r', &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_binary_read(f, OSKAR_INT, grp, OSKAR_BEAM_PATTERN_TAG_IMAGE_SIZE,
+            0, sizeof(size), size, &status);
+    EXPECT_EQ(image_size, size[0]);
+    EXPECT_EQ(image_size, size[1]);
+    oskar_binary_read_int(f, grp, OSKAR_BEAM_PATTERN_TAG_NUM_PIXELS,
+            0, &value, &status);
+    EXPECT_EQ(num_pixels, value);
+    oskar_binary_read_int(f, grp, OSKAR_BEAM_PATTERN_TAG_MAX_CHUNK_SIZE,
+            0, &value, &status);
+    EXPECT_EQ(max_chunk_size, value);
+    oskar_binary_read_int(f, grp, OSKAR_BEAM_PATTERN_TAG_NUM_CHUNKS,
+            0, &value, &status);
+    EXPECT_EQ(num_chunks, value);
+    oskar_binary_read_int(f, grp, OSKAR_BEAM_PATTERN_TAG_NUM_TIMES,
+            0, &value, &status);
+    EXPECT_EQ(num_times, value);
+    oskar_binary_read_int(f, grp, OSKAR_BEAM_PATTERN_TAG_NUM_CHANNELS,
+            0, &value, &status);
+    EXPECT_EQ(num_channels, value);
+    oskar_binary_read_double(f, grp, OSKAR_BEAM_PATTERN_TAG_FREQ_START_HZ,
+            0, &value_d, &status);
+    EXPECT_DOUBLE_EQ(100e6, value_d);
+    oskar_binary_read_double(f, grp, OSKAR_BEAM_PATTERN_TAG_TIME_INC_SEC,
+            0, &value_d, &status);
+    EXPECT_DOUBLE_EQ(3600.0, value_d);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Read the last block, which holds a partial chunk, and compare each
+    // set of pixels in it with the matching part of the FITS image.
+    int last_block = -1;
+    for (int query_status = 0; !query_status; ++last_block)
+    {
+        oskar_binary_query(f, OSKAR_INT, grp,
+                OSKAR_BEAM_PATTERN_TAG_BLOCK_INDEX, last_block + 1, 0,
+                &query_status);
+    }
+    --last_block;
+    ASSERT_GE(last_block, 0);
+
+    // One block is written for each chunk at each time and channel.
+    EXPECT_EQ(num_chunks * num_times * num_channels, last_block + 1);
+    oskar_Mem* index = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, &status);
+    oskar_Mem* data = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    oskar_binary_read_mem(f, index, grp,
+            OSKAR_BEAM_PATTERN_TAG_BLOCK_INDEX, last_block, &status);
+    oskar_binary_read_mem(f, data, grp,
+            OSKAR_BEAM_PATTERN_TAG_BLOCK_DATA, last_block, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const int* idx = oskar_mem_int_const(index, &status);
+    const int i_chunk = idx[0], num_pix = idx[1], num_sets = idx[2];
+    EXPECT_EQ(num_chunks - 1, i_chunk);
+    EXPECT_EQ(num_pixels - i_chunk * max_chunk_size, num_pix);
+    ASSERT_GT(num_sets, 0);
+    ASSERT_EQ((size_t) (3 + 3 * num_sets), oskar_mem_length(index));
+    ASSERT_EQ((size_t) (num_pix * num_sets), oskar_mem_length(data));
+    const double* d = oskar_mem_double_const(data, &status);
+    for (int k = 0; k < num_sets; ++k)
+    {
+        const int i_product = idx[3 + 3 * k];
+        const int i_time = idx[4 + 3 * k], i_channel = idx[5 + 3 * k];
+        oskar_Mem* name = oskar_mem_create(OSKAR_CHAR, OSKAR_CPU, 0, &status);
+        oskar_binary_read_mem(f, name, grp,
+                OSKAR_BEAM_PATTERN_TAG_DATA_PRODUCT_NAME, i_product, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        const std::string fits_name = std::string(root) + "_" +
+                oskar_mem_char_const(name) + ".fits";
+        oskar_mem_free(name, &status);
+        oskar_Mem* image = read_fits(fits_name, num_pixels,
+                i_time, i_channel, &status);
+        ASSERT_EQ(0, status) << fits_name << ": " <<
+                oskar_get_error_string(status);
+        const double* img = oskar_mem_double_const(image, &status);
+        for (int i = 0; i < num_pix; ++i)
+        {
+            EXPECT_DOUBLE_EQ(img[i_chunk * max_chunk_size + i],
+                    d[k * num_pix + i]) << fits_name;
+        }
+        oskar_mem_free(image, &status);
+    }
+    oskar_mem_free(index, &status);
+    oskar_mem_free(data, &status);
+    oskar_binary_free(f);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Remove the output files.
+    oskar_dir_remove(tel_dir);
+    remove(bin_name.c_str());
+    remove_fits_files(root);
+}
+
+TEST(beam_pattern_run, multiple_devices)
+{
+    int status = 0;
+    const char* tel_dir = "temp_test_beam_pattern_devices.tm";
+    const char* root[] = {
+            "temp_test_beam_pattern_1_device",
+            "temp_test_beam_pattern_3_devices"
+    };
+    oskar_Telescope* tel = create_telescope(tel_dir, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Run the same beam pattern using one and three CPU devices.
+    // There are more work units than devices, and the averaged
+    // products are accumulated from units finished by every device.
+    run_beam_pattern(tel, root[0], 1, 24, 0, &status);
+    run_beam_pattern(tel, root[1], 3, 24, 0, &status);
+    oskar_telescope_free(tel, &status);
+    oskar_dir_remove(tel_dir);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check that each image cube is the same.
+    const std::vector<std::string> names = fits_files(root[0]);
+    ASSERT_EQ(names.size(), fits_files(root[1]).size());
+    ASSERT_GT(names.size(), 0u);
+    for (size_t k = 0; k < names.size(); ++k)
+    {
+        int num_axes = 0, *axis_size = 0, start_index = 0;
+        double* axis_inc = 0;
+        oskar_Mem* data[2];
+        for (int i = 0; i < 2; ++i)
+        {
+            const std::string name = root[i] + names[k];
+            data[i] = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+            oskar_mem_read_fits(data[i], 0, 0, name.c_str(), -1,
+                    &start_index, &num_axes, &axis_size, &axis_inc, &status);
+            ASSERT_EQ(0, status) << name << ": " <<
+                    oskar_get_error_string(status);
+        }
+        free(axis_size);
+        free(axis_inc);
+        const size_t num_pixels = oskar_mem_length(data[0]);
+        ASSERT_EQ(num_pixels, oskar_mem_length(data[1])) << names[k];
+        const double* a = oskar_mem_double_const(data[0], &status);
+        const double* b = oskar_mem_double_const(data[1], &status);
+        for (size_t j = 0; j < num_pixels; ++j)
+            EXPECT_DOUBLE_EQ(a[j], b[j]) << names[k] << " pixel " << j;
+        oskar_mem_free(data[0], &status);
+        oskar_mem_free(data[1], &status);
+    }
+
+    // Remove the output files.
+    remove_fits_files(root[0]);
+    remove_fits_files(root[1]);
+}
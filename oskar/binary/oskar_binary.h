@@ -67,7 +67,8 @@ enum OSKAR_TAG_GROUPS
     OSKAR_TAG_GROUP_SPLINE_DATA      = 9,
     OSKAR_TAG_GROUP_ELEMENT_DATA     = 10,
     OSKAR_TAG_GROUP_VIS_HEADER       = 11,
-    OSKAR_TAG_GROUP_VIS_BLOCK        = 12
+    OSKAR_TAG_GROUP_VIS_BLOCK        = 12,
+    OSKAR_TAG_GROUP_BEAM_PATTERN     = 13
 };
 
 /* Standard metadata tags. */
@@ -8,7 +8,7 @@
         const int offset,\
         GLOBAL FP4c *jones)\
 {\
-    KERNEL_LOOP_X(int, i, 0, num)\
+    KERNEL_LOOP_PAR_X(int, i, 0, num)\
     FP sin_phi, cos_phi;\
     FP2 x_theta_, x_phi_, y_theta_, y_phi_;\
     const FP p_x = phi_x[i];\
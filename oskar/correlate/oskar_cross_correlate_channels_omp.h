@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_CROSS_CORRELATE_CHANNELS_OMP_H_
+#define OSKAR_CROSS_CORRELATE_CHANNELS_OMP_H_
+
+/**
+ * @file oskar_cross_correlate_channels_omp.h
+ */
+
+#include <oskar_global.h>
+#include <utility/oskar_vector_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Correlate function for a block of channels, which also applies the
+ * interferometer phase (single precision).
+ *
+ * @details
+ * Forms visibilities on all baselines for a block of evenly-spaced
+ * channels, as oskar_cross_correlate_phase_omp_f() would for each channel
+ * in turn, but loads the source and baseline parameters only once for all
+ * the channels. The interferometer phase at each channel is obtained from
+ * the one at the first channel by a per-source complex rotation, so only
+ * two sine/cosine evaluations are needed per source and baseline,
+ * regardless of the number of channels.
+ *
+ * The Jones matrices may be supplied either once for all channels
+ * (if \p num_jones is 1) or once per channel (if \p num_jones is equal to
+ * \p num_channels). Source Stokes parameters are supplied for every channel,
+ * with the channel dimension slowest-varying.
+ *
+ * Gaussian sources are used if all of a, b and c are supplied;
+ * otherwise, these may be NULL for point sources.
+ *
+ * Note that the station x, y coordinates must be in the ECEF frame.
+ *
+ * @param[in] num_sources    Number of sources.
+ * @param[in] num_stations   Number of stations.
+ * @param[in] num_channels   Number of channels.
+ * @param[in] num_jones      Number of sets of Jones matrices (1 or num_channels).
+ * @param[in] offset_out     Output visibility start offset, for first channel.
+ * @param[in] channel_stride Output visibility offset between channels.
+ * @param[in] jones          Jones matrices to correlate (without Jones K).
+ * @param[in] I              Source Stokes I values, in Jy, for each channel.
+ * @param[in] Q              Source Stokes Q values, in Jy, for each channel.
+ * @param[in] U              Source Stokes U values, in Jy, for each channel.
+ * @param[in] V              Source Stokes V values, in Jy, for each channel.
+ * @param[in] l              Source l-direction cosines from phase centre.
+ * @param[in] m              Source m-direction cosines from phase centre.
+ * @param[in] n              Source n-direction cosines from phase centre.
+ * @param[in] a              Source Gaussian parameter a, or NULL.
+ * @param[in] b              Source Gaussian parameter b, or NULL.
+ * @param[in] c              Source Gaussian parameter c, or NULL.
+ * @param[in] station_u      Station u-coordinates, in metres.
+ * @param[in] station_v      Station v-coordinates, in metres.
+ * @param[in] station_w      Station w-coordinates, in metres.
+ * @param[in] station_x      Station x-coordinates, in metres.
+ * @param[in] station_y      Station y-coordinates, in metres.
+ * @param[in] uv_min_lambda  Minimum allowed UV length for each channel,
+ *                           in wavelengths.
+ * @param[in] uv_max_lambda  Maximum allowed UV length for each channel,
+ *                           in wavelengths.
+ * @param[in] inv_wavelength Inverse of the wavelength of the first channel.
+ * @param[in] inv_wavelength_inc Increment in inverse wavelength per channel.
+ * @param[in] frac_bandwidth Bandwidth divided by frequency of first channel.
+ * @param[in] time_int_sec   Time averaging interval, in seconds.
+ * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
+ * @param[in] dec0_rad       Declination of phase centre, in radians.
+ * @param[in] ignore_w_components If set, ignore w in the phase term.
+ * @param[in,out] vis        Modified output complex visibilities.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_channels_omp_f(
+        int num_sources, int num_stations, int num_channels, int num_jones,
+        int offset_out, int channel_stride,
+        const float4c* const* jones, const float* I, const float* Q,
+        const float* U, const float* V,
+        const float* l, const float* m, const float* n,
+        const float* a, const float* b, const float* c,
+        const float* station_u, const float* station_v,
+        const float* station_w, const float* station_x,
+        const float* station_y, const float* uv_min_lambda,
+        const float* uv_max_lambda, float inv_wavelength,
+        float inv_wavelength_inc, float frac_bandwidth, float time_int_sec,
+        float gha0_rad, float dec0_rad, int ignore_w_components,
+        float4c* vis);
+
+/**
+ * @brief
+ * Correlate function for a block of channels, which also applies the
+ * interferometer phase (double precision).
+ *
+ * @details
+ * See oskar_cross_correlate_channels_omp_f().
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_channels_omp_d(
+        int num_sources, int num_stations, int num_channels, int num_jones,
+        int offset_out, int channel_stride,
+        const double4c* const* jones, const double* I, const double* Q,
+        const double* U, const double* V,
+        const double* l, const double* m, const double* n,
+        const double* a, const double* b, const double* c,
+        const double* station_u, const double* station_v,
+        const double* station_w, const double* station_x,
+        const double* station_y, const double* uv_min_lambda,
+        const double* uv_max_lambda, double inv_wavelength,
+        double inv_wavelength_inc, double frac_bandwidth, double time_int_sec,
+        double gha0_rad, double dec0_rad, int ignore_w_components,
+        double4c* vis);
+
+/**
+ * @brief
+ * Scalar correlate function for a block of channels, which also applies
+ * the interferometer phase (single precision).
+ *
+ * @details
+ * As oskar_cross_correlate_channels_omp_f(), but for scalar Jones terms,
+ * using only Stokes I.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_scalar_channels_omp_f(
+        int num_sources, int num_stations, int num_channels, int num_jones,
+        int offset_out, int channel_stride,
+        const float2* const* jones, const float* I,
+        const float* l, const float* m, const float* n,
+        const float* a, const float* b, const float* c,
+        const float* station_u, const float* station_v,
+        const float* station_w, const float* station_x,
+        const float* station_y, const float* uv_min_lambda,
+        const float* uv_max_lambda, float inv_wavelength,
+        float inv_wavelength_inc, float frac_bandwidth, float time_int_sec,
+        float gha0_rad, float dec0_rad, int ignore_w_components,
+        float2* vis);
+
+/**
+ * @brief
+ * Scalar correlate function for a block of channels, which also applies
+ * the interferometer phase (double precision).
+ *
+ * @details
+ * As oskar_cross_correlate_channels_omp_f(), but for scalar Jones terms,
+ * using only Stokes I.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_scalar_channels_omp_d(
+        int num_sources, int num_stations, int num_channels, int num_jones,
+        int offset_out, int channel_stride,
+        const double2* const* jones, const double* I,
+        const double* l, const double* m, const double* n,
+        const double* a, const double* b, const double* c,
+        const double* station_u, const double* station_v,
+        const double* station_w, const double* station_x,
+        const double* station_y, const double* uv_min_lambda,
+        const double* uv_max_lambda, double inv_wavelength,
+        double inv_wavelength_inc, double frac_bandwidth, double time_int_sec,
+        double gha0_rad, double dec0_rad, int ignore_w_components,
+        double2* vis);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -244,6 +244,128 @@ void oskar_cross_correlate_gaussian_omp_d(
         double inv_wavelength, double frac_bandwidth, double time_int_sec,
         double gha0_rad, double dec0_rad, double4c* vis);
 
+/**
+ * @brief
+ * Correlate function which also applies the interferometer phase
+ * (single precision).
+ *
+ * @details
+ * Forms visibilities on all baselines by correlating Jones matrices for pairs
+ * of stations and summing along the source dimension, as the other
+ * correlate functions, but the input Jones matrices must not include the
+ * interferometer phase (Jones K). Instead, the phase for each source is
+ * evaluated on the fly from the baseline coordinates, which avoids forming
+ * and reading the station-based Jones K and combined Jones arrays.
+ *
+ * Gaussian sources are used if all of a, b and c are supplied;
+ * otherwise, these may be NULL for point sources.
+ *
+ * Note that the station x, y coordinates must be in the ECEF frame.
+ *
+ * @param[in] num_sources    Number of sources.
+ * @param[in] num_stations   Number of stations.
+ * @param[in] offset_out     Output visibility start offset.
+ * @param[in] jones          Jones matrices to correlate (without Jones K).
+ * @param[in] I              Source Stokes I values, in Jy.
+ * @param[in] Q              Source Stokes Q values, in Jy.
+ * @param[in] U              Source Stokes U values, in Jy.
+ * @param[in] V              Source Stokes V values, in Jy.
+ * @param[in] l              Source l-direction cosines from phase centre.
+ * @param[in] m              Source m-direction cosines from phase centre.
+ * @param[in] n              Source n-direction cosines from phase centre.
+ * @param[in] a              Source Gaussian parameter a, or NULL.
+ * @param[in] b              Source Gaussian parameter b, or NULL.
+ * @param[in] c              Source Gaussian parameter c, or NULL.
+ * @param[in] station_u      Station u-coordinates, in metres.
+ * @param[in] station_v      Station v-coordinates, in metres.
+ * @param[in] station_w      Station w-coordinates, in metres.
+ * @param[in] station_x      Station x-coordinates, in metres.
+ * @param[in] station_y      Station y-coordinates, in metres.
+ * @param[in] uv_min_lambda  Minimum allowed UV length, in wavelengths.
+ * @param[in] uv_max_lambda  Maximum allowed UV length, in wavelengths.
+ * @param[in] inv_wavelength Inverse of the wavelength, in metres.
+ * @param[in] frac_bandwidth Bandwidth divided by frequency.
+ * @param[in] time_int_sec   Time averaging interval, in seconds.
+ * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
+ * @param[in] dec0_rad       Declination of phase centre, in radians.
+ * @param[in] ignore_w_components If set, ignore w in the phase term.
+ * @param[in,out] vis        Modified output complex visibilities.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_phase_omp_f(
+        int num_sources, int num_stations, int offset_out,
+        const float4c* jones, const float* I, const float* Q,
+        const float* U, const float* V,
+        const float* l, const float* m, const float* n,
+        const float* a, const float* b, const float* c,
+        const float* station_u, const float* station_v,
+        const float* station_w, const float* station_x,
+        const float* station_y, float uv_min_lambda, float uv_max_lambda,
+        float inv_wavelength, float frac_bandwidth, float time_int_sec,
+        float gha0_rad, float dec0_rad, int ignore_w_components,
+        float4c* vis);
+
+/**
+ * @brief
+ * Correlate function which also applies the interferometer phase
+ * (double precision).
+ *
+ * @details
+ * Forms visibilities on all baselines by correlating Jones matrices for pairs
+ * of stations and summing along the source dimension, as the other
+ * correlate functions, but the input Jones matrices must not include the
+ * interferometer phase (Jones K). Instead, the phase for each source is
+ * evaluated on the fly from the baseline coordinates, which avoids forming
+ * and reading the station-based Jones K and combined Jones arrays.
+ *
+ * Gaussian sources are used if all of a, b and c are supplied;
+ * otherwise, these may be NULL for point sources.
+ *
+ * Note that the station x, y coordinates must be in the ECEF frame.
+ *
+ * @param[in] num_sources    Number of sources.
+ * @param[in] num_stations   Number of stations.
+ * @param[in] offset_out     Output visibility start offset.
+ * @param[in] jones          Jones matrices to correlate (without Jones K).
+ * @param[in] I              Source Stokes I values, in Jy.
+ * @param[in] Q              Source Stokes Q values, in Jy.
+ * @param[in] U              Source Stokes U values, in Jy.
+ * @param[in] V              Source Stokes V values, in Jy.
+ * @param[in] l              Source l-direction cosines from phase centre.
+ * @param[in] m              Source m-direction cosines from phase centre.
+ * @param[in] n              Source n-direction cosines from phase centre.
+ * @param[in] a              Source Gaussian parameter a, or NULL.
+ * @param[in] b              Source Gaussian parameter b, or NULL.
+ * @param[in] c              Source Gaussian parameter c, or NULL.
+ * @param[in] station_u      Station u-coordinates, in metres.
+ * @param[in] station_v      Station v-coordinates, in metres.
+ * @param[in] station_w      Station w-coordinates, in metres.
+ * @param[in] station_x      Station x-coordinates, in metres.
+ * @param[in] station_y      Station y-coordinates, in metres.
+ * @param[in] uv_min_lambda  Minimum allowed UV length, in wavelengths.
+ * @param[in] uv_max_lambda  Maximum allowed UV length, in wavelengths.
+ * @param[in] inv_wavelength Inverse of the wavelength, in metres.
+ * @param[in] frac_bandwidth Bandwidth divided by frequency.
+ * @param[in] time_int_sec   Time averaging interval, in seconds.
+ * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
+ * @param[in] dec0_rad       Declination of phase centre, in radians.
+ * @param[in] ignore_w_components If set, ignore w in the phase term.
+ * @param[in,out] vis        Modified output complex visibilities.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_phase_omp_d(
+        int num_sources, int num_stations, int offset_out,
+        const double4c* jones, const double* I, const double* Q,
+        const double* U, const double* V,
+        const double* l, const double* m, const double* n,
+        const double* a, const double* b, const double* c,
+        const double* station_u, const double* station_v,
+        const double* station_w, const double* station_x,
+        const double* station_y, double uv_min_lambda, double uv_max_lambda,
+        double inv_wavelength, double frac_bandwidth, double time_int_sec,
+        double gha0_rad, double dec0_rad, int ignore_w_components,
+        double4c* vis);
+
 #ifdef __cplusplus
 }
 #endif
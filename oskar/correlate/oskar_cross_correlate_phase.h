@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_CROSS_CORRELATE_PHASE_H_
+#define OSKAR_CROSS_CORRELATE_PHASE_H_
+
+/**
+ * @file oskar_cross_correlate_phase.h
+ */
+
+#include <oskar_global.h>
+#include <telescope/oskar_telescope.h>
+#include <interferometer/oskar_jones.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Forms visibilities from Jones matrices which do not include
+ * the interferometer phase (i.e. V = E K B K* E*).
+ *
+ * @details
+ * This is equivalent to evaluating the interferometer phase (Jones K)
+ * at each station, multiplying it with the supplied Jones matrices and
+ * then calling oskar_cross_correlate(), but the phase for each source
+ * is instead evaluated from the baseline coordinates while correlating.
+ * This avoids writing and reading the station-based Jones K and combined
+ * Jones arrays.
+ *
+ * Unlike oskar_evaluate_jones_K(), no source filter is applied,
+ * so any sources to be omitted must have zero flux.
+ *
+ * This function is currently only available for data in CPU memory.
+ *
+ * @param[in]  source_type    Source type (0 = point, 1 = Gaussian).
+ * @param[in]  num_sources    Number of sources to use.
+ * @param[in]  jones          Set of Jones matrices, without Jones K.
+ * @param[in]  src_flux[4]    Vectors of source Stokes (I, Q, U, V) values.
+ * @param[in]  src_dir[3]     Vectors of source direction cosines.
+ * @param[in]  src_ext[3]     Vectors of extended source parameters.
+ * @param[in]  tel            Telescope model.
+ * @param[in]  station_uvw[3] Station (u, v, w) coordinates, in metres.
+ * @param[in]  gast           Greenwich apparent sidereal time, in radians.
+ * @param[in]  frequency_hz   Current observation frequency, in Hz.
+ * @param[in]  ignore_w_components If set, ignore w in the phase term.
+ * @param[in]  offset_out     Output visibility start offset.
+ * @param[out] vis            Output visibility amplitudes.
+ * @param[in,out] status      Status return code.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_phase(
+        int source_type,
+        int num_sources,
+        const oskar_Jones* jones,
+        const oskar_Mem* const src_flux[4],
+        const oskar_Mem* const src_dir[3],
+        const oskar_Mem* const src_ext[3],
+        const oskar_Telescope* tel,
+        const oskar_Mem* const station_uvw[3],
+        double gast,
+        double frequency_hz,
+        int ignore_w_components,
+        int offset_out,
+        oskar_Mem* vis,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_CROSS_CORRELATE_PHASE_CHANNELS_H_
+#define OSKAR_CROSS_CORRELATE_PHASE_CHANNELS_H_
+
+/**
+ * @file oskar_cross_correlate_phase_channels.h
+ */
+
+#include <oskar_global.h>
+#include <telescope/oskar_telescope.h>
+#include <interferometer/oskar_jones.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Forms visibilities for a block of channels from Jones matrices
+ * which do not include the interferometer phase.
+ *
+ * @details
+ * This is equivalent to calling oskar_cross_correlate_phase() for each of
+ * \p num_channels evenly-spaced channels, but each source is loaded only
+ * once for all the channels, and the interferometer phase at each channel
+ * is found from the one at the first channel using a complex rotation.
+ *
+ * If the Jones matrices do not depend on frequency, \p num_jones can be 1,
+ * and the same matrices are used for every channel. Otherwise,
+ * \p num_jones must be equal to \p num_channels.
+ *
+ * The source flux vectors must contain the Stokes parameters for every
+ * channel, with the channel dimension slowest-varying
+ * (i.e. num_channels * num_sources values).
+ *
+ * The visibilities for channel c are accumulated starting at
+ * offset_out + c * channel_stride.
+ *
+ * This function is currently only available for data in CPU memory.
+ *
+ * @param[in]  source_type    Source type (0 = point, 1 = Gaussian).
+ * @param[in]  num_sources    Number of sources to use.
+ * @param[in]  num_channels   Number of channels.
+ * @param[in]  num_jones      Number of sets of Jones matrices in \p jones.
+ * @param[in]  jones          Sets of Jones matrices, without Jones K.
+ * @param[in]  src_flux[4]    Source Stokes (I, Q, U, V) values per channel.
+ * @param[in]  src_dir[3]     Vectors of source direction cosines.
+ * @param[in]  src_ext[3]     Vectors of extended source parameters.
+ * @param[in]  tel            Telescope model.
+ * @param[in]  station_uvw[3] Station (u, v, w) coordinates, in metres.
+ * @param[in]  gast           Greenwich apparent sidereal time, in radians.
+ * @param[in]  start_frequency_hz Frequency of the first channel, in Hz.
+ * @param[in]  frequency_inc_hz   Frequency increment per channel, in Hz.
+ * @param[in]  ignore_w_components If set, ignore w in the phase term.
+ * @param[in]  offset_out     Output visibility start offset.
+ * @param[in]  channel_stride Output visibility offset between channels.
+ * @param[out] vis            Output visibility amplitudes.
+ * @param[in,out] status      Status return code.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_phase_channels(
+        int source_type,
+        int num_sources,
+        int num_channels,
+        int num_jones,
+        const oskar_Jones* const* jones,
+        const oskar_Mem* const src_flux[4],
+        const oskar_Mem* const src_dir[3],
+        const oskar_Mem* const src_ext[3],
+        const oskar_Telescope* tel,
+        const oskar_Mem* const station_uvw[3],
+        double gast,
+        double start_frequency_hz,
+        double frequency_inc_hz,
+        int ignore_w_components,
+        int offset_out,
+        int channel_stride,
+        oskar_Mem* vis,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -0,0 +1,439 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "correlate/define_correlate_utils.h"
+#include "correlate/oskar_cross_correlate_channels_omp.h"
+#include "math/define_multiply.h"
+#include "math/oskar_kahan_sum.h"
+#include "math/oskar_sincos.h"
+#include "utility/oskar_kernel_macros.h"
+#include "utility/oskar_vector_types.h"
+
+/* Maximum number of channels handled by one call to a kernel. */
+#define XCORR_MAX_CHANNELS 16
+
+template<typename T1, typename T2>
+struct is_same
+{
+    enum { value = false };
+};
+
+template<typename T>
+struct is_same<T,T>
+{
+    enum { value = true };
+};
+
+static inline void xcorr_sincos(float x, float* s, float* c)
+{
+    oskar_sincos_f(x, s, c);
+}
+
+static inline void xcorr_sincos(double x, double* s, double* c)
+{
+    oskar_sincos_d(x, s, c);
+}
+
+/* Evaluates the per-baseline terms common to the matrix and scalar kernels,
+ * and skips the baseline if it is filtered out in every channel. */
+#define XCORR_CHANNELS_BASELINE_SETUP(REAL) \
+        REAL uv_len, uu, vv, ww, uu2, vv2, uuvv, du, dv, dw;\
+        REAL scale[XCORR_MAX_CHANNELS];\
+        int active[XCORR_MAX_CHANNELS], num_active = 0;\
+        OSKAR_BASELINE_TERMS(REAL, station_u[SP], station_u[SQ],\
+                station_v[SP], station_v[SQ], station_w[SP], station_w[SQ],\
+                uu, vv, ww, uu2, vv2, uuvv, uv_len);\
+        for (int ch = 0; ch < num_channels; ++ch)\
+        {\
+            scale[ch] = (REAL) 1 + ch * inv_wavelength_inc / inv_wavelength;\
+            const REAL len = uv_len * scale[ch];\
+            active[ch] = !(len < uv_min_lambda[ch] || len > uv_max_lambda[ch]);\
+            num_active += active[ch];\
+        }\
+        if (num_active == 0) continue;\
+        const REAL k = ((REAL) (2.0 * M_PI)) * inv_wavelength;\
+        const REAL pu = (station_u[SP] - station_u[SQ]) * k;\
+        const REAL pv = (station_v[SP] - station_v[SQ]) * k;\
+        const REAL pw = ignore_w_components ?\
+                (REAL) 0 : (station_w[SP] - station_w[SQ]) * k;\
+        const REAL phase_ratio = inv_wavelength_inc / inv_wavelength;\
+        if (TIME_SMEARING)\
+            OSKAR_BASELINE_DELTAS(REAL, station_x[SP], station_x[SQ],\
+                    station_y[SP], station_y[SQ], du, dv, dw);
+
+/* Evaluates the per-source terms common to the matrix and scalar kernels:
+ * the phasor for the first channel and its increment per channel,
+ * and the frequency-independent parts of the smearing terms. */
+#define XCORR_CHANNELS_SOURCE_SETUP(REAL, REAL2) \
+        REAL2 phasor, d_phasor;\
+        REAL gauss_t = (REAL) 0, tsm_t = (REAL) 0, smear_bw = (REAL) 1;\
+        const REAL l = source_l[i];\
+        const REAL m = source_m[i];\
+        const REAL n = source_n[i] - (REAL) 1;\
+        const REAL phase = pu * l + pv * m + pw * n;\
+        xcorr_sincos(phase, &phasor.y, &phasor.x);\
+        xcorr_sincos(phase * phase_ratio, &d_phasor.y, &d_phasor.x);\
+        if (GAUSSIAN)\
+            gauss_t = source_a[i] * uu2 + source_b[i] * uuvv +\
+                    source_c[i] * vv2;\
+        if (BANDWIDTH_SMEARING)\
+        {\
+            const REAL t = uu * l + vv * m + ww * n;\
+            smear_bw = OSKAR_SINC(REAL, t);\
+        }\
+        if (TIME_SMEARING)\
+            tsm_t = du * l + dv * m + dw * n;
+
+/* Evaluates the smearing term for the current channel. */
+#define XCORR_CHANNELS_SMEARING(REAL) \
+        REAL smearing = smear_bw;\
+        if (GAUSSIAN)\
+            smearing *= exp((REAL) -(gauss_t * scale[ch] * scale[ch]));\
+        if (TIME_SMEARING)\
+        {\
+            const REAL t = tsm_t * scale[ch];\
+            smearing *= OSKAR_SINC(REAL, t);\
+        }
+
+template
+<
+// Compile-time parameters.
+bool BANDWIDTH_SMEARING, bool TIME_SMEARING, bool GAUSSIAN,
+typename REAL, typename REAL2, typename REAL4c
+>
+void oskar_xcorr_channels_omp(
+        const int                    num_sources,
+        const int                    num_stations,
+        const int                    num_channels,
+        const int                    num_jones,
+        const int                    offset_out,
+        const int                    channel_stride,
+        const REAL4c* const*         jones,
+        const REAL*   const RESTRICT source_I,
+        const REAL*   const RESTRICT source_Q,
+        const REAL*   const RESTRICT source_U,
+        const REAL*   const RESTRICT source_V,
+        const REAL*   const RESTRICT source_l,
+        const REAL*   const RESTRICT source_m,
+        const REAL*   const RESTRICT source_n,
+        const REAL*   const RESTRICT source_a,
+        const REAL*   const RESTRICT source_b,
+        const REAL*   const RESTRICT source_c,
+        const REAL*   const RESTRICT station_u,
+        const REAL*   const RESTRICT station_v,
+        const REAL*   const RESTRICT station_w,
+        const REAL*   const RESTRICT station_x,
+        const REAL*   const RESTRICT station_y,
+        const REAL*   const RESTRICT uv_min_lambda,
+        const REAL*   const RESTRICT uv_max_lambda,
+        const REAL                   inv_wavelength,
+        const REAL                   inv_wavelength_inc,
+        const REAL                   frac_bandwidth,
+        const REAL                   time_int_sec,
+        const REAL                   gha0_rad,
+        const REAL                   dec0_rad,
+        const int                    ignore_w_components,
+        REAL4c*             RESTRICT vis)
+{
+    // Loop over stations.
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int SQ = 0; SQ < num_stations; ++SQ)
+    {
+        // Loop over baselines for this station.
+        for (int SP = SQ + 1; SP < num_stations; ++SP)
+        {
+            REAL4c sum[XCORR_MAX_CHANNELS], guard[XCORR_MAX_CHANNELS];
+            XCORR_CHANNELS_BASELINE_SETUP(REAL)
+            for (int ch = 0; ch < num_channels; ++ch)
+            {
+                OSKAR_CLEAR_COMPLEX_MATRIX(REAL, sum[ch])
+                OSKAR_CLEAR_COMPLEX_MATRIX(REAL, guard[ch])
+            }
+
+            // Loop over sources.
+            for (int i = 0; i < num_sources; ++i)
+            {
+                XCORR_CHANNELS_SOURCE_SETUP(REAL, REAL2)
+
+                // Loop over channels.
+                for (int ch = 0; ch < num_channels; ++ch)
+                {
+                    REAL4c m1, m2;
+                    if (ch > 0)
+                        OSKAR_MUL_COMPLEX_IN_PLACE(REAL2, phasor, d_phasor)
+                    if (!active[ch]) continue;
+                    XCORR_CHANNELS_SMEARING(REAL)
+
+                    // Construct source brightness matrix.
+                    const int s = ch * num_sources + i;
+                    OSKAR_CONSTRUCT_B(REAL, m2,
+                            source_I[s], source_Q[s], source_U[s], source_V[s])
+
+                    // Multiply first Jones matrix and the phase with
+                    // source brightness matrix.
+                    const REAL4c* const J = jones[num_jones > 1 ? ch : 0];
+                    OSKAR_LOAD_MATRIX(m1, J[SP * num_sources + i])
+                    OSKAR_MUL_COMPLEX_MATRIX_COMPLEX_SCALAR_IN_PLACE(
+                            REAL2, m1, phasor)
+                    OSKAR_MUL_COMPLEX_MATRIX_HERMITIAN_IN_PLACE(REAL2, m1, m2)
+
+                    // Multiply result with second (Hermitian transposed)
+                    // Jones matrix.
+                    OSKAR_LOAD_MATRIX(m2, J[SQ * num_sources + i])
+                    OSKAR_MUL_COMPLEX_MATRIX_CONJUGATE_TRANSPOSE_IN_PLACE(
+                            REAL2, m1, m2)
+
+                    // Multiply result by smearing term and accumulate.
+                    if (is_same<REAL, float>::value)
+                    {
+                        OSKAR_KAHAN_SUM_MULTIPLY_COMPLEX_MATRIX(
+                                REAL, sum[ch], m1, smearing, guard[ch])
+                    }
+                    else
+                    {
+                        OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(
+                                sum[ch], m1, smearing)
+                    }
+                }
+            }
+
+            // Add results to the baseline visibilities.
+            const int b = OSKAR_BASELINE_INDEX(num_stations, SP, SQ) +
+                    offset_out;
+            for (int ch = 0; ch < num_channels; ++ch)
+            {
+                if (!active[ch]) continue;
+                OSKAR_ADD_COMPLEX_MATRIX_IN_PLACE(
+                        vis[b + ch * channel_stride], sum[ch]);
+            }
+        }
+    }
+}
+
+template
+<
+// Compile-time parameters.
+bool BANDWIDTH_SMEARING, bool TIME_SMEARING, bool GAUSSIAN,
+typename REAL, typename REAL2
+>
+void oskar_xcorr_scalar_channels_omp(
+        const int                   num_sources,
+        const int                   num_stations,
+        const int                   num_channels,
+        const int                   num_jones,
+        const int                   offset_out,
+        const int                   channel_stride,
+        const REAL2* const*         jones,
+        const REAL*  const RESTRICT source_I,
+        const REAL*  const RESTRICT source_l,
+        const REAL*  const RESTRICT source_m,
+        const REAL*  const RESTRICT source_n,
+        const REAL*  const RESTRICT source_a,
+        const REAL*  const RESTRICT source_b,
+        const REAL*  const RESTRICT source_c,
+        const REAL*  const RESTRICT station_u,
+        const REAL*  const RESTRICT station_v,
+        const REAL*  const RESTRICT station_w,
+        const REAL*  const RESTRICT station_x,
+        const REAL*  const RESTRICT station_y,
+        const REAL*  const RESTRICT uv_min_lambda,
+        const REAL*  const RESTRICT uv_max_lambda,
+        const REAL                  inv_wavelength,
+        const REAL                  inv_wavelength_inc,
+        const REAL                  frac_bandwidth,
+        const REAL                  time_int_sec,
+        const REAL                  gha0_rad,
+        const REAL                  dec0_rad,
+        const int                   ignore_w_components,
+        REAL2*             RESTRICT vis)
+{
+    // Loop over stations.
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int SQ = 0; SQ < num_stations; ++SQ)
+    {
+        // Loop over baselines for this station.
+        for (int SP = SQ + 1; SP < num_stations; ++SP)
+        {
+            REAL2 sum[XCORR_MAX_CHANNELS], guard[XCORR_MAX_CHANNELS];
+            XCORR_CHANNELS_BASELINE_SETUP(REAL)
+            for (int ch = 0; ch < num_channels; ++ch)
+            {
+                sum[ch].x = sum[ch].y = (REAL) 0;
+                guard[ch].x = guard[ch].y = (REAL) 0;
+            }
+
+            // Loop over sources.
+            for (int i = 0; i < num_sources; ++i)
+            {
+                XCORR_CHANNELS_SOURCE_SETUP(REAL, REAL2)
+
+                // Loop over channels.
+                for (int ch = 0; ch < num_channels; ++ch)
+                {
+                    REAL2 t1, t2;
+                    if (ch > 0)
+                        OSKAR_MUL_COMPLEX_IN_PLACE(REAL2, phasor, d_phasor)
+                    if (!active[ch]) continue;
+                    XCORR_CHANNELS_SMEARING(REAL)
+                    smearing *= source_I[ch * num_sources + i];
+
+                    // Multiply Jones scalars and the phase.
+                    const REAL2* const J = jones[num_jones > 1 ? ch : 0];
+                    t1 = J[SP * num_sources + i];
+                    t2 = J[SQ * num_sources + i];
+                    OSKAR_MUL_COMPLEX_CONJUGATE_IN_PLACE(REAL2, t1, t2)
+                    OSKAR_MUL_COMPLEX_IN_PLACE(REAL2, t1, phasor)
+
+                    // Multiply result by smearing term and accumulate.
+                    if (is_same<REAL, float>::value)
+                    {
+                        OSKAR_KAHAN_SUM_MULTIPLY_COMPLEX(
+                                REAL, sum[ch], t1, smearing, guard[ch])
+                    }
+                    else
+                    {
+                        sum[ch].x += t1.x * smearing;
+                        sum[ch].y += t1.y * smearing;
+                    }
+                }
+            }
+
+            // Add results to the baseline visibilities.
+            const int b = OSKAR_BASELINE_INDEX(num_stations, SP, SQ) +
+                    offset_out;
+            for (int ch = 0; ch < num_channels; ++ch)
+            {
+                if (!active[ch]) continue;
+                vis[b + ch * channel_stride].x += sum[ch].x;
+                vis[b + ch * channel_stride].y += sum[ch].y;
+            }
+        }
+    }
+}
+
+#define XCORR_KERNEL(BS, TS, GAUSSIAN, REAL, REAL2, REAL4c)                 \
+        oskar_xcorr_channels_omp<BS, TS, GAUSSIAN, REAL, REAL2, REAL4c>     \
+        (num_sources, num_stations, n_ch, num_jones,                        \
+                offset_out + c0 * channel_stride, channel_stride,           \
+                jones + (num_jones > 1 ? c0 : 0),                           \
+                I + c0 * num_sources, Q + c0 * num_sources,                 \
+                U + c0 * num_sources, V + c0 * num_sources,                 \
+                l, m, n, a, b, c,                                           \
+                station_u, station_v, station_w, station_x, station_y,      \
+                uv_min_lambda + c0, uv_max_lambda + c0,                     \
+                inv_wavelength + c0 * inv_wavelength_inc,                   \
+                inv_wavelength_inc, frac_bandwidth_c0, time_int_sec,        \
+                gha0_rad, dec0_rad, ignore_w_components, vis);
+
+#define XCORR_SCALAR_KERNEL(BS, TS, GAUSSIAN, REAL, REAL2)                  \
+        oskar_xcorr_scalar_channels_omp<BS, TS, GAUSSIAN, REAL, REAL2>      \
+        (num_sources, num_stations, n_ch, num_jones,                        \
+                offset_out + c0 * channel_stride, channel_stride,           \
+                jones + (num_jones > 1 ? c0 : 0), I + c0 * num_sources,     \
+                l, m, n, a, b, c,                                           \
+                station_u, station_v, station_w, station_x, station_y,      \
+                uv_min_lambda + c0, uv_max_lambda + c0,                     \
+                inv_wavelength + c0 * inv_wavelength_inc,                   \
+                inv_wavelength_inc, frac_bandwidth_c0, time_int_sec,        \
+                gha0_rad, dec0_rad, ignore_w_components, vis);
+
+#define XCORR_SELECT(KERNEL, GAUSSIAN, ...)                                 \
+        if (frac_bandwidth == 0 && time_int_sec == 0)                       \
+            KERNEL(false, false, GAUSSIAN, __VA_ARGS__)                     \
+        else if (frac_bandwidth != 0 && time_int_sec == 0)                  \
+            KERNEL(true, false, GAUSSIAN, __VA_ARGS__)                      \
+        else if (frac_bandwidth == 0 && time_int_sec != 0)                  \
+            KERNEL(false, true, GAUSSIAN, __VA_ARGS__)                      \
+        else if (frac_bandwidth != 0 && time_int_sec != 0)                  \
+            KERNEL(true, true, GAUSSIAN, __VA_ARGS__)
+
+/* Processes the channels in groups of up to XCORR_MAX_CHANNELS.
+ * The fractional bandwidth is scaled to the first channel of each group. */
+#define XCORR_CHANNEL_GROUPS(KERNEL, ...)                                   \
+        for (int c0 = 0; c0 < num_channels; c0 += XCORR_MAX_CHANNELS)       \
+        {                                                                   \
+            const int n_ch = (num_channels - c0 < XCORR_MAX_CHANNELS) ?     \
+                    num_channels - c0 : XCORR_MAX_CHANNELS;                 \
+            const double frac_bandwidth_c0 = frac_bandwidth *               \
+                    inv_wavelength / (inv_wavelength + c0 * inv_wavelength_inc); \
+            if (a && b && c)                                                \
+            {                                                               \
+                XCORR_SELECT(KERNEL, true, __VA_ARGS__)                     \
+            }                                                               \
+            else                                                            \
+            {                                                               \
+                XCORR_SELECT(KERNEL, false, __VA_ARGS__)                    \
+            }                                                               \
+        }
+
+void oskar_cross_correlate_channels_omp_f(
+        int num_sources, int num_stations, int num_channels, int num_jones,
+        int offset_out, int channel_stride,
+        const float4c* const* jones, const float* I, const float* Q,
+        const float* U, const float* V,
+        const float* l, const float* m, const float* n,
+        const float* a, const float* b, const float* c,
+        const float* station_u, const float* station_v,
+        const float* station_w, const float* station_x,
+        const float* station_y, const float* uv_min_lambda,
+        const float* uv_max_lambda, float inv_wavelength,
+        float inv_wavelength_inc, float frac_bandwidth, float time_int_sec,
+        float gha0_rad, float dec0_rad, int ignore_w_components,
+        float4c* vis)
+{
+    XCORR_CHANNEL_GROUPS(XCORR_KERNEL, float, float2, float4c)
+}
+
+void oskar_cross_correlate_channels_omp_d(
+        int num_sources, int num_stations, int num_channels, int num_jones,
+        int offset_out, int channel_stride,
+        const double4c* const* jones, const double* I, const double* Q,
+        const double* U, const double* V,
+        const double* l, const double* m, const double* n,
+        const double* a, const double* b, const double* c,
+        const double* station_u, const double* station_v,
+        const double* station_w, const double* station_x,
+        const double* station_y, const double* uv_min_lambda,
+        const double* uv_max_lambda, double inv_wavelength,
+        double inv_wavelength_inc, double frac_bandwidth, double time_int_sec,
+        double gha0_rad, double dec0_rad, int ignore_w_components,
+        double4c* vis)
+{
+    XCORR_CHANNEL_GROUPS(XCORR_KERNEL, double, double2, double4c)
+}
+
+void oskar_cross_correlate_scalar_channels_omp_f(
+        int num_sources, int num_stations, int num_channels, int num_jones,
+        int offset_out, int channel_stride,
+        const float2* const* jones, const float* I,
+        const float* l, const float* m, const float* n,
+        const float* a, const float* b, const float* c,
+        const float* station_u, const float* station_v,
+        const float* station_w, const float* station_x,
+        const float* station_y, const float* uv_min_lambda,
+        const float* uv_max_lambda, float inv_wavelength,
+        float inv_wavelength_inc, float frac_bandwidth, float time_int_sec,
+        float gha0_rad, float dec0_rad, int ignore_w_components,
+        float2* vis)
+{
+    XCORR_CHANNEL_GROUPS(XCORR_SCALAR_KERNEL, float, float2)
+}
+
+void oskar_cross_correlate_scalar_channels_omp_d(
+        int num_sources, int num_stations, int num_channels, int num_jones,
+        int offset_out, int channel_stride,
+        const double2* const* jones, const double* I,
+        const double* l, const double* m, const double* n,
+        const double* a, const double* b, const double* c,
+        const double* station_u, const double* station_v,
+        const double* station_w, const double* station_x,
+        const double* station_y, const double* uv_min_lambda,
+        const double* uv_max_lambda, double inv_wavelength,
+        double inv_wavelength_inc, double frac_bandwidth, double time_int_sec,
+        double gha0_rad, double dec0_rad, int ignore_w_components,
+        double2* vis)
+{
+    XCORR_CHANNEL_GROUPS(XCORR_SCALAR_KERNEL, double, double2)
+}
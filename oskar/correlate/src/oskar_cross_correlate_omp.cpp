@@ -30,6 +30,7 @@
 #include "correlate/oskar_cross_correlate_omp.h"
 #include "math/define_multiply.h"
 #include "math/oskar_kahan_sum.h"
+#include "math/oskar_sincos.h"
 #include "utility/oskar_kernel_macros.h"
 #include "utility/oskar_vector_types.h"
 
@@ -47,10 +48,20 @@ struct is_same<T,T>
     typedef is_same<T,T> type;
 };
 
+static inline void xcorr_sincos(float x, float* s, float* c)
+{
+    oskar_sincos_f(x, s, c);
+}
+
+static inline void xcorr_sincos(double x, double* s, double* c)
+{
+    oskar_sincos_d(x, s, c);
+}
+
 template
 <
 // Compile-time parameters.
-bool BANDWIDTH_SMEARING, bool TIME_SMEARING, bool GAUSSIAN,
+bool BANDWIDTH_SMEARING, bool TIME_SMEARING, bool GAUSSIAN, bool PHASE,
 typename REAL, typename REAL2, typename REAL4c
 >
 void oskar_xcorr_omp(
@@ -80,6 +91,7 @@ void oskar_xcorr_omp(
         const REAL                   time_int_sec,
         const REAL                   gha0_rad,
         const REAL                   dec0_rad,
+        const int                    ignore_w_components,
         REAL4c*             RESTRICT vis)
 {
     // Loop over stations.
@@ -109,6 +121,17 @@ void oskar_xcorr_omp(
             // Apply the baseline length filter.
             if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
 
+            // Get the baseline coordinates in radians for the phase term.
+            REAL pu = (REAL) 0, pv = (REAL) 0, pw = (REAL) 0;
+            if (PHASE)
+            {
+                const REAL k = ((REAL) (2.0 * M_PI)) * inv_wavelength;
+                pu = (station_u[SP] - station_u[SQ]) * k;
+                pv = (station_v[SP] - station_v[SQ]) * k;
+                if (!ignore_w_components)
+                    pw = (station_w[SP] - station_w[SQ]) * k;
+            }
+
             // Compute the deltas for time-average smearing.
             if (TIME_SMEARING)
                 OSKAR_BASELINE_DELTAS(REAL, station_x[SP], station_x[SQ],
@@ -148,6 +171,16 @@ void oskar_xcorr_omp(
 
                 // Multiply first Jones matrix with source brightness matrix.
                 OSKAR_LOAD_MATRIX(m1, station_p[i])
+                if (PHASE)
+                {
+                    // Apply the interferometer phase for the baseline.
+                    REAL2 phasor;
+                    const REAL phase = pu * source_l[i] + pv * source_m[i] +
+                            pw * (source_n[i] - (REAL) 1);
+                    xcorr_sincos(phase, &phasor.y, &phasor.x);
+                    OSKAR_MUL_COMPLEX_MATRIX_COMPLEX_SCALAR_IN_PLACE(
+                            REAL2, m1, phasor)
+                }
                 OSKAR_MUL_COMPLEX_MATRIX_HERMITIAN_IN_PLACE(REAL2, m1, m2)
 
                 // Multiply result with second (Hermitian transposed) Jones matrix.
@@ -173,24 +206,24 @@ void oskar_xcorr_omp(
     }
 }
 
-#define XCORR_KERNEL(BS, TS, GAUSSIAN, REAL, REAL2, REAL4c)                 \
-        oskar_xcorr_omp<BS, TS, GAUSSIAN, REAL, REAL2, REAL4c>              \
+#define XCORR_KERNEL(BS, TS, GAUSSIAN, PHASE, REAL, REAL2, REAL4c)          \
+        oskar_xcorr_omp<BS, TS, GAUSSIAN, PHASE, REAL, REAL2, REAL4c>       \
         (num_sources, num_stations, offset_out, d_jones,                    \
                 d_I, d_Q, d_U, d_V, d_l, d_m, d_n, d_a, d_b, d_c,           \
                 d_station_u, d_station_v, d_station_w,                      \
                 d_station_x, d_station_y, uv_min_lambda, uv_max_lambda,     \
                 inv_wavelength, frac_bandwidth, time_int_sec,               \
-                gha0_rad, dec0_rad, d_vis);
+                gha0_rad, dec0_rad, ignore_w_components, d_vis);
 
-#define XCORR_SELECT(GAUSSIAN, REAL, REAL2, REAL4c)                         \
+#define XCORR_SELECT(GAUSSIAN, PHASE, REAL, REAL2, REAL4c)                  \
         if (frac_bandwidth == (REAL)0 && time_int_sec == (REAL)0)           \
-            XCORR_KERNEL(false, false, GAUSSIAN, REAL, REAL2, REAL4c)       \
+            XCORR_KERNEL(false, false, GAUSSIAN, PHASE, REAL, REAL2, REAL4c) \
         else if (frac_bandwidth != (REAL)0 && time_int_sec == (REAL)0)      \
-            XCORR_KERNEL(true, false, GAUSSIAN, REAL, REAL2, REAL4c)        \
+            XCORR_KERNEL(true, false, GAUSSIAN, PHASE, REAL, REAL2, REAL4c) \
         else if (frac_bandwidth == (REAL)0 && time_int_sec != (REAL)0)      \
-            XCORR_KERNEL(false, true, GAUSSIAN, REAL, REAL2, REAL4c)        \
+            XCORR_KERNEL(false, true, GAUSSIAN, PHASE, REAL, REAL2, REAL4c) \
         else if (frac_bandwidth != (REAL)0 && time_int_sec != (REAL)0)      \
-            XCORR_KERNEL(true, true, GAUSSIAN, REAL, REAL2, REAL4c)
+            XCORR_KERNEL(true, true, GAUSSIAN, PHASE, REAL, REAL2, REAL4c)
 
 void oskar_cross_correlate_point_omp_f(
         int num_sources, int num_stations, int offset_out,
@@ -205,7 +238,8 @@ void oskar_cross_correlate_point_omp_f(
         float dec0_rad, float4c* d_vis)
 {
     const float *d_a = 0, *d_b = 0, *d_c = 0;
-    XCORR_SELECT(false, float, float2, float4c)
+    const int ignore_w_components = 0;
+    XCORR_SELECT(false, false, float, float2, float4c)
 }
 
 void oskar_cross_correlate_point_omp_d(
@@ -221,7 +255,8 @@ void oskar_cross_correlate_point_omp_d(
         double dec0_rad, double4c* d_vis)
 {
     const double *d_a = 0, *d_b = 0, *d_c = 0;
-    XCORR_SELECT(false, double, double2, double4c)
+    const int ignore_w_components = 0;
+    XCORR_SELECT(false, false, double, double2, double4c)
 }
 
 void oskar_cross_correlate_gaussian_omp_f(
@@ -236,7 +271,8 @@ void oskar_cross_correlate_gaussian_omp_f(
         float inv_wavelength, float frac_bandwidth, float time_int_sec,
         float gha0_rad, float dec0_rad, float4c* d_vis)
 {
-    XCORR_SELECT(true, float, float2, float4c)
+    const int ignore_w_components = 0;
+    XCORR_SELECT(true, false, float, float2, float4c)
 }
 
 void oskar_cross_correlate_gaussian_omp_d(
@@ -251,5 +287,52 @@ void oskar_cross_correlate_gaussian_omp_d(
         double inv_wavelength, double frac_bandwidth, double time_int_sec,
         double gha0_rad, double dec0_rad, double4c* d_vis)
 {
-    XCORR_SELECT(true, double, double2, double4c)
+    const int ignore_w_components = 0;
+    XCORR_SELECT(true, false, double, double2, double4c)
+}
+
+void oskar_cross_correlate_phase_omp_f(
+        int num_sources, int num_stations, int offset_out,
+        const float4c* d_jones, const float* d_I, const float* d_Q,
+        const float* d_U, const float* d_V,
+        const float* d_l, const float* d_m, const float* d_n,
+        const float* d_a, const float* d_b, const float* d_c,
+        const float* d_station_u, const float* d_station_v,
+        const float* d_station_w, const float* d_station_x,
+        const float* d_station_y, float uv_min_lambda, float uv_max_lambda,
+        float inv_wavelength, float frac_bandwidth, float time_int_sec,
+        float gha0_rad, float dec0_rad, int ignore_w_components,
+        float4c* d_vis)
+{
+    if (d_a && d_b && d_c)
+    {
+        XCORR_SELECT(true, true, float, float2, float4c)
+    }
+    else
+    {
+        XCORR_SELECT(false, true, float, float2, float4c)
+    }
+}
+
+void oskar_cross_correlate_phase_omp_d(
+        int num_sources, int num_stations, int offset_out,
+        const double4c* d_jones, const double* d_I, const double* d_Q,
+        const double* d_U, const double* d_V,
+        const double* d_l, const double* d_m, const double* d_n,
+        const double* d_a, const double* d_b, const double* d_c,
+        const double* d_station_u, const double* d_station_v,
+        const double* d_station_w, const double* d_station_x,
+        const double* d_station_y, double uv_min_lambda, double uv_max_lambda,
+        double inv_wavelength, double frac_bandwidth, double time_int_sec,
+        double gha0_rad, double dec0_rad, int ignore_w_components,
+        double4c* d_vis)
+{
+    if (d_a && d_b && d_c)
+    {
+        XCORR_SELECT(true, true, double, double2, double4c)
+    }
+    else
+    {
+        XCORR_SELECT(false, true, double, double2, double4c)
+    }
 }
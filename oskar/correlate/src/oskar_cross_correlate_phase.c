@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "correlate/oskar_cross_correlate_phase.h"
+#include "correlate/oskar_cross_correlate_omp.h"
+#include "correlate/oskar_cross_correlate_scalar_omp.h"
+
+#include <float.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_cross_correlate_phase(
+        int source_type,
+        int num_sources,
+        const oskar_Jones* jones,
+        const oskar_Mem* const src_flux[4],
+        const oskar_Mem* const src_dir[3],
+        const oskar_Mem* const src_ext[3],
+        const oskar_Telescope* tel,
+        const oskar_Mem* const station_uvw[3],
+        double gast,
+        double frequency_hz,
+        int ignore_w_components,
+        int offset_out,
+        oskar_Mem* vis,
+        int* status)
+{
+    const oskar_Mem *J, *x, *y;
+    const void *ext_a = 0, *ext_b = 0, *ext_c = 0;
+    double uv_filter_min, uv_filter_max;
+    double time_avg = 0.0, gha0 = 0.0, dec0 = 0.0;
+    if (*status) return;
+
+    /* Get the data dimensions. */
+    const int num_stations = oskar_telescope_num_stations(tel);
+
+    /* Get bandwidth-smearing terms. */
+    frequency_hz = fabs(frequency_hz);
+    const double inv_wavelength = frequency_hz / 299792458.0;
+    const double channel_bandwidth = oskar_telescope_channel_bandwidth_hz(tel);
+    const double frac_bandwidth = channel_bandwidth / frequency_hz;
+
+    /* Get time-average smearing terms.
+     * Ignore if drift scanning - this will need to be done differently. */
+    if (oskar_telescope_phase_centre_coord_type(tel) != OSKAR_COORDS_AZEL)
+    {
+        time_avg = oskar_telescope_time_average_sec(tel);
+        gha0 = gast - oskar_telescope_phase_centre_longitude_rad(tel);
+        dec0 = oskar_telescope_phase_centre_latitude_rad(tel);
+    }
+
+    /* Get UV filter parameters in wavelengths. */
+    uv_filter_min = oskar_telescope_uv_filter_min(tel);
+    uv_filter_max = oskar_telescope_uv_filter_max(tel);
+    if (oskar_telescope_uv_filter_units(tel) == OSKAR_METRES)
+    {
+        uv_filter_min *= inv_wavelength;
+        uv_filter_max *= inv_wavelength;
+    }
+    if (uv_filter_max < 0.0 || uv_filter_max > FLT_MAX)
+        uv_filter_max = FLT_MAX;
+
+    /* Check data locations. */
+    const int location = oskar_jones_mem_location(jones);
+    if (location != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+        return;
+    }
+    if (oskar_telescope_mem_location(tel) != location ||
+            oskar_mem_location(vis) != location ||
+            oskar_mem_location(station_uvw[0]) != location ||
+            oskar_mem_location(station_uvw[1]) != location ||
+            oskar_mem_location(station_uvw[2]) != location)
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+
+    /* Check for consistent data types. */
+    const int jones_type = oskar_jones_type(jones);
+    const int base_type = oskar_type_precision(jones_type);
+    if (oskar_mem_precision(vis) != base_type ||
+            oskar_mem_type(station_uvw[0]) != base_type ||
+            oskar_mem_type(station_uvw[1]) != base_type ||
+            oskar_mem_type(station_uvw[2]) != base_type)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (oskar_mem_type(vis) != jones_type)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+
+    /* Check the input dimensions. */
+    if (oskar_jones_num_sources(jones) < num_sources ||
+            (int)oskar_mem_length(station_uvw[0]) != num_stations ||
+            (int)oskar_mem_length(station_uvw[1]) != num_stations ||
+            (int)oskar_mem_length(station_uvw[2]) != num_stations)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
+    /* Get handles to arrays. */
+    J = oskar_jones_mem_const(jones);
+    x = oskar_telescope_station_true_offset_ecef_metres_const(tel, 0);
+    y = oskar_telescope_station_true_offset_ecef_metres_const(tel, 1);
+    if (source_type == 1)
+    {
+        ext_a = oskar_mem_void_const(src_ext[0]);
+        ext_b = oskar_mem_void_const(src_ext[1]);
+        ext_c = oskar_mem_void_const(src_ext[2]);
+    }
+
+    /* Select kernel. */
+    switch (oskar_mem_type(vis))
+    {
+    case OSKAR_SINGLE_COMPLEX_MATRIX:
+        oskar_cross_correlate_phase_omp_f(
+                num_sources, num_stations, offset_out,
+                oskar_mem_float4c_const(J, status),
+                oskar_mem_float_const(src_flux[0], status),
+                oskar_mem_float_const(src_flux[1], status),
+                oskar_mem_float_const(src_flux[2], status),
+                oskar_mem_float_const(src_flux[3], status),
+                oskar_mem_float_const(src_dir[0], status),
+                oskar_mem_float_const(src_dir[1], status),
+                oskar_mem_float_const(src_dir[2], status),
+                (const float*) ext_a,
+                (const float*) ext_b,
+                (const float*) ext_c,
+                oskar_mem_float_const(station_uvw[0], status),
+                oskar_mem_float_const(station_uvw[1], status),
+                oskar_mem_float_const(station_uvw[2], status),
+                oskar_mem_float_const(x, status),
+                oskar_mem_float_const(y, status),
+                uv_filter_min, uv_filter_max, inv_wavelength,
+                frac_bandwidth, time_avg, gha0, dec0, ignore_w_components,
+                oskar_mem_float4c(vis, status));
+        break;
+    case OSKAR_DOUBLE_COMPLEX_MATRIX:
+        oskar_cross_correlate_phase_omp_d(
+                num_sources, num_stations, offset_out,
+                oskar_mem_double4c_const(J, status),
+                oskar_mem_double_const(src_flux[0], status),
+                oskar_mem_double_const(src_flux[1], status),
+                oskar_mem_double_const(src_flux[2], status),
+                oskar_mem_double_const(src_flux[3], status),
+                oskar_mem_double_const(src_dir[0], status),
+                oskar_mem_double_const(src_dir[1], status),
+                oskar_mem_double_const(src_dir[2], status),
+                (const double*) ext_a,
+                (const double*) ext_b,
+                (const double*) ext_c,
+                oskar_mem_double_const(station_uvw[0], status),
+                oskar_mem_double_const(station_uvw[1], status),
+                oskar_mem_double_const(station_uvw[2], status),
+                oskar_mem_double_const(x, status),
+                oskar_mem_double_const(y, status),
+                uv_filter_min, uv_filter_max, inv_wavelength,
+                frac_bandwidth, time_avg, gha0, dec0, ignore_w_components,
+                oskar_mem_double4c(vis, status));
+        break;
+    case OSKAR_SINGLE_COMPLEX:
+        oskar_cross_correlate_scalar_phase_omp_f(
+                num_sources, num_stations, offset_out,
+                oskar_mem_float2_const(J, status),
+                oskar_mem_float_const(src_flux[0], status),
+                oskar_mem_float_const(src_dir[0], status),
+                oskar_mem_float_const(src_dir[1], status),
+                oskar_mem_float_const(src_dir[2], status),
+                (const float*) ext_a,
+                (const float*) ext_b,
+                (const float*) ext_c,
+                oskar_mem_float_const(station_uvw[0], status),
+                oskar_mem_float_const(station_uvw[1], status),
+                oskar_mem_float_const(station_uvw[2], status),
+                oskar_mem_float_const(x, status),
+                oskar_mem_float_const(y, status),
+                uv_filter_min, uv_filter_max, inv_wavelength,
+                frac_bandwidth, time_avg, gha0, dec0, ignore_w_components,
+                oskar_mem_float2(vis, status));
+        break;
+    case OSKAR_DOUBLE_COMPLEX:
+        oskar_cross_correlate_scalar_phase_omp_d(
+                num_sources, num_stations, offset_out,
+                oskar_mem_double2_const(J, status),
+                oskar_mem_double_const(src_flux[0], status),
+                oskar_mem_double_const(src_dir[0], status),
+                oskar_mem_double_const(src_dir[1], status),
+                oskar_mem_double_const(src_dir[2], status),
+                (const double*) ext_a,
+                (const double*) ext_b,
+                (const double*) ext_c,
+                oskar_mem_double_const(station_uvw[0], status),
+                oskar_mem_double_const(station_uvw[1], status),
+                oskar_mem_double_const(station_uvw[2], status),
+                oskar_mem_double_const(x, status),
+                oskar_mem_double_const(y, status),
+                uv_filter_min, uv_filter_max, inv_wavelength,
+                frac_bandwidth, time_avg, gha0, dec0, ignore_w_components,
+                oskar_mem_double2(vis, status));
+        break;
+    default:
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
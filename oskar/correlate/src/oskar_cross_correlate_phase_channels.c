@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "correlate/oskar_cross_correlate_phase_channels.h"
+#include "correlate/oskar_cross_correlate_channels_omp.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_cross_correlate_phase_channels(
+        int source_type,
+        int num_sources,
+        int num_channels,
+        int num_jones,
+        const oskar_Jones* const* jones,
+        const oskar_Mem* const src_flux[4],
+        const oskar_Mem* const src_dir[3],
+        const oskar_Mem* const src_ext[3],
+        const oskar_Telescope* tel,
+        const oskar_Mem* const station_uvw[3],
+        double gast,
+        double start_frequency_hz,
+        double frequency_inc_hz,
+        int ignore_w_components,
+        int offset_out,
+        int channel_stride,
+        oskar_Mem* vis,
+        int* status)
+{
+    int c;
+    const oskar_Mem *x, *y;
+    const void *ext_a = 0, *ext_b = 0, *ext_c = 0;
+    const void** J = 0;
+    double *uv_min = 0, *uv_max = 0;
+    float *uv_min_f = 0, *uv_max_f = 0;
+    double time_avg = 0.0, gha0 = 0.0, dec0 = 0.0;
+    if (*status || num_channels <= 0) return;
+    if (num_jones != 1 && num_jones != num_channels)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
+    /* Get the data dimensions. */
+    const int num_stations = oskar_telescope_num_stations(tel);
+
+    /* Get bandwidth-smearing terms for the first channel. */
+    const double c0 = 299792458.0;
+    const double inv_wavelength = start_frequency_hz / c0;
+    const double inv_wavelength_inc = frequency_inc_hz / c0;
+    const double channel_bandwidth = oskar_telescope_channel_bandwidth_hz(tel);
+    const double frac_bandwidth = channel_bandwidth / start_frequency_hz;
+
+    /* Get time-average smearing terms.
+     * Ignore if drift scanning - this will need to be done differently. */
+    if (oskar_telescope_phase_centre_coord_type(tel) != OSKAR_COORDS_AZEL)
+    {
+        time_avg = oskar_telescope_time_average_sec(tel);
+        gha0 = gast - oskar_telescope_phase_centre_longitude_rad(tel);
+        dec0 = oskar_telescope_phase_centre_latitude_rad(tel);
+    }
+
+    /* Check data locations. */
+    const int location = oskar_jones_mem_location(jones[0]);
+    if (location != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+        return;
+    }
+    if (oskar_telescope_mem_location(tel) != location ||
+            oskar_mem_location(vis) != location ||
+            oskar_mem_location(station_uvw[0]) != location ||
+            oskar_mem_location(station_uvw[1]) != location ||
+            oskar_mem_location(station_uvw[2]) != location)
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+
+    /* Check for consistent data types and dimensions. */
+    const int jones_type = oskar_jones_type(jones[0]);
+    const int base_type = oskar_type_precision(jones_type);
+    if (oskar_mem_precision(vis) != base_type ||
+            oskar_mem_type(vis) != jones_type ||
+            oskar_mem_type(station_uvw[0]) != base_type ||
+            oskar_mem_type(station_uvw[1]) != base_type ||
+            oskar_mem_type(station_uvw[2]) != base_type)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if ((int)oskar_mem_length(src_flux[0]) < num_channels * num_sources ||
+            (int)oskar_mem_length(station_uvw[0]) != num_stations ||
+            (int)oskar_mem_length(station_uvw[1]) != num_stations ||
+            (int)oskar_mem_length(station_uvw[2]) != num_stations)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    J = (const void**) calloc(num_jones, sizeof(void*));
+    for (c = 0; c < num_jones; ++c)
+    {
+        if (oskar_jones_type(jones[c]) != jones_type)
+            *status = OSKAR_ERR_TYPE_MISMATCH;
+        else if (oskar_jones_num_sources(jones[c]) < num_sources ||
+                oskar_jones_num_stations(jones[c]) != num_stations)
+            *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        else
+            J[c] = oskar_mem_void_const(oskar_jones_mem_const(jones[c]));
+    }
+
+    /* Get UV filter parameters in wavelengths, for each channel. */
+    uv_min = (double*) calloc(num_channels, sizeof(double));
+    uv_max = (double*) calloc(num_channels, sizeof(double));
+    uv_min_f = (float*) calloc(num_channels, sizeof(float));
+    uv_max_f = (float*) calloc(num_channels, sizeof(float));
+    for (c = 0; c < num_channels; ++c)
+    {
+        uv_min[c] = oskar_telescope_uv_filter_min(tel);
+        uv_max[c] = oskar_telescope_uv_filter_max(tel);
+        if (oskar_telescope_uv_filter_units(tel) == OSKAR_METRES)
+        {
+            const double inv_wavelength_c =
+                    inv_wavelength + c * inv_wavelength_inc;
+            uv_min[c] *= inv_wavelength_c;
+            uv_max[c] *= inv_wavelength_c;
+        }
+        if (uv_max[c] < 0.0 || uv_max[c] > FLT_MAX)
+            uv_max[c] = FLT_MAX;
+        uv_min_f[c] = (float) uv_min[c];
+        uv_max_f[c] = (float) uv_max[c];
+    }
+
+    /* Get handles to arrays. */
+    x = oskar_telescope_station_true_offset_ecef_metres_const(tel, 0);
+    y = oskar_telescope_station_true_offset_ecef_metres_const(tel, 1);
+    if (source_type == 1)
+    {
+        ext_a = oskar_mem_void_const(src_ext[0]);
+        ext_b = oskar_mem_void_const(src_ext[1]);
+        ext_c = oskar_mem_void_const(src_ext[2]);
+    }
+
+    /* Select kernel. */
+    if (!*status)
+    {
+        switch (oskar_mem_type(vis))
+        {
+        case OSKAR_SINGLE_COMPLEX_MATRIX:
+            oskar_cross_correlate_channels_omp_f(
+                    num_sources, num_stations, num_channels, num_jones,
+                    offset_out, channel_stride,
+                    (const float4c* const*) J,
+                    oskar_mem_float_const(src_flux[0], status),
+                    oskar_mem_float_const(src_flux[1], status),
+                    oskar_mem_float_const(src_flux[2], status),
+                    oskar_mem_float_const(src_flux[3], status),
+                    oskar_mem_float_const(src_dir[0], status),
+                    oskar_mem_float_const(src_dir[1], status),
+                    oskar_mem_float_const(src_dir[2], status),
+                    (const float*) ext_a,
+                    (const float*) ext_b,
+                    (const float*) ext_c,
+                    oskar_mem_float_const(station_uvw[0], status),
+                    oskar_mem_float_const(station_uvw[1], status),
+                    oskar_mem_float_const(station_uvw[2], status),
+                    oskar_mem_float_const(x, status),
+                    oskar_mem_float_const(y, status),
+                    uv_min_f, uv_max_f, inv_wavelength, inv_wavelength_inc,
+                    frac_bandwidth, time_avg, gha0, dec0, ignore_w_components,
+                    oskar_mem_float4c(vis, status));
+            break;
+        case OSKAR_DOUBLE_COMPLEX_MATRIX:
+            oskar_cross_correlate_channels_omp_d(
+                    num_sources, num_stations, num_channels, num_jones,
+                    offset_out, channel_stride,
+                    (const double4c* const*) J,
+                    oskar_mem_double_const(src_flux[0], status),
+                    oskar_mem_double_const(src_flux[1], status),
+                    oskar_mem_double_const(src_flux[2], status),
+                    oskar_mem_double_const(src_flux[3], status),
+                    oskar_mem_double_const(src_dir[0], status),
+                    oskar_mem_double_const(src_dir[1], status),
+                    oskar_mem_double_const(src_dir[2], status),
+                    (const double*) ext_a,
+                    (const double*) ext_b,
+                    (const double*) ext_c,
+                    oskar_mem_double_const(station_uvw[0], status),
+                    oskar_mem_double_const(station_uvw[1], status),
+                    oskar_mem_double_const(station_uvw[2], status),
+                    oskar_mem_double_const(x, status),
+                    oskar_mem_double_const(y, status),
+                    uv_min, uv_max, inv_wavelength, inv_wavelength_inc,
+                    frac_bandwidth, time_avg, gha0, dec0, ignore_w_components,
+                    oskar_mem_double4c(vis, status));
+            break;
+        case OSKAR_SINGLE_COMPLEX:
+            oskar_cross_correlate_scalar_channels_omp_f(
+                    num_sources, num_stations, num_channels, num_jones,
+                    offset_out, channel_stride,
+                    (const float2* const*) J,
+                    oskar_mem_float_const(src_flux[0], status),
+                    oskar_mem_float_const(src_dir[0], status),
+                    oskar_mem_float_const(src_dir[1], status),
+                    oskar_mem_float_const(src_dir[2], status),
+                    (const float*) ext_a,
+                    (const float*) ext_b,
+                    (const float*) ext_c,
+                    oskar_mem_float_const(station_uvw[0], status),
+                    oskar_mem_float_const(station_uvw[1], status),
+                    oskar_mem_float_const(station_uvw[2], status),
+                    oskar_mem_float_const(x, status),
+                    oskar_mem_float_const(y, status),
+                    uv_min_f, uv_max_f, inv_wavelength, inv_wavelength_inc,
+                    frac_bandwidth, time_avg, gha0, dec0, ignore_w_components,
+                    oskar_mem_float2(vis, status));
+            break;
+        case OSKAR_DOUBLE_COMPLEX:
+            oskar_cross_correlate_scalar_channels_omp_d(
+                    num_sources, num_stations, num_channels, num_jones,
+                    offset_out, channel_stride,
+                    (const double2* const*) J,
+                    oskar_mem_double_const(src_flux[0], status),
+                    oskar_mem_double_const(src_dir[0], status),
+                    oskar_mem_double_const(src_dir[1], status),
+                    oskar_mem_double_const(src_dir[2], status),
+                    (const double*) ext_a,
+                    (const double*) ext_b,
+                    (const double*) ext_c,
+                    oskar_mem_double_const(station_uvw[0], status),
+                    oskar_mem_double_const(station_uvw[1], status),
+                    oskar_mem_double_const(station_uvw[2], status),
+                    oskar_mem_double_const(x, status),
+                    oskar_mem_double_const(y, status),
+                    uv_min, uv_max, inv_wavelength, inv_wavelength_inc,
+                    frac_bandwidth, time_avg, gha0, dec0, ignore_w_components,
+                    oskar_mem_double2(vis, status));
+            break;
+        default:
+            *status = OSKAR_ERR_BAD_DATA_TYPE;
+            break;
+        }
+    }
+    free(J);
+    free(uv_min);
+    free(uv_max);
+    free(uv_min_f);
+    free(uv_max_f);
+}
+
+#ifdef __cplusplus
+}
+#endif
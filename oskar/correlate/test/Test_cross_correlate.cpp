@@ -8,8 +8,13 @@
 #include "utility/oskar_timer.h"
 
 #include "correlate/oskar_cross_correlate.h"
+#include "correlate/oskar_cross_correlate_phase.h"
+#include "correlate/oskar_cross_correlate_phase_channels.h"
+#include "interferometer/oskar_evaluate_jones_K.h"
 #include "utility/oskar_get_error_string.h"
 #include "math/oskar_kahan_sum.h"
+#include <cfloat>
+#include <cmath>
 #include <cstdlib>
 
 // Comment out this line to disable benchmark timer printing.
@@ -36,6 +41,29 @@ static void check_values(const oskar_Mem* approx, const oskar_Mem* accurate)
             " AVG: " << avg_rel_error << " STD: " << std_rel_error;
 }
 
+static void check_values_scaled(const oskar_Mem* approx,
+        const oskar_Mem* accurate)
+{
+    int status = 0;
+    double max_abs = 0.0, max_diff = 0.0;
+    oskar_Mem* t1 = oskar_mem_convert_precision(approx, OSKAR_DOUBLE, &status);
+    oskar_Mem* t2 = oskar_mem_convert_precision(accurate, OSKAR_DOUBLE,
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const size_t n = oskar_mem_length(t1) *
+            (oskar_type_is_matrix(oskar_mem_type(t1)) ? 8 : 2);
+    const double* p1 = (const double*) oskar_mem_void_const(t1);
+    const double* p2 = (const double*) oskar_mem_void_const(t2);
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (fabs(p2[i]) > max_abs) max_abs = fabs(p2[i]);
+        if (fabs(p1[i] - p2[i]) > max_diff) max_diff = fabs(p1[i] - p2[i]);
+    }
+    EXPECT_LT(max_diff / max_abs, oskar_mem_is_double(approx) ? 1e-12 : 1e-5);
+    oskar_mem_free(t1, &status);
+    oskar_mem_free(t2, &status);
+}
+
 static const char* loc_to_str(int loc)
 {
     switch (loc) {
@@ -216,6 +244,145 @@ protected:
                 time2 * 1000.0);
 #endif
     }
+
+    void run_test_phase(int prec, int matrix, int extended,
+            double time_average, double freq_average)
+    {
+        int num_baselines, status = 0, type;
+        oskar_Jones *K, *J;
+        oskar_Mem *vis1, *vis2;
+        const double frequency = 100e6;
+
+        // Evaluate Jones K in double precision, join it with the other
+        // Jones matrices and correlate. Station coordinates span several
+        // turns of phase, but are small enough for single precision.
+        create_test_data(OSKAR_DOUBLE, OSKAR_CPU, matrix);
+        for (int i = 0; i < 3; ++i)
+            oskar_mem_random_range(uvw[i], -10.0, 10.0, &status);
+        num_baselines = oskar_telescope_num_baselines(tel);
+        type = OSKAR_DOUBLE_COMPLEX;
+        if (matrix) type |= OSKAR_MATRIX;
+        vis1 = oskar_mem_create(type, OSKAR_CPU, num_baselines, &status);
+        oskar_mem_clear_contents(vis1, &status);
+        oskar_telescope_set_channel_bandwidth(tel, freq_average);
+        oskar_telescope_set_time_average(tel, time_average);
+        K = oskar_jones_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+                num_stations, num_sources, &status);
+        J = oskar_jones_create(type, OSKAR_CPU,
+                num_stations, num_sources, &status);
+        oskar_evaluate_jones_K(K, num_sources,
+                src_dir[0], src_dir[1], src_dir[2], uvw[0], uvw[1], uvw[2],
+                frequency, src_flux[0], -DBL_MAX, DBL_MAX, 0, &status);
+        oskar_jones_join(J, K, jones, &status);
+        oskar_cross_correlate(extended, num_sources, J,
+                src_flux, src_dir, src_ext,
+                tel, uvw, 1.0, frequency, 0, vis1, &status);
+        oskar_jones_free(K, &status);
+        oskar_jones_free(J, &status);
+        destroy_test_data();
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Apply the phase in the correlator instead.
+        create_test_data(prec, OSKAR_CPU, matrix);
+        for (int i = 0; i < 3; ++i)
+            oskar_mem_random_range(uvw[i], -10.0, 10.0, &status);
+        type = prec | OSKAR_COMPLEX;
+        if (matrix) type |= OSKAR_MATRIX;
+        vis2 = oskar_mem_create(type, OSKAR_CPU, num_baselines, &status);
+        oskar_mem_clear_contents(vis2, &status);
+        oskar_telescope_set_channel_bandwidth(tel, freq_average);
+        oskar_telescope_set_time_average(tel, time_average);
+        oskar_cross_correlate_phase(extended, num_sources, jones,
+                src_flux, src_dir, src_ext,
+                tel, uvw, 1.0, frequency, 0, 0, vis2, &status);
+        destroy_test_data();
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Compare results.
+        check_values(vis2, vis1);
+
+        // Free memory.
+        oskar_mem_free(vis1, &status);
+        oskar_mem_free(vis2, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+
+    void run_test_channels(int prec, int matrix, int extended,
+            double time_average, double freq_average, int num_jones)
+    {
+        int status = 0, type;
+        const int num_channels = 21;
+        const double freq_start = 100e6, freq_inc = 0.5e6;
+        oskar_Mem *vis1, *vis2, *flux_all[4];
+        oskar_Jones* jones_chan[num_channels];
+
+        // Create per-channel Jones matrices and source fluxes.
+        create_test_data(prec, OSKAR_CPU, matrix);
+        for (int i = 0; i < 3; ++i)
+            oskar_mem_random_range(uvw[i], -10.0, 10.0, &status);
+        oskar_telescope_set_channel_bandwidth(tel, freq_average);
+        oskar_telescope_set_time_average(tel, time_average);
+        oskar_telescope_set_uv_filter(tel, 0.0, 15.0, "Metres", &status);
+        const int num_baselines = oskar_telescope_num_baselines(tel);
+        type = prec | OSKAR_COMPLEX;
+        if (matrix) type |= OSKAR_MATRIX;
+        for (int c = 0; c < num_jones; ++c)
+        {
+            jones_chan[c] = oskar_jones_create(type, OSKAR_CPU,
+                    num_stations, num_sources, &status);
+            oskar_mem_random_range(oskar_jones_mem(jones_chan[c]),
+                    1.0, 5.0, &status);
+        }
+        for (int i = 0; i < 4; ++i)
+        {
+            flux_all[i] = oskar_mem_create(prec, OSKAR_CPU,
+                    num_channels * num_sources, &status);
+            oskar_mem_random_range(flux_all[i], 0.1, 2.0, &status);
+        }
+        vis1 = oskar_mem_create(type, OSKAR_CPU,
+                num_channels * num_baselines, &status);
+        vis2 = oskar_mem_create(type, OSKAR_CPU,
+                num_channels * num_baselines, &status);
+        oskar_mem_clear_contents(vis1, &status);
+        oskar_mem_clear_contents(vis2, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Correlate each channel separately.
+        for (int c = 0; c < num_channels; ++c)
+        {
+            oskar_Mem* flux[4];
+            for (int i = 0; i < 4; ++i)
+                flux[i] = oskar_mem_create_alias(flux_all[i],
+                        c * num_sources, num_sources, &status);
+            oskar_cross_correlate_phase(extended, num_sources,
+                    jones_chan[num_jones > 1 ? c : 0], flux, src_dir,
+                    src_ext, tel, uvw, 1.0, freq_start + c * freq_inc,
+                    0, c * num_baselines, vis1, &status);
+            for (int i = 0; i < 4; ++i)
+                oskar_mem_free(flux[i], &status);
+        }
+
+        // Correlate all channels together.
+        oskar_cross_correlate_phase_channels(extended, num_sources,
+                num_channels, num_jones, jones_chan, flux_all, src_dir,
+                src_ext, tel, uvw, 1.0, freq_start, freq_inc, 0,
+                0, num_baselines, vis2, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Compare results, relative to the largest visibility amplitude,
+        // as random data can give some very small visibilities.
+        check_values_scaled(vis2, vis1);
+
+        // Free memory.
+        for (int c = 0; c < num_jones; ++c)
+            oskar_jones_free(jones_chan[c], &status);
+        for (int i = 0; i < 4; ++i)
+            oskar_mem_free(flux_all[i], &status);
+        oskar_mem_free(vis1, &status);
+        oskar_mem_free(vis2, &status);
+        destroy_test_data();
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
 };
 
 
@@ -247,6 +414,54 @@ TEST_F(cross_correlate, CPU)
     }
 }
 
+// Check that applying the phase in the correlator gives the same result
+// as evaluating and joining Jones K first.
+TEST_F(cross_correlate, CPU_phase)
+{
+    const int precision[] = {OSKAR_SINGLE, OSKAR_DOUBLE};
+    const double time_avg[] = {0.0, 10.0};
+    const double freq_avg[] = {0.0, 1.e4};
+    for (int i_prec = 0; i_prec < 2; ++i_prec)
+    {
+        for (int matrix = 0; matrix < 2; ++matrix)
+        {
+            for (int extended = 0; extended < 2; ++extended)
+            {
+                for (int i_avg = 0; i_avg < 2; ++i_avg)
+                {
+                    run_test_phase(precision[i_prec], matrix, extended,
+                            time_avg[i_avg], freq_avg[i_avg]);
+                }
+            }
+        }
+    }
+}
+
+// Check that correlating a block of channels together gives the same result
+// as correlating each channel separately.
+TEST_F(cross_correlate, CPU_channels)
+{
+    const int precision[] = {OSKAR_SINGLE, OSKAR_DOUBLE};
+    const double time_avg[] = {0.0, 10.0};
+    const double freq_avg[] = {0.0, 1.e4};
+    for (int i_prec = 0; i_prec < 2; ++i_prec)
+    {
+        for (int matrix = 0; matrix < 2; ++matrix)
+        {
+            for (int extended = 0; extended < 2; ++extended)
+            {
+                for (int i_avg = 0; i_avg < 2; ++i_avg)
+                {
+                    run_test_channels(precision[i_prec], matrix, extended,
+                            time_avg[i_avg], freq_avg[i_avg], 1);
+                    run_test_channels(precision[i_prec], matrix, extended,
+                            time_avg[i_avg], freq_avg[i_avg], 21);
+                }
+            }
+        }
+    }
+}
+
 #ifdef OSKAR_HAVE_CUDA
 // Check for consistency between CPU and CUDA versions.
 TEST_F(cross_correlate, CUDA)
@@ -0,0 +1,194 @@
+/* Copyright (c) 2021, The OSKAR Developers. See LICENSE file. */
+
+/* CPU functions used by the W-stacking imager. */
+
+#define WSTACK_MAX_SUPPORT 16
+
+/* Evaluates the ES kernel at 2 * support + 1 points, given the position
+ * of the visibility in grid cells, and returns the index of the first. */
+#define WSTACK_KERNEL(FP, SUPPORT, BETA, INV_HW, POS, K)\
+        const int K ## _start = ROUND(FP, POS) - SUPPORT;\
+        for (int t = 0; t <= 2 * SUPPORT; ++t) {\
+            const FP x = ((FP) (K ## _start + t) - POS) * INV_HW;\
+            const FP r = (FP) 1 - x * x;\
+            K[t] = (r > (FP) 0) ? exp(BETA * (sqrt(r) - (FP) 1)) : (FP) 0;\
+        }\
+
+/*
+ * Finds the first W-layer and the band of grid rows updated by each
+ * visibility, and phase-rotates the visibilities to the centre of the
+ * range of (n - 1) values in the image.
+ */
+#define OSKAR_GRID_WSTACK_PREPARE(NAME, FP) static void NAME(\
+        const size_t    num_vis,\
+        const FP*       vv,\
+        const FP*       ww,\
+        FP*             vis,\
+        const int       support,\
+        const int       grid_size,\
+        const double    grid_scale,\
+        const double    w_start,\
+        const double    inv_dw,\
+        const double    nm1_centre,\
+        const int       num_bands,\
+        int*            key)\
+{\
+    ptrdiff_t i;\
+    const int band_size = 2 * support + 1;\
+    DO_PRAGMA(omp parallel for)\
+    for (i = 0; i < (ptrdiff_t) num_vis; ++i) {\
+        double re, im;\
+        const FP pos_v = (FP) (vv[i] * grid_scale);\
+        const int band = (ROUND(FP, pos_v) + grid_size / 2 - support) /\
+                band_size;\
+        const FP pos_w = (FP) ((ww[i] - w_start) * inv_dw);\
+        const int layer = ROUND(FP, pos_w) - support;\
+        key[i] = layer * num_bands + band;\
+        oskar_sincos_d(-2.0 * M_PI * nm1_centre * ww[i], &im, &re);\
+        const double v_re = vis[2 * i], v_im = vis[2 * i + 1];\
+        vis[2 * i]     = (FP) (v_re * re - v_im * im);\
+        vis[2 * i + 1] = (FP) (v_re * im + v_im * re);\
+    }\
+}\
+
+/*
+ * Grids all the visibilities which contribute to one W-layer.
+ * The grid is updated in bands of rows at least as high as the kernel,
+ * so alternate bands can be processed in parallel without locks.
+ */
+#define OSKAR_GRID_WSTACK_LAYER(NAME, FP) static void NAME(\
+        const int       layer,\
+        const int       num_layers,\
+        const size_t*   order,\
+        const size_t*   offsets,\
+        const FP*       uu,\
+        const FP*       vv,\
+        const FP*       ww,\
+        const FP*       vis,\
+        const int       support,\
+        const FP        beta,\
+        const int       grid_size,\
+        const double    grid_scale,\
+        const double    w_start,\
+        const double    inv_dw,\
+        const int       num_bands,\
+        FP*             grid)\
+{\
+    int parity;\
+    const int grid_centre = grid_size / 2;\
+    const FP inv_hw = (FP) 1 / ((FP) support + (FP) 0.5);\
+    const int first = (layer > 2 * support) ? layer - 2 * support : 0;\
+    const int last = (layer < num_layers) ? layer : num_layers - 1;\
+    for (parity = 0; parity < 2; ++parity) {\
+        int b;\
+        DO_PRAGMA(omp parallel for schedule(dynamic, 1))\
+        for (b = parity; b < num_bands; b += 2) {\
+            FP ku[2 * WSTACK_MAX_SUPPORT + 1], kv[2 * WSTACK_MAX_SUPPORT + 1];\
+            FP kw[2 * WSTACK_MAX_SUPPORT + 1];\
+            int l;\
+            for (l = first; l <= last; ++l) {\
+                size_t j;\
+                const int k = l * num_bands + b;\
+                for (j = offsets[k]; j < offsets[k + 1]; ++j) {\
+                    const size_t i = order[j];\
+                    const FP pos_u = (FP) (-uu[i] * grid_scale);\
+                    const FP pos_v = (FP) (vv[i] * grid_scale);\
+                    const FP pos_w = (FP) ((ww[i] - w_start) * inv_dw);\
+                    WSTACK_KERNEL(FP, support, beta, inv_hw, pos_w, kw)\
+                    const FP c = kw[layer - kw_start];\
+                    const FP v_re = c * vis[2 * i], v_im = c * vis[2 * i + 1];\
+                    WSTACK_KERNEL(FP, support, beta, inv_hw, pos_u, ku)\
+                    WSTACK_KERNEL(FP, support, beta, inv_hw, pos_v, kv)\
+                    for (int y = 0; y <= 2 * support; ++y) {\
+                        const FP c_re = kv[y] * v_re, c_im = kv[y] * v_im;\
+                        FP* row = grid + 2 * ((size_t) grid_size *\
+                                (size_t) (kv_start + y + grid_centre) +\
+                                (size_t) (ku_start + grid_centre));\
+                        for (int x = 0; x <= 2 * support; ++x) {\
+                            row[2 * x]     += c_re * ku[x];\
+                            row[2 * x + 1] += c_im * ku[x];\
+                        }\
+                    }\
+                }\
+            }\
+        }\
+    }\
+}\
+
+/* Returns (n - 1) for pixel (x, y) of the grid, or 1 if below the horizon. */
+#define WSTACK_NM1(X, Y, GRID_CENTRE, CELLSIZE, NM1)\
+        const double l_ = ((X) - (GRID_CENTRE)) * (CELLSIZE);\
+        const double m_ = ((Y) - (GRID_CENTRE)) * (CELLSIZE);\
+        const double r2_ = l_ * l_ + m_ * m_;\
+        const double NM1 = (r2_ < 1.0) ? -r2_ / (sqrt(1.0 - r2_) + 1.0) : 1.0;\
+
+/*
+ * Multiplies the transformed W-layer by its W-screen, and adds it to the
+ * image plane, for pixels inside the image region.
+ */
+#define OSKAR_GRID_WSTACK_ADD_LAYER(NAME, FP) static void NAME(\
+        const int       grid_size,\
+        const int       image_size,\
+        const double    cellsize_rad,\
+        const double    w_layer,\
+        const double    nm1_centre,\
+        const FP*       grid,\
+        FP*             plane)\
+{\
+    int y;\
+    const int grid_centre = grid_size / 2;\
+    const int start = (grid_size - image_size) / 2;\
+    DO_PRAGMA(omp parallel for)\
+    for (y = start; y < start + image_size; ++y) {\
+        for (int x = start; x < start + image_size; ++x) {\
+            double re_d, im_d;\
+            const size_t p = 2 * ((size_t) y * (size_t) grid_size + x);\
+            WSTACK_NM1(x, y, grid_centre, cellsize_rad, nm1)\
+            if (nm1 > 0.0) continue;\
+            oskar_sincos_d(-2.0 * M_PI * w_layer * (nm1 - nm1_centre),\
+                    &im_d, &re_d);\
+            const FP re = (FP) re_d, im = (FP) im_d;\
+            plane[p]     += grid[p] * re - grid[p + 1] * im;\
+            plane[p + 1] += grid[p] * im + grid[p + 1] * re;\
+        }\
+    }\
+}\
+
+/*
+ * Applies the grid correction in all three dimensions to pixels in the
+ * image region. The W-correction function is interpolated from a table.
+ */
+#define OSKAR_GRID_WSTACK_CORRECT(NAME, FP) static void NAME(\
+        const int       grid_size,\
+        const int       image_size,\
+        const double    cellsize_rad,\
+        const double    nm1_centre,\
+        const double*   corr_uv,\
+        const int       num_corr_w,\
+        const double    corr_w_scale,\
+        const double*   corr_w,\
+        FP*             plane)\
+{\
+    int y;\
+    const int grid_centre = grid_size / 2;\
+    const int start = (grid_size - image_size) / 2;\
+    DO_PRAGMA(omp parallel for)\
+    for (y = start; y < start + image_size; ++y) {\
+        for (int x = start; x < start + image_size; ++x) {\
+            double c = 0.0;\
+            const size_t p = 2 * ((size_t) y * (size_t) grid_size + x);\
+            WSTACK_NM1(x, y, grid_centre, cellsize_rad, nm1)\
+            if (nm1 <= 0.0) {\
+                double t = fabs(nm1 - nm1_centre) * corr_w_scale;\
+                int i = (int) t;\
+                if (i >= num_corr_w - 1) i = num_corr_w - 2;\
+                t -= i;\
+                c = corr_uv[x] * corr_uv[y] *\
+                        ((1.0 - t) * corr_w[i] + t * corr_w[i + 1]);\
+            }\
+            plane[p]     *= (FP) c;\
+            plane[p + 1] *= (FP) c;\
+        }\
+    }\
+}\
+
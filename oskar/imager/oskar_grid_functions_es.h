@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_GRID_FUNCTIONS_ES_H_
+#define OSKAR_GRID_FUNCTIONS_ES_H_
+
+/**
+ * @file oskar_grid_functions_es.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Returns the shape parameter of the exponential of semicircle (ES) kernel.
+ *
+ * @details
+ * Returns the shape parameter, beta, of the "exponential of semicircle"
+ * gridding kernel
+ *
+ *   phi(x) = exp(beta * (sqrt(1 - x^2) - 1)),  |x| < 1,
+ *
+ * which is optimal for the given support size and grid padding factor
+ * (Barnett, Magland & af Klinteberg, 2019).
+ *
+ * The kernel covers (2 * support + 1) grid cells, and the error of the
+ * corrected image is approximately exp(-pi * w * sqrt(1 - 1 / padding)),
+ * where w = 2 * support + 1.
+ *
+ * @param[in] support    Kernel support size (width = 2 * support + 1).
+ * @param[in] padding    Ratio of grid size to image size (> 1).
+ */
+OSKAR_EXPORT
+double oskar_grid_function_es_beta(const int support, const double padding);
+
+/**
+ * @brief
+ * Evaluates the exponential of semicircle (ES) gridding kernel.
+ *
+ * @details
+ * Evaluates the ES kernel at a distance \p dx grid cells from its centre.
+ *
+ * @param[in] support    Kernel support size (width = 2 * support + 1).
+ * @param[in] beta       Kernel shape parameter.
+ * @param[in] dx         Distance from the kernel centre, in grid cells.
+ */
+OSKAR_EXPORT
+double oskar_grid_function_es(const int support, const double beta,
+        const double dx);
+
+/**
+ * @brief
+ * Evaluates the Fourier transform of the ES gridding kernel.
+ *
+ * @details
+ * Evaluates the Fourier transform of the ES kernel at \p num_points
+ * frequencies \p freq (in cycles per grid cell) by numerical quadrature.
+ * The result is used to correct the image for the effect of gridding.
+ *
+ * @param[in] support    Kernel support size (width = 2 * support + 1).
+ * @param[in] beta       Kernel shape parameter.
+ * @param[in] num_points Number of frequencies to evaluate.
+ * @param[in] freq       Frequencies, in cycles per grid cell.
+ * @param[out] fn        Fourier transform of the kernel at each frequency.
+ */
+OSKAR_EXPORT
+void oskar_grid_function_es_fourier(const int support, const double beta,
+        const int num_points, const double* freq, double* fn);
+
+/**
+ * @brief
+ * Generates grid correction function for the ES convolution function.
+ *
+ * @details
+ * Generates the reciprocal of the Fourier transform of the ES kernel
+ * at each pixel of a (padded) image, for use with oskar_grid_correction().
+ *
+ * @param[in] image_size Side length of the grid and image.
+ * @param[in] support    Kernel support size (width = 2 * support + 1).
+ * @param[in] beta       Kernel shape parameter.
+ * @param[in,out] fn     Array holding correction function, length image_size.
+ */
+OSKAR_EXPORT
+void oskar_grid_correction_function_es(const int image_size,
+        const int support, const double beta, double* fn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_GRID_FUNCTIONS_ES_H_ */
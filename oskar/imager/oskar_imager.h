@@ -66,7 +66,8 @@ enum OSKAR_IMAGE_ALGORITHM
     OSKAR_ALGORITHM_DFT_2D,
     OSKAR_ALGORITHM_DFT_3D,
     OSKAR_ALGORITHM_WPROJ,
-    OSKAR_ALGORITHM_AWPROJ
+    OSKAR_ALGORITHM_AWPROJ,
+    OSKAR_ALGORITHM_WSTACK
 };
 
 enum OSKAR_IMAGE_WEIGHTING
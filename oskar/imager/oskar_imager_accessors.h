@@ -162,6 +162,19 @@ int oskar_imager_generate_w_kernels_on_gpu(const oskar_Imager* h);
 OSKAR_EXPORT
 int oskar_imager_grid_on_gpu(const oskar_Imager* h);
 
+/**
+ * @brief
+ * Returns the image padding factor.
+ *
+ * @details
+ * Returns the ratio of the grid size to the image size, used by the
+ * W-projection and W-stacking algorithms.
+ *
+ * @param[in] h  Handle to imager.
+ */
+OSKAR_EXPORT
+double oskar_imager_image_padding(const oskar_Imager* h);
+
 /**
  * @brief
  * Returns the image side length.
@@ -319,12 +332,18 @@ int oskar_imager_scale_norm_with_num_input_files(const oskar_Imager* h);
  * The \p type string can be:
  * - "FFT" to use standard gridding followed by a FFT.
  * - "W-projection" to use W-projection gridding followed by a FFT.
+ * - "W-stacking" to use W-stacking with an exponential of semicircle
+ *   gridding kernel, followed by a FFT of each W-layer.
+ *   Visibilities are buffered in host memory until the plane is finalised,
+ *   so memory use is proportional to the total number of visibilities.
  * - "DFT 2D" to use a 2D Direct Fourier Transform, without gridding.
  * - "DFT 3D" to use a 3D Direct Fourier Transform, without gridding.
  *
  * This function also sets the default gridding parameters.
  * Call oskar_imager_set_grid_kernel() or oskar_imager_set_oversample()
  * afterwards to override these if required.
+ * The default image padding is used only if none has been set using
+ * oskar_imager_set_image_padding().
  *
  * @param[in,out] h          Handle to imager.
  * @param[in]     type       The algorithm to use (see description).
@@ -510,6 +529,7 @@ void oskar_imager_set_gpus(oskar_Imager* h, int num, const int* ids,
  *
  * The \p type string can be:
  * - "Spheroidal" to use the spheroidal kernel from CASA.
+ * - "ES" to use the exponential of semicircle kernel (W-stacking only).
  *
  * @param[in,out] h          Handle to imager.
  * @param[in]     type       Type of kernel to use.
@@ -534,6 +554,26 @@ void oskar_imager_set_grid_kernel(oskar_Imager* h, const char* type,
 OSKAR_EXPORT
 void oskar_imager_set_grid_on_gpu(oskar_Imager* h, int value);
 
+/**
+ * @brief
+ * Sets the image padding factor.
+ *
+ * @details
+ * Sets the ratio of the grid size to the image size, used by the
+ * W-projection and W-stacking algorithms.
+ *
+ * A value set here is kept if the algorithm is changed later.
+ * A value less than 1 restores the default for the algorithm
+ * (1.2 for W-projection, 1.5 for W-stacking).
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in]     value      Image padding factor.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_image_padding(oskar_Imager* h, double value,
+        int* status);
+
 /**
  * @brief
  * Sets image side length.
@@ -790,6 +830,28 @@ void oskar_imager_set_vis_phase_centre(oskar_Imager* h,
 OSKAR_EXPORT
 void oskar_imager_set_num_w_planes(oskar_Imager* h, int value);
 
+/**
+ * @brief
+ * Sets the directory used to cache W-projection kernels.
+ *
+ * @details
+ * Sets the directory used to cache W-projection kernels between runs.
+ *
+ * Kernels are saved to a file named using a hash of all the parameters
+ * used to generate them, and the file is memory-mapped when the same
+ * parameters are used again, instead of generating the kernels.
+ * The directory is created if it does not exist.
+ *
+ * An empty string or NULL disables the cache (the default).
+ *
+ * @param[in,out] h            Handle to imager.
+ * @param[in] dir              Path to cache directory.
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_w_kernel_cache_dir(oskar_Imager* h, const char* dir,
+        int* status);
+
 /**
  * @brief
  * Sets the visibility weighting scheme to use.
@@ -867,6 +929,19 @@ double oskar_imager_uv_filter_max(const oskar_Imager* h);
 OSKAR_EXPORT
 double oskar_imager_uv_filter_min(const oskar_Imager* h);
 
+/**
+ * @brief
+ * Returns the directory used to cache W-projection kernels.
+ *
+ * @details
+ * Returns the directory used to cache W-projection kernels,
+ * or an empty string if the cache is not used.
+ *
+ * @param[in] h  Handle to imager.
+ */
+OSKAR_EXPORT
+const char* oskar_imager_w_kernel_cache_dir(const oskar_Imager* h);
+
 /**
  * @brief
  * Returns the visibility weighting scheme.
@@ -33,6 +33,14 @@ struct DeviceData
 };
 typedef struct DeviceData DeviceData;
 
+/* Visibilities buffered for one image plane by the W-stacking imager. */
+struct WStackData
+{
+    oskar_Mem *uu, *vv, *ww, *vis;
+    size_t num_vis;
+};
+typedef struct WStackData WStackData;
+
 struct oskar_Imager
 {
     char* output_name[4];
@@ -48,9 +56,10 @@ struct oskar_Imager
     int algorithm, fft_on_gpu, grid_on_gpu;
     int image_size, use_stokes, support, oversample;
     int generate_w_kernels_on_gpu, set_cellsize, set_fov, weighting;
-    int num_files, scale_norm_with_num_input_files;
+    int num_files, scale_norm_with_num_input_files, set_image_padding;
     char direction_type, kernel_type;
     char **input_files, *input_root, *output_root, *ms_column;
+    char *w_kernel_cache_dir;
     double cellsize_rad, fov_deg, image_padding, im_centre_deg[2];
     double uv_filter_min, uv_filter_max;
     double time_min_utc, time_max_utc, freq_min_hz, freq_max_hz;
@@ -87,6 +96,12 @@ struct oskar_Imager
     int num_w_planes;
     double w_scale, ww_min, ww_max, ww_rms;
     oskar_Mem *w_support, *w_kernels_compact, *w_kernel_start;
+    void* w_kernel_map; /* Memory-mapped kernel cache file. */
+    size_t w_kernel_map_size;
+
+    /* W-stacking imager data (array of WStackData structures). */
+    int num_w_layers;
+    WStackData* ws;
 
     /* Memory allocated per GPU (array of DeviceData structures). */
     DeviceData* d;
@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_IMAGER_FINALISE_PLANE_WSTACK_H_
+#define OSKAR_IMAGER_FINALISE_PLANE_WSTACK_H_
+
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_imager_finalise_plane_wstack(oskar_Imager* h, int i_plane,
+        oskar_Mem* plane, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
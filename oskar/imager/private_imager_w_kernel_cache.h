@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_IMAGER_W_KERNEL_CACHE_H_
+#define OSKAR_IMAGER_W_KERNEL_CACHE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Loads W-kernels from the cache directory, returning 1 if found. */
+int oskar_imager_w_kernel_cache_load(oskar_Imager* h, int conv_size,
+        int* status);
+
+/* Saves the W-kernels to the cache directory. */
+void oskar_imager_w_kernel_cache_save(oskar_Imager* h, int conv_size,
+        int* status);
+
+/* Releases the memory-mapped kernel file, if any. */
+void oskar_imager_w_kernel_cache_release(oskar_Imager* h);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/oskar_grid_functions_es.h"
+
+#include "math/oskar_cmath.h"
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Generates Gauss-Legendre quadrature nodes and weights on [0, 1]. */
+static void gauss_legendre(int n, double* x, double* w)
+{
+    int i, j;
+    const int m = (n + 1) / 2;
+    for (i = 0; i < m; ++i)
+    {
+        double z = cos(M_PI * (i + 0.75) / (n + 0.5)), z1, pp = 0.0;
+        do
+        {
+            double p1 = 1.0, p2 = 0.0;
+            for (j = 0; j < n; ++j)
+            {
+                const double p3 = p2;
+                p2 = p1;
+                p1 = ((2.0 * j + 1.0) * z * p2 - j * p3) / (j + 1);
+            }
+            pp = n * (z * p1 - p2) / (z * z - 1.0);
+            z1 = z;
+            z = z1 - p1 / pp;
+        }
+        while (fabs(z - z1) > 1e-15);
+        x[i] = 0.5 * (1.0 - z);
+        x[n - 1 - i] = 0.5 * (1.0 + z);
+        w[i] = 1.0 / ((1.0 - z * z) * pp * pp);
+        w[n - 1 - i] = w[i];
+    }
+}
+
+
+double oskar_grid_function_es_beta(const int support, const double padding)
+{
+    /* Values from Barnett et al. (2019), Section 4.3. */
+    const double width = 2.0 * support + 1.0;
+    return 0.97 * M_PI * width * (1.0 - 0.5 / padding);
+}
+
+
+double oskar_grid_function_es(const int support, const double beta,
+        const double dx)
+{
+    const double x = dx / (support + 0.5);
+    const double t = 1.0 - x * x;
+    return (t > 0.0) ? exp(beta * (sqrt(t) - 1.0)) : 0.0;
+}
+
+
+void oskar_grid_function_es_fourier(const int support, const double beta,
+        const int num_points, const double* freq, double* fn)
+{
+    int i, j;
+    const double half_width = support + 0.5;
+    const int n = 8 * support + 36;
+    double* x = (double*) calloc(n, sizeof(double));
+    double* w = (double*) calloc(n, sizeof(double));
+    double* k = (double*) calloc(n, sizeof(double));
+
+    /* The kernel is even, so integrate over half of it. */
+    gauss_legendre(n, x, w);
+    for (j = 0; j < n; ++j)
+    {
+        k[j] = 2.0 * w[j] * half_width *
+                exp(beta * (sqrt(1.0 - x[j] * x[j]) - 1.0));
+        x[j] *= 2.0 * M_PI * half_width;
+    }
+    for (i = 0; i < num_points; ++i)
+    {
+        double sum = 0.0;
+        for (j = 0; j < n; ++j) sum += k[j] * cos(x[j] * freq[i]);
+        fn[i] = sum;
+    }
+    free(x);
+    free(w);
+    free(k);
+}
+
+
+void oskar_grid_correction_function_es(const int image_size,
+        const int support, const double beta, double* fn)
+{
+    int i;
+    const int centre = image_size / 2;
+    for (i = 0; i < image_size; ++i)
+        fn[i] = (double) (i - centre) / (double) image_size;
+    oskar_grid_function_es_fourier(support, beta, image_size, fn, fn);
+    for (i = 0; i < image_size; ++i)
+        fn[i] = (fn[i] != 0.0) ? 1.0 / fn[i] : 1.0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -26,12 +26,24 @@
 extern "C" {
 #endif
 
+static double default_image_padding(int algorithm)
+{
+    switch (algorithm)
+    {
+    case OSKAR_ALGORITHM_WPROJ:  return 1.2;
+    case OSKAR_ALGORITHM_WSTACK: return 1.5;
+    default:                     return 1.0;
+    }
+}
+
+
 const char* oskar_imager_algorithm(const oskar_Imager* h)
 {
     switch (h->algorithm)
     {
     case OSKAR_ALGORITHM_FFT:    return "FFT";
     case OSKAR_ALGORITHM_WPROJ:  return "W-projection";
+    case OSKAR_ALGORITHM_WSTACK: return "W-stacking";
     case OSKAR_ALGORITHM_DFT_2D: return "DFT 2D";
     case OSKAR_ALGORITHM_DFT_3D: return "DFT 3D";
     default:                     return "";
@@ -93,6 +105,12 @@ int oskar_imager_grid_on_gpu(const oskar_Imager* h)
 }
 
 
+double oskar_imager_image_padding(const oskar_Imager* h)
+{
+    return h->image_padding;
+}
+
+
 int oskar_imager_image_size(const oskar_Imager* h)
 {
     return h->image_size;
@@ -165,7 +183,8 @@ int oskar_imager_plane_size(oskar_Imager* h)
 {
     if (h->grid_size == 0)
     {
-        if (h->algorithm == OSKAR_ALGORITHM_WPROJ)
+        if (h->algorithm == OSKAR_ALGORITHM_WPROJ ||
+                h->algorithm == OSKAR_ALGORITHM_WSTACK)
         {
             (void) oskar_imager_composite_nearest_even(h->image_padding *
                     ((double)(h->image_size)) - 0.5, 0, &h->grid_size);
@@ -208,7 +227,6 @@ void oskar_imager_set_algorithm(oskar_Imager* h, const char* type,
         int* status)
 {
     if (*status || !type) return;
-    h->image_padding = 1.0;
     if (!strncmp(type, "FFT", 3) || !strncmp(type, "fft", 3))
     {
         h->algorithm = OSKAR_ALGORITHM_FFT;
@@ -216,11 +234,17 @@ void oskar_imager_set_algorithm(oskar_Imager* h, const char* type,
         h->support = 3;
         h->oversample = 100;
     }
+    else if (!strncmp(type, "W-s", 3) || !strncmp(type, "w-s", 3))
+    {
+        h->algorithm = OSKAR_ALGORITHM_WSTACK;
+        h->kernel_type = 'E';
+        h->support = 3;
+        h->oversample = 0;
+    }
     else if (!strncmp(type, "W", 1) || !strncmp(type, "w", 1))
     {
         h->algorithm = OSKAR_ALGORITHM_WPROJ;
         h->oversample = 4;
-        h->image_padding = 1.2;
     }
     else if (!strncmp(type, "DFT 2", 5) || !strncmp(type, "dft 2", 5))
         h->algorithm = OSKAR_ALGORITHM_DFT_2D;
@@ -228,6 +252,10 @@ void oskar_imager_set_algorithm(oskar_Imager* h, const char* type,
         h->algorithm = OSKAR_ALGORITHM_DFT_3D;
     else *status = OSKAR_ERR_INVALID_ARGUMENT;
 
+    /* Use the default padding for the algorithm, unless it has been set. */
+    if (!h->set_image_padding)
+        h->image_padding = default_image_padding(h->algorithm);
+
     /* Recalculate grid plane size. */
     h->grid_size = 0;
     oskar_imager_reset_cache(h, status);
@@ -389,6 +417,8 @@ void oskar_imager_set_grid_kernel(oskar_Imager* h, const char* type,
         h->kernel_type = 'G';
     else if (!strncmp(type, "P", 1) || !strncmp(type, "p", 1))
         h->kernel_type = 'P';
+    else if (!strncmp(type, "E", 1) || !strncmp(type, "e", 1))
+        h->kernel_type = 'E';
     else *status = OSKAR_ERR_INVALID_ARGUMENT;
 }
 
@@ -399,6 +429,19 @@ void oskar_imager_set_grid_on_gpu(oskar_Imager* h, int value)
 }
 
 
+void oskar_imager_set_image_padding(oskar_Imager* h, double value,
+        int* status)
+{
+    if (*status) return;
+    h->set_image_padding = (value >= 1.0);
+    h->image_padding = h->set_image_padding ?
+            value : default_image_padding(h->algorithm);
+    h->grid_size = 0;
+    oskar_imager_reset_cache(h, status);
+    (void) oskar_imager_plane_size(h);
+}
+
+
 void oskar_imager_set_image_size(oskar_Imager* h, int size, int* status)
 {
     oskar_imager_set_size(h, size, status);
@@ -691,6 +734,18 @@ void oskar_imager_set_num_w_planes(oskar_Imager* h, int value)
 }
 
 
+void oskar_imager_set_w_kernel_cache_dir(oskar_Imager* h, const char* dir,
+        int* status)
+{
+    if (*status) return;
+    free(h->w_kernel_cache_dir);
+    h->w_kernel_cache_dir = 0;
+    if (!dir || strlen(dir) == 0) return;
+    h->w_kernel_cache_dir = (char*) calloc(1 + strlen(dir), 1);
+    strcpy(h->w_kernel_cache_dir, dir);
+}
+
+
 void oskar_imager_set_weighting(oskar_Imager* h, const char* type, int* status)
 {
     if (*status || !type) return;
@@ -736,6 +791,12 @@ double oskar_imager_uv_filter_min(const oskar_Imager* h)
 }
 
 
+const char* oskar_imager_w_kernel_cache_dir(const oskar_Imager* h)
+{
+    return h->w_kernel_cache_dir ? h->w_kernel_cache_dir : "";
+}
+
+
 const char* oskar_imager_weighting(const oskar_Imager* h)
 {
     switch (h->weighting)
@@ -32,6 +32,7 @@
 #include "imager/oskar_grid_correction.h"
 #include "imager/oskar_grid_functions_pillbox.h"
 #include "imager/oskar_grid_functions_spheroidal.h"
+#include "imager/private_imager_finalise_plane_wstack.h"
 #include "imager/private_imager_free_device_data.h"
 #include "math/oskar_fft.h"
 #include "math/oskar_fftphase.h"
@@ -39,6 +40,8 @@
 #include "utility/oskar_device.h"
 #include "utility/oskar_get_error_string.h"
 #include "utility/oskar_get_memory_usage.h"
+#include "utility/oskar_get_num_procs.h"
+#include "utility/oskar_thread.h"
 #include "utility/oskar_timer.h"
 
 #include <fitsio.h>
@@ -52,6 +55,9 @@ extern "C" {
 
 static void write_plane(oskar_Imager* h, oskar_Mem* plane,
         int c, int p, int* status);
+static void update_corr_func(oskar_Imager* h, int size, int* status);
+static int use_fused_finalise(const oskar_Imager* h);
+static void finalise_planes_fused(oskar_Imager* h, int* status);
 
 
 void oskar_imager_finalise(oskar_Imager* h,
@@ -143,13 +149,22 @@ void oskar_imager_finalise(oskar_Imager* h,
     if (h->fits_file[0] || output_images)
     {
         /* Finalise all the planes. */
-        for (i = 0; i < h->num_planes; ++i)
+        const int fused = use_fused_finalise(h);
+        if (fused)
+            finalise_planes_fused(h, status);
+        else for (i = 0; i < h->num_planes; ++i)
         {
             oskar_Mem *plane = h->planes[i];
             if (h->grid_on_gpu && h->num_gpus > 0 && !(
                     h->algorithm == OSKAR_ALGORITHM_DFT_2D ||
                     h->algorithm == OSKAR_ALGORITHM_DFT_3D))
                 plane = h->d[0].planes[i];
+            if (h->algorithm == OSKAR_ALGORITHM_WSTACK)
+            {
+                oskar_timer_resume(h->tmr_grid_finalise);
+                oskar_imager_finalise_plane_wstack(h, i, plane, status);
+                oskar_timer_pause(h->tmr_grid_finalise);
+            }
             oskar_imager_finalise_plane(h, plane, h->plane_norm[i], status);
             if (plane != h->planes[i])
                 oskar_mem_copy(h->planes[i], plane, status);
@@ -169,9 +184,9 @@ void oskar_imager_finalise(oskar_Imager* h,
                     num_pix * oskar_mem_element_size(h->imager_prec));
         }
 
-        /* Write to files if required. */
+        /* Write to files if required (already done if fused). */
         oskar_timer_resume(h->tmr_write);
-        for (c = 0, i = 0; c < h->num_im_channels; ++c)
+        for (c = 0, i = 0; c < h->num_im_channels && !fused; ++c)
             for (p = 0; p < h->num_im_pols; ++p, ++i)
                 write_plane(h, h->planes[i], c, p, status);
         oskar_timer_pause(h->tmr_write);
@@ -238,6 +253,9 @@ void oskar_imager_finalise(oskar_Imager* h,
         if (h->num_w_planes > 0)
             oskar_log_value(h->log, 'M', 0,
                     "W-projection planes", "%d", h->num_w_planes);
+        if (h->num_w_layers > 0)
+            oskar_log_value(h->log, 'M', 0,
+                    "W-stacking layers", "%d", h->num_w_layers);
         if (h->fov_deg > 0.1)
             oskar_log_value(h->log, 'M', 0,
                     "Field of view [deg]", "%.1f", h->fov_deg);
@@ -317,9 +335,11 @@ void oskar_imager_finalise_plane(oskar_Imager* h,
         oskar_timer_pause(h->tmr_grid_finalise);
     }
 
-    /* If algorithm if DFT, we've finished here. */
+    /* If algorithm if DFT, we've finished here.
+     * W-stacking planes are transformed when the W-layers are combined. */
     if (h->algorithm == OSKAR_ALGORITHM_DFT_2D ||
-            h->algorithm == OSKAR_ALGORITHM_DFT_3D)
+            h->algorithm == OSKAR_ALGORITHM_DFT_3D ||
+            h->algorithm == OSKAR_ALGORITHM_WSTACK)
         return;
 
     /* Check plane is complex type, as plane must be gridded visibilities. */
@@ -351,25 +371,7 @@ void oskar_imager_finalise_plane(oskar_Imager* h,
     oskar_fft_exec(h->fft, plane, status);
 
     /* Generate grid correction function if required. */
-    if (!h->corr_func)
-    {
-        oskar_Mem* corr_func = 0;
-        corr_func = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, size, status);
-        if (h->algorithm != OSKAR_ALGORITHM_FFT)
-            oskar_grid_correction_function_spheroidal(size, h->oversample,
-                    oskar_mem_double(corr_func, status));
-        else
-        {
-            if (h->kernel_type == 'S')
-                oskar_grid_correction_function_spheroidal(size, 0,
-                        oskar_mem_double(corr_func, status));
-            else if (h->kernel_type == 'P')
-                oskar_grid_correction_function_pillbox(size,
-                        oskar_mem_double(corr_func, status));
-        }
-        h->corr_func = oskar_mem_convert_precision(corr_func,
-                h->imager_prec, status);
-    }
+    update_corr_func(h, size, status);
 
     /* FFT shift again, and apply grid correction. */
     oskar_fftphase(size, size, plane, status);
@@ -424,6 +426,199 @@ void oskar_imager_trim_image(oskar_Imager* h, oskar_Mem* plane,
 }
 
 
+static void update_corr_func(oskar_Imager* h, int size, int* status)
+{
+    oskar_Mem* corr_func = 0;
+    if (h->corr_func || *status) return;
+    corr_func = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, size, status);
+    if (h->algorithm != OSKAR_ALGORITHM_FFT)
+        oskar_grid_correction_function_spheroidal(size, h->oversample,
+                oskar_mem_double(corr_func, status));
+    else
+    {
+        if (h->kernel_type == 'S')
+            oskar_grid_correction_function_spheroidal(size, 0,
+                    oskar_mem_double(corr_func, status));
+        else if (h->kernel_type == 'P')
+            oskar_grid_correction_function_pillbox(size,
+                    oskar_mem_double(corr_func, status));
+    }
+    h->corr_func = oskar_mem_convert_precision(corr_func,
+            h->imager_prec, status);
+    oskar_mem_free(corr_func, status);
+}
+
+
+/*
+ * Produces the real part of the trimmed image from a transformed grid.
+ *
+ * This combines the FFT shifts either side of the FFT, the FFT scaling,
+ * the normalisation, the grid correction and the trim in one pass:
+ * shifting the grid before the FFT is equivalent to reading the output
+ * from (x + N/2, y + N/2), and shifting it afterwards is a sign change
+ * on alternate pixels.
+ */
+#define FINALISE_CROP(NAME, FP) static void NAME(const int grid_size,\
+        const int image_size, const FP scale, const FP* corr,\
+        const FP* grid, FP* image)\
+{\
+    int x, y;\
+    const int half = grid_size / 2, start = (grid_size - image_size) / 2;\
+    for (y = 0; y < image_size; ++y) {\
+        const int gy = y + start;\
+        const FP fy = ((gy & 1) ? -scale : scale) * corr[gy];\
+        const FP* in = grid + 2 * (size_t) ((gy + half) % grid_size) *\
+                (size_t) grid_size;\
+        FP* out = image + (size_t) y * (size_t) image_size;\
+        for (x = 0; x < image_size; ++x) {\
+            const int gx = x + start;\
+            const int sx = (gx + half) % grid_size;\
+            out[x] = ((gx & 1) ? -fy : fy) * corr[gx] * in[2 * sx];\
+        }\
+    }\
+}
+
+FINALISE_CROP(finalise_crop_float, float)
+FINALISE_CROP(finalise_crop_double, double)
+
+struct FinaliseArgs
+{
+    oskar_Imager* h;
+    int *next_plane, *next_write, *plane_done;
+};
+typedef struct FinaliseArgs FinaliseArgs;
+
+static void* run_finalise(void* arg)
+{
+    int status = 0;
+    FinaliseArgs* a = (FinaliseArgs*) arg;
+    oskar_Imager* h = a->h;
+    const int grid_size = oskar_imager_plane_size(h);
+    const size_t num_cells = (size_t) grid_size * (size_t) grid_size;
+    const size_t num_pix = (size_t) h->image_size * (size_t) h->image_size;
+    const size_t image_bytes = num_pix * oskar_mem_element_size(h->imager_prec);
+
+    /* Each thread needs its own FFT plan, which holds work arrays.
+     * The scaling applied to be consistent with cuFFT is done later. */
+    oskar_FFT* fft = oskar_fft_create(h->imager_prec, OSKAR_CPU, 2,
+            grid_size, 0, &status);
+    oskar_fft_set_ensure_consistent_norm(fft, 0);
+    oskar_Mem* image = oskar_mem_create(h->imager_prec, OSKAR_CPU, num_pix,
+            &status);
+    for (;;)
+    {
+        int i;
+        oskar_mutex_lock(h->mutex);
+        i = (*a->next_plane)++;
+        if (h->status) status = h->status;
+        oskar_mutex_unlock(h->mutex);
+        if (i >= h->num_planes || status) break;
+
+        /* Transform the plane and produce the trimmed image. */
+        oskar_Mem* plane = h->planes[i];
+        const double norm = h->plane_norm[i];
+        const double scale = (double) num_cells /
+                ((norm > 0.0 || norm < 0.0) ? norm : 1.0);
+        oskar_fft_exec(fft, plane, &status);
+        if (status) break;
+        if (h->imager_prec == OSKAR_DOUBLE)
+            finalise_crop_double(grid_size, h->image_size, scale,
+                    oskar_mem_double_const(h->corr_func, &status),
+                    oskar_mem_double_const(plane, &status),
+                    oskar_mem_double(image, &status));
+        else
+            finalise_crop_float(grid_size, h->image_size, (float) scale,
+                    oskar_mem_float_const(h->corr_func, &status),
+                    oskar_mem_float_const(plane, &status),
+                    oskar_mem_float(image, &status));
+        memcpy(oskar_mem_void(plane), oskar_mem_void_const(image),
+                image_bytes);
+
+        /* Write all finished planes to file, in order. */
+        oskar_mutex_lock(h->mutex);
+        a->plane_done[i] = 1;
+        while (*a->next_write < h->num_planes &&
+                a->plane_done[*a->next_write])
+        {
+            const int j = (*a->next_write)++;
+            oskar_timer_resume(h->tmr_write);
+            write_plane(h, h->planes[j], j / h->num_im_pols,
+                    j % h->num_im_pols, &h->status);
+            oskar_timer_pause(h->tmr_write);
+        }
+        oskar_mutex_unlock(h->mutex);
+    }
+    oskar_fft_free(fft);
+    oskar_mem_free(image, &status);
+    if (status)
+    {
+        oskar_mutex_lock(h->mutex);
+        if (!h->status) h->status = status;
+        oskar_mutex_unlock(h->mutex);
+    }
+    return 0;
+}
+
+
+static int use_fused_finalise(const oskar_Imager* h)
+{
+    /* Only for gridded planes in host memory, using the CPU FFT. */
+    return (h->algorithm == OSKAR_ALGORITHM_FFT ||
+            h->algorithm == OSKAR_ALGORITHM_WPROJ) &&
+            !(h->grid_on_gpu && h->num_gpus > 0) &&
+            !(h->fft_on_gpu && h->num_gpus > 0);
+}
+
+
+static void finalise_planes_fused(oskar_Imager* h, int* status)
+{
+    int i, next_plane = 0, next_write = 0, *plane_done = 0;
+    if (*status) return;
+    oskar_timer_resume(h->tmr_grid_finalise);
+    update_corr_func(h, oskar_imager_plane_size(h), status);
+
+    /* Use a thread per plane, up to the number of CPU cores.
+     * Each thread needs an FFT work array of twice the grid size, and an
+     * image buffer, so also limit the threads to those that fit in the
+     * free memory. */
+    const size_t grid_size = (size_t) oskar_imager_plane_size(h);
+    const size_t thread_bytes = oskar_mem_element_size(h->imager_prec) * (
+            2 * grid_size * grid_size +
+            (size_t) h->image_size * (size_t) h->image_size);
+    size_t mem_bytes = oskar_get_free_physical_memory();
+    if (mem_bytes == 0) mem_bytes = oskar_get_total_physical_memory();
+    int num_threads = oskar_get_num_procs();
+    if (num_threads > h->num_planes) num_threads = h->num_planes;
+    if (thread_bytes > 0 && (size_t) num_threads > mem_bytes / thread_bytes)
+        num_threads = (int) (mem_bytes / thread_bytes);
+    if (num_threads < 1) num_threads = 1;
+    oskar_Thread** threads = (oskar_Thread**)
+            calloc(num_threads, sizeof(oskar_Thread*));
+    FinaliseArgs* args = (FinaliseArgs*)
+            calloc(num_threads, sizeof(FinaliseArgs));
+    plane_done = (int*) calloc(h->num_planes, sizeof(int));
+    h->status = *status;
+    for (i = 0; i < num_threads; ++i)
+    {
+        args[i].h = h;
+        args[i].next_plane = &next_plane;
+        args[i].next_write = &next_write;
+        args[i].plane_done = plane_done;
+        threads[i] = oskar_thread_create(run_finalise, (void*)&args[i], 0);
+    }
+    for (i = 0; i < num_threads; ++i)
+    {
+        oskar_thread_join(threads[i]);
+        oskar_thread_free(threads[i]);
+    }
+    *status = h->status;
+    free(threads);
+    free(args);
+    free(plane_done);
+    oskar_timer_pause(h->tmr_grid_finalise);
+}
+
+
 void write_plane(oskar_Imager* h, oskar_Mem* plane,
         int c, int p, int* status)
 {
@@ -76,6 +76,7 @@ void oskar_imager_free(oskar_Imager* h, int* status)
     free(h->input_root);
     free(h->output_root);
     free(h->ms_column);
+    free(h->w_kernel_cache_dir);
     free(h->gpu_ids);
     free(h->d);
     free(h);
@@ -6,6 +6,7 @@
 #include "imager/private_imager.h"
 #include "imager/oskar_imager_reset_cache.h"
 #include "imager/private_imager_free_device_data.h"
+#include "imager/private_imager_w_kernel_cache.h"
 #include "log/oskar_log.h"
 #include "math/oskar_fft.h"
 #include <fitsio.h>
@@ -41,6 +42,19 @@ void oskar_imager_reset_cache(oskar_Imager* h, int* status)
     oskar_mem_free(h->w_support, status); h->w_support = 0;
     oskar_mem_free(h->w_kernels_compact, status); h->w_kernels_compact = 0;
     oskar_mem_free(h->w_kernel_start, status); h->w_kernel_start = 0;
+    oskar_imager_w_kernel_cache_release(h);
+
+    /* Free the W-stacking visibility buffers. */
+    if (h->ws)
+        for (i = 0; i < h->num_planes; ++i)
+        {
+            oskar_mem_free(h->ws[i].uu, status);
+            oskar_mem_free(h->ws[i].vv, status);
+            oskar_mem_free(h->ws[i].ww, status);
+            oskar_mem_free(h->ws[i].vis, status);
+        }
+    free(h->ws); h->ws = 0;
+    h->num_w_layers = 0;
 
     /* Free the image planes. */
     if (h->planes)
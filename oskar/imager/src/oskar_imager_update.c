@@ -15,6 +15,7 @@
 #include "imager/private_imager_update_plane_dft.h"
 #include "imager/private_imager_update_plane_fft.h"
 #include "imager/private_imager_update_plane_wproj.h"
+#include "imager/private_imager_update_plane_wstack.h"
 #include "imager/private_imager_weight_radial.h"
 #include "imager/private_imager_weight_uniform.h"
 #include "log/oskar_log.h"
@@ -549,6 +550,10 @@ void oskar_imager_update_plane(oskar_Imager* h, size_t num_vis,
             oskar_imager_update_plane_wproj(h, num_vis, pu, pv, pw, pa, ph,
                     i_plane, plane, plane_norm_ptr, &num_skipped, status);
             break;
+        case OSKAR_ALGORITHM_WSTACK:
+            oskar_imager_update_plane_wstack(h, num_vis, pu, pv, pw, pa, ph,
+                    i_plane, plane, plane_norm_ptr, &num_skipped, status);
+            break;
         default:
             *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
             break;
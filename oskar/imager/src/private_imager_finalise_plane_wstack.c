@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_finalise_plane_wstack.h"
+#include "imager/oskar_grid_functions_es.h"
+#include "math/oskar_fft.h"
+#include "math/oskar_fftphase.h"
+#include "utility/oskar_kernel_macros.h"
+#include "imager/define_grid_wstack.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+OSKAR_GRID_WSTACK_PREPARE(wstack_prepare_float, float)
+OSKAR_GRID_WSTACK_PREPARE(wstack_prepare_double, double)
+OSKAR_GRID_WSTACK_LAYER(wstack_layer_float, float)
+OSKAR_GRID_WSTACK_LAYER(wstack_layer_double, double)
+OSKAR_GRID_WSTACK_ADD_LAYER(wstack_add_layer_float, float)
+OSKAR_GRID_WSTACK_ADD_LAYER(wstack_add_layer_double, double)
+OSKAR_GRID_WSTACK_CORRECT(wstack_correct_float, float)
+OSKAR_GRID_WSTACK_CORRECT(wstack_correct_double, double)
+
+#define NUM_CORR_W 4097
+
+static void w_range(const oskar_Mem* ww, size_t num_vis,
+        double* w_min, double* w_max, int* status)
+{
+    size_t i;
+    double min_val = 0.0, max_val = 0.0;
+    if (oskar_mem_precision(ww) == OSKAR_DOUBLE)
+    {
+        const double* w = oskar_mem_double_const(ww, status);
+        min_val = max_val = w[0];
+        for (i = 1; i < num_vis; ++i)
+        {
+            if (w[i] < min_val) min_val = w[i];
+            if (w[i] > max_val) max_val = w[i];
+        }
+    }
+    else
+    {
+        const float* w = oskar_mem_float_const(ww, status);
+        min_val = max_val = w[0];
+        for (i = 1; i < num_vis; ++i)
+        {
+            if (w[i] < min_val) min_val = w[i];
+            if (w[i] > max_val) max_val = w[i];
+        }
+    }
+    *w_min = min_val;
+    *w_max = max_val;
+}
+
+void oskar_imager_finalise_plane_wstack(oskar_Imager* h, int i_plane,
+        oskar_Mem* plane, int* status)
+{
+    int i, k, *key = 0;
+    size_t j, *order = 0, *offsets = 0;
+    double w_min, w_max, *corr_uv = 0, *corr_w = 0;
+    oskar_Mem* grid = 0;
+    if (*status) return;
+    const int grid_size = oskar_imager_plane_size(h);
+    const size_t num_cells = (size_t) grid_size * (size_t) grid_size;
+    oskar_mem_ensure(plane, num_cells, status);
+    oskar_mem_clear_contents(plane, status);
+    if (*status || !h->ws || h->ws[i_plane].num_vis == 0) return;
+    const WStackData* d = &h->ws[i_plane];
+    const size_t num_vis = d->num_vis;
+    const int support = h->support;
+    const double beta = oskar_grid_function_es_beta(support, h->image_padding);
+    const double grid_scale = grid_size * h->cellsize_rad;
+
+    /* Find the range of (n - 1) over the image, and centre it on zero.
+     * The W-layer spacing is chosen to avoid aliasing in this range. */
+    const double l_max = (h->image_size / 2) * h->cellsize_rad;
+    const double r2_max = 2.0 * l_max * l_max;
+    const double nm1_min = (r2_max < 1.0) ? sqrt(1.0 - r2_max) - 1.0 : -1.0;
+    const double nm1_centre = 0.5 * nm1_min;
+    const double nm1_half_range = -nm1_centre;
+    w_range(d->ww, num_vis, &w_min, &w_max, status);
+    double inv_dw = 2.0 * h->image_padding * nm1_half_range;
+    if (inv_dw <= 0.0) inv_dw = 1.0;
+    const double dw = 1.0 / inv_dw;
+    const double w_start = w_min - support * dw;
+    const int num_layers = (int) ceil((w_max - w_min) * inv_dw) +
+            2 * support + 1;
+    const int band_size = 2 * support + 1;
+    const int num_bands = (grid_size + band_size - 1) / band_size;
+    const int num_keys = num_layers * num_bands;
+    if (num_layers > h->num_w_layers) h->num_w_layers = num_layers;
+
+    /* Rotate the visibilities and find their W-layers and grid bands. */
+    key = (int*) calloc(num_vis, sizeof(int));
+    order = (size_t*) calloc(num_vis, sizeof(size_t));
+    offsets = (size_t*) calloc(num_keys + 1, sizeof(size_t));
+    if (h->imager_prec == OSKAR_DOUBLE)
+        wstack_prepare_double(num_vis, oskar_mem_double_const(d->vv, status),
+                oskar_mem_double_const(d->ww, status),
+                oskar_mem_double(d->vis, status), support, grid_size,
+                grid_scale, w_start, inv_dw, nm1_centre, num_bands, key);
+    else
+        wstack_prepare_float(num_vis, oskar_mem_float_const(d->vv, status),
+                oskar_mem_float_const(d->ww, status),
+                oskar_mem_float(d->vis, status), support, grid_size,
+                grid_scale, w_start, inv_dw, nm1_centre, num_bands, key);
+
+    /* Sort visibilities by key (counting sort). */
+    for (j = 0; j < num_vis; ++j) offsets[key[j] + 1]++;
+    for (i = 0; i < num_keys; ++i) offsets[i + 1] += offsets[i];
+    for (j = 0; j < num_vis; ++j) order[offsets[key[j]]++] = j;
+    for (i = num_keys; i > 0; --i) offsets[i] = offsets[i - 1];
+    offsets[0] = 0;
+    free(key);
+
+    /* Grid, transform and accumulate each W-layer in turn. */
+    grid = oskar_mem_create(h->imager_prec | OSKAR_COMPLEX, OSKAR_CPU,
+            num_cells, status);
+    if (!h->fft)
+        h->fft = oskar_fft_create(h->imager_prec, OSKAR_CPU, 2, grid_size,
+                0, status);
+    for (k = 0; k < num_layers; ++k)
+    {
+        if (*status) break;
+        const double w_layer = w_start + k * dw;
+        oskar_mem_clear_contents(grid, status);
+        if (h->imager_prec == OSKAR_DOUBLE)
+            wstack_layer_double(k, num_layers, order, offsets,
+                    oskar_mem_double_const(d->uu, status),
+                    oskar_mem_double_const(d->vv, status),
+                    oskar_mem_double_const(d->ww, status),
+                    oskar_mem_double_const(d->vis, status), support, beta,
+                    grid_size, grid_scale, w_start, inv_dw, num_bands,
+                    oskar_mem_double(grid, status));
+        else
+            wstack_layer_float(k, num_layers, order, offsets,
+                    oskar_mem_float_const(d->uu, status),
+                    oskar_mem_float_const(d->vv, status),
+                    oskar_mem_float_const(d->ww, status),
+                    oskar_mem_float_const(d->vis, status), support,
+                    (float) beta, grid_size, grid_scale, w_start, inv_dw,
+                    num_bands, oskar_mem_float(grid, status));
+        oskar_fftphase(grid_size, grid_size, grid, status);
+        oskar_fft_exec(h->fft, grid, status);
+        oskar_fftphase(grid_size, grid_size, grid, status);
+        if (*status) break;
+        if (h->imager_prec == OSKAR_DOUBLE)
+            wstack_add_layer_double(grid_size, h->image_size,
+                    h->cellsize_rad, w_layer, nm1_centre,
+                    oskar_mem_double_const(grid, status),
+                    oskar_mem_double(plane, status));
+        else
+            wstack_add_layer_float(grid_size, h->image_size,
+                    h->cellsize_rad, w_layer, nm1_centre,
+                    oskar_mem_float_const(grid, status),
+                    oskar_mem_float(plane, status));
+    }
+    oskar_mem_free(grid, status);
+    free(order);
+    free(offsets);
+
+    /* Apply the grid correction in (u, v) and in w. */
+    corr_uv = (double*) calloc(grid_size, sizeof(double));
+    corr_w = (double*) calloc(NUM_CORR_W, sizeof(double));
+    oskar_grid_correction_function_es(grid_size, support, beta, corr_uv);
+    for (i = 0; i < NUM_CORR_W; ++i)
+        corr_w[i] = dw * nm1_half_range * i / (NUM_CORR_W - 1);
+    oskar_grid_function_es_fourier(support, beta, NUM_CORR_W, corr_w, corr_w);
+    for (i = 0; i < NUM_CORR_W; ++i)
+        corr_w[i] = (corr_w[i] != 0.0) ? 1.0 / corr_w[i] : 1.0;
+    const double corr_w_scale = (nm1_half_range > 0.0) ?
+            (NUM_CORR_W - 1) / nm1_half_range : 0.0;
+    if (h->imager_prec == OSKAR_DOUBLE)
+        wstack_correct_double(grid_size, h->image_size, h->cellsize_rad,
+                nm1_centre, corr_uv, NUM_CORR_W, corr_w_scale, corr_w,
+                oskar_mem_double(plane, status));
+    else
+        wstack_correct_float(grid_size, h->image_size, h->cellsize_rad,
+                nm1_centre, corr_uv, NUM_CORR_W, corr_w_scale, corr_w,
+                oskar_mem_float(plane, status));
+    free(corr_uv);
+    free(corr_w);
+}
+
+#ifdef __cplusplus
+}
+#endif
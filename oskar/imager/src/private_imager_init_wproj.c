@@ -32,6 +32,7 @@
 #include "imager/private_imager_composite_nearest_even.h"
 #include "imager/private_imager_generate_w_phase_screen.h"
 #include "imager/private_imager_init_wproj.h"
+#include "imager/private_imager_w_kernel_cache.h"
 #include "imager/oskar_grid_functions_spheroidal.h"
 #include "math/oskar_cmath.h"
 #include "math/oskar_fft.h"
@@ -54,8 +55,14 @@ extern "C" {
 static void oskar_imager_evaluate_w_kernel_params(const oskar_Imager* h,
         int* num_w_planes, double* w_scale);
 
+static int oskar_imager_evaluate_w_kernel_conv_size(const oskar_Imager* h,
+        int num_w_planes);
+
+static void oskar_imager_generate_w_kernels(oskar_Imager* h, int conv_size,
+        int* status);
+
 static oskar_Mem* oskar_imager_evaluate_w_kernel_cube(oskar_Imager* h,
-        int num_w_planes, double w_scale,
+        int num_w_planes, double w_scale, int conv_size,
         size_t* conv_size_half, double* norm_factor, int* status);
 
 static oskar_Mem* oskar_imager_evaluate_w_kernel_support_sizes(
@@ -81,55 +88,27 @@ static void oskar_imager_rearrange_kernels(int num_w_planes,
  */
 void oskar_imager_init_wproj(oskar_Imager* h, int* status)
 {
-    size_t conv_size_half = 0;
-    double norm_factor = 1.;
-    oskar_Mem *kernel_cube = 0;
-    const int save_kernels = 0;
     if (*status) return;
 
     /* Evaluate number of w-projection planes, and w-scale. */
     oskar_imager_evaluate_w_kernel_params(h, &h->num_w_planes, &h->w_scale);
+    const int conv_size = oskar_imager_evaluate_w_kernel_conv_size(h,
+            h->num_w_planes);
 
-    /* Evaluate unnormalised kernels. */
-    kernel_cube = oskar_imager_evaluate_w_kernel_cube(h, h->num_w_planes,
-            h->w_scale, &conv_size_half, &norm_factor, status);
-
-    /* Evaluate the support size of each kernel. */
-    oskar_mem_free(h->w_support, status);
-    h->w_support = oskar_imager_evaluate_w_kernel_support_sizes(
-            h->num_w_planes, h->oversample, conv_size_half,
-            kernel_cube, norm_factor, status);
+    /* Release any kernels from a previous run. */
+    oskar_mem_free(h->w_kernels_compact, status);
+    h->w_kernels_compact = 0;
+    oskar_imager_w_kernel_cache_release(h);
 
-#if 0
-    /* Print kernel support sizes. */
+    /* Use cached kernels if they exist for these parameters,
+     * otherwise generate them and save them to the cache. */
+    if (oskar_imager_w_kernel_cache_load(h, conv_size, status))
+        oskar_log_message(h->log, 'M', 0, "Loaded W-kernels from cache.");
+    else
     {
-        int i;
-        for (i = 0; i < h->num_w_planes; ++i)
-        {
-            const int* supp = oskar_mem_int_const(h->w_support, status);
-            printf("Plane %d, support: %d\n", i, supp[i]);
-        }
+        oskar_imager_generate_w_kernels(h, conv_size, status);
+        oskar_imager_w_kernel_cache_save(h, conv_size, status);
     }
-#endif
-
-    /* Normalise the kernel cube. */
-    oskar_imager_normalise_kernel_cube(h->w_support, h->oversample,
-            conv_size_half, kernel_cube, status);
-    if (save_kernels)
-        oskar_imager_trim_and_save_kernel_cube(h, h->num_w_planes,
-                h->w_support, &conv_size_half, kernel_cube, status);
-
-    /* Rearrange and compact the kernels. */
-    oskar_mem_free(h->w_kernels_compact, status);
-    oskar_mem_free(h->w_kernel_start, status);
-    h->w_kernel_start = oskar_mem_create(OSKAR_INT, OSKAR_CPU,
-            h->num_w_planes, status);
-    h->w_kernels_compact = oskar_mem_create(h->imager_prec| OSKAR_COMPLEX,
-            OSKAR_CPU, 0, status);
-    oskar_imager_rearrange_kernels(h->num_w_planes, h->w_support,
-            h->oversample, conv_size_half, kernel_cube, h->w_kernels_compact,
-            oskar_mem_int(h->w_kernel_start, status), status);
-    oskar_mem_free(kernel_cube, status);
 
     /* Record data about the kernels. */
     oskar_log_message(h->log, 'M', 0, "Baseline W values (wavelengths)");
@@ -172,10 +151,63 @@ void oskar_imager_init_wproj(oskar_Imager* h, int* status)
         /* No longer need kernels in host memory. */
         oskar_mem_free(h->w_kernels_compact, status);
         h->w_kernels_compact = 0;
+        oskar_imager_w_kernel_cache_release(h);
     }
 }
 
 
+static void oskar_imager_generate_w_kernels(oskar_Imager* h, int conv_size,
+        int* status)
+{
+    size_t conv_size_half = 0;
+    double norm_factor = 1.;
+    oskar_Mem *kernel_cube = 0;
+    const int save_kernels = 0;
+    if (*status) return;
+
+    /* Evaluate unnormalised kernels. */
+    kernel_cube = oskar_imager_evaluate_w_kernel_cube(h, h->num_w_planes,
+            h->w_scale, conv_size, &conv_size_half, &norm_factor, status);
+
+    /* Evaluate the support size of each kernel. */
+    oskar_mem_free(h->w_support, status);
+    h->w_support = oskar_imager_evaluate_w_kernel_support_sizes(
+            h->num_w_planes, h->oversample, conv_size_half,
+            kernel_cube, norm_factor, status);
+
+#if 0
+    /* Print kernel support sizes. */
+    {
+        int i;
+        for (i = 0; i < h->num_w_planes; ++i)
+        {
+            const int* supp = oskar_mem_int_const(h->w_support, status);
+            printf("Plane %d, support: %d\n", i, supp[i]);
+        }
+    }
+#endif
+
+    /* Normalise the kernel cube. */
+    oskar_imager_normalise_kernel_cube(h->w_support, h->oversample,
+            conv_size_half, kernel_cube, status);
+    if (save_kernels)
+        oskar_imager_trim_and_save_kernel_cube(h, h->num_w_planes,
+                h->w_support, &conv_size_half, kernel_cube, status);
+
+    /* Rearrange and compact the kernels. */
+    oskar_mem_free(h->w_kernels_compact, status);
+    oskar_mem_free(h->w_kernel_start, status);
+    h->w_kernel_start = oskar_mem_create(OSKAR_INT, OSKAR_CPU,
+            h->num_w_planes, status);
+    h->w_kernels_compact = oskar_mem_create(h->imager_prec| OSKAR_COMPLEX,
+            OSKAR_CPU, 0, status);
+    oskar_imager_rearrange_kernels(h->num_w_planes, h->w_support,
+            h->oversample, conv_size_half, kernel_cube, h->w_kernels_compact,
+            oskar_mem_int(h->w_kernel_start, status), status);
+    oskar_mem_free(kernel_cube, status);
+}
+
+
 static void oskar_imager_evaluate_w_kernel_params(const oskar_Imager* h,
         int* num_w_planes, double* w_scale)
 {
@@ -199,11 +231,24 @@ static void oskar_imager_evaluate_w_kernel_params(const oskar_Imager* h,
 }
 
 
+static int oskar_imager_evaluate_w_kernel_conv_size(const oskar_Imager* h,
+        int num_w_planes)
+{
+    size_t max_mem_bytes;
+    const size_t max_bytes_per_plane = 64 * 1024 * 1024; /* 64 MB/plane */
+    max_mem_bytes = oskar_get_total_physical_memory();
+    max_mem_bytes = MIN(max_mem_bytes, max_bytes_per_plane * num_w_planes);
+    const double max_conv_size = sqrt(max_mem_bytes / (16. * num_w_planes));
+    const int nearest = oskar_imager_composite_nearest_even(
+            2 * (int)(max_conv_size / 2.0), 0, 0);
+    return MIN((int)(h->image_size * h->image_padding), nearest);
+}
+
+
 static oskar_Mem* oskar_imager_evaluate_w_kernel_cube(oskar_Imager* h,
-        int num_w_planes, double w_scale,
+        int num_w_planes, double w_scale, int conv_size,
         size_t* conv_size_half, double* norm_factor, int* status)
 {
-    size_t max_mem_bytes;
     oskar_FFT* fft = 0;
     oskar_Mem *screen = 0, *screen_gpu = 0, *screen_ptr = 0;
     oskar_Mem *taper = 0, *taper_gpu = 0, *taper_ptr = 0;
@@ -213,14 +258,7 @@ static oskar_Mem* oskar_imager_evaluate_w_kernel_cube(oskar_Imager* h,
     int i;
     if (*status) return 0;
 
-    /* Calculate convolution kernel size. */
-    const size_t max_bytes_per_plane = 64 * 1024 * 1024; /* 64 MB/plane */
-    max_mem_bytes = oskar_get_total_physical_memory();
-    max_mem_bytes = MIN(max_mem_bytes, max_bytes_per_plane * num_w_planes);
-    const double max_conv_size = sqrt(max_mem_bytes / (16. * num_w_planes));
-    const int nearest = oskar_imager_composite_nearest_even(
-            2 * (int)(max_conv_size / 2.0), 0, 0);
-    const int conv_size = MIN((int)(h->image_size * h->image_padding),nearest);
+    /* Get the size of the first quarter of each kernel. */
     *conv_size_half = conv_size / 2 - 1;
     const size_t kernel_plane_size = (*conv_size_half) * (*conv_size_half);
 
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/define_grid_wstack.h"
+#include "imager/private_imager_init_wstack.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_imager_init_wstack(oskar_Imager* h, int* status)
+{
+    if (*status) return;
+
+    /* The W-stacking imager is only implemented for the CPU. */
+    if (h->grid_on_gpu || h->fft_on_gpu)
+    {
+        oskar_log_warning(h->log,
+                "W-stacking uses the CPU for gridding and FFTs.");
+        h->grid_on_gpu = 0;
+        h->fft_on_gpu = 0;
+    }
+
+    /* Check the kernel parameters. */
+    if (h->kernel_type != 'E')
+    {
+        *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+        return;
+    }
+    if (h->support < 1) h->support = 1;
+    if (h->support > WSTACK_MAX_SUPPORT) h->support = WSTACK_MAX_SUPPORT;
+    oskar_log_message(h->log, 'M', 0, "Using exponential of semicircle "
+            "kernel with support %d.", h->support);
+    oskar_log_message(h->log, 'M', 0, "Visibilities are held in memory "
+            "until finalised (%d bytes each).",
+            5 * (h->imager_prec == OSKAR_DOUBLE ? 8 : 4));
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -31,8 +31,10 @@
 #include "imager/private_imager.h"
 #include "imager/private_imager_update_plane_dft.h"
 #include "imager/oskar_imager.h"
+#include "convert/oskar_convert_fov_to_cellsize.h"
 #include "math/oskar_cmath.h"
 #include "math/oskar_dft_c2r.h"
+#include "math/oskar_sincos.h"
 #include "utility/oskar_device.h"
 #include "utility/oskar_thread.h"
 
@@ -44,7 +46,24 @@
 extern "C" {
 #endif
 
+/* Number of pixels along a row between exactly evaluated phase factors,
+ * and number of independent phase recurrences within each segment. */
+#define SEG_LEN 64
+#define NUM_LANES 8
+
 static void* run_blocks(void* arg);
+static void dft_2d_prepare_d(int num_vis, const double* uu, const double* vv,
+        const double2* amp, const double* weight, double delta,
+        double* scratch);
+static void dft_2d_prepare_f(int num_vis, const float* uu, const float* vv,
+        const float2* amp, const float* weight, float delta,
+        float* scratch);
+static void dft_2d_recurrence_d(int num_vis, const double* scratch,
+        int image_size, double delta, size_t block_start, size_t block_size,
+        const double* grid_l, double* out);
+static void dft_2d_recurrence_f(int num_vis, const float* scratch,
+        int image_size, double delta, size_t block_start, size_t block_size,
+        const float* grid_l, float* out);
 
 struct ThreadArgs
 {
@@ -141,6 +160,7 @@ static void* run_blocks(void* arg)
 {
     oskar_Imager* h;
     oskar_Mem *plane, *uu, *vv, *ww = 0, *amp, *weight, *block, *l, *m, *n;
+    oskar_Mem *scratch = 0;
     size_t max_size;
     const size_t smallest = 1024, largest = 65536;
     int dev_loc = OSKAR_CPU, *status;
@@ -167,6 +187,33 @@ static void* run_blocks(void* arg)
     if (h->algorithm == OSKAR_ALGORITHM_DFT_3D)
         ww = oskar_mem_create_copy(((ThreadArgs*)arg)->ww, dev_loc, status);
 
+    /* On the CPU, a 2D DFT to the regular pixel grid can use phase
+     * recurrences along each row: precompute the per-visibility terms. */
+    const double delta = sin(oskar_convert_fov_to_cellsize(
+            h->fov_deg * M_PI / 180.0, h->image_size));
+    const int use_recurrence = (dev_loc == OSKAR_CPU &&
+            h->algorithm == OSKAR_ALGORITHM_DFT_2D);
+    if (use_recurrence)
+    {
+        scratch = oskar_mem_create(h->imager_prec, OSKAR_CPU,
+                8 * (size_t) num_vis, status);
+        if (!*status)
+        {
+            if (h->imager_prec == OSKAR_DOUBLE)
+                dft_2d_prepare_d(num_vis, oskar_mem_double_const(uu, status),
+                        oskar_mem_double_const(vv, status),
+                        oskar_mem_double2_const(amp, status),
+                        oskar_mem_double_const(weight, status), delta,
+                        oskar_mem_double(scratch, status));
+            else
+                dft_2d_prepare_f(num_vis, oskar_mem_float_const(uu, status),
+                        oskar_mem_float_const(vv, status),
+                        oskar_mem_float2_const(amp, status),
+                        oskar_mem_float_const(weight, status), (float) delta,
+                        oskar_mem_float(scratch, status));
+        }
+    }
+
 #ifdef _OPENMP
     /* Disable nested parallelism. */
     omp_set_nested(0);
@@ -203,6 +250,28 @@ static void* run_blocks(void* arg)
         block_size = num_pixels - block_start;
         if (block_size > max_size) block_size = max_size;
 
+        /* Use phase recurrences for the block, if possible. */
+        if (use_recurrence)
+        {
+            oskar_mem_ensure(block, block_size, status);
+            if (*status) break;
+            if (h->imager_prec == OSKAR_DOUBLE)
+                dft_2d_recurrence_d(num_vis,
+                        oskar_mem_double_const(scratch, status),
+                        h->image_size, delta, block_start, block_size,
+                        oskar_mem_double_const(h->l, status),
+                        oskar_mem_double(block, status));
+            else
+                dft_2d_recurrence_f(num_vis,
+                        oskar_mem_float_const(scratch, status),
+                        h->image_size, delta, block_start, block_size,
+                        oskar_mem_float_const(h->l, status),
+                        oskar_mem_float(block, status));
+            oskar_mem_add(plane, plane, block,
+                    block_start, block_start, 0, block_size, status);
+            continue;
+        }
+
         /* Copy the (l,m,n) positions for the block. */
         oskar_mem_copy_contents(l, h->l, 0, block_start, block_size, status);
         oskar_mem_copy_contents(m, h->m, 0, block_start, block_size, status);
@@ -229,9 +298,160 @@ static void* run_blocks(void* arg)
     oskar_mem_free(l, status);
     oskar_mem_free(m, status);
     oskar_mem_free(n, status);
+    oskar_mem_free(scratch, status);
     return 0;
 }
 
+/*
+ * Stores, for each visibility, the weighted visibility amplitude, the
+ * phase gradients in l and m, and the phase factors for one and
+ * NUM_LANES pixel steps along a row (where l decreases by delta per pixel).
+ */
+static void dft_2d_prepare_d(int num_vis, const double* uu, const double* vv,
+        const double2* amp, const double* weight, double delta,
+        double* scratch)
+{
+    int k;
+    for (k = 0; k < num_vis; ++k)
+    {
+        double* t = &scratch[8 * k];
+        const double ku = 2.0 * M_PI * uu[k];
+        t[0] = amp[k].x * weight[k];
+        t[1] = amp[k].y * weight[k];
+        t[2] = ku;
+        t[3] = 2.0 * M_PI * vv[k];
+        oskar_sincos_d(ku * delta, &t[5], &t[4]);
+        oskar_sincos_d(ku * delta * NUM_LANES, &t[7], &t[6]);
+    }
+}
+
+static void dft_2d_prepare_f(int num_vis, const float* uu, const float* vv,
+        const float2* amp, const float* weight, float delta,
+        float* scratch)
+{
+    int k;
+    for (k = 0; k < num_vis; ++k)
+    {
+        float* t = &scratch[8 * k];
+        const float ku = 2.0f * (float) M_PI * uu[k];
+        t[0] = amp[k].x * weight[k];
+        t[1] = amp[k].y * weight[k];
+        t[2] = ku;
+        t[3] = 2.0f * (float) M_PI * vv[k];
+        oskar_sincos_f(ku * delta, &t[5], &t[4]);
+        oskar_sincos_f(ku * delta * NUM_LANES, &t[7], &t[6]);
+    }
+}
+
+/*
+ * Evaluates the real part of the 2D DFT for a block of pixels on the
+ * regular (l,m) grid used by the DFT imager.
+ *
+ * Along each row, the phase factor for each visibility is evaluated exactly
+ * at the start of each segment of SEG_LEN pixels, and is then advanced by
+ * complex multiplication. NUM_LANES independent recurrences are used, so
+ * that the inner loop can be vectorised, and so that each recurrence
+ * takes at most SEG_LEN / NUM_LANES steps before it is re-seeded.
+ * Pixels outside the sky (with NaN coordinates) are set to NaN.
+ */
+static void dft_2d_recurrence_d(int num_vis, const double* scratch,
+        int image_size, double delta, size_t block_start, size_t block_size,
+        const double* grid_l, double* out)
+{
+    size_t p = block_start;
+    const size_t block_end = block_start + block_size;
+    while (p < block_end)
+    {
+        int b, k, q;
+        double acc[SEG_LEN];
+        const int row = (int) (p / image_size), i0 = (int) (p % image_size);
+        int len = image_size - i0;
+        if (len > SEG_LEN) len = SEG_LEN;
+        if ((size_t) len > block_end - p) len = (int) (block_end - p);
+        const double l0 = ((image_size / 2) - i0) * delta;
+        const double m0 = (-(image_size / 2) + row) * delta;
+        for (q = 0; q < SEG_LEN; ++q) acc[q] = 0.0;
+        for (k = 0; k < num_vis; ++k)
+        {
+            double re, im, zr[NUM_LANES], zi[NUM_LANES];
+            const double* t = &scratch[8 * k];
+            oskar_sincos_d(-(t[2] * l0 + t[3] * m0), &im, &re);
+            zr[0] = t[0] * re - t[1] * im;
+            zi[0] = t[0] * im + t[1] * re;
+            for (q = 1; q < NUM_LANES; ++q)
+            {
+                zr[q] = zr[q - 1] * t[4] - zi[q - 1] * t[5];
+                zi[q] = zr[q - 1] * t[5] + zi[q - 1] * t[4];
+            }
+            for (b = 0; b < len; b += NUM_LANES)
+            {
+                for (q = 0; q < NUM_LANES; ++q)
+                {
+                    const double r = zr[q];
+                    acc[b + q] += r;
+                    zr[q] = r * t[6] - zi[q] * t[7];
+                    zi[q] = r * t[7] + zi[q] * t[6];
+                }
+            }
+        }
+        for (q = 0; q < len; ++q)
+        {
+            const double l = grid_l[p + q];
+            out[p - block_start + q] = (l != l) ? l : acc[q];
+        }
+        p += len;
+    }
+}
+
+static void dft_2d_recurrence_f(int num_vis, const float* scratch,
+        int image_size, double delta, size_t block_start, size_t block_size,
+        const float* grid_l, float* out)
+{
+    size_t p = block_start;
+    const size_t block_end = block_start + block_size;
+    while (p < block_end)
+    {
+        int b, k, q;
+        float acc[SEG_LEN];
+        const int row = (int) (p / image_size), i0 = (int) (p % image_size);
+        int len = image_size - i0;
+        if (len > SEG_LEN) len = SEG_LEN;
+        if ((size_t) len > block_end - p) len = (int) (block_end - p);
+        const float l0 = (float) (((image_size / 2) - i0) * delta);
+        const float m0 = (float) ((-(image_size / 2) + row) * delta);
+        for (q = 0; q < SEG_LEN; ++q) acc[q] = 0.0f;
+        for (k = 0; k < num_vis; ++k)
+        {
+            float re, im, zr[NUM_LANES], zi[NUM_LANES];
+            const float* t = &scratch[8 * k];
+            oskar_sincos_f(-(t[2] * l0 + t[3] * m0), &im, &re);
+            zr[0] = t[0] * re - t[1] * im;
+            zi[0] = t[0] * im + t[1] * re;
+            for (q = 1; q < NUM_LANES; ++q)
+            {
+                zr[q] = zr[q - 1] * t[4] - zi[q - 1] * t[5];
+                zi[q] = zr[q - 1] * t[5] + zi[q - 1] * t[4];
+            }
+            for (b = 0; b < len; b += NUM_LANES)
+            {
+                for (q = 0; q < NUM_LANES; ++q)
+                {
+                    const float r = zr[q];
+                    acc[b + q] += r;
+                    zr[q] = r * t[6] - zi[q] * t[7];
+                    zi[q] = r * t[7] + zi[q] * t[6];
+                }
+            }
+        }
+        for (q = 0; q < len; ++q)
+        {
+            const float l = grid_l[p + q];
+            out[p - block_start + q] = (l != l) ? l : acc[q];
+        }
+        p += len;
+    }
+}
+
 #ifdef __cplusplus
 }
 #endif
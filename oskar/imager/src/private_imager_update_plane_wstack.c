@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_update_plane_wstack.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define APPEND_VIS(FP) {\
+    const FP *u_in = (const FP*) oskar_mem_void_const(uu);\
+    const FP *v_in = (const FP*) oskar_mem_void_const(vv);\
+    const FP *w_in = (const FP*) oskar_mem_void_const(ww);\
+    const FP *a_in = (const FP*) oskar_mem_void_const(amps);\
+    const FP *wt_in = (const FP*) oskar_mem_void_const(weight);\
+    FP *u_out = (FP*) oskar_mem_void(d->uu);\
+    FP *v_out = (FP*) oskar_mem_void(d->vv);\
+    FP *w_out = (FP*) oskar_mem_void(d->ww);\
+    FP *a_out = (FP*) oskar_mem_void(d->vis);\
+    for (i = 0; i < num_vis; ++i) {\
+        const FP pos_u = (FP) (-u_in[i] * grid_scale);\
+        const FP pos_v = (FP) (v_in[i] * grid_scale);\
+        const int grid_u = (int) round(pos_u) + grid_centre;\
+        const int grid_v = (int) round(pos_v) + grid_centre;\
+        if (grid_u + support >= grid_size || grid_u - support < 0 ||\
+                grid_v + support >= grid_size || grid_v - support < 0) {\
+            (*num_skipped)++;\
+            continue;\
+        }\
+        const FP wt = wt_in[i];\
+        u_out[n] = u_in[i];\
+        v_out[n] = v_in[i];\
+        w_out[n] = w_in[i];\
+        a_out[2 * n]     = a_in[2 * i] * wt;\
+        a_out[2 * n + 1] = a_in[2 * i + 1] * wt;\
+        norm += wt;\
+        ++n;\
+    }\
+    }\
+
+void oskar_imager_update_plane_wstack(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* amps, const oskar_Mem* weight, int i_plane,
+        oskar_Mem* plane, double* plane_norm, size_t* num_skipped, int* status)
+{
+    int i_ws;
+    size_t i, n;
+    double norm = 0.0;
+    if (*status) return;
+
+    /* Visibilities are gridded only when the plane is finalised, once their
+     * W-range is known, so they can't be accumulated into a caller-supplied
+     * plane. Memory use is therefore proportional to the total number of
+     * visibilities: each buffered one needs three coordinates and a complex
+     * amplitude, or 40 bytes in double precision. */
+    if (plane)
+    {
+        *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+        return;
+    }
+    if (oskar_mem_precision(amps) != h->imager_prec)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+
+    /* Create the visibility buffers if required. */
+    if (!h->ws)
+    {
+        h->ws = (WStackData*) calloc(h->num_planes, sizeof(WStackData));
+        for (i_ws = 0; i_ws < h->num_planes; ++i_ws)
+        {
+            WStackData* d = &h->ws[i_ws];
+            d->uu = oskar_mem_create(h->imager_prec, OSKAR_CPU, 0, status);
+            d->vv = oskar_mem_create(h->imager_prec, OSKAR_CPU, 0, status);
+            d->ww = oskar_mem_create(h->imager_prec, OSKAR_CPU, 0, status);
+            d->vis = oskar_mem_create(h->imager_prec | OSKAR_COMPLEX,
+                    OSKAR_CPU, 0, status);
+        }
+    }
+    if (i_plane < 0 || i_plane >= h->num_planes)
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return;
+    }
+
+    /* Grow the buffers geometrically, to avoid copying on every block. */
+    WStackData* d = &h->ws[i_plane];
+    const size_t required = d->num_vis + num_vis;
+    if (oskar_mem_length(d->uu) < required)
+    {
+        size_t capacity = 3 * oskar_mem_length(d->uu) / 2;
+        if (capacity < required) capacity = required;
+        oskar_mem_realloc(d->uu, capacity, status);
+        oskar_mem_realloc(d->vv, capacity, status);
+        oskar_mem_realloc(d->ww, capacity, status);
+        oskar_mem_realloc(d->vis, capacity, status);
+        if (*status) return;
+    }
+
+    /* Append visibilities that fall on the grid, applying the weights. */
+    const int support = h->support;
+    const int grid_size = oskar_imager_plane_size(h);
+    const int grid_centre = grid_size / 2;
+    const double grid_scale = grid_size * h->cellsize_rad;
+    n = d->num_vis;
+    if (h->imager_prec == OSKAR_DOUBLE)
+        APPEND_VIS(double)
+    else
+        APPEND_VIS(float)
+    d->num_vis = n;
+    if (plane_norm) *plane_norm += norm;
+}
+
+#ifdef __cplusplus
+}
+#endif
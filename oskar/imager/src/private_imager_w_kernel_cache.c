@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_w_kernel_cache.h"
+#include "utility/oskar_dir.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef OSKAR_OS_WIN
+#include <process.h>
+#define getpid _getpid
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CACHE_MAGIC "OSKARWK1"
+
+/*
+ * File header. Everything except num_kernels forms the cache key,
+ * and must match exactly for a cached file to be used.
+ * The header size is a multiple of 16 bytes, so the kernel data
+ * which follows it is suitably aligned.
+ */
+struct CacheHeader
+{
+    char magic[8];
+    int ints[8];
+    double dbls[4];
+    unsigned long long num_kernels;
+};
+typedef struct CacheHeader CacheHeader;
+
+static void make_header(const oskar_Imager* h, int conv_size,
+        CacheHeader* hdr)
+{
+    memset(hdr, 0, sizeof(CacheHeader));
+    memcpy(hdr->magic, CACHE_MAGIC, sizeof(hdr->magic));
+    hdr->ints[0] = h->imager_prec;
+    hdr->ints[1] = h->num_w_planes;
+    hdr->ints[2] = h->oversample;
+    hdr->ints[3] = conv_size;
+    hdr->ints[4] = h->image_size;
+    hdr->ints[5] = h->grid_size;
+    hdr->ints[6] = (int) sizeof(CacheHeader);
+    hdr->dbls[0] = h->w_scale;
+    hdr->dbls[1] = h->fov_deg;
+    hdr->dbls[2] = h->image_padding;
+    hdr->dbls[3] = h->cellsize_rad;
+}
+
+/* Returns the file name for the header, using a 64-bit FNV-1a hash. */
+static char* cache_path(const oskar_Imager* h, const CacheHeader* hdr)
+{
+    size_t i;
+    char name[64];
+    unsigned long long hash = 14695981039346656037ULL;
+    const unsigned char* p = (const unsigned char*) hdr;
+    for (i = 0; i < offsetof(CacheHeader, num_kernels); ++i)
+    {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    sprintf(name, "oskar_w_kernels_%016llx.bin", hash);
+    return oskar_dir_get_path(h->w_kernel_cache_dir, name);
+}
+
+/* Releases the file data returned by the loader. */
+static void release_data(char* data, size_t file_size)
+{
+#ifdef OSKAR_OS_WIN
+    (void) file_size;
+    free(data);
+#else
+    munmap(data, file_size);
+#endif
+}
+
+/* Returns the byte offset of the kernels, after the support arrays. */
+static size_t kernel_offset(int num_w_planes)
+{
+    const size_t len = sizeof(CacheHeader) + 2 * sizeof(int) * num_w_planes;
+    return (len + 15) & ~((size_t) 15);
+}
+
+int oskar_imager_w_kernel_cache_load(oskar_Imager* h, int conv_size,
+        int* status)
+{
+    CacheHeader hdr;
+    char* data = 0;
+    size_t file_size = 0;
+    if (*status || !h->w_kernel_cache_dir) return 0;
+    make_header(h, conv_size, &hdr);
+    char* path = cache_path(h, &hdr);
+    const size_t key_size = offsetof(CacheHeader, num_kernels);
+    const size_t offset = kernel_offset(h->num_w_planes);
+    const size_t element_size = 2 * oskar_mem_element_size(h->imager_prec);
+#ifdef OSKAR_OS_WIN
+    /* No memory mapping: read the whole file. */
+    FILE* file = fopen(path, "rb");
+    free(path);
+    if (!file) return 0;
+    fseek(file, 0, SEEK_END);
+    file_size = (size_t) ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (file_size > offset)
+    {
+        data = (char*) malloc(file_size);
+        if (fread(data, 1, file_size, file) != file_size)
+        {
+            free(data);
+            data = 0;
+        }
+    }
+    fclose(file);
+#else
+    struct stat st;
+    const int fd = open(path, O_RDONLY);
+    free(path);
+    if (fd < 0) return 0;
+    if (fstat(fd, &st) == 0 && (size_t) st.st_size > offset)
+    {
+        file_size = (size_t) st.st_size;
+        data = (char*) mmap(0, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == (char*) MAP_FAILED) data = 0;
+    }
+    close(fd);
+#endif
+    if (!data) return 0;
+
+    /* Check the key and the size of the file. */
+    const CacheHeader* file_hdr = (const CacheHeader*) data;
+    const size_t num_kernels = (size_t) file_hdr->num_kernels;
+    if (memcmp(file_hdr, &hdr, key_size) ||
+            file_size != offset + num_kernels * element_size)
+    {
+        release_data(data, file_size);
+        return 0;
+    }
+
+    /* Copy the support sizes, and use the kernels in place. */
+    const size_t support_bytes = sizeof(int) * h->num_w_planes;
+    const char* support = data + sizeof(CacheHeader);
+    oskar_mem_free(h->w_support, status);
+    oskar_mem_free(h->w_kernel_start, status);
+    oskar_mem_free(h->w_kernels_compact, status);
+    h->w_support = oskar_mem_create(OSKAR_INT, OSKAR_CPU,
+            h->num_w_planes, status);
+    h->w_kernel_start = oskar_mem_create(OSKAR_INT, OSKAR_CPU,
+            h->num_w_planes, status);
+    if (*status)
+    {
+        release_data(data, file_size);
+        return 0;
+    }
+    memcpy(oskar_mem_void(h->w_support), support, support_bytes);
+    memcpy(oskar_mem_void(h->w_kernel_start), support + support_bytes,
+            support_bytes);
+    h->w_kernels_compact = oskar_mem_create_alias_from_raw(data + offset,
+            h->imager_prec | OSKAR_COMPLEX, OSKAR_CPU, num_kernels, status);
+    h->w_kernel_map = data;
+    h->w_kernel_map_size = file_size;
+    return 1;
+}
+
+void oskar_imager_w_kernel_cache_save(oskar_Imager* h, int conv_size,
+        int* status)
+{
+    CacheHeader hdr;
+    char* tmp_path;
+    FILE* file;
+    size_t len;
+    int ok = 1;
+    const char zeros[16] = {0};
+    if (*status || !h->w_kernel_cache_dir) return;
+    if (!oskar_dir_exists(h->w_kernel_cache_dir) &&
+            !oskar_dir_mkpath(h->w_kernel_cache_dir))
+    {
+        oskar_log_warning(h->log, "Unable to create W-kernel cache "
+                "directory '%s'.", h->w_kernel_cache_dir);
+        return;
+    }
+    make_header(h, conv_size, &hdr);
+    hdr.num_kernels = (unsigned long long)
+            oskar_mem_length(h->w_kernels_compact);
+    char* path = cache_path(h, &hdr);
+
+    /* Write to a temporary file first, then rename it, so that
+     * concurrent runs never see a partly written file. */
+    len = strlen(path) + 32;
+    tmp_path = (char*) calloc(len, 1);
+    sprintf(tmp_path, "%s.%d.tmp", path, (int) getpid());
+    file = fopen(tmp_path, "wb");
+    if (file)
+    {
+        const size_t support_bytes = sizeof(int) * h->num_w_planes;
+        const size_t offset = kernel_offset(h->num_w_planes);
+        const size_t kernel_bytes = oskar_mem_length(h->w_kernels_compact) *
+                oskar_mem_element_size(h->imager_prec | OSKAR_COMPLEX);
+        const size_t pad = offset - sizeof(CacheHeader) - 2 * support_bytes;
+        ok &= (fwrite(&hdr, sizeof(CacheHeader), 1, file) == 1);
+        ok &= (fwrite(oskar_mem_void_const(h->w_support),
+                1, support_bytes, file) == support_bytes);
+        ok &= (fwrite(oskar_mem_void_const(h->w_kernel_start),
+                1, support_bytes, file) == support_bytes);
+        ok &= (fwrite(zeros, 1, pad, file) == pad);
+        ok &= (fwrite(oskar_mem_void_const(h->w_kernels_compact),
+                1, kernel_bytes, file) == kernel_bytes);
+        ok &= (fclose(file) == 0);
+        if (ok) ok = (rename(tmp_path, path) == 0);
+        if (!ok) remove(tmp_path);
+    }
+    else ok = 0;
+    if (ok)
+        oskar_log_message(h->log, 'M', 0, "Saved W-kernels to '%s'.", path);
+    else
+        oskar_log_warning(h->log, "Unable to save W-kernels to '%s'.", path);
+    free(tmp_path);
+    free(path);
+}
+
+void oskar_imager_w_kernel_cache_release(oskar_Imager* h)
+{
+    if (!h->w_kernel_map) return;
+    release_data((char*) h->w_kernel_map, h->w_kernel_map_size);
+    h->w_kernel_map = 0;
+    h->w_kernel_map_size = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
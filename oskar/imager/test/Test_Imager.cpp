@@ -5,6 +5,10 @@
 
 #include <gtest/gtest.h>
 #include "imager/oskar_imager.h"
+#include "imager/private_imager.h"
+#include "math/oskar_cmath.h"
+#include "math/oskar_dft_c2r.h"
+#include "utility/oskar_dir.h"
 #include "vis/oskar_vis_header.h"
 #include "vis/oskar_vis_block.h"
 
@@ -93,3 +97,310 @@ TEST(imager, update_from_block)
     oskar_mem_free(image, &status);
     oskar_mem_free(grid, &status);
 }
+
+static void check_dft_2d_cpu(int type, double tol)
+{
+    int status = 0;
+    const int size = 100, num_pixels = size * size, num_vis = 500;
+    double plane_norm = 0.0;
+
+    // Create and set up a DFT imager using CPU threads.
+    oskar_Imager* im = oskar_imager_create(type, &status);
+    oskar_imager_set_algorithm(im, "DFT 2D", &status);
+    oskar_imager_set_fov(im, 4.0);
+    oskar_imager_set_size(im, size, &status);
+    oskar_imager_set_weighting(im, "Natural", &status);
+    oskar_imager_set_gpus(im, 0, 0, &status);
+    oskar_imager_set_num_devices(im, 3);
+    oskar_imager_check_init(im, &status);
+    ASSERT_EQ(0, status);
+
+    // Create visibility data.
+    oskar_Mem* uu = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* vv = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* ww = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* amp = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_vis, &status);
+    oskar_Mem* weight = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_mem_random_gaussian(uu, 0, 1, 2, 3, 300.0, &status);
+    oskar_mem_random_gaussian(vv, 4, 5, 6, 7, 300.0, &status);
+    oskar_mem_clear_contents(ww, &status);
+    oskar_mem_random_uniform(amp, 1, 2, 3, 4, &status);
+    oskar_mem_random_uniform(weight, 5, 6, 7, 8, &status);
+    ASSERT_EQ(0, status);
+
+    // Make the image.
+    oskar_Mem* plane = oskar_mem_create(type, OSKAR_CPU, num_pixels, &status);
+    oskar_mem_clear_contents(plane, &status);
+    oskar_imager_update_plane(im, num_vis, uu, vv, ww, amp, weight, 0,
+            plane, &plane_norm, 0, &status);
+    ASSERT_EQ(0, status);
+
+    // Compare with a direct evaluation of the DFT at each pixel.
+    oskar_Mem* ref = oskar_mem_create(type, OSKAR_CPU, num_pixels, &status);
+    oskar_dft_c2r(num_vis, 2.0 * M_PI, uu, vv, 0, amp, weight,
+            num_pixels, im->l, im->m, 0, ref, &status);
+    ASSERT_EQ(0, status);
+    double max_err = 0.0, max_val = 0.0;
+    for (int i = 0; i < num_pixels; ++i)
+    {
+        const double a = oskar_mem_get_element(plane, i, &status);
+        const double b = oskar_mem_get_element(ref, i, &status);
+        if (fabs(a - b) > max_err) max_err = fabs(a - b);
+        if (fabs(b) > max_val) max_val = fabs(b);
+    }
+    EXPECT_LT(max_err / max_val, tol);
+
+    // Clean up.
+    oskar_imager_free(im, &status);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(amp, &status);
+    oskar_mem_free(weight, &status);
+    oskar_mem_free(plane, &status);
+    oskar_mem_free(ref, &status);
+}
+
+TEST(imager, dft_2d_cpu_double)
+{
+    check_dft_2d_cpu(OSKAR_DOUBLE, 1e-12);
+}
+
+TEST(imager, dft_2d_cpu_single)
+{
+    check_dft_2d_cpu(OSKAR_SINGLE, 1e-4);
+}
+
+static void make_image(const char* algorithm, int type, int size,
+        double fov_deg, int num_vis, const oskar_Mem* uu, const oskar_Mem* vv,
+        const oskar_Mem* ww, const oskar_Mem* amp, const oskar_Mem* weight,
+        const char* cache_dir, oskar_Mem* image, int* status)
+{
+    // Visibility frequency is chosen so that wavelength is 1 metre.
+    oskar_Imager* im = oskar_imager_create(type, status);
+    oskar_imager_set_algorithm(im, algorithm, status);
+    oskar_imager_set_fov(im, fov_deg);
+    oskar_imager_set_size(im, size, status);
+    oskar_imager_set_weighting(im, "Natural", status);
+    oskar_imager_set_gpus(im, 0, 0, status);
+    oskar_imager_set_num_devices(im, 2);
+    oskar_imager_set_vis_frequency(im, 299792458.0, 1.0, 1);
+    oskar_imager_set_w_kernel_cache_dir(im, cache_dir, status);
+    oskar_imager_update(im, num_vis, 0, 0, 1, uu, vv, ww, amp, weight,
+            0, status);
+    oskar_imager_finalise(im, 1, &image, 0, 0, status);
+    oskar_imager_free(im, status);
+}
+
+static void check_wstack_cpu(int type, double tol)
+{
+    int status = 0;
+    const int size = 128, num_pixels = size * size, num_vis = 2000;
+    const double fov_deg = 30.0;
+
+    // Create visibility data with significant w-terms over a wide field.
+    oskar_Mem* uu = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* vv = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* ww = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* amp = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_vis, &status);
+    oskar_Mem* weight = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_mem_random_gaussian(uu, 0, 1, 2, 3, 30.0, &status);
+    oskar_mem_random_gaussian(vv, 4, 5, 6, 7, 30.0, &status);
+    oskar_mem_random_gaussian(ww, 8, 9, 10, 11, 100.0, &status);
+    oskar_mem_random_uniform(amp, 1, 2, 3, 4, &status);
+    oskar_mem_random_uniform(weight, 5, 6, 7, 8, &status);
+    ASSERT_EQ(0, status);
+
+    // Compare the W-stacking image with one made using a 3D DFT.
+    oskar_Mem* image = oskar_mem_create(type, OSKAR_CPU, num_pixels, &status);
+    oskar_Mem* ref = oskar_mem_create(type, OSKAR_CPU, num_pixels, &status);
+    make_image("W-stacking", type, size, fov_deg, num_vis,
+            uu, vv, ww, amp, weight, 0, image, &status);
+    ASSERT_EQ(0, status);
+    make_image("DFT 3D", type, size, fov_deg, num_vis,
+            uu, vv, ww, amp, weight, 0, ref, &status);
+    ASSERT_EQ(0, status);
+    double max_err = 0.0, max_val = 0.0;
+    for (int i = 0; i < num_pixels; ++i)
+    {
+        const double a = oskar_mem_get_element(image, i, &status);
+        const double b = oskar_mem_get_element(ref, i, &status);
+        if (fabs(a - b) > max_err) max_err = fabs(a - b);
+        if (fabs(b) > max_val) max_val = fabs(b);
+    }
+    EXPECT_LT(max_err / max_val, tol);
+
+    // Clean up.
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(amp, &status);
+    oskar_mem_free(weight, &status);
+    oskar_mem_free(image, &status);
+    oskar_mem_free(ref, &status);
+}
+
+TEST(imager, wstack_cpu_double)
+{
+    check_wstack_cpu(OSKAR_DOUBLE, 1e-4);
+}
+
+TEST(imager, wstack_cpu_single)
+{
+    check_wstack_cpu(OSKAR_SINGLE, 1e-3);
+}
+
+TEST(imager, image_padding)
+{
+    int status = 0;
+    oskar_Imager* im = oskar_imager_create(OSKAR_DOUBLE, &status);
+    oskar_imager_set_size(im, 100, &status);
+
+    // Check the default for each algorithm.
+    oskar_imager_set_algorithm(im, "W-stacking", &status);
+    EXPECT_DOUBLE_EQ(1.5, oskar_imager_image_padding(im));
+    oskar_imager_set_algorithm(im, "W-projection", &status);
+    EXPECT_DOUBLE_EQ(1.2, oskar_imager_image_padding(im));
+
+    // Check a padding set by the user is kept when changing algorithm.
+    oskar_imager_set_image_padding(im, 2.0, &status);
+    oskar_imager_set_algorithm(im, "W-stacking", &status);
+    EXPECT_DOUBLE_EQ(2.0, oskar_imager_image_padding(im));
+    EXPECT_EQ(200, oskar_imager_plane_size(im));
+
+    // Check the default can be restored.
+    oskar_imager_set_image_padding(im, 0.0, &status);
+    EXPECT_DOUBLE_EQ(1.5, oskar_imager_image_padding(im));
+    EXPECT_EQ(150, oskar_imager_plane_size(im));
+    ASSERT_EQ(0, status);
+    oskar_imager_free(im, &status);
+}
+
+TEST(imager, finalise_fft_planes)
+{
+    int status = 0, type = OSKAR_DOUBLE;
+    const int size = 200, num_pixels = size * size, num_vis = 5000;
+    const int num_pols = 4, num_planes = 4;
+
+    // Create visibility data for all polarisations.
+    oskar_Mem* uu = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* vv = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* ww = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* amp = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_vis * num_pols, &status);
+    oskar_Mem* weight = oskar_mem_create(type, OSKAR_CPU,
+            num_vis * num_pols, &status);
+    oskar_mem_random_gaussian(uu, 0, 1, 2, 3, 50.0, &status);
+    oskar_mem_random_gaussian(vv, 4, 5, 6, 7, 50.0, &status);
+    oskar_mem_random_uniform(amp, 1, 2, 3, 4, &status);
+    oskar_mem_random_uniform(weight, 5, 6, 7, 8, &status);
+    ASSERT_EQ(0, status);
+
+    // Make the images and grids.
+    oskar_Imager* im = oskar_imager_create(type, &status);
+    oskar_imager_set_algorithm(im, "FFT", &status);
+    oskar_imager_set_image_type(im, "Linear", &status);
+    oskar_imager_set_fov(im, 2.0);
+    oskar_imager_set_size(im, size, &status);
+    oskar_imager_set_gpus(im, 0, 0, &status);
+    oskar_imager_set_vis_frequency(im, 299792458.0, 1.0, 1);
+    oskar_imager_update(im, num_vis, 0, 0, num_pols, uu, vv, ww, amp, weight,
+            0, &status);
+    ASSERT_EQ(0, status);
+    oskar_Mem *images[num_planes], *grids[num_planes];
+    for (int i = 0; i < num_planes; ++i) images[i] = grids[i] = 0;
+    oskar_imager_finalise(im, num_planes, images, num_planes, grids, &status);
+    ASSERT_EQ(0, status);
+
+    // Check each image against the normalised grid finalised on its own.
+    const int plane_size = oskar_imager_plane_size(im);
+    for (int i = 0; i < num_planes; ++i)
+    {
+        oskar_imager_finalise_plane(im, grids[i], 1.0, &status);
+        oskar_imager_trim_image(im, grids[i], plane_size, size, &status);
+        ASSERT_EQ(0, status);
+        const double* a = oskar_mem_double_const(images[i], &status);
+        const double* b = oskar_mem_double_const(grids[i], &status);
+        double max_err = 0.0, max_val = 0.0;
+        for (int j = 0; j < num_pixels; ++j)
+        {
+            if (fabs(a[j] - b[j]) > max_err) max_err = fabs(a[j] - b[j]);
+            if (fabs(b[j]) > max_val) max_val = fabs(b[j]);
+        }
+        EXPECT_GT(max_val, 0.0);
+        EXPECT_LT(max_err / max_val, 1e-10);
+        oskar_mem_free(images[i], &status);
+        oskar_mem_free(grids[i], &status);
+    }
+
+    // Clean up.
+    oskar_imager_free(im, &status);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(amp, &status);
+    oskar_mem_free(weight, &status);
+}
+
+TEST(imager, w_kernel_cache)
+{
+    int status = 0, type = OSKAR_DOUBLE;
+    const int size = 64, num_pixels = size * size, num_vis = 200;
+    const char* cache_dir = "temp_test_w_kernel_cache";
+    oskar_dir_remove(cache_dir);
+
+    // Create visibility data.
+    oskar_Mem* uu = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* vv = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* ww = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* amp = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_vis, &status);
+    oskar_Mem* weight = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_mem_random_gaussian(uu, 0, 1, 2, 3, 100.0, &status);
+    oskar_mem_random_gaussian(vv, 4, 5, 6, 7, 100.0, &status);
+    oskar_mem_random_gaussian(ww, 8, 9, 10, 11, 100.0, &status);
+    oskar_mem_random_uniform(amp, 1, 2, 3, 4, &status);
+    oskar_mem_set_value_real(weight, 1.0, 0, num_vis, &status);
+    ASSERT_EQ(0, status);
+
+    // Make images without the cache, then generating and reading kernels.
+    oskar_Mem* ref = oskar_mem_create(type, OSKAR_CPU, num_pixels, &status);
+    oskar_Mem* image1 = oskar_mem_create(type, OSKAR_CPU, num_pixels, &status);
+    oskar_Mem* image2 = oskar_mem_create(type, OSKAR_CPU, num_pixels, &status);
+    make_image("W-projection", type, size, 10.0, num_vis,
+            uu, vv, ww, amp, weight, 0, ref, &status);
+    ASSERT_EQ(0, status);
+    make_image("W-projection", type, size, 10.0, num_vis,
+            uu, vv, ww, amp, weight, cache_dir, image1, &status);
+    ASSERT_EQ(0, status);
+    int num_files = 0;
+    char** files = 0;
+    oskar_dir_items(cache_dir, "*.bin", 1, 0, &num_files, &files);
+    ASSERT_EQ(1, num_files);
+    for (int i = 0; i < num_files; ++i) free(files[i]);
+    free(files);
+    make_image("W-projection", type, size, 10.0, num_vis,
+            uu, vv, ww, amp, weight, cache_dir, image2, &status);
+    ASSERT_EQ(0, status);
+    const double* r = oskar_mem_double_const(ref, &status);
+    const double* a = oskar_mem_double_const(image1, &status);
+    const double* b = oskar_mem_double_const(image2, &status);
+    for (int i = 0; i < num_pixels; ++i)
+    {
+        ASSERT_EQ(r[i], a[i]);
+        ASSERT_EQ(r[i], b[i]);
+    }
+
+    // Clean up.
+    oskar_dir_remove(cache_dir);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(amp, &status);
+    oskar_mem_free(weight, &status);
+    oskar_mem_free(ref, &status);
+    oskar_mem_free(image1, &status);
+    oskar_mem_free(image2, &status);
+}
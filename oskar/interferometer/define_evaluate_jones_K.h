@@ -45,7 +45,7 @@
         phase  = u_[la] * l_[ls];\
         phase += v_[la] * m_[ls];\
         if (!ignore_w_components) phase += w_[la] * n_[ls];\
-        SINCOS(phase, im, re);\
+        SINCOS_FP(FP, phase, im, re);\
         weight.x = re; weight.y = im;\
     }\
     if (s < num_sources && a < num_stations)\
@@ -56,7 +56,7 @@ OSKAR_REGISTER_KERNEL(NAME)
 #define OSKAR_JONES_K_CPU(NAME, FP, FP2) KERNEL(NAME) (\
         OSKAR_JONES_K_ARGS(FP, FP2))\
 {\
-    KERNEL_LOOP_Y(int, a, 0, num_stations)\
+    KERNEL_LOOP_PAR_Y(int, a, 0, num_stations)\
     KERNEL_LOOP_X(int, s, 0, num_sources)\
     FP2 weight; weight.x = weight.y = (FP) 0;\
     if (source_filter[s] > source_filter_min &&\
@@ -65,7 +65,7 @@ OSKAR_REGISTER_KERNEL(NAME)
         phase = u[a] * l[s] + v[a] * m[s];\
         if (!ignore_w_components) phase += w[a] * (n[s] - (FP)1);\
         phase *= wavenumber;\
-        SINCOS(phase, im, re);\
+        SINCOS_FP(FP, phase, im, re);\
         weight.x = re; weight.y = im;\
     }\
     jones[s + num_sources * a] = weight;\
@@ -30,6 +30,9 @@ extern "C" {
  * If all stations are marked as identical, the results for the first station
  * are copied into the results for the others.
  *
+ * If the telescope model has a station beam interpolation tolerance set,
+ * the beams may be interpolated from a grid (see oskar_station_beam_interp()).
+ *
  * @param[out] E             Output set of Jones matrices.
  * @param[in]  coord_type    Type of coordinates.
  * @param[in]  num_points    Number of coordinates given.
@@ -42,6 +42,10 @@ void oskar_interferometer_reset_cache(oskar_Interferometer* h, int* status);
 OSKAR_EXPORT
 void oskar_interferometer_reset_work_unit_index(oskar_Interferometer* h);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_bda(oskar_Interferometer* h, int enable,
+        double max_fact, double fov_deg, double max_avg_time_sec);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_coords_only(oskar_Interferometer* h, int value,
         int* status);
@@ -50,10 +54,18 @@ OSKAR_EXPORT
 void oskar_interferometer_set_correlation_type(oskar_Interferometer* h,
         const char* type, int* status);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_cpu_shared_memory(oskar_Interferometer* h,
+        int value);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_force_polarised_ms(oskar_Interferometer* h,
         int value);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_fused_correlation(oskar_Interferometer* h,
+        int value);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_gpus(oskar_Interferometer* h, int num_gpus,
         const int* cuda_device_ids, int* status);
@@ -77,6 +89,10 @@ OSKAR_EXPORT
 void oskar_interferometer_set_max_times_per_block(oskar_Interferometer* h,
         int value);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_mpi_distribution(oskar_Interferometer* h,
+        const char* type, int* status);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_num_devices(oskar_Interferometer* h, int value);
 
@@ -108,6 +124,10 @@ OSKAR_EXPORT
 void oskar_interferometer_set_telescope_model(oskar_Interferometer* h,
         const oskar_Telescope* model, int* status);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_sort_sky_by_locality(oskar_Interferometer* h,
+        int value);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_source_flux_range(oskar_Interferometer* h,
         double min_jy, double max_jy);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2020, The OSKAR Developers.
+ * Copyright (c) 2011-2021, The OSKAR Developers.
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
@@ -15,6 +15,7 @@
 #include <telescope/oskar_telescope.h>
 #include <utility/oskar_thread.h>
 #include <utility/oskar_timer.h>
+#include <vis/oskar_vis_bda.h>
 #include <vis/oskar_vis_block.h>
 #include <vis/oskar_vis_header.h>
 
@@ -30,8 +31,14 @@ struct DeviceData
     oskar_Mem *lmn[3], *uvw[3];
     oskar_Sky* chunk;           /* The unmodified sky chunk being processed. */
     oskar_Sky* chunk_clip;      /* Copy of the chunk after horizon clipping. */
-    oskar_Telescope* tel;       /* Telescope model, created as a copy. */
+    oskar_Sky** chunk_merge;    /* Clipped chunks merged for each time. */
+    int *merge_first, *merge_last; /* Range of chunks in each merged set. */
+    int num_chunk_merge;
+    oskar_Telescope* tel;       /* Telescope model (shared on the CPU). */
     oskar_Jones *J, *R, *E, *K;
+    oskar_Jones** E_chan;       /* Jones E for each channel in a batch. */
+    int num_E_chan;
+    oskar_Mem *flux_chan[4];    /* Source fluxes for each channel in a batch. */
     oskar_Mem *gains;
     oskar_StationWork* station_work;
 
@@ -39,6 +46,7 @@ struct DeviceData
     oskar_Timer* tmr_compute;   /* Total time spent filling vis blocks. */
     oskar_Timer* tmr_copy;      /* Time spent copying data. */
     oskar_Timer* tmr_clip;      /* Time spent in horizon clip. */
+    oskar_Timer* tmr_time;      /* Time spent on per-time (u,v,w), ENU, R. */
     oskar_Timer* tmr_correlate; /* Time spent correlating Jones matrices. */
     oskar_Timer* tmr_join;      /* Time spent combining Jones matrices. */
     oskar_Timer* tmr_E;         /* Time spent evaluating E-Jones. */
@@ -53,11 +61,17 @@ struct oskar_Interferometer
     int prec, num_devices, num_gpus_avail, dev_loc, num_gpus, *gpu_ids;
     int num_channels, num_time_steps;
     int max_sources_per_chunk, max_times_per_block, max_channels_per_block;
+    int max_channels_per_block_set; /* True if not automatic. */
     int apply_horizon_clip, force_polarised_ms, zero_failed_gaussians;
-    int coords_only, ignore_w_components;
+    int coords_only, ignore_w_components, bda_enabled;
+    int cpu_shared_memory, num_cpu_threads, fused_correlation;
+    int sort_sky_by_locality;
+    int mpi_rank, mpi_size; /* Process rank and number of processes. */
+    double bda_max_fact, bda_fov_deg, bda_max_time_sec;
     double freq_start_hz, freq_inc_hz, time_start_mjd_utc, time_inc_sec;
     double source_min_jy, source_max_jy;
-    char correlation_type, *vis_name, *ms_name, *settings_path;
+    char correlation_type, mpi_distribution, *vis_name, *ms_name;
+    char *settings_path;
 
     /* State. */
     int init_sky, work_unit_index;
@@ -67,13 +81,16 @@ struct oskar_Interferometer
 
     /* Sky model and telescope model. */
     int num_sources_total, num_sky_chunks;
+    int chunk_size; /* Maximum number of sources in each chunk. */
     oskar_Sky** sky_chunks;
+    double* sky_chunk_caps; /* Bounding cap (RA, Dec, radius) of each chunk. */
     oskar_Telescope* tel;
 
     /* Output data and file handles. */
     oskar_VisHeader* header;
     oskar_MeasurementSet* ms;
     oskar_Binary* vis;
+    oskar_VisBDA* bda;      /* Baseline-dependent averaging stage. */
     oskar_Mem *temp;
     oskar_Timer* tmr_sim;   /* The total time for the simulation. */
     oskar_Timer* tmr_write; /* The time spent writing vis blocks. */
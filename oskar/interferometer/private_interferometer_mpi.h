@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_PRIVATE_INTERFEROMETER_MPI_H_
+#define OSKAR_PRIVATE_INTERFEROMETER_MPI_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Functions used to distribute the simulation over multiple processes.
+ * If OSKAR was built without MPI, or if MPI has not been initialised,
+ * there is only one process and these functions do nothing.
+ *
+ * The functions below which communicate between processes must be called
+ * by all processes involved, even if an error has occurred, so that no
+ * process is left waiting. Any error is passed on instead.
+ */
+
+/* Sets the process rank and the number of processes. */
+void oskar_interferometer_mpi_init(oskar_Interferometer* h);
+
+/* Sets the status code on all processes, if it is set on any of them. */
+void oskar_interferometer_mpi_check_status(oskar_Interferometer* h,
+        int* status);
+
+/* Sends a finalised visibility block (which may be NULL) to the root. */
+void oskar_interferometer_mpi_send_block(oskar_Interferometer* h,
+        const oskar_VisBlock* block, int* status);
+
+/* Receives a finalised visibility block from the given process. */
+void oskar_interferometer_mpi_recv_block(oskar_Interferometer* h,
+        oskar_VisBlock* block, int source, int* status);
+
+/* Sums the visibility amplitudes in the block from all processes,
+ * leaving the result on the root. */
+void oskar_interferometer_mpi_reduce_block(oskar_Interferometer* h,
+        oskar_VisBlock* block, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -30,6 +30,7 @@ void oskar_evaluate_jones_E(
     if (*status) return;
     const int num_stations = oskar_telescope_num_stations(tel);
     const int num_sources = oskar_jones_num_sources(E);
+    const double tolerance = oskar_telescope_station_beam_interp_tolerance(tel);
     if (num_stations == 0)
     {
         *status = OSKAR_ERR_MEMORY_NOT_ALLOCATED;
@@ -45,14 +46,14 @@ void oskar_evaluate_jones_E(
     {
         /* Evaluate all the station beams. */
         for (i = 0; i < num_stations; ++i)
-            oskar_station_beam(
+            oskar_station_beam_interp(
                     oskar_telescope_station_const(tel, i),
                     work, coord_type, num_points, source_coords,
                     ref_lon_rad, ref_lat_rad,
                     oskar_telescope_phase_centre_coord_type(tel),
                     oskar_telescope_phase_centre_longitude_rad(tel),
                     oskar_telescope_phase_centre_latitude_rad(tel),
-                    time_index, gast_rad, frequency_hz,
+                    time_index, gast_rad, frequency_hz, tolerance,
                     i * num_sources, oskar_jones_mem(E), status);
     }
     else
@@ -84,14 +85,14 @@ void oskar_evaluate_jones_E(
             }
             else
             {
-                oskar_station_beam(
+                oskar_station_beam_interp(
                         oskar_telescope_station_const(tel, station_model_type),
                         work, coord_type, num_points, source_coords,
                         ref_lon_rad, ref_lat_rad,
                         oskar_telescope_phase_centre_coord_type(tel),
                         oskar_telescope_phase_centre_longitude_rad(tel),
                         oskar_telescope_phase_centre_latitude_rad(tel),
-                        time_index, gast_rad, frequency_hz,
+                        time_index, gast_rad, frequency_hz, tolerance,
                         i * num_sources, oskar_jones_mem(E), status);
                 num_models_evaluated++;
                 models_evaluated = (int*) realloc(models_evaluated,
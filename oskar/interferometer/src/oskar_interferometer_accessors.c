@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2020, The OSKAR Developers.
+ * Copyright (c) 2011-2021, The OSKAR Developers.
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
@@ -52,6 +52,15 @@ void oskar_interferometer_reset_work_unit_index(oskar_Interferometer* h)
     h->work_unit_index = 0;
 }
 
+void oskar_interferometer_set_bda(oskar_Interferometer* h, int enable,
+        double max_fact, double fov_deg, double max_avg_time_sec)
+{
+    h->bda_enabled = enable;
+    h->bda_max_fact = max_fact;
+    h->bda_fov_deg = fov_deg;
+    h->bda_max_time_sec = max_avg_time_sec;
+}
+
 void oskar_interferometer_set_coords_only(oskar_Interferometer* h, int value,
         int* status)
 {
@@ -72,12 +81,24 @@ void oskar_interferometer_set_correlation_type(oskar_Interferometer* h,
     else *status = OSKAR_ERR_INVALID_ARGUMENT;
 }
 
+void oskar_interferometer_set_cpu_shared_memory(oskar_Interferometer* h,
+        int value)
+{
+    h->cpu_shared_memory = value;
+}
+
 void oskar_interferometer_set_force_polarised_ms(oskar_Interferometer* h,
         int value)
 {
     h->force_polarised_ms = value;
 }
 
+void oskar_interferometer_set_fused_correlation(oskar_Interferometer* h,
+        int value)
+{
+    h->fused_correlation = value;
+}
+
 void oskar_interferometer_set_gpus(oskar_Interferometer* h, int num,
         const int* ids, int* status)
 {
@@ -139,6 +160,7 @@ void oskar_interferometer_set_max_channels_per_block(oskar_Interferometer* h,
         int value)
 {
     h->max_channels_per_block = value;
+    h->max_channels_per_block_set = (value > 0);
 }
 
 void oskar_interferometer_set_max_times_per_block(oskar_Interferometer* h,
@@ -147,6 +169,17 @@ void oskar_interferometer_set_max_times_per_block(oskar_Interferometer* h,
     h->max_times_per_block = value;
 }
 
+void oskar_interferometer_set_mpi_distribution(oskar_Interferometer* h,
+        const char* type, int* status)
+{
+    if (*status) return;
+    if (!strncmp(type, "B", 1) || !strncmp(type, "b", 1))
+        h->mpi_distribution = 'B';
+    else if (!strncmp(type, "S", 1) || !strncmp(type, "s", 1))
+        h->mpi_distribution = 'S';
+    else *status = OSKAR_ERR_INVALID_ARGUMENT;
+}
+
 void oskar_interferometer_set_num_devices(oskar_Interferometer* h, int value)
 {
     int status = 0;
@@ -200,22 +233,53 @@ void oskar_interferometer_set_sky_model(oskar_Interferometer* h,
     for (i = 0; i < h->num_sky_chunks; ++i)
         oskar_sky_free(h->sky_chunks[i], status);
     free(h->sky_chunks);
+    free(h->sky_chunk_caps);
     h->sky_chunks = 0;
+    h->sky_chunk_caps = 0;
     h->num_sky_chunks = 0;
 
-    /* Split up the sky model into chunks and store them. */
+    /* Split up the sky model into chunks and store them.
+     * If required, sort the sources first so that each chunk
+     * covers a compact region of the sky.
+     * If the chunk size is automatic, it depends on the telescope model
+     * and the devices, so keep all the sources in one chunk until
+     * oskar_interferometer_check_init() splits them up. */
     h->num_sources_total = oskar_sky_num_sources(sky);
     if (h->num_sources_total > 0)
-        oskar_sky_append_to_set(&h->num_sky_chunks, &h->sky_chunks,
-                h->max_sources_per_chunk, sky, status);
+    {
+        h->chunk_size = h->max_sources_per_chunk > 0 ?
+                h->max_sources_per_chunk : h->num_sources_total;
+        if (h->sort_sky_by_locality)
+        {
+            oskar_Sky* sorted = oskar_sky_create_copy(sky, OSKAR_CPU, status);
+            oskar_sky_sort_by_locality(sorted, status);
+            oskar_sky_append_to_set(&h->num_sky_chunks, &h->sky_chunks,
+                    h->chunk_size, sorted, status);
+            oskar_sky_free(sorted, status);
+        }
+        else
+        {
+            oskar_sky_append_to_set(&h->num_sky_chunks, &h->sky_chunks,
+                    h->chunk_size, sky, status);
+        }
+    }
+
+    /* Store the bounding cap of each chunk, for horizon culling. */
+    h->sky_chunk_caps = (double*) calloc(3 * (h->num_sky_chunks + 1),
+            sizeof(double));
+    for (i = 0; i < h->num_sky_chunks; ++i)
+        oskar_sky_bounding_cap(h->sky_chunks[i], &h->sky_chunk_caps[3 * i],
+                &h->sky_chunk_caps[3 * i + 1], &h->sky_chunk_caps[3 * i + 2],
+                status);
     h->init_sky = 0;
 
     /* Print summary data. */
     oskar_log_section(h->log, 'M', "Sky model summary");
     oskar_log_value(h->log, 'M', 0,
             "Number of sources", "%d", h->num_sources_total);
-    oskar_log_value(h->log, 'M', 0,
-            "Number of chunks", "%d", h->num_sky_chunks);
+    if (h->max_sources_per_chunk > 0)
+        oskar_log_value(h->log, 'M', 0,
+                "Number of chunks", "%d", h->num_sky_chunks);
     if (h->num_sources_total < 32 && h->num_gpus > 0)
         oskar_log_advice(h->log, "It may be faster to use CPU cores "
                 "only, as the sky model contains fewer than 32 sources.");
@@ -234,7 +298,9 @@ void oskar_interferometer_set_telescope_model(oskar_Interferometer* h,
         return;
     }
 
-    /* Remove any existing telescope model, and copy the new one. */
+    /* Remove any existing telescope model, and copy the new one.
+     * CPU devices refer to the model directly, so free them first. */
+    oskar_interferometer_free_device_data(h, status);
     oskar_telescope_free(h->tel, status);
     h->tel = oskar_telescope_create_copy(model, OSKAR_CPU, status);
 
@@ -272,6 +338,12 @@ void oskar_interferometer_set_output_measurement_set(oskar_Interferometer* h,
         sprintf(h->ms_name, "%s.MS", filename);
 }
 
+void oskar_interferometer_set_sort_sky_by_locality(oskar_Interferometer* h,
+        int value)
+{
+    h->sort_sky_by_locality = value;
+}
+
 void oskar_interferometer_set_source_flux_range(oskar_Interferometer* h,
         double min_jy, double max_jy)
 {
@@ -11,11 +11,19 @@
 #include "utility/oskar_device.h"
 #include "utility/oskar_get_memory_usage.h"
 
+/* Parameters used to choose the chunk size automatically. */
+#define WORK_UNITS_PER_DEVICE 4   /* Minimum work units per device. */
+#define MIN_CHUNK_SIZE 1024       /* Smallest chunk worth a work unit. */
+#define CPU_CACHE_BYTES (1 << 20) /* Cache assumed for each CPU thread. */
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+static int auto_chunk_size(oskar_Interferometer* h);
+static void set_num_devices(oskar_Interferometer* h);
 static void set_up_device_data(oskar_Interferometer* h, int* status);
+static void set_up_sky_chunks(oskar_Interferometer* h, int* status);
 static void set_up_vis_header(oskar_Interferometer* h, int* status);
 
 void oskar_interferometer_check_init(oskar_Interferometer* h, int* status)
@@ -34,10 +42,31 @@ void oskar_interferometer_check_init(oskar_Interferometer* h, int* status)
     if (!h->header)
         set_up_vis_header(h, status);
 
+    /* Create the baseline-dependent averaging stage if required. */
+    if (h->bda_enabled && !h->bda && !*status)
+    {
+        if (!h->ms_name)
+            oskar_log_warning(h->log, "Baseline-dependent averaging "
+                    "is only applied to Measurement Set output.");
+        else
+        {
+            if (h->correlation_type != 'C')
+                oskar_log_warning(h->log, "Auto-correlations are not "
+                        "written when using baseline-dependent averaging.");
+            h->bda = oskar_vis_bda_create(h->header, status);
+            oskar_vis_bda_set_compression(h->bda, h->bda_max_fact,
+                    h->bda_fov_deg, h->bda_max_time_sec);
+        }
+    }
+
+    /* Set the number of compute devices. */
+    set_num_devices(h);
+
     /* Calculate source parameters if required. */
     if (!h->init_sky)
     {
         int i, num_failed = 0;
+        set_up_sky_chunks(h, status);
         double ra0 = 0.0, dec0 = 0.0;
 
         /* Compute source direction cosines. */
@@ -99,6 +128,23 @@ static void set_up_vis_header(oskar_Interferometer* h, int* status)
         write_crosscorr = 1;
     }
 
+    /* Baseline-dependent averages must contain all channels.
+     * Only the automatic block size can be overridden here. */
+    if (h->bda_enabled && h->ms_name &&
+            h->max_channels_per_block < h->num_channels)
+    {
+        if (h->max_channels_per_block_set)
+        {
+            oskar_log_error(h->log, "Baseline-dependent averaging needs "
+                    "all %d channels in each block, but the maximum number "
+                    "of channels per block is %d.",
+                    h->num_channels, h->max_channels_per_block);
+            *status = OSKAR_ERR_INVALID_ARGUMENT;
+            return;
+        }
+        h->max_channels_per_block = h->num_channels;
+    }
+
     /* Create visibility header. */
     const int num_stations = oskar_telescope_num_stations(h->tel);
     vis_type = h->prec | OSKAR_COMPLEX;
@@ -179,7 +225,7 @@ static void* init_device(void* arg)
     status = a->status;
     const int i = a->thread_id;
     const int num_stations = oskar_telescope_num_stations(h->tel);
-    const int num_src = h->max_sources_per_chunk;
+    const int num_src = h->chunk_size;
     const int complx = (h->prec) | OSKAR_COMPLEX;
     vistype = complx;
     if (oskar_telescope_pol_mode(h->tel) == OSKAR_POL_MODE_FULL)
@@ -204,6 +250,7 @@ static void* init_device(void* arg)
         d->tmr_compute   = oskar_timer_create(dev_loc);
         d->tmr_copy      = oskar_timer_create(dev_loc);
         d->tmr_clip      = oskar_timer_create(dev_loc);
+        d->tmr_time      = oskar_timer_create(dev_loc);
         d->tmr_E         = oskar_timer_create(dev_loc);
         d->tmr_K         = oskar_timer_create(dev_loc);
         d->tmr_join      = oskar_timer_create(dev_loc);
@@ -235,7 +282,8 @@ static void* init_device(void* arg)
         d->lmn[2] = oskar_mem_create(h->prec, dev_loc, 1 + num_src, status);
         d->chunk = oskar_sky_create(h->prec, dev_loc, num_src, status);
         d->chunk_clip = oskar_sky_create(h->prec, dev_loc, num_src, status);
-        d->tel = oskar_telescope_create_copy(h->tel, dev_loc, status);
+        d->tel = (dev_loc == OSKAR_CPU) ? h->tel :
+                oskar_telescope_create_copy(h->tel, dev_loc, status);
         d->J = oskar_jones_create(vistype, dev_loc, num_stations, num_src,
                 status);
         d->R = oskar_type_is_matrix(vistype) ? oskar_jones_create(vistype,
@@ -246,6 +294,8 @@ static void* init_device(void* arg)
                 status);
         d->gains = oskar_mem_create(vistype, dev_loc, num_stations, status);
         d->station_work = oskar_station_work_create(h->prec, dev_loc, status);
+        oskar_station_work_set_weights_cache_size(d->station_work,
+                OSKAR_STATION_WORK_WEIGHTS_CACHE_SIZE, status);
         oskar_station_work_set_tec_screen_common_params(d->station_work,
                 oskar_telescope_ionosphere_screen_type(d->tel),
                 oskar_telescope_tec_screen_height_km(d->tel),
@@ -259,6 +309,122 @@ static void* init_device(void* arg)
 }
 
 
+static void set_num_devices(oskar_Interferometer* h)
+{
+    /* Expand the number of devices to the number of selected GPUs,
+     * if required. */
+    if (h->num_devices < h->num_gpus)
+        oskar_interferometer_set_num_devices(h, h->num_gpus);
+
+    /* In shared-memory CPU mode, replace the CPU devices with a single one,
+     * which uses the same number of threads inside the kernels. */
+    if (h->cpu_shared_memory && h->num_devices > h->num_gpus + 1)
+    {
+        h->num_cpu_threads = h->num_devices - h->num_gpus;
+        oskar_interferometer_set_num_devices(h, h->num_gpus + 1);
+    }
+}
+
+
+static int auto_chunk_size(oskar_Interferometer* h)
+{
+    int i, num_chunks;
+    size_t size;
+    const int num_sources = h->num_sources_total;
+    const int num_stations = oskar_telescope_num_stations(h->tel);
+    const int num_devices = h->num_devices;
+    const int num_cpus = num_devices - h->num_gpus;
+    const int num_times = h->max_times_per_block < h->num_time_steps ?
+            h->max_times_per_block : h->num_time_steps;
+    int jones_type = h->prec | OSKAR_COMPLEX;
+    if (oskar_telescope_pol_mode(h->tel) == OSKAR_POL_MODE_FULL)
+        jones_type |= OSKAR_MATRIX;
+    const size_t jones_bytes = oskar_mem_element_size(jones_type);
+    const size_t prec_bytes = oskar_mem_element_size(h->prec);
+
+    /* Memory needed on a device for each source in a chunk: Jones matrices
+     * J, E, K and R for every station, and about twenty source parameters
+     * for the chunk, the clipped chunk and the merged chunks for each time. */
+    const size_t source_bytes = 4 * num_stations * jones_bytes +
+            20 * (2 + num_times) * prec_bytes;
+
+    /* Split the sky so that each device can take several work units from
+     * each visibility block, as the horizon clip makes them uneven. */
+    num_chunks = (WORK_UNITS_PER_DEVICE * num_devices + num_times - 1) /
+            (num_times > 0 ? num_times : 1);
+    if (num_chunks < 1) num_chunks = 1;
+    size = (num_sources + num_chunks - 1) / num_chunks;
+    if (size < MIN_CHUNK_SIZE) size = MIN_CHUNK_SIZE;
+
+    /* Use no more than half the free memory on any device. */
+    for (i = 0; i < h->num_gpus; ++i)
+    {
+        size_t mem_free = 0, mem_cache = 0;
+        oskar_device_mem_info(h->dev_loc, h->gpu_ids[i],
+                &mem_free, &mem_cache);
+        if (mem_free > 0 && size > mem_free / (2 * source_bytes))
+            size = mem_free / (2 * source_bytes);
+    }
+    if (num_cpus > 0)
+    {
+        const size_t mem_free = oskar_get_free_physical_memory() / num_cpus;
+        if (mem_free > 0 && size > mem_free / (2 * source_bytes))
+            size = mem_free / (2 * source_bytes);
+
+        /* On the CPU, the Jones matrices for each pair of stations
+         * should fit in cache while correlating. */
+        if (size > CPU_CACHE_BYTES / (2 * jones_bytes))
+            size = CPU_CACHE_BYTES / (2 * jones_bytes);
+    }
+    if (size < 1) size = 1;
+
+    /* Make the chunks the same size. */
+    if (size >= (size_t) num_sources) return num_sources;
+    num_chunks = (int) ((num_sources + size - 1) / size);
+    return (num_sources + num_chunks - 1) / num_chunks;
+}
+
+
+static void set_up_sky_chunks(oskar_Interferometer* h, int* status)
+{
+    int i, num_chunks = 0;
+    oskar_Sky** chunks = 0;
+    if (*status || h->num_sky_chunks == 0) return;
+
+    /* Get the chunk size. */
+    const int chunk_size = h->max_sources_per_chunk > 0 ?
+            h->max_sources_per_chunk : auto_chunk_size(h);
+    if (chunk_size == h->chunk_size) return;
+
+    /* Split the sources up again, and find the new bounding caps. */
+    for (i = 0; i < h->num_sky_chunks; ++i)
+    {
+        oskar_sky_append_to_set(&num_chunks, &chunks, chunk_size,
+                h->sky_chunks[i], status);
+        oskar_sky_free(h->sky_chunks[i], status);
+    }
+    free(h->sky_chunks);
+    free(h->sky_chunk_caps);
+    h->sky_chunks = chunks;
+    h->num_sky_chunks = num_chunks;
+    h->chunk_size = chunk_size;
+    h->sky_chunk_caps = (double*) calloc(3 * (num_chunks + 1), sizeof(double));
+    for (i = 0; i < num_chunks; ++i)
+        oskar_sky_bounding_cap(chunks[i], &h->sky_chunk_caps[3 * i],
+                &h->sky_chunk_caps[3 * i + 1], &h->sky_chunk_caps[3 * i + 2],
+                status);
+
+    /* Device buffers are sized for the chunks, so must be set up again. */
+    oskar_interferometer_free_device_data(h, status);
+    oskar_log_section(h->log, 'M', "Sky model chunks");
+    oskar_log_value(h->log, 'M', 0,
+            "Sources per chunk", "%d%s", h->chunk_size,
+            h->max_sources_per_chunk > 0 ? "" : " (automatic)");
+    oskar_log_value(h->log, 'M', 0,
+            "Number of chunks", "%d", h->num_sky_chunks);
+}
+
+
 static void set_up_device_data(oskar_Interferometer* h, int* status)
 {
     int i, init = 1;
@@ -266,11 +432,6 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
     ThreadArgs* args = 0;
     if (*status) return;
 
-    /* Expand the number of devices to the number of selected GPUs,
-     * if required. */
-    if (h->num_devices < h->num_gpus)
-        oskar_interferometer_set_num_devices(h, h->num_gpus);
-
     /* Set up devices in parallel. */
     const int num_devices = h->num_devices;
     threads = (oskar_Thread**) calloc(num_devices, sizeof(oskar_Thread*));
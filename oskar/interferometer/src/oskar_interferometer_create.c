@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2020, The OSKAR Developers.
+ * Copyright (c) 2011-2021, The OSKAR Developers.
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
@@ -32,10 +32,14 @@ oskar_Interferometer* oskar_interferometer_create(int precision, int* status)
 
     /* Set sensible defaults. */
     h->max_sources_per_chunk = 16384;
+    h->chunk_size = h->max_sources_per_chunk;
     oskar_interferometer_set_gpus(h, -1, 0, status);
     oskar_interferometer_set_num_devices(h, -1);
     oskar_interferometer_set_correlation_type(h, "Cross-correlations", status);
+    oskar_interferometer_set_mpi_distribution(h, "Blocks", status);
+    h->mpi_size = 1;
     oskar_interferometer_set_horizon_clip(h, 1);
+    oskar_interferometer_set_fused_correlation(h, 1);
     oskar_interferometer_set_source_flux_range(h, -DBL_MAX, DBL_MAX);
     oskar_interferometer_set_max_times_per_block(h, 8);
     return h;
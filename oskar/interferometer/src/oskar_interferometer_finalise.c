@@ -37,6 +37,7 @@ extern "C" {
 #endif
 
 static void record_timing(oskar_Interferometer* h);
+static void record_beam_interp(oskar_Interferometer* h);
 
 void oskar_interferometer_finalise(oskar_Interferometer* h, int* status)
 {
@@ -86,6 +87,7 @@ void oskar_interferometer_finalise(oskar_Interferometer* h, int* status)
                     "only, as the sky model contains fewer than 32 sources.");
         oskar_log_set_value_width(h->log, 25);
         record_timing(h);
+        record_beam_interp(h);
         oskar_log_section(h->log, 'M', "Simulation complete");
         oskar_log_message(h->log, 'M', 0, "Output(s):");
         if (h->vis_name)
@@ -94,6 +96,13 @@ void oskar_interferometer_finalise(oskar_Interferometer* h, int* status)
         if (h->ms_name)
             oskar_log_value(h->log, 'M', 1,
                     "Measurement Set", "%s", h->ms_name);
+#ifndef OSKAR_NO_MS
+        if (h->ms && h->bda)
+            oskar_log_message(h->log, 'M', 1, "Baseline-dependent "
+                    "averaging reduced %d rows to %u rows.",
+                    oskar_vis_bda_num_input_rows(h->bda),
+                    oskar_ms_num_rows(h->ms));
+#endif
         oskar_log_message(h->log, 'M', 0, "Run completed in %.3f sec.",
                 oskar_timer_elapsed(h->tmr_sim));
 
@@ -126,7 +135,8 @@ static void record_timing(oskar_Interferometer* h)
 {
     /* Obtain component times. */
     int i;
-    double t_copy = 0., t_clip = 0., t_E = 0., t_K = 0., t_join = 0.;
+    double t_copy = 0., t_clip = 0., t_time = 0., t_E = 0., t_K = 0.;
+    double t_join = 0.;
     double t_correlate = 0., t_compute = 0., t_components = 0.;
     double *compute_times;
     compute_times = (double*) calloc(h->num_devices, sizeof(double));
@@ -135,13 +145,14 @@ static void record_timing(oskar_Interferometer* h)
         compute_times[i] = oskar_timer_elapsed(h->d[i].tmr_compute);
         t_copy += oskar_timer_elapsed(h->d[i].tmr_copy);
         t_clip += oskar_timer_elapsed(h->d[i].tmr_clip);
+        t_time += oskar_timer_elapsed(h->d[i].tmr_time);
         t_join += oskar_timer_elapsed(h->d[i].tmr_join);
         t_E += oskar_timer_elapsed(h->d[i].tmr_E);
         t_K += oskar_timer_elapsed(h->d[i].tmr_K);
         t_correlate += oskar_timer_elapsed(h->d[i].tmr_correlate);
         t_compute += compute_times[i];
     }
-    t_components = t_copy + t_clip + t_E + t_K + t_join + t_correlate;
+    t_components = t_copy + t_clip + t_time + t_E + t_K + t_join + t_correlate;
 
     /* Record time taken. */
     oskar_log_section(h->log, 'M', "Simulation timing");
@@ -157,6 +168,8 @@ static void record_timing(oskar_Interferometer* h)
             (t_copy / t_compute) * 100.0);
     oskar_log_value(h->log, 'M', 1, "Horizon clip", "%4.1f%%",
             (t_clip / t_compute) * 100.0);
+    oskar_log_value(h->log, 'M', 1, "Per-time setup", "%4.1f%%",
+            (t_time / t_compute) * 100.0);
     oskar_log_value(h->log, 'M', 1, "Jones E", "%4.1f%%",
             (t_E / t_compute) * 100.0);
     oskar_log_value(h->log, 'M', 1, "Jones K", "%4.1f%%",
@@ -170,6 +183,33 @@ static void record_timing(oskar_Interferometer* h)
     free(compute_times);
 }
 
+
+static void record_beam_interp(oskar_Interferometer* h)
+{
+    int i, num_interp = 0, num_exact = 0;
+    double max_error = 0.0;
+    const double tolerance =
+            oskar_telescope_station_beam_interp_tolerance(h->tel);
+    if (tolerance <= 0.0) return;
+    for (i = 0; i < h->num_devices; ++i)
+    {
+        int n_interp = 0, n_exact = 0;
+        double error = 0.0;
+        if (!h->d[i].station_work) continue;
+        oskar_station_work_beam_interp_stats(h->d[i].station_work,
+                &n_interp, &n_exact, &error);
+        num_interp += n_interp;
+        num_exact += n_exact;
+        if (error > max_error) max_error = error;
+    }
+    oskar_log_section(h->log, 'M', "Station beam interpolation");
+    oskar_log_value(h->log, 'M', 0, "Tolerance", "%.3e", tolerance);
+    oskar_log_value(h->log, 'M', 0, "Beams interpolated", "%d", num_interp);
+    oskar_log_value(h->log, 'M', 0, "Beams evaluated exactly", "%d",
+            num_exact);
+    oskar_log_value(h->log, 'M', 0, "Max. sampled error", "%.3e", max_error);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -6,6 +6,7 @@
 #include <stdlib.h>
 
 #include "interferometer/private_interferometer.h"
+#include "interferometer/private_interferometer_mpi.h"
 #include "interferometer/oskar_interferometer.h"
 
 #include "utility/oskar_get_error_string.h"
@@ -22,13 +23,19 @@ oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
 {
     int i, i_active;
     oskar_VisBlock *b0 = 0, *b = 0;
+
+    /* If sky chunks are distributed between processes, all processes
+     * must take part in the reduction, so check the status on all of them. */
+    if (h->mpi_distribution == 'S')
+        oskar_interferometer_mpi_check_status(h, status);
     if (*status) return 0;
 
     /* The visibilities must be copied back
      * at the end of the block simulation. */
 
     /* Combine all vis blocks into the first one. */
-    i_active = (block_index + 1) % 2;
+    const int block_stride = h->mpi_distribution == 'B' ? h->mpi_size : 1;
+    i_active = (block_index / block_stride + 1) % 2;
     b0 = h->d[0].vis_block_cpu[!i_active];
     if (!h->coords_only)
     {
@@ -45,6 +52,13 @@ oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
                 oskar_mem_add(ac0, ac0, oskar_vis_block_auto_correlations(b),
                         0, 0, 0, oskar_mem_length(ac0), status);
         }
+
+        /* Sum the visibilities from all processes, if required. */
+        if (h->mpi_distribution == 'S')
+        {
+            oskar_interferometer_mpi_reduce_block(h, b0, status);
+            if (h->mpi_rank > 0) return b0;
+        }
     }
 
     /* Calculate (u,v,w) coordinates for the block. */
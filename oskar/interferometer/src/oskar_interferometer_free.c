@@ -29,6 +29,7 @@ void oskar_interferometer_free(oskar_Interferometer* h, int* status)
     oskar_barrier_free(h->barrier);
     oskar_log_free(h->log);
     free(h->sky_chunks);
+    free(h->sky_chunk_caps);
     free(h->gpu_ids);
     free(h->vis_name);
     free(h->ms_name);
@@ -39,7 +40,7 @@ void oskar_interferometer_free(oskar_Interferometer* h, int* status)
 
 void oskar_interferometer_free_device_data(oskar_Interferometer* h, int* status)
 {
-    int i;
+    int i, j;
     if (!h->d) return;
     for (i = 0; i < h->num_devices; ++i)
     {
@@ -50,6 +51,7 @@ void oskar_interferometer_free_device_data(oskar_Interferometer* h, int* status)
         oskar_timer_free(d->tmr_compute);
         oskar_timer_free(d->tmr_copy);
         oskar_timer_free(d->tmr_clip);
+        oskar_timer_free(d->tmr_time);
         oskar_timer_free(d->tmr_E);
         oskar_timer_free(d->tmr_K);
         oskar_timer_free(d->tmr_join);
@@ -65,12 +67,23 @@ void oskar_interferometer_free_device_data(oskar_Interferometer* h, int* status)
         oskar_mem_free(d->uvw[2], status);
         oskar_sky_free(d->chunk, status);
         oskar_sky_free(d->chunk_clip, status);
-        oskar_telescope_free(d->tel, status);
+        for (j = 0; j < d->num_chunk_merge; ++j)
+            oskar_sky_free(d->chunk_merge[j], status);
+        free(d->chunk_merge);
+        free(d->merge_first);
+        free(d->merge_last);
+        if (d->tel != h->tel)
+            oskar_telescope_free(d->tel, status);
         oskar_station_work_free(d->station_work, status);
         oskar_jones_free(d->J, status);
         oskar_jones_free(d->E, status);
         oskar_jones_free(d->K, status);
         oskar_jones_free(d->R, status);
+        for (j = 0; j < d->num_E_chan; ++j)
+            oskar_jones_free(d->E_chan[j], status);
+        free(d->E_chan);
+        for (j = 0; j < 4; ++j)
+            oskar_mem_free(d->flux_chan[j], status);
         oskar_mem_free(d->gains, status);
         memset(d, 0, sizeof(DeviceData));
     }
@@ -81,11 +94,13 @@ void oskar_interferometer_reset_cache(oskar_Interferometer* h, int* status)
     oskar_interferometer_free_device_data(h, status);
     oskar_binary_free(h->vis);
     oskar_vis_header_free(h->header, status);
+    oskar_vis_bda_free(h->bda, status);
 #ifndef OSKAR_NO_MS
     oskar_ms_close(h->ms);
 #endif
     h->vis = 0;
     h->header = 0;
+    h->bda = 0;
     h->ms = 0;
 }
 
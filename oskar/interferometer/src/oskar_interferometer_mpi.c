@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "interferometer/private_interferometer.h"
+#include "interferometer/private_interferometer_mpi.h"
+#include "interferometer/oskar_interferometer.h"
+
+#ifdef OSKAR_HAVE_MPI
+#include <mpi.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef OSKAR_HAVE_MPI
+
+/* Maximum number of bytes or values passed in a single MPI call. */
+#define MAX_COUNT (1 << 30)
+
+enum { TAG_HEADER = 1, TAG_DATA = 2 };
+
+/* Returns the arrays in the block which are sent between processes. */
+static int block_arrays_const(const oskar_VisBlock* block,
+        const oskar_Mem** arrays)
+{
+    int i, n = 0;
+    if (oskar_vis_block_has_cross_correlations(block))
+    {
+        arrays[n++] = oskar_vis_block_cross_correlations_const(block);
+        for (i = 0; i < 3; ++i)
+            arrays[n++] = oskar_vis_block_baseline_uvw_metres_const(block, i);
+    }
+    if (oskar_vis_block_has_auto_correlations(block))
+        arrays[n++] = oskar_vis_block_auto_correlations_const(block);
+    if (oskar_vis_block_has_station_coords(block))
+        for (i = 0; i < 3; ++i)
+            arrays[n++] = oskar_vis_block_station_uvw_metres_const(block, i);
+    return n;
+}
+
+static int block_arrays(oskar_VisBlock* block, oskar_Mem** arrays)
+{
+    int i, n = 0;
+    if (oskar_vis_block_has_cross_correlations(block))
+    {
+        arrays[n++] = oskar_vis_block_cross_correlations(block);
+        for (i = 0; i < 3; ++i)
+            arrays[n++] = oskar_vis_block_baseline_uvw_metres(block, i);
+    }
+    if (oskar_vis_block_has_auto_correlations(block))
+        arrays[n++] = oskar_vis_block_auto_correlations(block);
+    if (oskar_vis_block_has_station_coords(block))
+        for (i = 0; i < 3; ++i)
+            arrays[n++] = oskar_vis_block_station_uvw_metres(block, i);
+    return n;
+}
+
+#endif /* OSKAR_HAVE_MPI */
+
+
+void oskar_interferometer_mpi_init(oskar_Interferometer* h)
+{
+    h->mpi_rank = 0;
+    h->mpi_size = 1;
+#ifdef OSKAR_HAVE_MPI
+    int initialised = 0, finalised = 0;
+    MPI_Initialized(&initialised);
+    MPI_Finalized(&finalised);
+    if (initialised && !finalised)
+    {
+        MPI_Comm_rank(MPI_COMM_WORLD, &h->mpi_rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &h->mpi_size);
+    }
+#endif
+}
+
+
+void oskar_interferometer_mpi_check_status(oskar_Interferometer* h,
+        int* status)
+{
+    if (h->mpi_size < 2) return;
+#ifdef OSKAR_HAVE_MPI
+    /* Find the most negative and the most positive codes together. */
+    int in[2], out[2];
+    in[0] = *status;
+    in[1] = -*status;
+    MPI_Allreduce(in, out, 2, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    if (!*status) *status = out[0] ? out[0] : -out[1];
+#else
+    (void) status;
+#endif
+}
+
+
+void oskar_interferometer_mpi_send_block(oskar_Interferometer* h,
+        const oskar_VisBlock* block, int* status)
+{
+    if (h->mpi_size < 2) return;
+#ifdef OSKAR_HAVE_MPI
+    int i, hdr[5];
+    hdr[0] = *status ? *status : (block ? 0 : OSKAR_ERR_MEMORY_NOT_ALLOCATED);
+    hdr[1] = block ? oskar_vis_block_start_time_index(block) : 0;
+    hdr[2] = block ? oskar_vis_block_start_channel_index(block) : 0;
+    hdr[3] = block ? oskar_vis_block_num_times(block) : 0;
+    hdr[4] = block ? oskar_vis_block_num_channels(block) : 0;
+    MPI_Send(hdr, 5, MPI_INT, 0, TAG_HEADER, MPI_COMM_WORLD);
+    if (hdr[0]) return;
+    oskar_timer_resume(h->tmr_write);
+    const oskar_Mem* arrays[8];
+    const int num_arrays = block_arrays_const(block, arrays);
+    for (i = 0; i < num_arrays; ++i)
+    {
+        const char* ptr = (const char*) oskar_mem_void_const(arrays[i]);
+        size_t remaining = oskar_mem_length(arrays[i]) *
+                oskar_mem_element_size(oskar_mem_type(arrays[i]));
+        while (remaining > 0)
+        {
+            const int count = remaining > MAX_COUNT ?
+                    MAX_COUNT : (int) remaining;
+            MPI_Send(ptr, count, MPI_BYTE, 0, TAG_DATA, MPI_COMM_WORLD);
+            ptr += count;
+            remaining -= count;
+        }
+    }
+    oskar_timer_pause(h->tmr_write);
+#else
+    (void) block;
+    (void) status;
+#endif
+}
+
+
+void oskar_interferometer_mpi_recv_block(oskar_Interferometer* h,
+        oskar_VisBlock* block, int source, int* status)
+{
+    if (h->mpi_size < 2) return;
+#ifdef OSKAR_HAVE_MPI
+    int i, hdr[5], resize_status = 0;
+    MPI_Recv(hdr, 5, MPI_INT, source, TAG_HEADER, MPI_COMM_WORLD,
+            MPI_STATUS_IGNORE);
+    if (hdr[0])
+    {
+        if (!*status) *status = hdr[0];
+        return;
+    }
+
+    /* The data are on their way, so they must be received into a block
+     * of the right size even if there is an error on this process. */
+    oskar_timer_resume(h->tmr_write);
+    oskar_vis_block_resize(block, hdr[3], hdr[4],
+            oskar_vis_block_num_stations(block), &resize_status);
+    if (resize_status)
+        MPI_Abort(MPI_COMM_WORLD, resize_status);
+    oskar_vis_block_set_start_time_index(block, hdr[1]);
+    oskar_vis_block_set_start_channel_index(block, hdr[2]);
+    oskar_Mem* arrays[8];
+    const int num_arrays = block_arrays(block, arrays);
+    for (i = 0; i < num_arrays; ++i)
+    {
+        char* ptr = (char*) oskar_mem_void(arrays[i]);
+        size_t remaining = oskar_mem_length(arrays[i]) *
+                oskar_mem_element_size(oskar_mem_type(arrays[i]));
+        while (remaining > 0)
+        {
+            const int count = remaining > MAX_COUNT ?
+                    MAX_COUNT : (int) remaining;
+            MPI_Recv(ptr, count, MPI_BYTE, source, TAG_DATA, MPI_COMM_WORLD,
+                    MPI_STATUS_IGNORE);
+            ptr += count;
+            remaining -= count;
+        }
+    }
+    oskar_timer_pause(h->tmr_write);
+#else
+    (void) block;
+    (void) source;
+    (void) status;
+#endif
+}
+
+
+void oskar_interferometer_mpi_reduce_block(oskar_Interferometer* h,
+        oskar_VisBlock* block, int* status)
+{
+    if (h->mpi_size < 2) return;
+    oskar_interferometer_mpi_check_status(h, status);
+    if (*status) return;
+#ifdef OSKAR_HAVE_MPI
+    int i;
+    oskar_Mem* arrays[2];
+    int num_arrays = 0;
+    if (oskar_vis_block_has_cross_correlations(block))
+        arrays[num_arrays++] = oskar_vis_block_cross_correlations(block);
+    if (oskar_vis_block_has_auto_correlations(block))
+        arrays[num_arrays++] = oskar_vis_block_auto_correlations(block);
+    oskar_timer_resume(h->tmr_write);
+    for (i = 0; i < num_arrays; ++i)
+    {
+        const int type = oskar_mem_precision(arrays[i]);
+        const size_t value_size = oskar_mem_element_size(type);
+        const MPI_Datatype mpi_type =
+                (type == OSKAR_DOUBLE) ? MPI_DOUBLE : MPI_FLOAT;
+        char* ptr = (char*) oskar_mem_void(arrays[i]);
+        size_t remaining = oskar_mem_length(arrays[i]) *
+                oskar_mem_element_size(oskar_mem_type(arrays[i])) / value_size;
+        while (remaining > 0)
+        {
+            const int count = remaining > MAX_COUNT ?
+                    MAX_COUNT : (int) remaining;
+            if (h->mpi_rank == 0)
+                MPI_Reduce(MPI_IN_PLACE, ptr, count, mpi_type, MPI_SUM,
+                        0, MPI_COMM_WORLD);
+            else
+                MPI_Reduce(ptr, 0, count, mpi_type, MPI_SUM,
+                        0, MPI_COMM_WORLD);
+            ptr += count * value_size;
+            remaining -= count;
+        }
+    }
+    oskar_timer_pause(h->tmr_write);
+#else
+    (void) block;
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -6,7 +6,9 @@
 #include <stdlib.h>
 
 #include "interferometer/private_interferometer.h"
+#include "interferometer/private_interferometer_mpi.h"
 #include "interferometer/oskar_interferometer.h"
+#include "utility/oskar_get_num_procs.h"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -24,10 +26,19 @@ struct ThreadArgs
 };
 typedef struct ThreadArgs ThreadArgs;
 
+/* Returns the number of CPU threads used by CPU compute devices. */
+static int cpu_threads_in_use(const oskar_Interferometer* h)
+{
+    if (h->cpu_shared_memory)
+        return h->num_cpu_threads > 0 ?
+                h->num_cpu_threads : oskar_get_num_procs();
+    return h->num_devices - h->num_gpus;
+}
+
 static void* run_blocks(void* arg)
 {
     oskar_Interferometer* h;
-    int b, *status;
+    int b, i, *status;
 
     /* Get thread function arguments. */
     h = ((ThreadArgs*)arg)->h;
@@ -37,9 +48,22 @@ static void* run_blocks(void* arg)
     status = ((ThreadArgs*)arg)->status;
 
 #ifdef _OPENMP
-    /* Disable any nested parallelism. */
+    /* Disable any nested parallelism.
+     * In shared-memory CPU mode, the CPU device uses threads inside
+     * the kernels instead.
+     * The file writer thread can use any CPU cores not used by
+     * compute devices, e.g. to generate system noise. */
     omp_set_nested(0);
-    omp_set_num_threads(1);
+    if (h->cpu_shared_memory && device_id >= h->num_gpus)
+        omp_set_num_threads(cpu_threads_in_use(h));
+    else if (thread_id == 0)
+    {
+        const int num_free = oskar_get_num_procs() - (h->num_devices -
+                h->num_gpus > 0 ? cpu_threads_in_use(h) : 0);
+        omp_set_num_threads(num_free > 1 ? num_free : 1);
+    }
+    else
+        omp_set_num_threads(1);
 #endif
 
     /* Loop over visibility blocks, running simulation and file
@@ -54,17 +78,43 @@ static void* run_blocks(void* arg)
      * data are ready yet) and no simulation is performed for the last loop
      * counter (which corresponds to the last block + 1) as this iteration
      * simply writes the last block.
+     *
+     * If blocks are distributed between processes, each process simulates
+     * every mpi_size-th block, and sends it to the root process, which
+     * writes all the blocks in order.
      */
     const int num_blocks = oskar_interferometer_num_vis_blocks(h);
-    for (b = 0; b < num_blocks + 1; ++b)
+    const int distribute = h->mpi_distribution == 'B' && h->mpi_size > 1;
+    const int stride = distribute ? h->mpi_size : 1;
+    const int first = distribute ? h->mpi_rank : 0;
+    const int num_local = num_blocks > first ?
+            (num_blocks - first + stride - 1) / stride : 0;
+    for (b = 0; b < num_local + 1; ++b)
     {
-        if ((thread_id > 0 || num_threads == 1) && b < num_blocks)
-            oskar_interferometer_run_block(h, b, device_id, status);
+        const int i_block = first + b * stride;
+        if ((thread_id > 0 || num_threads == 1) && b < num_local)
+            oskar_interferometer_run_block(h, i_block, device_id, status);
         if (thread_id == 0 && b > 0)
         {
             oskar_VisBlock* block;
-            block = oskar_interferometer_finalise_block(h, b - 1, status);
-            oskar_interferometer_write_block(h, block, b - 1, status);
+            const int i_prev = i_block - stride;
+            block = oskar_interferometer_finalise_block(h, i_prev, status);
+            if (h->mpi_rank == 0)
+            {
+                oskar_interferometer_write_block(h, block, i_prev, status);
+
+                /* Receive the following blocks from the other processes. */
+                block = h->d[0].vis_block_cpu[(b - 1) % 2];
+                for (i = i_prev + 1; distribute &&
+                        i < i_prev + stride && i < num_blocks; ++i)
+                {
+                    oskar_interferometer_mpi_recv_block(h, block,
+                            i % stride, status);
+                    oskar_interferometer_write_block(h, block, i, status);
+                }
+            }
+            else if (distribute)
+                oskar_interferometer_mpi_send_block(h, block, status);
         }
 
         /* Barrier 1: Reset work unit index and print status. */
@@ -104,7 +154,13 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
     }
 
     /* Initialise if required. */
+    oskar_interferometer_mpi_init(h);
     oskar_interferometer_check_init(h, status);
+    oskar_interferometer_mpi_check_status(h, status);
+    if (h->mpi_size > 1)
+        oskar_log_message(h->log, 'M', 0, "Using %d processes, distributing "
+                "%s.", h->mpi_size, h->mpi_distribution == 'S' ?
+                        "sky chunks" : "visibility blocks");
 
     /* Set up worker threads. */
     const int num_threads = h->num_devices + 1;
@@ -134,6 +190,7 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
     free(args);
 
     /* Finalise. */
+    oskar_interferometer_mpi_check_status(h, status);
     oskar_interferometer_finalise(h, status);
 }
 
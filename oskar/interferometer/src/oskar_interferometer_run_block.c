@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2020, The OSKAR Developers.
+ * Copyright (c) 2011-2021, The OSKAR Developers.
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
@@ -11,19 +11,40 @@
 #include "convert/oskar_convert_mjd_to_gast_fast.h"
 #include "correlate/oskar_auto_correlate.h"
 #include "correlate/oskar_cross_correlate.h"
+#include "correlate/oskar_cross_correlate_phase.h"
+#include "correlate/oskar_cross_correlate_phase_channels.h"
 #include "interferometer/oskar_evaluate_jones_R.h"
 #include "interferometer/oskar_evaluate_jones_Z.h"
 #include "interferometer/oskar_evaluate_jones_E.h"
 #include "interferometer/oskar_evaluate_jones_K.h"
+#include "math/oskar_cmath.h"
 #include "utility/oskar_device.h"
 
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+static void sim_chunk(oskar_Interferometer* h, DeviceData* d,
+        oskar_Sky* sky, int device_id, int chunk_first, int chunk_last,
+        int time_index_start, int time_index_block, int chan_index_start,
+        int num_chans_block, int num_E, int* status);
+static void merge_sky(oskar_Sky* merged, const oskar_Sky* sky, int* status);
+static void sim_time(oskar_Interferometer* h, DeviceData* d,
+        const oskar_Sky* sky, int time_index_sim, int* status);
 static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
         oskar_Sky* sky, int channel_index_block, int time_index_block,
         int channel_index_sim, int time_index_sim, int* status);
+static void sim_baselines_channels(oskar_Interferometer* h, DeviceData* d,
+        oskar_Sky* sky, int num_chans, int num_E, int time_index_block,
+        int channel_index_sim, int time_index_sim, int* status);
+static int channel_batch_size(const oskar_Interferometer* h,
+        DeviceData* d, int num_chans);
+static int chunk_below_horizon(const double* cap,
+        const oskar_Telescope* tel, double gast);
 static unsigned int disp_width(unsigned int v);
 
 void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
@@ -79,23 +100,61 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
     oskar_vis_block_set_start_time_index(d->vis_block, time_index_start);
     oskar_vis_block_set_start_channel_index(d->vis_block, chan_index_start);
 
+    /* Check whether all channels in the block can be correlated together.
+     * If so, num_E is the number of station beams needed for them. */
+    const int num_E = channel_batch_size(h, d, num_chans_block);
+
+    /* With the horizon clip, small clipped chunks are merged with others
+     * for the same time, to keep the amount of work in each one even.
+     * Create the buffers for the merged chunks, if not already done. */
+    const int merge = h->apply_horizon_clip && total_chunks > 1;
+    if (merge && d->num_chunk_merge < num_times_block)
+    {
+        int i;
+        d->chunk_merge = (oskar_Sky**) realloc(d->chunk_merge,
+                num_times_block * sizeof(oskar_Sky*));
+        d->merge_first = (int*) realloc(d->merge_first,
+                num_times_block * sizeof(int));
+        d->merge_last = (int*) realloc(d->merge_last,
+                num_times_block * sizeof(int));
+        for (i = d->num_chunk_merge; i < num_times_block; ++i)
+        {
+            d->chunk_merge[i] = oskar_sky_create(h->prec,
+                    oskar_sky_mem_location(d->chunk), h->chunk_size, status);
+            oskar_sky_set_num_sources(d->chunk_merge[i], 0, status);
+        }
+        d->num_chunk_merge = num_times_block;
+    }
+
     /* Go though all possible work units in the block. A work unit is defined
-     * as the simulation for one time and one sky chunk. */
+     * as the simulation for one time and one sky chunk.
+     * The work units are ordered by chunk first, so each chunk is copied
+     * to the device only once for all the times it is used. */
     while (!h->coords_only)
     {
-        oskar_Sky* sky;
-        int i_channel;
-
         oskar_mutex_lock(h->mutex);
         const int i_work_unit = (h->work_unit_index)++;
         oskar_mutex_unlock(h->mutex);
         if ((i_work_unit >= num_times_block * total_chunks) || *status) break;
 
         /* Convert slice index to chunk/time index. */
-        const int i_chunk      = i_work_unit / num_times_block;
-        const int i_time       = i_work_unit - i_chunk * num_times_block;
+        const int i_chunk = i_work_unit / num_times_block;
+        const int i_time = i_work_unit - i_chunk * num_times_block;
         const int sim_time_idx = time_index_start + i_time;
 
+        /* Skip sky chunks simulated by other processes. */
+        if (h->mpi_distribution == 'S' &&
+                i_chunk % h->mpi_size != h->mpi_rank)
+            continue;
+
+        /* Skip the whole chunk if it is below every station's horizon. */
+        const double gast = oskar_convert_mjd_to_gast_fast(
+                obs_start_mjd + dt_dump_days * (sim_time_idx + 0.5));
+        if (h->apply_horizon_clip && h->sky_chunk_caps &&
+                chunk_below_horizon(&h->sky_chunk_caps[3 * i_chunk],
+                        d->tel, gast))
+            continue;
+
         /* Copy sky chunk to device only if different from the previous one. */
         if (i_chunk != d->previous_chunk_index)
         {
@@ -103,41 +162,68 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
             oskar_sky_copy(d->chunk, h->sky_chunks[i_chunk], status);
             oskar_timer_pause(d->tmr_copy);
         }
-        sky = h->apply_horizon_clip ? d->chunk_clip : d->chunk;
+        d->previous_chunk_index = i_chunk;
+        if (!h->apply_horizon_clip)
+        {
+            sim_chunk(h, d, d->chunk, device_id, i_chunk, i_chunk,
+                    time_index_start, i_time,
+                    chan_index_start, num_chans_block, num_E, status);
+            continue;
+        }
 
-        /* Apply horizon clip if required. */
-        if (h->apply_horizon_clip)
+        /* Apply horizon clip. */
+        oskar_timer_resume(d->tmr_clip);
+        oskar_sky_horizon_clip(d->chunk_clip, d->chunk, d->tel, gast,
+                d->station_work, status);
+        oskar_timer_pause(d->tmr_clip);
+
+        /* Simulate the clipped chunk on its own if it is at least half full,
+         * otherwise merge it with the others for this time. The merged
+         * chunks are simulated as soon as they are also half full,
+         * so they always fit in the chunk buffers. */
+        const int num_clip = oskar_sky_num_sources(d->chunk_clip);
+        if (!merge || 2 * num_clip >= h->chunk_size)
+        {
+            sim_chunk(h, d, d->chunk_clip, device_id, i_chunk, i_chunk,
+                    time_index_start, i_time,
+                    chan_index_start, num_chans_block, num_E, status);
+            continue;
+        }
+        if (num_clip == 0) continue;
+        oskar_Sky* merged = d->chunk_merge[i_time];
+        if (oskar_sky_num_sources(merged) == 0)
+            d->merge_first[i_time] = i_chunk;
+        d->merge_last[i_time] = i_chunk;
+        merge_sky(merged, d->chunk_clip, status);
+        if (2 * oskar_sky_num_sources(merged) >= h->chunk_size)
         {
-            double gast, mjd;
-            mjd = obs_start_mjd + dt_dump_days * (sim_time_idx + 0.5);
-            gast = oskar_convert_mjd_to_gast_fast(mjd);
-            oskar_timer_resume(d->tmr_clip);
-            oskar_sky_horizon_clip(d->chunk_clip, d->chunk, d->tel, gast,
-                    d->station_work, status);
-            oskar_timer_pause(d->tmr_clip);
+            sim_chunk(h, d, merged, device_id, d->merge_first[i_time],
+                    d->merge_last[i_time], time_index_start, i_time,
+                    chan_index_start, num_chans_block, num_E, status);
+            oskar_sky_set_num_sources(merged, 0, status);
         }
+    }
 
-        /* Simulate all baselines for all channels for this time and chunk. */
-        for (i_channel = 0; i_channel < num_chans_block; ++i_channel)
+    /* Simulate any chunks that are still merged. */
+    if (merge)
+    {
+        int i_time;
+        for (i_time = 0; i_time < num_times_block; ++i_time)
         {
-            if (*status) break;
-            const int sim_chan_idx = chan_index_start + i_channel;
-            oskar_mutex_lock(h->mutex);
-            oskar_log_message(h->log, 'S', 1, "Time %*i/%i, "
-                    "Chunk %*i/%i, Channel %*i/%i [Device %i, %i sources]",
-                    disp_width(total_times), sim_time_idx + 1, total_times,
-                    disp_width(total_chunks), i_chunk + 1, total_chunks,
-                    disp_width(total_chans), sim_chan_idx + 1, total_chans,
-                    device_id, oskar_sky_num_sources(sky));
-            oskar_mutex_unlock(h->mutex);
-            sim_baselines(h, d, sky, i_channel, i_time,
-                    sim_chan_idx, sim_time_idx, status);
+            oskar_Sky* merged = d->chunk_merge[i_time];
+            if (oskar_sky_num_sources(merged) == 0) continue;
+            sim_chunk(h, d, merged, device_id, d->merge_first[i_time],
+                    d->merge_last[i_time], time_index_start, i_time,
+                    chan_index_start, num_chans_block, num_E, status);
+            oskar_sky_set_num_sources(merged, 0, status);
         }
-        d->previous_chunk_index = i_chunk;
     }
 
-    /* Copy the visibility block to host memory. */
-    const int i_active = block_index % 2; /* Index of the active buffer. */
+    /* Copy the visibility block to host memory.
+     * If blocks are distributed between processes, this process
+     * only sees every mpi_size-th block. */
+    const int block_stride = h->mpi_distribution == 'B' ? h->mpi_size : 1;
+    const int i_active = (block_index / block_stride) % 2; /* Active buffer. */
     oskar_timer_resume(d->tmr_copy);
     oskar_vis_block_copy(d->vis_block_cpu[i_active], d->vis_block, status);
     oskar_timer_pause(d->tmr_copy);
@@ -145,6 +231,82 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
 }
 
 
+static void sim_chunk(oskar_Interferometer* h, DeviceData* d,
+        oskar_Sky* sky, int device_id, int chunk_first, int chunk_last,
+        int time_index_start, int time_index_block, int chan_index_start,
+        int num_chans_block, int num_E, int* status)
+{
+    int i_channel;
+    char chunks[64];
+    const int total_chunks = h->num_sky_chunks;
+    const int total_chans = h->num_channels;
+    const int total_times = h->num_time_steps;
+    const int sim_time_idx = time_index_start + time_index_block;
+    const int chan_index_end = chan_index_start + num_chans_block - 1;
+    if (*status) return;
+
+    /* Describe the chunk(s) being simulated. */
+    if (chunk_first == chunk_last)
+        sprintf(chunks, "Chunk %*i/%i",
+                disp_width(total_chunks), chunk_first + 1, total_chunks);
+    else
+        sprintf(chunks, "Chunks %*i-%*i/%i",
+                disp_width(total_chunks), chunk_first + 1,
+                disp_width(total_chunks), chunk_last + 1, total_chunks);
+
+    /* Evaluate everything which does not depend on frequency,
+     * then simulate all baselines for all channels for this
+     * time and chunk. */
+    sim_time(h, d, sky, sim_time_idx, status);
+    if (num_E > 0)
+    {
+        oskar_mutex_lock(h->mutex);
+        oskar_log_message(h->log, 'S', 1, "Time %*i/%i, "
+                "%s, Channels %*i-%*i/%i [Device %i, %i sources]",
+                disp_width(total_times), sim_time_idx + 1, total_times,
+                chunks,
+                disp_width(total_chans), chan_index_start + 1,
+                disp_width(total_chans), chan_index_end + 1, total_chans,
+                device_id, oskar_sky_num_sources(sky));
+        oskar_mutex_unlock(h->mutex);
+        sim_baselines_channels(h, d, sky, num_chans_block, num_E,
+                time_index_block, chan_index_start, sim_time_idx, status);
+    }
+    else for (i_channel = 0; i_channel < num_chans_block; ++i_channel)
+    {
+        if (*status) break;
+        const int sim_chan_idx = chan_index_start + i_channel;
+        oskar_mutex_lock(h->mutex);
+        oskar_log_message(h->log, 'S', 1, "Time %*i/%i, "
+                "%s, Channel %*i/%i [Device %i, %i sources]",
+                disp_width(total_times), sim_time_idx + 1, total_times,
+                chunks,
+                disp_width(total_chans), sim_chan_idx + 1, total_chans,
+                device_id, oskar_sky_num_sources(sky));
+        oskar_mutex_unlock(h->mutex);
+        sim_baselines(h, d, sky, i_channel, time_index_block,
+                sim_chan_idx, sim_time_idx, status);
+    }
+}
+
+
+static void merge_sky(oskar_Sky* merged, const oskar_Sky* sky, int* status)
+{
+    const int num_merged = oskar_sky_num_sources(merged);
+    const int num_sources = oskar_sky_num_sources(sky);
+    if (*status) return;
+    if (num_merged == 0)
+    {
+        oskar_sky_copy(merged, sky, status);
+        return;
+    }
+    oskar_sky_set_num_sources(merged, num_merged + num_sources, status);
+    oskar_sky_copy_contents(merged, sky, num_merged, 0, num_sources, status);
+    oskar_sky_set_use_extended(merged,
+            oskar_sky_use_extended(merged) || oskar_sky_use_extended(sky));
+}
+
+
 static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
         oskar_Sky* sky, int channel_index_block, int time_index_block,
         int channel_index_sim, int time_index_sim, int* status)
@@ -165,8 +327,8 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
 
     /* Get the time and frequency of the visibility slice being simulated. */
     const double dt_dump_days = h->time_inc_sec / 86400.0;
-    const double t_start = h->time_start_mjd_utc;
-    const double t_dump = t_start + dt_dump_days * (time_index_sim + 0.5);
+    const double t_dump = h->time_start_mjd_utc +
+            dt_dump_days * (time_index_sim + 0.5);
     const double gast_rad = oskar_convert_mjd_to_gast_fast(t_dump);
     const double freq = h->freq_start_hz + channel_index_sim * h->freq_inc_hz;
 
@@ -179,27 +341,14 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
             oskar_sky_V_const(sky)
     };
 
-    /* Get true station (u,v,w) coordinates. */
-    oskar_telescope_uvw(d->tel,
-            1, /* Use true coordinates. */
-            0, /* Do not ignore w-components. */
-            1, /* Single time sample. */
-            t_start, dt_dump_days, time_index_sim,
-            d->uvw[0], d->uvw[1], d->uvw[2], 0, 0, 0, status);
+    /* Station (u,v,w) coordinates were found by sim_time(). */
     const oskar_Mem* const uvw[] = { d->uvw[0], d->uvw[1], d->uvw[2] };
 
     /* Get source direction cosines. */
     const oskar_Mem* lmn[3];
     if (oskar_telescope_phase_centre_coord_type(d->tel) == OSKAR_COORDS_AZEL)
     {
-        /* Calculate ENU source direction cosines for array centre. */
-        const double lst_rad = gast_rad + oskar_telescope_lon_rad(d->tel);
-        oskar_convert_apparent_ra_dec_to_enu_directions(num_src,
-                oskar_sky_ra_rad_const(sky), oskar_sky_dec_rad_const(sky),
-                lst_rad, oskar_telescope_lat_rad(d->tel),
-                0, d->lmn[0], d->lmn[1], d->lmn[2], status);
-
-        /* Reference direction cosine scratch arrays. */
+        /* Reference ENU direction cosines found by sim_time(). */
         lmn[0] = d->lmn[0];
         lmn[1] = d->lmn[1];
         lmn[2] = d->lmn[2];
@@ -213,8 +362,6 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
     }
 
     /* Set dimensions of Jones matrices. */
-    if (d->R)
-        oskar_jones_set_size(d->R, num_stations, num_src, status);
     oskar_jones_set_size(d->J, num_stations, num_src, status);
     oskar_jones_set_size(d->E, num_stations, num_src, status);
     oskar_jones_set_size(d->K, num_stations, num_src, status);
@@ -231,33 +378,40 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
             d->tel, time_index_sim, gast_rad, freq, d->station_work, status);
     oskar_timer_pause(d->tmr_E);
 
-    /* Evaluate parallactic angle (Jones R: matrix), and join with Jones E.
-     * TODO Move this into station beam evaluation instead. */
+    /* Join Jones E with the parallactic angle (Jones R: matrix),
+     * which was evaluated by sim_time(). */
     if (d->R)
     {
-        oskar_timer_resume(d->tmr_E);
-        oskar_evaluate_jones_R(d->R, num_src,
-                oskar_sky_ra_rad_const(sky),
-                oskar_sky_dec_rad_const(sky),
-                d->tel, gast_rad, status);
-        oskar_timer_pause(d->tmr_E);
         oskar_timer_resume(d->tmr_join);
-        oskar_jones_join(d->R, d->E, d->R, status);
+        oskar_jones_join(0, d->E, d->R, status);
         oskar_timer_pause(d->tmr_join);
     }
 
-    /* Evaluate interferometer phase (Jones K: scalar). */
-    oskar_timer_resume(d->tmr_K);
-    oskar_evaluate_jones_K(d->K, num_src,
-            lmn[0], lmn[1], lmn[2], uvw[0], uvw[1], uvw[2],
-            freq, src_flux[0], h->source_min_jy, h->source_max_jy,
-            h->ignore_w_components, status);
-    oskar_timer_pause(d->tmr_K);
-
-    /* Multiply Jones matrix chain to get a single block. */
-    oskar_timer_resume(d->tmr_join);
-    oskar_jones_join(d->J, d->K, d->R ? d->R : d->E, status);
-    oskar_timer_pause(d->tmr_join);
+    /* On the CPU, if no source flux filter is used, the interferometer
+     * phase can be applied while cross-correlating, instead of evaluating
+     * Jones K and joining it with the station beam. As Jones K has unit
+     * amplitude, the auto-correlations do not depend on it. */
+    oskar_Jones* J = d->J;
+    const int fused = h->fused_correlation &&
+            oskar_jones_mem_location(d->J) == OSKAR_CPU &&
+            h->source_min_jy <= -DBL_MAX && h->source_max_jy >= DBL_MAX;
+    if (fused)
+        J = d->E;
+    else
+    {
+        /* Evaluate interferometer phase (Jones K: scalar). */
+        oskar_timer_resume(d->tmr_K);
+        oskar_evaluate_jones_K(d->K, num_src,
+                lmn[0], lmn[1], lmn[2], uvw[0], uvw[1], uvw[2],
+                freq, src_flux[0], h->source_min_jy, h->source_max_jy,
+                h->ignore_w_components, status);
+        oskar_timer_pause(d->tmr_K);
+
+        /* Multiply Jones matrix chain to get a single block. */
+        oskar_timer_resume(d->tmr_join);
+        oskar_jones_join(d->J, d->K, d->E, status);
+        oskar_timer_pause(d->tmr_join);
+    }
 
     /* Check whether gain model exists.
      * If so, evaluate gains and apply them. */
@@ -265,7 +419,7 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
     {
         oskar_gains_evaluate(oskar_telescope_gains(d->tel),
                 time_index_sim, freq, d->gains, status);
-        oskar_jones_apply_station_gains(d->J, d->gains, status);
+        oskar_jones_apply_station_gains(J, d->gains, status);
     }
 
     /* Calculate output offset. */
@@ -274,7 +428,7 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
 
     /* Auto-correlate for this time and channel. */
     if (oskar_vis_block_has_auto_correlations(d->vis_block))
-        oskar_auto_correlate(num_src, d->J, src_flux, num_stations * offset,
+        oskar_auto_correlate(num_src, J, src_flux, num_stations * offset,
                 oskar_vis_block_auto_correlations(d->vis_block), status);
 
     /* Cross-correlate for this time and channel. */
@@ -286,16 +440,265 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
             oskar_sky_gaussian_b_const(sky),
             oskar_sky_gaussian_c_const(sky)
         };
-        oskar_cross_correlate(
-                source_type, num_src, d->J,
-                src_flux, lmn, src_extended,
-                d->tel, uvw,
-                gast_rad, freq, num_baselines * offset,
-                oskar_vis_block_cross_correlations(d->vis_block), status);
+        if (fused)
+            oskar_cross_correlate_phase(
+                    source_type, num_src, J,
+                    src_flux, lmn, src_extended,
+                    d->tel, uvw,
+                    gast_rad, freq, h->ignore_w_components,
+                    num_baselines * offset,
+                    oskar_vis_block_cross_correlations(d->vis_block), status);
+        else
+            oskar_cross_correlate(
+                    source_type, num_src, J,
+                    src_flux, lmn, src_extended,
+                    d->tel, uvw,
+                    gast_rad, freq, num_baselines * offset,
+                    oskar_vis_block_cross_correlations(d->vis_block), status);
+    }
+    oskar_timer_pause(d->tmr_correlate);
+}
+
+
+static void sim_baselines_channels(oskar_Interferometer* h, DeviceData* d,
+        oskar_Sky* sky, int num_chans, int num_E, int time_index_block,
+        int channel_index_sim, int time_index_sim, int* status)
+{
+    int c, i;
+
+    /* Get dimensions. */
+    const int num_baselines   = oskar_telescope_num_baselines(d->tel);
+    const int num_stations    = oskar_telescope_num_stations(d->tel);
+    const int num_src         = oskar_sky_num_sources(sky);
+    const int num_times_block = oskar_vis_block_num_times(d->vis_block);
+    const int num_chans_block = oskar_vis_block_num_channels(d->vis_block);
+    if (*status || num_src == 0 || time_index_block >= num_times_block ||
+            num_chans > num_chans_block)
+        return;
+
+    /* Get the time and frequency of the visibility slice being simulated. */
+    const double dt_dump_days = h->time_inc_sec / 86400.0;
+    const double t_dump = h->time_start_mjd_utc +
+            dt_dump_days * (time_index_sim + 0.5);
+    const double gast_rad = oskar_convert_mjd_to_gast_fast(t_dump);
+    const double freq_start = h->freq_start_hz +
+            channel_index_sim * h->freq_inc_hz;
+
+    /* Create the per-channel work arrays, if not already done. */
+    if (d->num_E_chan < num_E)
+    {
+        d->E_chan = (oskar_Jones**) realloc(d->E_chan,
+                num_E * sizeof(oskar_Jones*));
+        for (c = d->num_E_chan; c < num_E; ++c)
+            d->E_chan[c] = oskar_jones_create(oskar_jones_type(d->E),
+                    oskar_jones_mem_location(d->E), num_stations,
+                    h->chunk_size, status);
+        d->num_E_chan = num_E;
+    }
+    for (i = 0; i < 4; ++i)
+    {
+        if (!d->flux_chan[i])
+            d->flux_chan[i] = oskar_mem_create(h->prec,
+                    oskar_jones_mem_location(d->E), 0, status);
+        oskar_mem_ensure(d->flux_chan[i], num_chans * num_src, status);
+    }
+
+    /* Station (u,v,w) coordinates were found by sim_time(). */
+    const oskar_Mem* const uvw[] = { d->uvw[0], d->uvw[1], d->uvw[2] };
+
+    /* Get source direction cosines. */
+    const oskar_Mem* lmn[3];
+    if (oskar_telescope_phase_centre_coord_type(d->tel) == OSKAR_COORDS_AZEL)
+    {
+        lmn[0] = d->lmn[0];
+        lmn[1] = d->lmn[1];
+        lmn[2] = d->lmn[2];
+    }
+    else
+    {
+        lmn[0] = oskar_sky_l_const(sky);
+        lmn[1] = oskar_sky_m_const(sky);
+        lmn[2] = oskar_sky_n_const(sky);
+    }
+    const oskar_Mem* const source_coords[] = {
+            oskar_sky_l_const(sky),
+            oskar_sky_m_const(sky),
+            oskar_sky_n_const(sky)
+    };
+    const oskar_Mem* const src_flux[] = {
+            oskar_sky_I_const(sky),
+            oskar_sky_Q_const(sky),
+            oskar_sky_U_const(sky),
+            oskar_sky_V_const(sky)
+    };
+
+    /* Evaluate everything which depends on frequency, channel by channel. */
+    for (c = 0; c < num_chans; ++c)
+    {
+        const double freq = freq_start + c * h->freq_inc_hz;
+        const int offset = num_chans_block * time_index_block + c;
+
+        /* Scale source fluxes and store them for the cross-correlation. */
+        oskar_sky_scale_flux_with_frequency(sky, freq, status);
+        for (i = 0; i < 4; ++i)
+            oskar_mem_copy_contents(d->flux_chan[i], src_flux[i],
+                    c * num_src, 0, num_src, status);
+
+        /* Evaluate and correct the station beam, if it depends on frequency
+         * or has not yet been evaluated for this time and chunk. */
+        oskar_Jones* E_c = d->E_chan[num_E > 1 ? c : 0];
+        if (c < num_E)
+        {
+            oskar_jones_set_size(E_c, num_stations, num_src, status);
+            oskar_timer_resume(d->tmr_E);
+            oskar_evaluate_jones_E(E_c, OSKAR_COORDS_REL_DIR, num_src,
+                    source_coords, oskar_sky_reference_ra_rad(sky),
+                    oskar_sky_reference_dec_rad(sky), d->tel, time_index_sim,
+                    gast_rad, freq, d->station_work, status);
+            oskar_timer_pause(d->tmr_E);
+            if (d->R)
+            {
+                oskar_timer_resume(d->tmr_join);
+                oskar_jones_join(0, E_c, d->R, status);
+                oskar_timer_pause(d->tmr_join);
+            }
+            if (oskar_gains_defined(oskar_telescope_gains(d->tel)))
+            {
+                oskar_gains_evaluate(oskar_telescope_gains(d->tel),
+                        time_index_sim, freq, d->gains, status);
+                oskar_jones_apply_station_gains(E_c, d->gains, status);
+            }
+        }
+
+        /* Auto-correlate for this time and channel. */
+        if (oskar_vis_block_has_auto_correlations(d->vis_block))
+        {
+            oskar_timer_resume(d->tmr_correlate);
+            oskar_auto_correlate(num_src, E_c, src_flux, num_stations * offset,
+                    oskar_vis_block_auto_correlations(d->vis_block), status);
+            oskar_timer_pause(d->tmr_correlate);
+        }
     }
+
+    /* Cross-correlate for this time and all channels together. */
+    const int source_type = oskar_sky_use_extended(sky);
+    const oskar_Mem* const src_flux_chan[] = {
+            d->flux_chan[0], d->flux_chan[1], d->flux_chan[2], d->flux_chan[3]
+    };
+    const oskar_Mem* const src_extended[] = {
+            oskar_sky_gaussian_a_const(sky),
+            oskar_sky_gaussian_b_const(sky),
+            oskar_sky_gaussian_c_const(sky)
+    };
+    oskar_timer_resume(d->tmr_correlate);
+    oskar_cross_correlate_phase_channels(source_type, num_src, num_chans,
+            num_E, (const oskar_Jones* const*) d->E_chan, src_flux_chan,
+            lmn, src_extended, d->tel, uvw, gast_rad, freq_start,
+            h->freq_inc_hz, h->ignore_w_components,
+            num_baselines * num_chans_block * time_index_block, num_baselines,
+            oskar_vis_block_cross_correlations(d->vis_block), status);
     oskar_timer_pause(d->tmr_correlate);
 }
 
+static int channel_batch_size(const oskar_Interferometer* h,
+        DeviceData* d, int num_chans)
+{
+    int i, num_E = 1;
+
+    /* Only the fused CPU correlator can process a block of channels. */
+    if (num_chans < 2 || !h->fused_correlation ||
+            oskar_jones_mem_location(d->E) != OSKAR_CPU ||
+            h->source_min_jy > -DBL_MAX || h->source_max_jy < DBL_MAX ||
+            !oskar_vis_block_has_cross_correlations(d->vis_block))
+        return 0;
+
+    /* The station beam is the same for all channels only if every station
+     * is isotropic, with no gains or ionospheric screen. */
+    if (oskar_gains_defined(oskar_telescope_gains(d->tel)) ||
+            oskar_telescope_ionosphere_screen_type(d->tel) != 'N')
+        num_E = num_chans;
+    const int num_station_models = oskar_telescope_num_station_models(d->tel);
+    for (i = 0; i < num_station_models; ++i)
+    {
+        const oskar_Station* s = oskar_telescope_station_const(d->tel, i);
+        if (oskar_station_type(s) != OSKAR_STATION_TYPE_ISOTROPIC)
+            num_E = num_chans;
+    }
+
+    /* Otherwise, a station beam is needed for every channel,
+     * so limit the memory used for them. */
+    const size_t jones_bytes = oskar_mem_element_size(oskar_jones_type(d->E)) *
+            oskar_telescope_num_stations(d->tel) * h->chunk_size;
+    if (num_E > 1 && num_E * jones_bytes > (((size_t)1) << 29))
+        return 0;
+    return num_E;
+}
+
+static void sim_time(oskar_Interferometer* h, DeviceData* d,
+        const oskar_Sky* sky, int time_index_sim, int* status)
+{
+    const int num_stations = oskar_telescope_num_stations(d->tel);
+    const int num_src = oskar_sky_num_sources(sky);
+    if (*status || num_src == 0) return;
+
+    /* Get the time of the visibility slice being simulated. */
+    const double dt_dump_days = h->time_inc_sec / 86400.0;
+    const double t_start = h->time_start_mjd_utc;
+    const double t_dump = t_start + dt_dump_days * (time_index_sim + 0.5);
+    const double gast_rad = oskar_convert_mjd_to_gast_fast(t_dump);
+    oskar_timer_resume(d->tmr_time);
+
+    /* Get true station (u,v,w) coordinates. */
+    oskar_telescope_uvw(d->tel,
+            1, /* Use true coordinates. */
+            0, /* Do not ignore w-components. */
+            1, /* Single time sample. */
+            t_start, dt_dump_days, time_index_sim,
+            d->uvw[0], d->uvw[1], d->uvw[2], 0, 0, 0, status);
+
+    /* Calculate ENU source direction cosines for array centre, if needed. */
+    if (oskar_telescope_phase_centre_coord_type(d->tel) == OSKAR_COORDS_AZEL)
+    {
+        const double lst_rad = gast_rad + oskar_telescope_lon_rad(d->tel);
+        oskar_convert_apparent_ra_dec_to_enu_directions(num_src,
+                oskar_sky_ra_rad_const(sky), oskar_sky_dec_rad_const(sky),
+                lst_rad, oskar_telescope_lat_rad(d->tel),
+                0, d->lmn[0], d->lmn[1], d->lmn[2], status);
+    }
+
+    /* Evaluate parallactic angle (Jones R: matrix).
+     * TODO Move this into station beam evaluation instead. */
+    if (d->R)
+    {
+        oskar_jones_set_size(d->R, num_stations, num_src, status);
+        oskar_evaluate_jones_R(d->R, num_src,
+                oskar_sky_ra_rad_const(sky),
+                oskar_sky_dec_rad_const(sky),
+                d->tel, gast_rad, status);
+    }
+    oskar_timer_pause(d->tmr_time);
+}
+
+static int chunk_below_horizon(const double* cap,
+        const oskar_Telescope* tel, double gast)
+{
+    int i;
+    const double ra = cap[0], dec = cap[1];
+    const double radius = cap[2] + 1e-6; /* Allow for rounding. */
+    if (radius >= 0.5 * M_PI) return 0;
+    const double sin_dec = sin(dec), cos_dec = cos(dec);
+    const double min_sin_el = -sin(radius);
+    const int num_station_models = oskar_telescope_num_station_models(tel);
+    for (i = 0; i < num_station_models; ++i)
+    {
+        const oskar_Station* s = oskar_telescope_station_const(tel, i);
+        const double lat = oskar_station_lat_rad(s);
+        const double ha = gast + oskar_station_lon_rad(s) - ra;
+        const double sin_el = sin(lat) * sin_dec + cos(lat) * cos_dec * cos(ha);
+        if (sin_el > min_sin_el) return 0;
+    }
+    return num_station_models > 0;
+}
 
 static unsigned int disp_width(unsigned int v)
 {
@@ -5,6 +5,7 @@
 
 #include "interferometer/private_interferometer.h"
 #include "interferometer/oskar_interferometer.h"
+#include "vis/oskar_vis_bda_write_ms.h"
 #include "vis/oskar_vis_block_write_ms.h"
 #include "vis/oskar_vis_header_write_ms.h"
 
@@ -21,7 +22,17 @@ void oskar_interferometer_write_block(oskar_Interferometer* h,
     if (h->ms_name && !h->ms)
         h->ms = oskar_vis_header_write_ms(h->header, h->ms_name,
                 h->force_polarised_ms, status);
-    if (h->ms) oskar_vis_block_write_ms(block, h->header, h->ms, status);
+    if (h->ms && h->bda)
+    {
+        /* Average the block, and write any averages that are complete. */
+        oskar_vis_bda_add_block(h->bda, block, status);
+        if (block_index == oskar_interferometer_num_vis_blocks(h) - 1)
+            oskar_vis_bda_flush(h->bda, status);
+        oskar_vis_bda_write_ms(h->bda, h->ms, status);
+        oskar_vis_bda_clear_rows(h->bda);
+    }
+    else if (h->ms)
+        oskar_vis_block_write_ms(block, h->header, h->ms, status);
 #endif
     if (h->vis_name && !h->vis)
         h->vis = oskar_vis_header_write(h->header, h->vis_name, status);
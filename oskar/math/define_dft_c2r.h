@@ -48,7 +48,7 @@
         for (int i = 0; i < chunk_size; ++i) {\
             FP re, im, t = xo * c_xy[i].x + yo * c_xy[i].y;\
             if (IS_3D) t += zo * c_z[i];\
-            SINCOS(-t, im, re);\
+            SINCOS_FP(FP, -t, im, re);\
             const FP2 d = c_d[i];\
             out += d.x * re; out -= d.y * im;\
         } BARRIER;\
@@ -71,7 +71,7 @@ OSKAR_REGISTER_KERNEL(NAME)
     for (i = 0; i < num_in; ++i) {\
         FP re, im, t = xo * x_in[i] + yo * y_in[i];\
         if (IS_3D) t += zo * z_in[i];\
-        SINCOS(-t, im, re);\
+        SINCOS_FP(FP, -t, im, re);\
         FP2 d = data_in[i];\
         d.x *= weight_in[i];\
         d.y *= weight_in[i];\
@@ -59,7 +59,7 @@
             for (int i = 0; i < chunk_size; ++i) {\
                 FP re, im, t = xo * c_xy[i].x + yo * c_xy[i].y;\
                 if (IS_3D) t += zo * c_z[i];\
-                SINCOS(t, im, re);\
+                SINCOS_FP(FP, t, im, re);\
                 t = re;\
                 const FP2 w = c_w[i];\
                 re *= w.x; re -= w.y * im;\
@@ -122,7 +122,7 @@ OSKAR_REGISTER_KERNEL(NAME)
     for (i = 0; i < num_in; ++i) {\
         FP re, im, t = xo * x_in[i] + yo * y_in[i];\
         if (IS_3D) t += zo * z_in[i];\
-        SINCOS(t, im, re);\
+        SINCOS_FP(FP, t, im, re);\
         t = re;\
         const FP2 w = weights_in[i];\
         re *= w.x; re -= w.y * im;\
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "math/oskar_sincos.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+
+static double ulp_error_d(double value, long double ref)
+{
+    const double r = (double) ref;
+    const double ulp = nextafter(fabs(r), DBL_MAX) - fabs(r);
+    return (double) (fabsl((long double) value - ref) / ulp);
+}
+
+static double ulp_error_f(float value, double ref)
+{
+    const float r = (float) ref;
+    const float ulp = nextafterf(fabsf(r), FLT_MAX) - fabsf(r);
+    return fabs((double) value - ref) / ulp;
+}
+
+TEST(sincos, double_precision)
+{
+    const double ranges[] = {1.0, 1e3, 1e6, 2e8};
+    srand(1);
+    for (int r = 0; r < 4; ++r)
+    {
+        double max_err = 0.0;
+        for (int i = 0; i < 200000; ++i)
+        {
+            double s = 0.0, c = 0.0;
+            const double x = ranges[r] * (2.0 * rand() / RAND_MAX - 1.0);
+            oskar_sincos_d(x, &s, &c);
+            const double err_s = ulp_error_d(s, sinl((long double) x));
+            const double err_c = ulp_error_d(c, cosl((long double) x));
+            if (err_s > max_err) max_err = err_s;
+            if (err_c > max_err) max_err = err_c;
+        }
+        EXPECT_LT(max_err, 2.5) << "Range: " << ranges[r];
+    }
+}
+
+TEST(sincos, single_precision)
+{
+    const double ranges[] = {1.0, 1e3, 1e6};
+    srand(2);
+    for (int r = 0; r < 3; ++r)
+    {
+        double max_err = 0.0;
+        for (int i = 0; i < 200000; ++i)
+        {
+            float s = 0.0f, c = 0.0f;
+            const float x = (float) (ranges[r] *
+                    (2.0 * rand() / RAND_MAX - 1.0));
+            oskar_sincos_f(x, &s, &c);
+            const double err_s = ulp_error_f(s, sin((double) x));
+            const double err_c = ulp_error_f(c, cos((double) x));
+            if (err_s > max_err) max_err = err_s;
+            if (err_c > max_err) max_err = err_c;
+        }
+        EXPECT_LT(max_err, 2.0) << "Range: " << ranges[r];
+    }
+}
+
+TEST(sincos, quadrant_boundaries)
+{
+    for (int k = -16; k <= 16; ++k)
+    {
+        double s = 0.0, c = 0.0;
+        float sf = 0.0f, cf = 0.0f;
+        const double x = k * M_PI / 4.0;
+        oskar_sincos_d(x, &s, &c);
+        oskar_sincos_f((float) x, &sf, &cf);
+        EXPECT_NEAR(sin(x), s, 1e-15);
+        EXPECT_NEAR(cos(x), c, 1e-15);
+        EXPECT_NEAR(sin(x), sf, 1e-6);
+        EXPECT_NEAR(cos(x), cf, 1e-6);
+    }
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "settings/oskar_option_parser.h"
+#include "math/oskar_sincos.h"
+#include "utility/oskar_timer.h"
+#include "oskar_version.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Evaluates sine and cosine of all input values using the C library.
+template <typename FP>
+static void loop_libm(int n, const FP* in, FP* out_s, FP* out_c)
+{
+    #pragma omp parallel for
+    for (int i = 0; i < n; ++i)
+    {
+        out_s[i] = std::sin(in[i]);
+        out_c[i] = std::cos(in[i]);
+    }
+}
+
+static void sincos_inline(float x, float* s, float* c)
+{
+    oskar_sincos_f(x, s, c);
+}
+
+static void sincos_inline(double x, double* s, double* c)
+{
+    oskar_sincos_d(x, s, c);
+}
+
+// Evaluates sine and cosine of all input values using oskar_sincos.
+template <typename FP>
+static void loop_inline(int n, const FP* in, FP* out_s, FP* out_c)
+{
+    #pragma omp parallel for
+    for (int i = 0; i < n; ++i)
+    {
+        sincos_inline(in[i], &out_s[i], &out_c[i]);
+    }
+}
+
+// Direct Fourier transform to the real plane, as in the DFT imager,
+// using the C library.
+template <typename FP>
+static void dft_libm(int n_in, int n_out, const FP* u, const FP* v,
+        const FP* re, const FP* im, const FP* l, const FP* m, FP* out)
+{
+    #pragma omp parallel for
+    for (int j = 0; j < n_out; ++j)
+    {
+        FP sum = (FP) 0;
+        for (int i = 0; i < n_in; ++i)
+        {
+            const FP t = u[i] * l[j] + v[i] * m[j];
+            sum += re[i] * std::cos(t) - im[i] * std::sin(t);
+        }
+        out[j] = sum;
+    }
+}
+
+// Direct Fourier transform to the real plane, using oskar_sincos.
+template <typename FP>
+static void dft_inline(int n_in, int n_out, const FP* u, const FP* v,
+        const FP* re, const FP* im, const FP* l, const FP* m, FP* out)
+{
+    #pragma omp parallel for
+    for (int j = 0; j < n_out; ++j)
+    {
+        FP sum = (FP) 0;
+        for (int i = 0; i < n_in; ++i)
+        {
+            FP s, c;
+            const FP t = u[i] * l[j] + v[i] * m[j];
+            sincos_inline(t, &s, &c);
+            sum += re[i] * c - im[i] * s;
+        }
+        out[j] = sum;
+    }
+}
+
+template <typename FP>
+static void benchmark(int n, int niter, oskar_Timer* tmr)
+{
+    const int n_dft = (int) sqrt((double) n);
+    std::vector<FP> in(n), out_s(n), out_c(n), ref_s(n), ref_c(n);
+    std::vector<FP> l(n_dft), m(n_dft), out(n_dft), ref(n_dft);
+    srand(1);
+    for (int i = 0; i < n; ++i)
+    {
+        in[i] = (FP) (2e4 * (rand() / (double) RAND_MAX - 0.5));
+    }
+    for (int i = 0; i < n_dft; ++i)
+    {
+        l[i] = (FP) (rand() / (double) RAND_MAX - 0.5);
+        m[i] = (FP) (rand() / (double) RAND_MAX - 0.5);
+    }
+    const FP* u = &in[0];
+    const FP* v = &in[n_dft];
+    const FP* re = &out_s[0];
+    const FP* im = &out_c[0];
+
+    // Time the sine and cosine evaluation on its own.
+    double t_libm = 0.0, t_inline = 0.0, max_err = 0.0;
+    for (int k = 0; k < niter; ++k)
+    {
+        oskar_timer_start(tmr);
+        loop_libm(n, &in[0], &ref_s[0], &ref_c[0]);
+        t_libm += oskar_timer_elapsed(tmr);
+        oskar_timer_start(tmr);
+        loop_inline(n, &in[0], &out_s[0], &out_c[0]);
+        t_inline += oskar_timer_elapsed(tmr);
+    }
+    for (int i = 0; i < n; ++i)
+    {
+        const double err_s = fabs((double) (out_s[i] - ref_s[i]));
+        const double err_c = fabs((double) (out_c[i] - ref_c[i]));
+        if (err_s > max_err) max_err = err_s;
+        if (err_c > max_err) max_err = err_c;
+    }
+    printf("  sincos (%d values): libm %.4f s, inline %.4f s, "
+            "speed-up %.2fx, max abs diff %.3e\n", n,
+            t_libm / niter, t_inline / niter, t_libm / t_inline, max_err);
+
+    // Time a DFT, which is dominated by the evaluation of the phase factor.
+    t_libm = t_inline = max_err = 0.0;
+    for (int k = 0; k < niter; ++k)
+    {
+        oskar_timer_start(tmr);
+        dft_libm(n_dft, n_dft, u, v, re, im, &l[0], &m[0], &ref[0]);
+        t_libm += oskar_timer_elapsed(tmr);
+        oskar_timer_start(tmr);
+        dft_inline(n_dft, n_dft, u, v, re, im, &l[0], &m[0], &out[0]);
+        t_inline += oskar_timer_elapsed(tmr);
+    }
+    for (int i = 0; i < n_dft; ++i)
+    {
+        const double err = fabs((double) (out[i] - ref[i]));
+        if (err > max_err) max_err = err;
+    }
+    printf("  DFT (%d x %d): libm %.4f s, inline %.4f s, "
+            "speed-up %.2fx, max abs diff %.3e\n", n_dft, n_dft,
+            t_libm / niter, t_inline / niter, t_libm / t_inline, max_err);
+}
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_sincos_benchmark", OSKAR_VERSION_STR);
+    opt.add_flag("-n", "Number of values.", 1, "4000000", false);
+    opt.add_flag("-i", "Number of iterations.", 1, "5", false);
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+    const int n = opt.get_int("-n");
+    const int niter = opt.get_int("-i");
+    oskar_Timer* tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    printf("Single precision:\n");
+    benchmark<float>(n, niter, tmr);
+    printf("Double precision:\n");
+    benchmark<double>(n, niter, tmr);
+    oskar_timer_free(tmr);
+    return EXIT_SUCCESS;
+}
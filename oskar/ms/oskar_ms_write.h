@@ -73,6 +73,31 @@ void oskar_ms_write_coords_d(oskar_MeasurementSet* p,
         const double* uu, const double* vv, const double* ww,
         double exposure_sec, double interval_sec, double time_stamp);
 
+/**
+ * @details
+ * Writes baseline coordinate data to the main table, with error checking.
+ *
+ * @details
+ * This function is the same as oskar_ms_write_coords_d(), but also
+ * returns an error code if the column buffers could not be allocated.
+ *
+ * @param[in] start_row     The start row index to write (zero-based).
+ * @param[in] num_baselines Number of rows to write to the main table.
+ * @param[in] uu            Baseline u-coordinates, in metres.
+ * @param[in] vv            Baseline v-coordinates, in metres.
+ * @param[in] ww            Baseline w-coordinates, in metres.
+ * @param[in] exposure_sec  The exposure length per visibility, in seconds.
+ * @param[in] interval_sec  The interval length per visibility, in seconds.
+ * @param[in] time_stamp    Time stamp of coordinate data.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_MS_EXPORT
+void oskar_ms_write_coords_status_d(oskar_MeasurementSet* p,
+        unsigned int start_row, unsigned int num_baselines,
+        const double* uu, const double* vv, const double* ww,
+        double exposure_sec, double interval_sec, double time_stamp,
+        int* status);
+
 /**
  * @details
  * Writes baseline coordinate data to the main table.
@@ -107,6 +132,31 @@ void oskar_ms_write_coords_f(oskar_MeasurementSet* p,
         const float* uu, const float* vv, const float* ww,
         double exposure_sec, double interval_sec, double time_stamp);
 
+/**
+ * @details
+ * Writes baseline coordinate data to the main table, with error checking.
+ *
+ * @details
+ * This function is the same as oskar_ms_write_coords_f(), but also
+ * returns an error code if the column buffers could not be allocated.
+ *
+ * @param[in] start_row     The start row index to write (zero-based).
+ * @param[in] num_baselines Number of rows to write to the main table.
+ * @param[in] uu            Baseline u-coordinates, in metres.
+ * @param[in] vv            Baseline v-coordinates, in metres.
+ * @param[in] ww            Baseline w-coordinates, in metres.
+ * @param[in] exposure_sec  The exposure length per visibility, in seconds.
+ * @param[in] interval_sec  The interval length per visibility, in seconds.
+ * @param[in] time_stamp    Time stamp of coordinate data.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_MS_EXPORT
+void oskar_ms_write_coords_status_f(oskar_MeasurementSet* p,
+        unsigned int start_row, unsigned int num_baselines,
+        const float* uu, const float* vv, const float* ww,
+        double exposure_sec, double interval_sec, double time_stamp,
+        int* status);
+
 /**
  * @details
  * Writes visibility data to the main table.
@@ -173,6 +223,48 @@ void oskar_ms_write_vis_f(oskar_MeasurementSet* p,
         unsigned int num_channels, unsigned int num_baselines,
         const float* vis);
 
+/**
+ * @details
+ * Writes rows with explicit baselines and time stamps to the main table.
+ *
+ * @details
+ * This function writes the given rows of baseline coordinates and
+ * visibility data to the main table of the Measurement Set, extending it
+ * if necessary. Unlike oskar_ms_write_coords_d() and oskar_ms_write_vis_d(),
+ * the antenna indices, time stamps and integration lengths are given
+ * explicitly for each row, so the rows need not be regularly spaced in time.
+ * This is used to write baseline-dependent averaged data.
+ *
+ * The time stamps are given in units of (MJD) * 86400, i.e. seconds since
+ * Julian date 2400000.5.
+ *
+ * The dimensionality of the complex \p vis data block is:
+ * (num_rows * num_channels * num_pols),
+ * with num_pols the fastest varying dimension, then num_channels,
+ * and num_rows the slowest.
+ *
+ * @param[in] start_row     The start row index to write (zero-based).
+ * @param[in] num_rows      Number of rows to write to the main table.
+ * @param[in] antenna1      First antenna index of each row.
+ * @param[in] antenna2      Second antenna index of each row.
+ * @param[in] uu            Baseline u-coordinates, in metres.
+ * @param[in] vv            Baseline v-coordinates, in metres.
+ * @param[in] ww            Baseline w-coordinates, in metres.
+ * @param[in] time_centroid Time centroid of each row.
+ * @param[in] interval_sec  The interval length of each row, in seconds.
+ * @param[in] exposure_sec  The exposure length of each row, in seconds.
+ * @param[in] weight        The weight of each row.
+ * @param[in] vis           Pointer to complex visibility block.
+ */
+OSKAR_MS_EXPORT
+void oskar_ms_write_rows(oskar_MeasurementSet* p,
+        unsigned int start_row, unsigned int num_rows,
+        const int* antenna1, const int* antenna2,
+        const double* uu, const double* vv, const double* ww,
+        const double* time_centroid, const double* interval_sec,
+        const double* exposure_sec, const double* weight,
+        const float* vis);
+
 #ifdef __cplusplus
 }
 #endif
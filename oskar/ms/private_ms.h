@@ -31,7 +31,11 @@ struct oskar_MeasurementSet
     casacore::MSMainColumns* msmc;  // Pointer to the main columns.
 #endif
     char* app_name;
-    unsigned int *a1, *a2;
+    int *a1, *a2;
+    double *coord_buf;    // Column data for oskar_ms_write_coords().
+    float *coord_ones;    // Constant WEIGHT and SIGMA values.
+    unsigned int coord_buf_rows;
+    double coord_exposure_sec, coord_interval_sec;
     unsigned int num_pols, num_channels, num_stations, num_receptors;
     int data_written;
     int phase_centre_type;
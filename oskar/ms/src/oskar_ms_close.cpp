@@ -23,6 +23,8 @@ void oskar_ms_close(oskar_MeasurementSet* p)
         delete p->ms;
     free(p->a1);
     free(p->a2);
+    free(p->coord_buf);
+    free(p->coord_ones);
     free(p->app_name);
     free(p);
 }
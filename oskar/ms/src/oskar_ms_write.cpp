@@ -5,20 +5,35 @@
 
 #include "ms/oskar_measurement_set.h"
 #include "ms/private_ms.h"
+#include "oskar_global.h"
 
 #include <tables/Tables.h>
+#include <casa/Arrays/Matrix.h>
 #include <casa/Arrays/Vector.h>
 
+#include <cmath>
+#include <cstring>
+
 using namespace casacore;
 
 static void oskar_ms_create_baseline_indices(oskar_MeasurementSet* p,
-        unsigned int num_baselines)
+        unsigned int num_baselines, int* status)
 {
     bool write_auto_corr = false, write_cross_corr = false;
     unsigned int num_stations = p->num_stations;
-    size_t size_bytes = num_baselines * sizeof(unsigned int);
-    p->a1 = (unsigned int*) realloc(p->a1, size_bytes);
-    p->a2 = (unsigned int*) realloc(p->a2, size_bytes);
+    size_t size_bytes = num_baselines * sizeof(int);
+    int* a1 = (int*) realloc(p->a1, size_bytes);
+    if (a1) p->a1 = a1;
+    int* a2 = (int*) realloc(p->a2, size_bytes);
+    if (a2) p->a2 = a2;
+    if (!a1 || !a2)
+    {
+        free(p->a1);
+        free(p->a2);
+        p->a1 = p->a2 = 0;
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
     if (num_baselines == num_stations * (num_stations + 1) / 2)
     {
         write_auto_corr = true;
@@ -40,16 +55,16 @@ static void oskar_ms_create_baseline_indices(oskar_MeasurementSet* p,
         {
             if (write_auto_corr)
             {
-                p->a1[i] = s1;
-                p->a2[i] = s1;
+                p->a1[i] = (int) s1;
+                p->a2[i] = (int) s1;
                 ++i;
             }
             if (write_cross_corr)
             {
                 for (unsigned int s2 = s1 + 1; s2 < num_stations; ++i, ++s2)
                 {
-                    p->a1[i] = s1;
-                    p->a2[i] = s2;
+                    p->a1[i] = (int) s1;
+                    p->a2[i] = (int) s2;
                 }
             }
         }
@@ -65,11 +80,11 @@ template <typename T>
 void oskar_ms_write_coords(oskar_MeasurementSet* p,
         unsigned int start_row, unsigned int num_baselines,
         const T* uu, const T* vv, const T* ww,
-        double exposure_sec, double interval_sec, double time_stamp)
+        double exposure_sec, double interval_sec, double time_stamp,
+        int* status)
 {
-    // Allocate storage for a (u,v,w) coordinate and a visibility weight.
-    Vector<Double> uvw(3);
-    Vector<Float> weight(p->num_pols, 1.0), sigma(p->num_pols, 1.0);
+    if (*status) return;
+    const unsigned int num_pols = p->num_pols;
 
     // Get references to columns.
 #ifdef OSKAR_MS_NEW
@@ -101,25 +116,78 @@ void oskar_ms_write_coords(oskar_MeasurementSet* p,
 
     // Create baseline antenna indices if required.
     if (!p->a1 || !p->a2)
-        oskar_ms_create_baseline_indices(p, num_baselines);
+        oskar_ms_create_baseline_indices(p, num_baselines, status);
+    if (*status) return;
 
-    // Loop over rows to add.
-    for (unsigned int r = 0; r < num_baselines; ++r)
+    // Resize the column buffers if required, and set the constant values.
+    const unsigned int n = num_baselines;
+    if (n == 0) return;
+    if (p->coord_buf_rows < n)
+    {
+        double* coord_buf = (double*) realloc(p->coord_buf,
+                6 * n * sizeof(double));
+        if (coord_buf) p->coord_buf = coord_buf;
+        float* coord_ones = (float*) realloc(p->coord_ones,
+                num_pols * n * sizeof(float));
+        if (coord_ones) p->coord_ones = coord_ones;
+        if (!coord_buf || !coord_ones)
+        {
+            free(p->coord_buf);
+            free(p->coord_ones);
+            p->coord_buf = 0;
+            p->coord_ones = 0;
+            p->coord_buf_rows = 0;
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+        for (unsigned int i = 0; i < num_pols * n; ++i)
+            p->coord_ones[i] = 1.0f;
+        p->coord_buf_rows = n;
+        p->coord_exposure_sec = p->coord_interval_sec = -1.0;
+    }
+    const unsigned int max_rows = p->coord_buf_rows;
+    double *buf_uvw = p->coord_buf, *buf_time = p->coord_buf + 3 * max_rows;
+    double *buf_exposure = p->coord_buf + 4 * max_rows;
+    double *buf_interval = p->coord_buf + 5 * max_rows;
+    if (exposure_sec != p->coord_exposure_sec)
+    {
+        for (unsigned int r = 0; r < max_rows; ++r)
+            buf_exposure[r] = exposure_sec;
+        p->coord_exposure_sec = exposure_sec;
+    }
+    if (interval_sec != p->coord_interval_sec)
+    {
+        for (unsigned int r = 0; r < max_rows; ++r)
+            buf_interval[r] = interval_sec;
+        p->coord_interval_sec = interval_sec;
+    }
+    for (unsigned int r = 0; r < n; ++r)
     {
-        // Write the data to the Measurement Set.
-        unsigned int row = r + start_row;
-        uvw(0) = uu[r]; uvw(1) = vv[r]; uvw(2) = ww[r];
-        col_uvw.put(row, uvw);
-        col_antenna1.put(row, p->a1[r]);
-        col_antenna2.put(row, p->a2[r]);
-        col_weight.put(row, weight);
-        col_sigma.put(row, sigma);
-        col_exposure.put(row, exposure_sec);
-        col_interval.put(row, interval_sec);
-        col_time.put(row, time_stamp);
-        col_timeCentroid.put(row, time_stamp);
+        buf_uvw[3 * r]     = uu[r];
+        buf_uvw[3 * r + 1] = vv[r];
+        buf_uvw[3 * r + 2] = ww[r];
+        buf_time[r] = time_stamp;
     }
 
+    // Wrap the buffers, without copying, and write whole column ranges.
+    Matrix<Double> uvw(IPosition(2, 3, n), buf_uvw, SHARE);
+    Vector<Double> time(IPosition(1, n), buf_time, SHARE);
+    Vector<Double> exposure(IPosition(1, n), buf_exposure, SHARE);
+    Vector<Double> interval(IPosition(1, n), buf_interval, SHARE);
+    Vector<Int> antenna1(IPosition(1, n), p->a1, SHARE);
+    Vector<Int> antenna2(IPosition(1, n), p->a2, SHARE);
+    Matrix<Float> ones(IPosition(2, num_pols, n), p->coord_ones, SHARE);
+    Slicer row_range(IPosition(1, start_row), IPosition(1, n));
+    col_uvw.putColumnRange(row_range, uvw);
+    col_antenna1.putColumnRange(row_range, antenna1);
+    col_antenna2.putColumnRange(row_range, antenna2);
+    col_weight.putColumnRange(row_range, ones);
+    col_sigma.putColumnRange(row_range, ones);
+    col_exposure.putColumnRange(row_range, exposure);
+    col_interval.putColumnRange(row_range, interval);
+    col_time.putColumnRange(row_range, time);
+    col_timeCentroid.putColumnRange(row_range, time);
+
     // Update time range if required.
     if (time_stamp < p->start_time)
         p->start_time = time_stamp - interval_sec/2.0;
@@ -134,8 +202,19 @@ void oskar_ms_write_coords_d(oskar_MeasurementSet* p,
         const double* uu, const double* vv, const double* ww,
         double exposure_sec, double interval_sec, double time_stamp)
 {
+    int status = 0;
     oskar_ms_write_coords(p, start_row, num_baselines, uu, vv, ww,
-            exposure_sec, interval_sec, time_stamp);
+            exposure_sec, interval_sec, time_stamp, &status);
+}
+
+void oskar_ms_write_coords_status_d(oskar_MeasurementSet* p,
+        unsigned int start_row, unsigned int num_baselines,
+        const double* uu, const double* vv, const double* ww,
+        double exposure_sec, double interval_sec, double time_stamp,
+        int* status)
+{
+    oskar_ms_write_coords(p, start_row, num_baselines, uu, vv, ww,
+            exposure_sec, interval_sec, time_stamp, status);
 }
 
 void oskar_ms_write_coords_f(oskar_MeasurementSet* p,
@@ -143,8 +222,19 @@ void oskar_ms_write_coords_f(oskar_MeasurementSet* p,
         const float* uu, const float* vv, const float* ww,
         double exposure_sec, double interval_sec, double time_stamp)
 {
+    int status = 0;
     oskar_ms_write_coords(p, start_row, num_baselines, uu, vv, ww,
-            exposure_sec, interval_sec, time_stamp);
+            exposure_sec, interval_sec, time_stamp, &status);
+}
+
+void oskar_ms_write_coords_status_f(oskar_MeasurementSet* p,
+        unsigned int start_row, unsigned int num_baselines,
+        const float* uu, const float* vv, const float* ww,
+        double exposure_sec, double interval_sec, double time_stamp,
+        int* status)
+{
+    oskar_ms_write_coords(p, start_row, num_baselines, uu, vv, ww,
+            exposure_sec, interval_sec, time_stamp, status);
 }
 
 template <typename T>
@@ -212,3 +302,95 @@ void oskar_ms_write_vis_f(oskar_MeasurementSet* p,
     oskar_ms_write_vis(p, start_row, start_channel,
             num_channels, num_baselines, vis);
 }
+
+void oskar_ms_write_rows(oskar_MeasurementSet* p,
+        unsigned int start_row, unsigned int num_rows,
+        const int* antenna1, const int* antenna2,
+        const double* uu, const double* vv, const double* ww,
+        const double* time_centroid, const double* interval_sec,
+        const double* exposure_sec, const double* weight,
+        const float* vis)
+{
+    if (num_rows == 0) return;
+    const unsigned int num_pols = p->num_pols;
+    const unsigned int num_channels = p->num_channels;
+
+    // Get references to columns.
+#ifdef OSKAR_MS_NEW
+    ArrayColumn<Double>& col_uvw = p->msmc.uvw;
+    ScalarColumn<Int>& col_antenna1 = p->msmc.antenna1;
+    ScalarColumn<Int>& col_antenna2 = p->msmc.antenna2;
+    ArrayColumn<Float>& col_weight = p->msmc.weight;
+    ArrayColumn<Float>& col_sigma = p->msmc.sigma;
+    ScalarColumn<Double>& col_exposure = p->msmc.exposure;
+    ScalarColumn<Double>& col_interval = p->msmc.interval;
+    ScalarColumn<Double>& col_time = p->msmc.time;
+    ScalarColumn<Double>& col_timeCentroid = p->msmc.timeCentroid;
+    ArrayColumn<Complex>& col_data = p->msmc.data;
+#else
+    MSMainColumns* msmc = p->msmc;
+    if (!msmc) return;
+    ArrayColumn<Double>& col_uvw = msmc->uvw();
+    ScalarColumn<Int>& col_antenna1 = msmc->antenna1();
+    ScalarColumn<Int>& col_antenna2 = msmc->antenna2();
+    ArrayColumn<Float>& col_weight = msmc->weight();
+    ArrayColumn<Float>& col_sigma = msmc->sigma();
+    ScalarColumn<Double>& col_exposure = msmc->exposure();
+    ScalarColumn<Double>& col_interval = msmc->interval();
+    ScalarColumn<Double>& col_time = msmc->time();
+    ScalarColumn<Double>& col_timeCentroid = msmc->timeCentroid();
+    ArrayColumn<Complex>& col_data = msmc->data();
+#endif
+
+    // Assemble the column data for the whole range of rows.
+    Vector<Int> ant1(num_rows), ant2(num_rows);
+    Vector<Double> time(num_rows), interval(num_rows), exposure(num_rows);
+    Matrix<Double> uvw(3, num_rows);
+    Matrix<Float> weights(num_pols, num_rows), sigmas(num_pols, num_rows);
+    for (unsigned int r = 0; r < num_rows; ++r)
+    {
+        ant1(r) = antenna1[r];
+        ant2(r) = antenna2[r];
+        uvw(0, r) = uu[r];
+        uvw(1, r) = vv[r];
+        uvw(2, r) = ww[r];
+        time(r) = time_centroid[r];
+        interval(r) = interval_sec[r];
+        exposure(r) = exposure_sec[r];
+        for (unsigned int i = 0; i < num_pols; ++i)
+        {
+            weights(i, r) = (Float) weight[r];
+            sigmas(i, r) = (Float) (1.0 / sqrt(weight[r]));
+        }
+    }
+    IPosition shape(3, num_pols, num_channels, num_rows);
+    Array<Complex> vis_data(shape);
+    memcpy((void*) vis_data.data(), vis,
+            2 * sizeof(float) * num_pols * num_channels * num_rows);
+
+    // Add new rows if required.
+    oskar_ms_ensure_num_rows(p, start_row + num_rows);
+
+    // Write the columns.
+    Slicer row_range(IPosition(1, start_row), IPosition(1, num_rows));
+    col_antenna1.putColumnRange(row_range, ant1);
+    col_antenna2.putColumnRange(row_range, ant2);
+    col_uvw.putColumnRange(row_range, uvw);
+    col_weight.putColumnRange(row_range, weights);
+    col_sigma.putColumnRange(row_range, sigmas);
+    col_exposure.putColumnRange(row_range, exposure);
+    col_interval.putColumnRange(row_range, interval);
+    col_time.putColumnRange(row_range, time);
+    col_timeCentroid.putColumnRange(row_range, time);
+    col_data.putColumnRange(row_range, vis_data);
+
+    // Update time range if required.
+    for (unsigned int r = 0; r < num_rows; ++r)
+    {
+        if (time(r) - interval(r) / 2.0 < p->start_time)
+            p->start_time = time(r) - interval(r) / 2.0;
+        if (time(r) + interval(r) / 2.0 > p->end_time)
+            p->end_time = time(r) + interval(r) / 2.0;
+    }
+    p->data_written = 1;
+}
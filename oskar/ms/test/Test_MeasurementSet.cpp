@@ -33,6 +33,7 @@
 
 TEST(MeasurementSet, test_create_simple)
 {
+    int status = 0;
     oskar_MeasurementSet* ms;
 
     // Add some dummy antenna positions.
@@ -51,7 +52,9 @@ TEST(MeasurementSet, test_create_simple)
     double w[] = {0.0, -56.0, 145.0};
     double vis[] = {1.0, 0.0, 0.00, 0.0, 0.00, 0.0};
     int num_baselines = sizeof(u) / sizeof(double);
-    oskar_ms_write_coords_d(ms, 0, num_baselines, u, v, w, 90.0, 90.0, 1.0);
+    oskar_ms_write_coords_status_d(ms, 0, num_baselines, u, v, w,
+            90.0, 90.0, 1.0, &status);
+    ASSERT_EQ(0, status);
     oskar_ms_write_vis_d(ms, 0, 0, 1, num_baselines, vis);
     oskar_ms_close(ms);
 }
@@ -112,8 +115,9 @@ TEST(MeasurementSet, test_multi_channel)
                 w[b] = 1000.0 * (t + 1) + b;
             }
         }
-        oskar_ms_write_coords_d(ms, t * n_baselines, n_baselines,
-                &u[0], &v[0], &w[0], exposure, interval, (double)t);
+        oskar_ms_write_coords_status_d(ms, t * n_baselines, n_baselines,
+                &u[0], &v[0], &w[0], exposure, interval, (double)t,
+                &status);
 
         for (int c = 0; c < n_chan; ++c)
         {
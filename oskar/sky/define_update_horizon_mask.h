@@ -5,7 +5,7 @@
         const FP l_mul, const FP m_mul, const FP n_mul,\
         GLOBAL_OUT(int, mask))\
 {\
-    KERNEL_LOOP_X(int, i, 0, num)\
+    KERNEL_LOOP_PAR_X(int, i, 0, num)\
     mask[i] |= ((l[i] * l_mul + m[i] * m_mul + n[i] * n_mul) > (FP) 0);\
     KERNEL_LOOP_END\
 }\
@@ -16,7 +16,7 @@ OSKAR_REGISTER_KERNEL(NAME)
         const FP lst_rad, const FP cos_lat, const FP sin_lat,\
         GLOBAL_OUT(int, mask))\
 {\
-    KERNEL_LOOP_X(int, i, 0, num)\
+    KERNEL_LOOP_PAR_X(int, i, 0, num)\
     FP sin_dec, cos_dec;\
     const FP cos_ha = cos(lst_rad - ra_rad[i]);\
     SINCOS(dec_rad[i], sin_dec, cos_dec);\
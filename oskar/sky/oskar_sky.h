@@ -72,6 +72,8 @@ enum OSKAR_SKY_TAGS
 #include <sky/oskar_sky_accessors.h>
 #include <sky/oskar_sky_append_to_set.h>
 #include <sky/oskar_sky_append.h>
+#include <sky/oskar_sky_bounding_cap.h>
+#include <sky/oskar_sky_columns.h>
 #include <sky/oskar_sky_copy.h>
 #include <sky/oskar_sky_copy_contents.h>
 #include <sky/oskar_sky_create.h>
@@ -97,6 +99,7 @@ enum OSKAR_SKY_TAGS
 #include <sky/oskar_sky_set_gaussian_parameters.h>
 #include <sky/oskar_sky_set_source.h>
 #include <sky/oskar_sky_set_spectral_index.h>
+#include <sky/oskar_sky_sort_by_locality.h>
 #include <sky/oskar_sky_write.h>
 
 
@@ -85,6 +85,21 @@ int oskar_sky_capacity(const oskar_Sky* sky);
 OSKAR_EXPORT
 int oskar_sky_num_sources(const oskar_Sky* sky);
 
+/**
+ * @brief Sets the number of sources in the sky model.
+ *
+ * @details
+ * Sets the number of sources in the sky model, without resizing the
+ * arrays, so that sources can be copied into the unused part of them.
+ * The number of sources must not exceed the capacity of the sky model.
+ *
+ * @param[in] sky           Pointer to sky model.
+ * @param[in] value         Number of sources.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_sky_set_num_sources(oskar_Sky* sky, int value, int* status);
+
 /**
  * @brief Returns the flag to specify whether the sky model contains
  * extended sources.
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_SKY_BOUNDING_CAP_H_
+#define OSKAR_SKY_BOUNDING_CAP_H_
+
+/**
+ * @file oskar_sky_bounding_cap.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Returns a spherical cap which contains all sources in the sky model.
+ *
+ * @details
+ * The centre of the cap is the normalised mean of the source direction
+ * vectors, and the radius is the largest angular distance of any source
+ * from the centre. This is not the smallest possible cap, but it is
+ * cheap to find, and is small for sky models sorted using
+ * oskar_sky_sort_by_locality().
+ *
+ * If the sky model is empty, the radius is returned as zero.
+ * The sky model must be in CPU memory.
+ *
+ * @param[in] sky          Sky model.
+ * @param[out] ra_rad      Right Ascension of the cap centre, in radians.
+ * @param[out] dec_rad     Declination of the cap centre, in radians.
+ * @param[out] radius_rad  Angular radius of the cap, in radians.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_sky_bounding_cap(const oskar_Sky* sky, double* ra_rad,
+        double* dec_rad, double* radius_rad, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
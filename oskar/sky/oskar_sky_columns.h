@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_SKY_COLUMNS_H_
+#define OSKAR_SKY_COLUMNS_H_
+
+/**
+ * @file oskar_sky_columns.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Writes a sky model to a columnar binary file.
+ *
+ * @details
+ * Writes the source parameters to a file in which each column is stored
+ * contiguously and aligned, so that it can be memory-mapped and used in
+ * place by oskar_sky_read_columns().
+ *
+ * The sources can optionally be split into chunks of up to
+ * \p max_sources_per_chunk sources, each of which is aligned in the file
+ * so it can be mapped on its own. If this is zero or negative, all the
+ * sources are written as a single chunk.
+ *
+ * @param[in] sky                    Sky model to write.
+ * @param[in] filename               Pathname of the file to write.
+ * @param[in] max_sources_per_chunk  Maximum number of sources per chunk.
+ * @param[in,out] status             Status return code.
+ */
+OSKAR_EXPORT
+void oskar_sky_write_columns(const oskar_Sky* sky, const char* filename,
+        int max_sources_per_chunk, int* status);
+
+/**
+ * @brief
+ * Returns the number of chunks in a columnar sky model file.
+ *
+ * @details
+ * Returns the number of chunks in a file written by
+ * oskar_sky_write_columns(), or 0 if the file does not exist or is not
+ * a columnar sky model file. The status code is not set in that case,
+ * so this can be used to check the format of a file.
+ *
+ * @param[in] filename    Pathname of the file to check.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+int oskar_sky_columns_num_chunks(const char* filename, int* status);
+
+/**
+ * @brief
+ * Reads one chunk of a columnar sky model file.
+ *
+ * @details
+ * Maps one chunk of a file written by oskar_sky_write_columns() into
+ * memory, and returns a sky model which uses the columns in place.
+ * The mapping is private: pages are shared with other processes via the
+ * page cache, and are only copied if a source parameter is modified.
+ * The columns are copied if the sky model is resized, and the mapping
+ * is released when the sky model is freed.
+ *
+ * If the location is not OSKAR_CPU, the sources are copied to it.
+ *
+ * @param[in] filename    Pathname of the file to read.
+ * @param[in] chunk       Index of the chunk to read.
+ * @param[in] location    Memory location of the returned sky model.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+oskar_Sky* oskar_sky_read_columns(const char* filename, int chunk,
+        int location, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
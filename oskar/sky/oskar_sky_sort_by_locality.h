@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_SKY_SORT_BY_LOCALITY_H_
+#define OSKAR_SKY_SORT_BY_LOCALITY_H_
+
+/**
+ * @file oskar_sky_sort_by_locality.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Sorts sources so that those close together on the sky are adjacent.
+ *
+ * @details
+ * Reorders the sources in the sky model along a space-filling curve,
+ * using the nested HEALPix pixel index of each source position as the
+ * sort key. Sources which fall in the same pixel keep their relative order.
+ *
+ * When the sorted sky model is split into chunks, each chunk then
+ * covers a compact region of the sky, so chunks can be culled as a whole
+ * when they are below the horizon (see oskar_sky_bounding_cap()).
+ *
+ * All source parameters are permuted together, including any derived
+ * direction cosines and Gaussian source parameters.
+ * The sky model must be in CPU memory.
+ *
+ * @param[in,out] sky     Sky model to sort.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_sky_sort_by_locality(oskar_Sky* sky, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
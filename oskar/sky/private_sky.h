@@ -73,6 +73,9 @@ struct oskar_Sky
     oskar_Mem* gaussian_a;     /**< Gaussian source width parameter */
     oskar_Mem* gaussian_b;     /**< Gaussian source width parameter */
     oskar_Mem* gaussian_c;     /**< Gaussian source width parameter */
+
+    void* map;                 /**< Mapped columnar file region, if any. */
+    size_t map_size;           /**< Size of the mapped region, in bytes. */
 };
 
 #ifndef OSKAR_SKY_TYPEDEF_
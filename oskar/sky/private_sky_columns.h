@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_PRIVATE_SKY_COLUMNS_H_
+#define OSKAR_PRIVATE_SKY_COLUMNS_H_
+
+#include <sky/private_sky.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Copies any columns which use a mapped file into owned memory. */
+void oskar_sky_columns_detach(oskar_Sky* sky, int* status);
+
+/* Releases the mapped file region, if any. Does not touch the columns. */
+void oskar_sky_columns_release(oskar_Sky* sky);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
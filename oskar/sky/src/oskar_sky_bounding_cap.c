@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "sky/oskar_sky.h"
+#include "math/oskar_cmath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BOUNDING_CAP(RA, DEC) {\
+        for (i = 0; i < num_sources; ++i) {\
+            const double cos_dec = cos(DEC[i]);\
+            x += cos_dec * cos(RA[i]);\
+            y += cos_dec * sin(RA[i]);\
+            z += sin(DEC[i]);\
+        }\
+        const double norm = sqrt(x * x + y * y + z * z);\
+        if (norm > 0.0) { x /= norm; y /= norm; z /= norm; }\
+        else { x = 1.0; y = 0.0; z = 0.0; min_dot = -1.0; }\
+        for (i = 0; i < num_sources; ++i) {\
+            const double cos_dec = cos(DEC[i]);\
+            const double dot = x * cos_dec * cos(RA[i]) +\
+                    y * cos_dec * sin(RA[i]) + z * sin(DEC[i]);\
+            if (dot < min_dot) min_dot = dot;\
+        }\
+    }
+
+void oskar_sky_bounding_cap(const oskar_Sky* sky, double* ra_rad,
+        double* dec_rad, double* radius_rad, int* status)
+{
+    int i;
+    double x = 0.0, y = 0.0, z = 0.0, min_dot = 1.0;
+    *ra_rad = *dec_rad = *radius_rad = 0.0;
+    if (*status) return;
+    const int num_sources = oskar_sky_num_sources(sky);
+    if (num_sources == 0) return;
+    if (oskar_sky_mem_location(sky) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (oskar_sky_precision(sky) == OSKAR_DOUBLE)
+    {
+        const double *ra, *dec;
+        ra = oskar_mem_double_const(oskar_sky_ra_rad_const(sky), status);
+        dec = oskar_mem_double_const(oskar_sky_dec_rad_const(sky), status);
+        BOUNDING_CAP(ra, dec)
+    }
+    else
+    {
+        const float *ra, *dec;
+        ra = oskar_mem_float_const(oskar_sky_ra_rad_const(sky), status);
+        dec = oskar_mem_float_const(oskar_sky_dec_rad_const(sky), status);
+        BOUNDING_CAP(ra, dec)
+    }
+    if (min_dot > 1.0) min_dot = 1.0;
+    if (min_dot < -1.0) min_dot = -1.0;
+    *ra_rad = atan2(y, x);
+    *dec_rad = asin(z);
+    *radius_rad = acos(min_dot);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,384 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "sky/private_sky.h"
+#include "sky/private_sky_columns.h"
+#include "sky/oskar_sky.h"
+#include "sky/oskar_sky_columns.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/stat.h>
+
+#ifndef OSKAR_OS_WIN
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define COLUMNS_MAGIC "OSKARSC1"
+#define COLUMNS_VERSION 1
+#define NUM_COLUMNS 12
+
+/* Chunks start on boundaries which are valid mapping offsets everywhere. */
+#define CHUNK_ALIGN 65536
+#define COLUMN_ALIGN 64
+
+/* File header: 64 bytes, followed by the chunk table. */
+struct ColumnsHeader
+{
+    char magic[8];
+    int version;
+    int precision;
+    int num_columns;
+    int num_chunks;
+    unsigned long long num_sources;
+    unsigned long long chunk_align;
+    unsigned long long reserved[3];
+};
+typedef struct ColumnsHeader ColumnsHeader;
+
+struct ChunkEntry
+{
+    unsigned long long offset, num_sources, bytes;
+};
+typedef struct ChunkEntry ChunkEntry;
+
+static size_t round_up(size_t value, size_t align)
+{
+    return (value + align - 1) / align * align;
+}
+
+/* The stored columns, in file order. The others are derived. */
+static void get_columns(oskar_Sky* sky, oskar_Mem*** cols)
+{
+    cols[0] = &sky->ra_rad;
+    cols[1] = &sky->dec_rad;
+    cols[2] = &sky->I;
+    cols[3] = &sky->Q;
+    cols[4] = &sky->U;
+    cols[5] = &sky->V;
+    cols[6] = &sky->reference_freq_hz;
+    cols[7] = &sky->spectral_index;
+    cols[8] = &sky->rm_rad;
+    cols[9] = &sky->fwhm_major_rad;
+    cols[10] = &sky->fwhm_minor_rad;
+    cols[11] = &sky->pa_rad;
+}
+
+static void get_columns_const(const oskar_Sky* sky, const oskar_Mem** cols)
+{
+    cols[0] = sky->ra_rad;
+    cols[1] = sky->dec_rad;
+    cols[2] = sky->I;
+    cols[3] = sky->Q;
+    cols[4] = sky->U;
+    cols[5] = sky->V;
+    cols[6] = sky->reference_freq_hz;
+    cols[7] = sky->spectral_index;
+    cols[8] = sky->rm_rad;
+    cols[9] = sky->fwhm_major_rad;
+    cols[10] = sky->fwhm_minor_rad;
+    cols[11] = sky->pa_rad;
+}
+
+static unsigned long long file_size(const char* filename)
+{
+#ifdef OSKAR_OS_WIN
+    struct _stat64 st;
+    return _stat64(filename, &st) == 0 ? (unsigned long long) st.st_size : 0;
+#else
+    struct stat st;
+    return stat(filename, &st) == 0 ? (unsigned long long) st.st_size : 0;
+#endif
+}
+
+/* Writes zeros to pad the file. */
+static int write_zeros(FILE* file, size_t bytes)
+{
+    const char zeros[COLUMN_ALIGN] = {0};
+    while (bytes > 0)
+    {
+        const size_t n = bytes < COLUMN_ALIGN ? bytes : COLUMN_ALIGN;
+        if (fwrite(zeros, 1, n, file) != n) return 0;
+        bytes -= n;
+    }
+    return 1;
+}
+
+/* Reads the header and chunk table, returning 1 if they are valid. */
+static int read_index(const char* filename, ColumnsHeader* hdr,
+        ChunkEntry** table)
+{
+    int i, ok = 0;
+    FILE* file = fopen(filename, "rb");
+    *table = 0;
+    if (!file) return 0;
+    if (fread(hdr, sizeof(ColumnsHeader), 1, file) == 1 &&
+            !memcmp(hdr->magic, COLUMNS_MAGIC, sizeof(hdr->magic)) &&
+            hdr->version == COLUMNS_VERSION &&
+            hdr->num_columns == NUM_COLUMNS && hdr->num_chunks >= 0 &&
+            (hdr->precision == OSKAR_SINGLE || hdr->precision == OSKAR_DOUBLE))
+    {
+        const size_t n = (size_t) hdr->num_chunks;
+        *table = (ChunkEntry*) calloc(n + 1, sizeof(ChunkEntry));
+        ok = (fread(*table, sizeof(ChunkEntry), n, file) == n);
+    }
+    fclose(file);
+    if (ok)
+    {
+        /* Check the file is long enough for all the chunks. */
+        const unsigned long long size = file_size(filename);
+        for (i = 0; ok && i < hdr->num_chunks; ++i)
+        {
+            ok = ((*table)[i].offset + (*table)[i].bytes <= size) &&
+                    ((*table)[i].offset % CHUNK_ALIGN == 0);
+        }
+    }
+    if (!ok)
+    {
+        free(*table);
+        *table = 0;
+    }
+    return ok;
+}
+
+void oskar_sky_write_columns(const oskar_Sky* sky, const char* filename,
+        int max_sources_per_chunk, int* status)
+{
+    int c, i;
+    ColumnsHeader hdr;
+    const oskar_Mem* cols[NUM_COLUMNS];
+    oskar_Sky* temp = 0;
+    const oskar_Sky* src = sky;
+    if (*status) return;
+    if (oskar_sky_mem_location(sky) != OSKAR_CPU)
+    {
+        temp = oskar_sky_create_copy(sky, OSKAR_CPU, status);
+        src = temp;
+    }
+    const int num_sources = oskar_sky_num_sources(src);
+    const int prec = oskar_sky_precision(src);
+    const size_t element_size = oskar_mem_element_size(prec);
+    const int chunk_size = (max_sources_per_chunk > 0 &&
+            max_sources_per_chunk < num_sources) ?
+                    max_sources_per_chunk : num_sources;
+    const int num_chunks = (num_sources > 0) ?
+            (num_sources + chunk_size - 1) / chunk_size : 0;
+    ChunkEntry* table = (ChunkEntry*) calloc(num_chunks + 1,
+            sizeof(ChunkEntry));
+    FILE* file = fopen(filename, "wb");
+    if (!file || !table || *status)
+    {
+        if (file) fclose(file);
+        free(table);
+        oskar_sky_free(temp, status);
+        if (!*status) *status = OSKAR_ERR_FILE_IO;
+        return;
+    }
+
+    /* Lay out the chunks. */
+    size_t offset = round_up(sizeof(ColumnsHeader) +
+            num_chunks * sizeof(ChunkEntry), CHUNK_ALIGN);
+    for (i = 0; i < num_chunks; ++i)
+    {
+        const int start = i * chunk_size;
+        const int n = (num_sources - start < chunk_size) ?
+                num_sources - start : chunk_size;
+        const size_t stride = round_up(n * element_size, COLUMN_ALIGN);
+        table[i].offset = offset;
+        table[i].num_sources = (unsigned long long) n;
+        table[i].bytes = NUM_COLUMNS * stride;
+        offset = round_up(offset + NUM_COLUMNS * stride, CHUNK_ALIGN);
+    }
+
+    /* Write the header and the chunk table. */
+    int ok = 1;
+    memset(&hdr, 0, sizeof(ColumnsHeader));
+    memcpy(hdr.magic, COLUMNS_MAGIC, sizeof(hdr.magic));
+    hdr.version = COLUMNS_VERSION;
+    hdr.precision = prec;
+    hdr.num_columns = NUM_COLUMNS;
+    hdr.num_chunks = num_chunks;
+    hdr.num_sources = (unsigned long long) num_sources;
+    hdr.chunk_align = CHUNK_ALIGN;
+    ok &= (fwrite(&hdr, sizeof(ColumnsHeader), 1, file) == 1);
+    ok &= (fwrite(table, sizeof(ChunkEntry), num_chunks, file) ==
+            (size_t) num_chunks);
+
+    /* Write the columns of each chunk, padding each one. */
+    size_t pos = sizeof(ColumnsHeader) + num_chunks * sizeof(ChunkEntry);
+    get_columns_const(src, cols);
+    for (i = 0; ok && i < num_chunks; ++i)
+    {
+        const size_t n = (size_t) table[i].num_sources;
+        const size_t bytes = n * element_size;
+        const size_t pad = round_up(bytes, COLUMN_ALIGN) - bytes;
+        ok &= write_zeros(file, (size_t) table[i].offset - pos);
+        for (c = 0; ok && c < NUM_COLUMNS; ++c)
+        {
+            const char* data = (const char*) oskar_mem_void_const(cols[c]);
+            ok &= (fwrite(data + (size_t) i * chunk_size * element_size,
+                    1, bytes, file) == bytes);
+            ok &= write_zeros(file, pad);
+        }
+        pos = (size_t) (table[i].offset + table[i].bytes);
+    }
+    ok &= (fclose(file) == 0);
+    if (!ok) *status = OSKAR_ERR_FILE_IO;
+    free(table);
+    oskar_sky_free(temp, status);
+}
+
+int oskar_sky_columns_num_chunks(const char* filename, int* status)
+{
+    ColumnsHeader hdr;
+    ChunkEntry* table = 0;
+    if (*status || !filename) return 0;
+    if (!read_index(filename, &hdr, &table)) return 0;
+    free(table);
+    return hdr.num_chunks;
+}
+
+oskar_Sky* oskar_sky_read_columns(const char* filename, int chunk,
+        int location, int* status)
+{
+    int c;
+    ColumnsHeader hdr;
+    ChunkEntry* table = 0;
+    oskar_Mem** cols[NUM_COLUMNS];
+    char* data = 0;
+    if (*status) return 0;
+    if (!read_index(filename, &hdr, &table))
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return 0;
+    }
+    if (chunk < 0 || chunk >= hdr.num_chunks)
+    {
+        free(table);
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return 0;
+    }
+    const ChunkEntry entry = table[chunk];
+    free(table);
+    const size_t n = (size_t) entry.num_sources;
+    const size_t map_size = (size_t) entry.bytes;
+    const size_t stride = round_up(
+            n * oskar_mem_element_size(hdr.precision), COLUMN_ALIGN);
+
+    /* Map the chunk. Writes go to private copies of the pages. */
+#ifdef OSKAR_OS_WIN
+    FILE* file = fopen(filename, "rb");
+    if (file)
+    {
+        data = (char*) malloc(map_size ? map_size : 1);
+        if (_fseeki64(file, (long long) entry.offset, SEEK_SET) != 0 ||
+                fread(data, 1, map_size, file) != map_size)
+        {
+            free(data);
+            data = 0;
+        }
+        fclose(file);
+    }
+#else
+    const int fd = open(filename, O_RDONLY);
+    if (fd >= 0)
+    {
+        if (map_size > 0)
+        {
+            data = (char*) mmap(0, map_size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE, fd, (off_t) entry.offset);
+            if (data == (char*) MAP_FAILED) data = 0;
+        }
+        close(fd);
+    }
+#endif
+    if (!data)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return 0;
+    }
+
+    /* Use the stored columns in place, and allocate the derived ones. */
+    oskar_Sky* sky = oskar_sky_create(hdr.precision, OSKAR_CPU, 0, status);
+    if (!sky) goto fail;
+    sky->map = data;
+    sky->map_size = map_size;
+    get_columns(sky, cols);
+    for (c = 0; c < NUM_COLUMNS; ++c)
+    {
+        oskar_mem_free(*cols[c], status);
+        *cols[c] = oskar_mem_create_alias_from_raw(data + c * stride,
+                hdr.precision, OSKAR_CPU, n, status);
+    }
+    oskar_mem_realloc(sky->l, n, status);
+    oskar_mem_realloc(sky->m, n, status);
+    oskar_mem_realloc(sky->n, n, status);
+    oskar_mem_realloc(sky->gaussian_a, n, status);
+    oskar_mem_realloc(sky->gaussian_b, n, status);
+    oskar_mem_realloc(sky->gaussian_c, n, status);
+    sky->num_sources = (int) n;
+    sky->capacity = (int) n;
+    if (*status)
+    {
+        oskar_sky_free(sky, status);
+        return 0;
+    }
+
+    /* Copy to the requested location if necessary. */
+    if (location != OSKAR_CPU)
+    {
+        oskar_Sky* temp = oskar_sky_create_copy(sky, location, status);
+        oskar_sky_free(sky, status);
+        sky = temp;
+    }
+    return sky;
+
+fail:
+#ifdef OSKAR_OS_WIN
+    free(data);
+#else
+    munmap(data, map_size);
+#endif
+    return 0;
+}
+
+void oskar_sky_columns_detach(oskar_Sky* sky, int* status)
+{
+    int c;
+    oskar_Mem** cols[NUM_COLUMNS];
+    if (!sky->map) return;
+    get_columns(sky, cols);
+    for (c = 0; c < NUM_COLUMNS; ++c)
+    {
+        oskar_Mem* copy = oskar_mem_create_copy(*cols[c], OSKAR_CPU, status);
+        oskar_mem_free(*cols[c], status);
+        *cols[c] = copy;
+    }
+    oskar_sky_columns_release(sky);
+}
+
+void oskar_sky_columns_release(oskar_Sky* sky)
+{
+    if (!sky->map) return;
+#ifdef OSKAR_OS_WIN
+    free(sky->map);
+#else
+    munmap(sky->map, sky->map_size);
+#endif
+    sky->map = 0;
+    sky->map_size = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
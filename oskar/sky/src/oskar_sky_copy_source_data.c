@@ -30,6 +30,7 @@
 #include "sky/oskar_sky.h"
 #include "sky/oskar_sky_copy_source_data.h"
 #include "utility/oskar_device.h"
+#include "utility/oskar_kernel_macros.h"
 
 #define CB(m) oskar_mem_buffer(m)
 #define CBC(m) oskar_mem_buffer_const(m)
@@ -43,29 +44,31 @@ extern "C" {
 #endif
 
 #define COPY_SOURCE_DATA \
+        DO_PRAGMA(omp parallel for private(i)) \
         for (i = 0; i < num_in; ++i) \
             if (mask[i]) \
             { \
-                o_ra[num_out]  = ra[i]; \
-                o_dec[num_out] = dec[i]; \
-                o_I[num_out]   = I[i]; \
-                o_Q[num_out]   = Q[i]; \
-                o_U[num_out]   = U[i]; \
-                o_V[num_out]   = V[i]; \
-                o_ref[num_out] = ref[i]; \
-                o_sp[num_out]  = sp[i]; \
-                o_rm[num_out]  = rm[i]; \
-                o_l[num_out]   = l[i]; \
-                o_m[num_out]   = m[i]; \
-                o_n[num_out]   = n[i]; \
-                o_a[num_out]   = a[i]; \
-                o_b[num_out]   = b[i]; \
-                o_c[num_out]   = c[i]; \
-                o_maj[num_out] = maj[i]; \
-                o_min[num_out] = min[i]; \
-                o_pa[num_out]  = pa[i]; \
-                num_out++; \
-            }
+                const int i_out = idx[i]; \
+                o_ra[i_out]  = ra[i]; \
+                o_dec[i_out] = dec[i]; \
+                o_I[i_out]   = I_in[i]; \
+                o_Q[i_out]   = Q_in[i]; \
+                o_U[i_out]   = U_in[i]; \
+                o_V[i_out]   = V_in[i]; \
+                o_ref[i_out] = ref[i]; \
+                o_sp[i_out]  = sp[i]; \
+                o_rm[i_out]  = rm[i]; \
+                o_l[i_out]   = l[i]; \
+                o_m[i_out]   = m[i]; \
+                o_n[i_out]   = n[i]; \
+                o_a[i_out]   = a[i]; \
+                o_b[i_out]   = b[i]; \
+                o_c[i_out]   = c[i]; \
+                o_maj[i_out] = maj[i]; \
+                o_min[i_out] = min[i]; \
+                o_pa[i_out]  = pa[i]; \
+            } \
+        num_out = idx[num_in];
 
 void oskar_sky_copy_source_data(const oskar_Sky* in,
         const oskar_Mem* horizon_mask, const oskar_Mem* indices,
@@ -79,12 +82,12 @@ void oskar_sky_copy_source_data(const oskar_Sky* in,
     if (location == OSKAR_CPU)
     {
         const int* mask = oskar_mem_int_const(horizon_mask, status);
-        (void) indices;
+        const int* idx = oskar_mem_int_const(indices, status);
         switch (type)
         {
         case OSKAR_SINGLE:
         {
-            const float *ra, *dec, *I, *Q, *U, *V;
+            const float *ra, *dec, *I_in, *Q_in, *U_in, *V_in;
             const float *ref, *sp, *rm, *l, *m, *n;
             const float *a, *b, *c, *maj, *min, *pa;
             float *o_ra, *o_dec, *o_I, *o_Q, *o_U, *o_V;
@@ -94,10 +97,10 @@ void oskar_sky_copy_source_data(const oskar_Sky* in,
             /* Inputs. */
             ra = CFC(oskar_sky_ra_rad_const(in));
             dec = CFC(oskar_sky_dec_rad_const(in));
-            I = CFC(oskar_sky_I_const(in));
-            Q = CFC(oskar_sky_Q_const(in));
-            U = CFC(oskar_sky_U_const(in));
-            V = CFC(oskar_sky_V_const(in));
+            I_in = CFC(oskar_sky_I_const(in));
+            Q_in = CFC(oskar_sky_Q_const(in));
+            U_in = CFC(oskar_sky_U_const(in));
+            V_in = CFC(oskar_sky_V_const(in));
             ref = CFC(oskar_sky_reference_freq_hz_const(in));
             sp = CFC(oskar_sky_spectral_index_const(in));
             rm = CFC(oskar_sky_rotation_measure_rad_const(in));
@@ -135,7 +138,7 @@ void oskar_sky_copy_source_data(const oskar_Sky* in,
         }
         case OSKAR_DOUBLE:
         {
-            const double *ra, *dec, *I, *Q, *U, *V;
+            const double *ra, *dec, *I_in, *Q_in, *U_in, *V_in;
             const double *ref, *sp, *rm, *l, *m, *n;
             const double *a, *b, *c, *maj, *min, *pa;
             double *o_ra, *o_dec, *o_I, *o_Q, *o_U, *o_V;
@@ -145,10 +148,10 @@ void oskar_sky_copy_source_data(const oskar_Sky* in,
             /* Inputs. */
             ra = CDC(oskar_sky_ra_rad_const(in));
             dec = CDC(oskar_sky_dec_rad_const(in));
-            I = CDC(oskar_sky_I_const(in));
-            Q = CDC(oskar_sky_Q_const(in));
-            U = CDC(oskar_sky_U_const(in));
-            V = CDC(oskar_sky_V_const(in));
+            I_in = CDC(oskar_sky_I_const(in));
+            Q_in = CDC(oskar_sky_Q_const(in));
+            U_in = CDC(oskar_sky_U_const(in));
+            V_in = CDC(oskar_sky_V_const(in));
             ref = CDC(oskar_sky_reference_freq_hz_const(in));
             sp = CDC(oskar_sky_spectral_index_const(in));
             rm = CDC(oskar_sky_rotation_measure_rad_const(in));
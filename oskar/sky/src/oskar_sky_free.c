@@ -27,6 +27,7 @@
  */
 
 #include "sky/private_sky.h"
+#include "sky/private_sky_columns.h"
 #include "sky/oskar_sky.h"
 #include "mem/oskar_mem.h"
 #include <stdlib.h>
@@ -59,6 +60,9 @@ void oskar_sky_free(oskar_Sky* model, int* status)
     oskar_mem_free(model->gaussian_b, status);
     oskar_mem_free(model->gaussian_c, status);
 
+    /* Release the mapped file region after the columns which use it. */
+    oskar_sky_columns_release(model);
+
     /* Free the structure itself. */
     free(model);
 }
@@ -70,8 +70,7 @@ void oskar_sky_horizon_clip(oskar_Sky* out, const oskar_Sky* in,
 
     /* Apply exclusive prefix sum to mask to get source output indices.
      * Last element of index array is total number to copy. */
-    if (location != OSKAR_CPU)
-        oskar_prefix_sum(num_in, horizon_mask, source_indices, status);
+    oskar_prefix_sum(num_in, horizon_mask, source_indices, status);
 
     /* Copy sources above horizon. */
     oskar_sky_copy_source_data(in, horizon_mask, source_indices, out, status);
@@ -27,6 +27,7 @@
  */
 
 #include "sky/private_sky.h"
+#include "sky/private_sky_columns.h"
 #include "sky/oskar_sky.h"
 
 #include "mem/oskar_mem.h"
@@ -42,6 +43,9 @@ void oskar_sky_resize(oskar_Sky* sky, int num_sources, int* status)
     /* Check if safe to proceed. */
     if (*status) return;
 
+    /* Columns mapped from a file cannot be reallocated, so copy them. */
+    oskar_sky_columns_detach(sky, status);
+
     capacity = num_sources + 1;
     sky->capacity = capacity;
     sky->num_sources = num_sources;
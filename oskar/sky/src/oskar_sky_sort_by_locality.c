@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "sky/oskar_sky.h"
+#include "math/oskar_cmath.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* HEALPix order used for the sort key (nside = 2^15, ~6 arcsec pixels). */
+#define SORT_ORDER 15
+
+typedef struct
+{
+    unsigned long long key;
+    int index;
+} SortItem;
+
+static unsigned long long spread_bits(unsigned long long v);
+static unsigned long long ang_to_nest(double ra_rad, double dec_rad);
+static int compare_items(const void* a, const void* b);
+static void permute(oskar_Mem* mem, const SortItem* items, int num,
+        void* temp, int* status);
+
+void oskar_sky_sort_by_locality(oskar_Sky* sky, int* status)
+{
+    int i;
+    SortItem* items;
+    void* temp;
+    if (*status) return;
+    const int num_sources = oskar_sky_num_sources(sky);
+    if (num_sources < 2) return;
+    if (oskar_sky_mem_location(sky) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+
+    /* Get the sort key for each source. */
+    items = (SortItem*) malloc(num_sources * sizeof(SortItem));
+    temp = malloc(num_sources * sizeof(double));
+    if (!items || !temp)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        free(items);
+        free(temp);
+        return;
+    }
+    if (oskar_sky_precision(sky) == OSKAR_DOUBLE)
+    {
+        const double *ra, *dec;
+        ra = oskar_mem_double_const(oskar_sky_ra_rad_const(sky), status);
+        dec = oskar_mem_double_const(oskar_sky_dec_rad_const(sky), status);
+        for (i = 0; i < num_sources; ++i)
+        {
+            items[i].key = ang_to_nest(ra[i], dec[i]);
+            items[i].index = i;
+        }
+    }
+    else
+    {
+        const float *ra, *dec;
+        ra = oskar_mem_float_const(oskar_sky_ra_rad_const(sky), status);
+        dec = oskar_mem_float_const(oskar_sky_dec_rad_const(sky), status);
+        for (i = 0; i < num_sources; ++i)
+        {
+            items[i].key = ang_to_nest(ra[i], dec[i]);
+            items[i].index = i;
+        }
+    }
+    qsort(items, (size_t) num_sources, sizeof(SortItem), compare_items);
+
+    /* Permute every column into the sorted order. */
+    permute(oskar_sky_ra_rad(sky), items, num_sources, temp, status);
+    permute(oskar_sky_dec_rad(sky), items, num_sources, temp, status);
+    permute(oskar_sky_I(sky), items, num_sources, temp, status);
+    permute(oskar_sky_Q(sky), items, num_sources, temp, status);
+    permute(oskar_sky_U(sky), items, num_sources, temp, status);
+    permute(oskar_sky_V(sky), items, num_sources, temp, status);
+    permute(oskar_sky_reference_freq_hz(sky), items, num_sources, temp, status);
+    permute(oskar_sky_spectral_index(sky), items, num_sources, temp, status);
+    permute(oskar_sky_rotation_measure_rad(sky), items, num_sources, temp,
+            status);
+    permute(oskar_sky_l(sky), items, num_sources, temp, status);
+    permute(oskar_sky_m(sky), items, num_sources, temp, status);
+    permute(oskar_sky_n(sky), items, num_sources, temp, status);
+    permute(oskar_sky_fwhm_major_rad(sky), items, num_sources, temp, status);
+    permute(oskar_sky_fwhm_minor_rad(sky), items, num_sources, temp, status);
+    permute(oskar_sky_position_angle_rad(sky), items, num_sources, temp,
+            status);
+    permute(oskar_sky_gaussian_a(sky), items, num_sources, temp, status);
+    permute(oskar_sky_gaussian_b(sky), items, num_sources, temp, status);
+    permute(oskar_sky_gaussian_c(sky), items, num_sources, temp, status);
+    free(items);
+    free(temp);
+}
+
+static void permute(oskar_Mem* mem, const SortItem* items, int num,
+        void* temp, int* status)
+{
+    int i;
+    if (*status || (int) oskar_mem_length(mem) < num) return;
+    const size_t element_size = oskar_mem_element_size(oskar_mem_type(mem));
+    char* data = (char*) oskar_mem_void(mem);
+    char* t = (char*) temp;
+    for (i = 0; i < num; ++i)
+    {
+        memcpy(t + i * element_size,
+                data + items[i].index * element_size, element_size);
+    }
+    memcpy(data, t, num * element_size);
+}
+
+static int compare_items(const void* a, const void* b)
+{
+    const SortItem* x = (const SortItem*) a;
+    const SortItem* y = (const SortItem*) b;
+    if (x->key != y->key) return (x->key < y->key) ? -1 : 1;
+    return (x->index < y->index) ? -1 : (x->index > y->index);
+}
+
+/* Interleaves the bits of v with zeros. */
+static unsigned long long spread_bits(unsigned long long v)
+{
+    v = (v | (v << 16)) & 0x0000FFFF0000FFFFULL;
+    v = (v | (v << 8))  & 0x00FF00FF00FF00FFULL;
+    v = (v | (v << 4))  & 0x0F0F0F0F0F0F0F0FULL;
+    v = (v | (v << 2))  & 0x3333333333333333ULL;
+    v = (v | (v << 1))  & 0x5555555555555555ULL;
+    return v;
+}
+
+/* Returns the nested HEALPix pixel index of a direction. */
+static unsigned long long ang_to_nest(double ra_rad, double dec_rad)
+{
+    long long ix, iy, face, jp, jm;
+    const long long nside = 1LL << SORT_ORDER;
+    const double z = sin(dec_rad), za = fabs(z);
+    double tt = fmod(ra_rad, 2.0 * M_PI);
+    if (tt < 0.0) tt += 2.0 * M_PI;
+    tt /= 0.5 * M_PI; /* In range [0, 4). */
+    if (za <= 2.0 / 3.0)
+    {
+        /* Equatorial region. */
+        const double t1 = nside * (0.5 + tt), t2 = nside * z * 0.75;
+        jp = (long long) (t1 - t2);
+        jm = (long long) (t1 + t2);
+        const long long ifp = jp >> SORT_ORDER, ifm = jm >> SORT_ORDER;
+        face = (ifp == ifm) ? (ifp | 4) : ((ifp < ifm) ? ifp : (ifm + 8));
+        ix = jm & (nside - 1);
+        iy = nside - (jp & (nside - 1)) - 1;
+    }
+    else
+    {
+        /* Polar caps. */
+        long long ntt = (long long) tt;
+        if (ntt >= 4) ntt = 3;
+        const double tp = tt - ntt;
+        const double tmp = nside * sqrt(3.0 * (1.0 - za));
+        jp = (long long) (tp * tmp);
+        jm = (long long) ((1.0 - tp) * tmp);
+        if (jp >= nside) jp = nside - 1;
+        if (jm >= nside) jm = nside - 1;
+        if (z >= 0.0)
+        {
+            face = ntt;
+            ix = nside - jm - 1;
+            iy = nside - jp - 1;
+        }
+        else
+        {
+            face = ntt + 8;
+            ix = jp;
+            iy = jm;
+        }
+    }
+    return ((unsigned long long) face << (2 * SORT_ORDER)) +
+            spread_bits((unsigned long long) ix) +
+            (spread_bits((unsigned long long) iy) << 1);
+}
+
+#ifdef __cplusplus
+}
+#endif
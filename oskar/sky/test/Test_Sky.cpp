@@ -36,6 +36,7 @@
 #include "utility/oskar_device.h"
 
 #include <cstdlib>
+#include <vector>
 #include "math/oskar_cmath.h"
 
 #ifdef OSKAR_HAVE_CUDA
@@ -1252,3 +1253,163 @@ TEST(SkyModel, read_write)
     remove(filename);
 }
 
+
+TEST(SkyModel, read_write_columns)
+{
+    int status = 0;
+    const int num_sources = 12345, chunk_size = 1000;
+    const char* filename = "test_sky_model_write_columns.osm";
+    oskar_Sky* sky = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_sources, &status);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        oskar_sky_set_source(sky, i, 1.0 * i, 2.1 * i, 3.2 * i, 4.3 * i,
+                5.4 * i, 6.5 * i, 7.6 * i, 8.7 * i, 8.9 * i, 9.8 * i,
+                10.9 * i, 11.1 * i, &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Write it as a chunked columnar file.
+    oskar_sky_write_columns(sky, filename, chunk_size, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const int num_chunks = oskar_sky_columns_num_chunks(filename, &status);
+    ASSERT_EQ((num_sources + chunk_size - 1) / chunk_size, num_chunks);
+
+    // Other files are not columnar.
+    oskar_sky_write(sky, "test_sky_model_write_not_columns.osm", &status);
+    EXPECT_EQ(0, oskar_sky_columns_num_chunks(
+            "test_sky_model_write_not_columns.osm", &status));
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    remove("test_sky_model_write_not_columns.osm");
+
+    // Read the chunks back, and join them together.
+    oskar_Sky* sky2 = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    for (int c = 0; c < num_chunks; ++c)
+    {
+        oskar_Sky* chunk = oskar_sky_read_columns(filename, c,
+                OSKAR_CPU, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        const int n = (c < num_chunks - 1) ?
+                chunk_size : num_sources - c * chunk_size;
+        ASSERT_EQ(n, oskar_sky_num_sources(chunk));
+        oskar_sky_append(sky2, chunk, &status);
+        oskar_sky_free(chunk, &status);
+    }
+    ASSERT_EQ(num_sources, oskar_sky_num_sources(sky2));
+    EXPECT_FALSE(oskar_mem_different(oskar_sky_ra_rad_const(sky),
+            oskar_sky_ra_rad_const(sky2), num_sources, &status));
+    EXPECT_FALSE(oskar_mem_different(oskar_sky_dec_rad_const(sky),
+            oskar_sky_dec_rad_const(sky2), num_sources, &status));
+    EXPECT_FALSE(oskar_mem_different(oskar_sky_I_const(sky),
+            oskar_sky_I_const(sky2), num_sources, &status));
+    EXPECT_FALSE(oskar_mem_different(oskar_sky_V_const(sky),
+            oskar_sky_V_const(sky2), num_sources, &status));
+    EXPECT_FALSE(oskar_mem_different(oskar_sky_spectral_index_const(sky),
+            oskar_sky_spectral_index_const(sky2), num_sources, &status));
+    EXPECT_FALSE(oskar_mem_different(
+            oskar_sky_rotation_measure_rad_const(sky),
+            oskar_sky_rotation_measure_rad_const(sky2), num_sources, &status));
+    EXPECT_FALSE(oskar_mem_different(
+            oskar_sky_position_angle_rad_const(sky),
+            oskar_sky_position_angle_rad_const(sky2), num_sources, &status));
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Modify and filter a mapped chunk, which must not change the file.
+    oskar_Sky* chunk = oskar_sky_read_columns(filename, 1, OSKAR_CPU, &status);
+    oskar_sky_set_source(chunk, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+            0.0, 0.0, 0.0, 0.0, 0.0, 0.0, &status);
+    oskar_sky_filter_by_flux(chunk, 3.2 * 1499.5, 1e9, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(500, oskar_sky_num_sources(chunk));
+    EXPECT_DOUBLE_EQ(3.2 * 1500,
+            oskar_mem_double(oskar_sky_I(chunk), &status)[0]);
+    oskar_sky_free(chunk, &status);
+    chunk = oskar_sky_read_columns(filename, 1, OSKAR_CPU, &status);
+    EXPECT_DOUBLE_EQ(1000.0, oskar_mem_double(oskar_sky_ra_rad(chunk),
+            &status)[0]);
+    oskar_sky_free(chunk, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Clean up.
+    oskar_sky_free(sky, &status);
+    oskar_sky_free(sky2, &status);
+    remove(filename);
+}
+
+
+TEST(SkyModel, sort_by_locality)
+{
+    int status = 0;
+    const int num_sources = 20000, chunk_size = 100;
+    const int num_chunks = num_sources / chunk_size;
+    oskar_Sky* sky = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_sources, &status);
+    srand(2);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        const double ra = 2.0 * M_PI * rand() / (double)RAND_MAX;
+        const double dec = asin(2.0 * rand() / (double)RAND_MAX - 1.0);
+        oskar_sky_set_source(sky, i, ra, dec, ra + 2.0 * dec, 0.0, 0.0, i,
+                1e8, 0.0, 0.0, 0.0, 0.0, 0.0, &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Find the mean bounding cap radius of chunks before sorting.
+    double ra0 = 0.0, dec0 = 0.0, radius = 0.0;
+    double mean_radius_unsorted = 0.0, mean_radius_sorted = 0.0;
+    oskar_Sky* chunk = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU,
+            chunk_size, &status);
+    for (int c = 0; c < num_chunks; ++c)
+    {
+        oskar_sky_copy_contents(chunk, sky, 0, c * chunk_size,
+                chunk_size, &status);
+        oskar_sky_bounding_cap(chunk, &ra0, &dec0, &radius, &status);
+        mean_radius_unsorted += radius / num_chunks;
+    }
+
+    // Sort the sources, and check that they have all been kept together.
+    oskar_sky_sort_by_locality(sky, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(num_sources, oskar_sky_num_sources(sky));
+    const double* ra = oskar_mem_double_const(
+            oskar_sky_ra_rad_const(sky), &status);
+    const double* dec = oskar_mem_double_const(
+            oskar_sky_dec_rad_const(sky), &status);
+    const double* I = oskar_mem_double_const(oskar_sky_I_const(sky), &status);
+    const double* V = oskar_mem_double_const(oskar_sky_V_const(sky), &status);
+    std::vector<int> seen(num_sources, 0);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        EXPECT_DOUBLE_EQ(ra[i] + 2.0 * dec[i], I[i]);
+        seen[(int) V[i]]++;
+    }
+    for (int i = 0; i < num_sources; ++i) ASSERT_EQ(1, seen[i]);
+
+    // Check that the chunks are now much more compact.
+    for (int c = 0; c < num_chunks; ++c)
+    {
+        oskar_sky_copy_contents(chunk, sky, 0, c * chunk_size,
+                chunk_size, &status);
+        oskar_sky_bounding_cap(chunk, &ra0, &dec0, &radius, &status);
+        mean_radius_sorted += radius / num_chunks;
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_GT(mean_radius_unsorted, 2.5);
+    EXPECT_LT(mean_radius_sorted, 0.5);
+
+    // Check the bounding cap of a known set of sources.
+    oskar_sky_resize(chunk, 3, &status);
+    oskar_sky_set_source(chunk, 0, 0.1, 0.5, 1.0, 0.0, 0.0, 0.0,
+            1e8, 0.0, 0.0, 0.0, 0.0, 0.0, &status);
+    oskar_sky_set_source(chunk, 1, 0.1, 0.3, 1.0, 0.0, 0.0, 0.0,
+            1e8, 0.0, 0.0, 0.0, 0.0, 0.0, &status);
+    oskar_sky_set_source(chunk, 2, 0.1, 0.4, 1.0, 0.0, 0.0, 0.0,
+            1e8, 0.0, 0.0, 0.0, 0.0, 0.0, &status);
+    oskar_sky_bounding_cap(chunk, &ra0, &dec0, &radius, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_NEAR(0.1, ra0, 1e-12);
+    EXPECT_NEAR(0.4, dec0, 1e-12);
+    EXPECT_NEAR(0.1, radius, 1e-9);
+    oskar_sky_free(chunk, &status);
+    oskar_sky_free(sky, &status);
+}
@@ -1,5 +1,15 @@
 /* Copyright (c) 2012-2019, The University of Oxford. See LICENSE file. */
 
+/* Finds the knot interval t(l-1) <= x < t(l), with 4 <= l <= nk1,
+ * by binary search. */
+#define FIND_KNOT_INTERVAL(t, nk1, x, l) {\
+    int lo_ = 4, hi_ = nk1;\
+    while (lo_ < hi_) {\
+        const int mid_ = (lo_ + hi_) >> 1;\
+        if (x < t[mid_]) hi_ = mid_; else lo_ = mid_ + 1;\
+    }\
+    l = lo_; }\
+
 /* Evaluates the (k+1) non-zero bicubic b-splines
  * at t(l) <= x < t(l+1) using the stable recurrence
  * relation of de Boor and Cox. */
@@ -28,13 +38,13 @@
     nk1 = nx - 4;\
     t = tx[3];   if (x_ < t) x_ = t;\
     t = tx[nk1]; if (x_ > t) x_ = t;\
-    l = 4; while (!(x_ < tx[l] || l == nk1)) l++;\
+    FIND_KNOT_INTERVAL(tx, nk1, x_, l)\
     FPBSPL(FP, tx, 3, x_, l, wx)\
     lx = l - 4;\
     nk1 = ny - 4;\
     t = ty[3];   if (y_ < t) y_ = t;\
     t = ty[nk1]; if (y_ > t) y_ = t;\
-    l = 4; while (!(y_ < ty[l] || l == nk1)) l++;\
+    FIND_KNOT_INTERVAL(ty, nk1, y_, l)\
     FPBSPL(FP, ty, 3, y_, l, wy)\
     l1 = lx * nk1 + (l - 4);\
     t = (FP)0;\
@@ -153,6 +153,7 @@ void oskar_splines_free(oskar_Splines* data, int* status);
 #endif
 
 #include <splines/oskar_splines_evaluate.h>
+#include <splines/oskar_splines_evaluate_multi.h>
 #include <splines/oskar_splines_fit.h>
 
 #endif /* OSKAR_SPLINES_H_ */
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_SPLINES_EVALUATE_MULTI_H_
+#define OSKAR_SPLINES_EVALUATE_MULTI_H_
+
+/**
+ * @file oskar_splines_evaluate_multi.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Evaluates several surfaces fitted by splines at the same positions.
+ *
+ * @details
+ * This function evaluates a set of surfaces fitted by splines at the
+ * given positions, as oskar_splines_evaluate() would for each surface
+ * in turn. The values of surface k are written to
+ * output[i * stride_out + offset_out + k] for point i.
+ *
+ * On the CPU, all surfaces are evaluated in a single pass over the points.
+ * The knot intervals and B-spline basis values at each point are found
+ * only once for each distinct set of knots, and then applied to the
+ * coefficients of every surface which uses those knots.
+ *
+ * Points outside the range of the knots are clamped to the nearest edge,
+ * as in oskar_splines_evaluate(). That function can only return
+ * OSKAR_ERR_SPLINE_EVAL_FAIL if the Dierckx workspace is too small or the
+ * coordinates are unsorted, which cannot happen when it evaluates one point
+ * at a time, so this function has no equivalent error.
+ * Surfaces with no coefficients evaluate to zero.
+ *
+ * @param[in] num_surfaces  Number of surfaces to evaluate.
+ * @param[in] splines       Array of pointers to the surfaces.
+ * @param[in] num_points    Number of points.
+ * @param[in] x             List of x coordinates.
+ * @param[in] y             List of y coordinates.
+ * @param[in] stride_out    Output stride between points.
+ * @param[in] offset_out    Output offset of first surface, for first point.
+ * @param[out] output       Output values.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_splines_evaluate_multi(int num_surfaces,
+        const oskar_Splines* const* splines, int num_points,
+        const oskar_Mem* x, const oskar_Mem* y,
+        int stride_out, int offset_out, oskar_Mem* output, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -47,6 +47,9 @@ extern "C" {
  * @details
  * This function constructs splines from a list of data points.
  *
+ * The average fractional error used for the fit is also stored in the
+ * spline data structure, so that it can be reported after the fit.
+ *
  * @param[in,out] spline         Pointer to spline data structure.
  * @param[in]     num_points     Number of data points in all arrays.
  * @param[in]     x_theta        Array of x or theta positions.
@@ -45,6 +45,7 @@ struct oskar_Splines
     oskar_Mem* knots_y_phi;   /* Knot positions in y or phi. */
     oskar_Mem* coeff;         /* Spline coefficient array. */
     double smoothing_factor;  /* Actual smoothing factor used for the fit. */
+    double avg_frac_error;    /* Average fractional error reached by fit. */
 };
 
 #ifndef OSKAR_SPLINES_TYPEDEF_
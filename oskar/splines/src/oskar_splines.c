@@ -101,6 +101,7 @@ void oskar_splines_copy(oskar_Splines* dst, const oskar_Splines* src,
     if (*status || !dst || !src) return;
     dst->precision = src->precision;
     dst->smoothing_factor = src->smoothing_factor;
+    dst->avg_frac_error = src->avg_frac_error;
     dst->num_knots_x_theta = src->num_knots_x_theta;
     dst->num_knots_y_phi = src->num_knots_y_phi;
     if (src->num_knots_x_theta > 0)
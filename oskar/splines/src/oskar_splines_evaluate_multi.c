@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "splines/define_dierckx_bispev_bicubic.h"
+#include "splines/oskar_splines.h"
+#include "utility/oskar_kernel_macros.h"
+
+#include <string.h>
+
+#define MAX_SURFACES 8
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Surfaces with the same knots share the same entry in the knot group
+ * arrays gx and gy, so the basis values need only be found once. */
+#define SPLINES_EVALUATE_MULTI(NAME, FP) static void NAME(\
+        const int num_surfaces, const int* nx, const int* ny,\
+        const void* const* tx_, const void* const* ty_,\
+        const void* const* c_, const int* gx, const int* gy, const int n,\
+        const FP* x, const FP* y, const int stride_out, FP* z)\
+{\
+    int p, k;\
+    const FP *tx[MAX_SURFACES], *ty[MAX_SURFACES], *c[MAX_SURFACES];\
+    for (k = 0; k < num_surfaces; ++k) {\
+        tx[k] = (const FP*) tx_[k];\
+        ty[k] = (const FP*) ty_[k];\
+        c[k] = (const FP*) c_[k];\
+    }\
+    DO_PRAGMA(omp parallel for private(k))\
+    for (p = 0; p < n; ++p) {\
+        int lx[MAX_SURFACES], ly[MAX_SURFACES];\
+        FP hh[3], wx[MAX_SURFACES][4], wy[MAX_SURFACES][4];\
+        FP* z_ = &z[p * stride_out];\
+        for (k = 0; k < num_surfaces; ++k) {\
+            int l, nk1;\
+            FP t, x_ = x[p], y_ = y[p];\
+            if (!c[k]) continue;\
+            if (gx[k] == k) {\
+                nk1 = nx[k] - 4;\
+                t = tx[k][3];   if (x_ < t) x_ = t;\
+                t = tx[k][nk1]; if (x_ > t) x_ = t;\
+                FIND_KNOT_INTERVAL(tx[k], nk1, x_, l)\
+                FPBSPL(FP, tx[k], 3, x_, l, wx[k])\
+                lx[k] = l - 4;\
+            }\
+            if (gy[k] == k) {\
+                nk1 = ny[k] - 4;\
+                t = ty[k][3];   if (y_ < t) y_ = t;\
+                t = ty[k][nk1]; if (y_ > t) y_ = t;\
+                FIND_KNOT_INTERVAL(ty[k], nk1, y_, l)\
+                FPBSPL(FP, ty[k], 3, y_, l, wy[k])\
+                ly[k] = l - 4;\
+            }\
+        }\
+        for (k = 0; k < num_surfaces; ++k) {\
+            int l, l1;\
+            FP t = (FP)0;\
+            if (c[k]) {\
+                const FP *wx_ = wx[gx[k]], *wy_ = wy[gy[k]];\
+                const int nky1 = ny[k] - 4;\
+                l1 = lx[gx[k]] * nky1 + ly[gy[k]];\
+                for (l = 0; l <= 3; ++l, l1 += nky1) {\
+                    const FP* ck = &c[k][l1];\
+                    t += wx_[l] * (ck[0] * wy_[0] + ck[1] * wy_[1] +\
+                            ck[2] * wy_[2] + ck[3] * wy_[3]);\
+                }\
+            }\
+            z_[k] = t;\
+        }\
+    }\
+}
+
+SPLINES_EVALUATE_MULTI(splines_evaluate_multi_float, float)
+SPLINES_EVALUATE_MULTI(splines_evaluate_multi_double, double)
+
+static int same_knots(const oskar_Mem* a, const oskar_Mem* b, int num,
+        int* status)
+{
+    return !memcmp(oskar_mem_void_const(a), oskar_mem_void_const(b),
+            num * oskar_mem_element_size(oskar_mem_type(a))) && !*status;
+}
+
+void oskar_splines_evaluate_multi(int num_surfaces,
+        const oskar_Splines* const* splines, int num_points,
+        const oskar_Mem* x, const oskar_Mem* y,
+        int stride_out, int offset_out, oskar_Mem* output, int* status)
+{
+    int i, k, nx[MAX_SURFACES], ny[MAX_SURFACES];
+    int gx[MAX_SURFACES], gy[MAX_SURFACES];
+    const void *tx[MAX_SURFACES], *ty[MAX_SURFACES], *c[MAX_SURFACES];
+    if (*status || num_surfaces <= 0) return;
+
+    /* Evaluate surfaces in batches of up to MAX_SURFACES. */
+    if (num_surfaces > MAX_SURFACES)
+    {
+        for (k = 0; k < num_surfaces; k += MAX_SURFACES)
+        {
+            const int num = num_surfaces - k < MAX_SURFACES ?
+                    num_surfaces - k : MAX_SURFACES;
+            oskar_splines_evaluate_multi(num, &splines[k], num_points, x, y,
+                    stride_out, offset_out + k, output, status);
+        }
+        return;
+    }
+
+    /* Use the single-surface function unless data are in CPU memory. */
+    const int type = oskar_splines_precision(splines[0]);
+    const int location = oskar_splines_mem_location(splines[0]);
+    if (location != OSKAR_CPU)
+    {
+        for (k = 0; k < num_surfaces; ++k)
+            oskar_splines_evaluate(splines[k], num_points, x, y,
+                    stride_out, offset_out + k, output, status);
+        return;
+    }
+    if (type != oskar_mem_type(x) || type != oskar_mem_type(y) ||
+            type != oskar_mem_precision(output))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (location != oskar_mem_location(output) ||
+            location != oskar_mem_location(x) ||
+            location != oskar_mem_location(y))
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+
+    /* Get the knots and coefficients of each surface, and find which
+     * surfaces share knots. Empty surfaces evaluate to zero. */
+    for (k = 0; k < num_surfaces; ++k)
+    {
+        const oskar_Mem* tx_k = oskar_splines_knots_x_theta_const(splines[k]);
+        const oskar_Mem* ty_k = oskar_splines_knots_y_phi_const(splines[k]);
+        if (oskar_splines_precision(splines[k]) != type)
+        {
+            *status = OSKAR_ERR_TYPE_MISMATCH;
+            return;
+        }
+        if (oskar_splines_mem_location(splines[k]) != location)
+        {
+            *status = OSKAR_ERR_LOCATION_MISMATCH;
+            return;
+        }
+        nx[k] = oskar_splines_num_knots_x_theta(splines[k]);
+        ny[k] = oskar_splines_num_knots_y_phi(splines[k]);
+        tx[k] = oskar_mem_void_const(tx_k);
+        ty[k] = oskar_mem_void_const(ty_k);
+        c[k] = oskar_mem_void_const(oskar_splines_coeff_const(splines[k]));
+        if (nx[k] < 8 || ny[k] < 8 || !tx[k] || !ty[k]) c[k] = 0;
+        gx[k] = gy[k] = k;
+        for (i = 0; i < k && c[k]; ++i)
+        {
+            if (!c[i]) continue;
+            const oskar_Splines* s = splines[i];
+            if (gx[k] == k && nx[i] == nx[k] && same_knots(tx_k,
+                    oskar_splines_knots_x_theta_const(s), nx[k], status))
+                gx[k] = gx[i];
+            if (gy[k] == k && ny[i] == ny[k] && same_knots(ty_k,
+                    oskar_splines_knots_y_phi_const(s), ny[k], status))
+                gy[k] = gy[i];
+        }
+    }
+
+    /* Evaluate all the surfaces. */
+    if (type == OSKAR_SINGLE)
+        splines_evaluate_multi_float(num_surfaces, nx, ny,
+                tx, ty, c, gx, gy, num_points,
+                oskar_mem_float_const(x, status),
+                oskar_mem_float_const(y, status), stride_out,
+                oskar_mem_float(output, status) + offset_out);
+    else if (type == OSKAR_DOUBLE)
+        splines_evaluate_multi_double(num_surfaces, nx, ny,
+                tx, ty, c, gx, gy, num_points,
+                oskar_mem_double_const(x, status),
+                oskar_mem_double_const(y, status), stride_out,
+                oskar_mem_double(output, status) + offset_out);
+    else
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -66,6 +66,7 @@ void oskar_splines_fit(oskar_Splines* spline, int num_points, double* x_theta,
     /* Check if safe to proceed. */
     if (*status) return;
     if (num_points <= 0) return;
+    spline->avg_frac_error = *avg_frac_err;
 
     /* Check the output data type and location. */
     if (oskar_splines_precision(spline) != OSKAR_DOUBLE)
@@ -273,6 +274,9 @@ void oskar_splines_fit(oskar_Splines* spline, int num_points, double* x_theta,
     free(wrk1);
     free(wrk2);
     free(iwrk);
+
+    /* Store the error reached by the search, so it can be reported. */
+    if (!*status) spline->avg_frac_error = *avg_frac_err;
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mem/oskar_mem.h"
+#include "splines/oskar_splines.h"
+#include "splines/private_splines.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+static oskar_Splines* fit_surface(int func, int* status)
+{
+    const int nx = 30, ny = 30;
+    std::vector<double> x(nx * ny), y(nx * ny), z(nx * ny), w(nx * ny, 1.0);
+    for (int j = 0, i = 0; j < ny; ++j)
+    {
+        for (int k = 0; k < nx; ++k, ++i)
+        {
+            x[i] = k / (nx - 1.0);
+            y[i] = 2.0 * j / (ny - 1.0);
+            z[i] = (func == 0) ?
+                    sin(3.0 * x[i]) * cos(2.0 * y[i]) :
+                    exp(-4.0 * (x[i] - 0.3) * (x[i] - 0.3)) +
+                    pow(y[i] - 1.2, 3);
+        }
+    }
+    double avg_frac_error = 0.01;
+    oskar_Splines* s = oskar_splines_create(OSKAR_DOUBLE, OSKAR_CPU, status);
+    oskar_splines_fit(s, nx * ny, &x[0], &y[0], &z[0], &w[0],
+            OSKAR_SPLINES_LINEAR, 1, &avg_frac_error, 1.5, 1.0, 1e-14,
+            status);
+    return s;
+}
+
+static oskar_Splines* scaled_copy(const oskar_Splines* in, double factor,
+        int* status)
+{
+    oskar_Splines* s = oskar_splines_create(OSKAR_DOUBLE, OSKAR_CPU, status);
+    oskar_splines_copy(s, in, status);
+    oskar_mem_scale_real(oskar_splines_coeff(s), factor,
+            0, oskar_mem_length(oskar_splines_coeff(s)), status);
+    return s;
+}
+
+static oskar_Splines* to_single(const oskar_Splines* in, int* status)
+{
+    oskar_Splines* s = oskar_splines_create(OSKAR_SINGLE, OSKAR_CPU, status);
+    s->num_knots_x_theta = in->num_knots_x_theta;
+    s->num_knots_y_phi = in->num_knots_y_phi;
+    oskar_mem_free(s->knots_x_theta, status);
+    oskar_mem_free(s->knots_y_phi, status);
+    oskar_mem_free(s->coeff, status);
+    s->knots_x_theta = oskar_mem_convert_precision(
+            in->knots_x_theta, OSKAR_SINGLE, status);
+    s->knots_y_phi = oskar_mem_convert_precision(
+            in->knots_y_phi, OSKAR_SINGLE, status);
+    s->coeff = oskar_mem_convert_precision(in->coeff, OSKAR_SINGLE, status);
+    return s;
+}
+
+static void compare_multi(int prec, double tol)
+{
+    int status = 0;
+
+    // Surfaces 0, 1 and 4 share knots; 2 has its own knots; 3 is empty.
+    // The list is repeated to exercise evaluation in batches.
+    oskar_Splines* d[5];
+    d[0] = fit_surface(0, &status);
+    d[1] = scaled_copy(d[0], -2.5, &status);
+    d[2] = fit_surface(1, &status);
+    d[3] = oskar_splines_create(OSKAR_DOUBLE, OSKAR_CPU, &status);
+    d[4] = scaled_copy(d[0], 0.5, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_TRUE(oskar_splines_num_knots_x_theta(d[0]) !=
+            oskar_splines_num_knots_x_theta(d[2]) ||
+            memcmp(oskar_mem_void_const(oskar_splines_knots_x_theta_const(
+                    d[0])), oskar_mem_void_const(
+                    oskar_splines_knots_x_theta_const(d[2])),
+                    oskar_splines_num_knots_x_theta(d[0]) * sizeof(double)));
+    oskar_Splines* s[5];
+    for (int k = 0; k < 5; ++k)
+        s[k] = (prec == OSKAR_SINGLE) ? to_single(d[k], &status) : d[k];
+    const int num_surfaces = 10;
+    const oskar_Splines* surfaces[num_surfaces];
+    for (int k = 0; k < num_surfaces; ++k) surfaces[k] = s[k % 5];
+
+    // Evaluation points, including some outside the fitted range.
+    const int num_points = 1000;
+    oskar_Mem* x = oskar_mem_create(prec, OSKAR_CPU, num_points, &status);
+    oskar_Mem* y = oskar_mem_create(prec, OSKAR_CPU, num_points, &status);
+    oskar_mem_random_uniform(x, 1, 2, 3, 4, &status);
+    oskar_mem_random_uniform(y, 5, 6, 7, 8, &status);
+    oskar_mem_scale_real(x, 1.4, 0, num_points, &status);
+    oskar_mem_scale_real(y, 2.8, 0, num_points, &status);
+    oskar_mem_add_real(x, -0.2, &status);
+    oskar_mem_add_real(y, -0.4, &status);
+
+    // Evaluate each surface in turn, and then all of them together.
+    const int stride = num_surfaces + 1, offset = 1;
+    oskar_Mem* ref = oskar_mem_create(prec, OSKAR_CPU,
+            stride * num_points, &status);
+    oskar_Mem* out = oskar_mem_create(prec, OSKAR_CPU,
+            stride * num_points, &status);
+    oskar_mem_clear_contents(ref, &status);
+    oskar_mem_clear_contents(out, &status);
+    for (int k = 0; k < num_surfaces; ++k)
+        oskar_splines_evaluate(surfaces[k], num_points, x, y,
+                stride, offset + k, ref, &status);
+    oskar_splines_evaluate_multi(num_surfaces, surfaces, num_points, x, y,
+            stride, offset, out, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Compare results.
+    oskar_Mem* ref_d = oskar_mem_convert_precision(ref, OSKAR_DOUBLE, &status);
+    oskar_Mem* out_d = oskar_mem_convert_precision(out, OSKAR_DOUBLE, &status);
+    const double* r = oskar_mem_double_const(ref_d, &status);
+    const double* o = oskar_mem_double_const(out_d, &status);
+    double max_abs = 0.0;
+    for (int i = 0; i < stride * num_points; ++i)
+        if (fabs(r[i]) > max_abs) max_abs = fabs(r[i]);
+    ASSERT_GT(max_abs, 0.0);
+    for (int p = 0; p < num_points; ++p)
+    {
+        EXPECT_EQ(0.0, o[p * stride]);
+        for (int k = 0; k < num_surfaces; ++k)
+        {
+            const int i = p * stride + offset + k;
+            if (k % 5 == 3)
+            {
+                EXPECT_EQ(0.0, o[i]);
+            }
+            EXPECT_NEAR(r[i], o[i], tol * max_abs) << "Surface " << k <<
+                    ", point " << p;
+        }
+    }
+
+    // Clean up.
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(ref, &status);
+    oskar_mem_free(out, &status);
+    oskar_mem_free(ref_d, &status);
+    oskar_mem_free(out_d, &status);
+    for (int k = 0; k < 5; ++k)
+    {
+        if (s[k] != d[k]) oskar_splines_free(s[k], &status);
+        oskar_splines_free(d[k], &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(splines_evaluate_multi, compare_single)
+{
+    compare_multi(OSKAR_SINGLE, 1e-5);
+}
+
+TEST(splines_evaluate_multi, compare_double)
+{
+    compare_multi(OSKAR_DOUBLE, 1e-12);
+}
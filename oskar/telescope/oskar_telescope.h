@@ -58,6 +58,7 @@ enum OSKAR_POL_MODE_TYPE
 #include <telescope/oskar_telescope_set_station_coords_enu.h>
 #include <telescope/oskar_telescope_set_station_coords_wgs84.h>
 #include <telescope/oskar_telescope_set_station_ids_and_coords.h>
+#include <telescope/oskar_telescope_snapshot.h>
 #include <telescope/oskar_telescope_uvw.h>
 
 #endif /* include guard */
@@ -350,6 +350,23 @@ OSKAR_EXPORT
 int oskar_telescope_allow_station_beam_duplication(
         const oskar_Telescope* model);
 
+/**
+ * @brief
+ * Returns the tolerance used for station beam interpolation.
+ *
+ * @details
+ * Returns the maximum error allowed when station beams are interpolated
+ * to source positions, relative to the peak of the beam.
+ * A value of zero means station beams are always evaluated exactly.
+ *
+ * @param[in] model   Pointer to telescope model.
+ *
+ * @return The interpolation tolerance.
+ */
+OSKAR_EXPORT
+double oskar_telescope_station_beam_interp_tolerance(
+        const oskar_Telescope* model);
+
 /**
  * @brief
  * Returns the flag specifying whether numerical element patterns are enabled.
@@ -679,6 +696,22 @@ OSKAR_EXPORT
 void oskar_telescope_set_allow_station_beam_duplication(oskar_Telescope* model,
         int value);
 
+/**
+ * @brief
+ * Sets the tolerance used for station beam interpolation.
+ *
+ * @details
+ * If greater than zero, station beams in Jones E are evaluated on a grid
+ * and interpolated to source positions, provided that the sampled error
+ * relative to the beam peak is within this tolerance.
+ *
+ * @param[in] model    Pointer to telescope model.
+ * @param[in] value    Interpolation tolerance (0 to disable).
+ */
+OSKAR_EXPORT
+void oskar_telescope_set_station_beam_interp_tolerance(oskar_Telescope* model,
+        double value);
+
 /**
  * @brief
  * Sets the channel bandwidth, used for bandwidth smearing.
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_TELESCOPE_SNAPSHOT_H_
+#define OSKAR_TELESCOPE_SNAPSHOT_H_
+
+/**
+ * @file oskar_telescope_snapshot.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Saves a loaded telescope model to a single binary snapshot file.
+ *
+ * @details
+ * Writes everything defined by oskar_telescope_load() to a single
+ * versioned binary file, including any fitted element pattern data,
+ * so that the model can be loaded again in one pass by
+ * oskar_telescope_load_snapshot() without parsing the directory tree.
+ *
+ * The snapshot records the options which affect the load
+ * (precision, polarisation mode, noise and numerical pattern flags), and a
+ * fingerprint of the names, sizes and modification times of all files in
+ * the telescope model directory, which are used to detect a stale snapshot.
+ *
+ * This must be called straight after oskar_telescope_load(), before any
+ * other settings are applied. The model must be in CPU memory.
+ *
+ * @param[in] telescope   Telescope model to save.
+ * @param[in] filename    Pathname of the snapshot file to write.
+ * @param[in] source_dir  Telescope model directory the model was loaded from.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_telescope_save_snapshot(const oskar_Telescope* telescope,
+        const char* filename, const char* source_dir, int* status);
+
+/**
+ * @brief
+ * Loads a telescope model from a binary snapshot file, if it is valid.
+ *
+ * @details
+ * If the snapshot was made with the same load options as those set in
+ * the telescope model, and the files in the telescope model directory
+ * have not changed since it was written, the model is loaded from the
+ * snapshot, and this function returns 1. This is equivalent to calling
+ * oskar_telescope_load() on the directory.
+ *
+ * If the snapshot does not exist or is stale, the model is left unchanged
+ * and this function returns 0, so that the caller can load the directory
+ * and save a new snapshot.
+ *
+ * @param[in,out] telescope  Telescope model to fill.
+ * @param[in] filename       Pathname of the snapshot file to read.
+ * @param[in] source_dir     Telescope model directory to check against.
+ * @param[in,out] status     Status return code.
+ *
+ * @return 1 if the model was loaded from the snapshot, otherwise 0.
+ */
+OSKAR_EXPORT
+int oskar_telescope_load_snapshot(oskar_Telescope* telescope,
+        const char* filename, const char* source_dir, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
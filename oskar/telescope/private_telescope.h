@@ -57,6 +57,7 @@ struct oskar_Telescope
     int max_station_depth;                             /* Maximum station depth. */
     int allow_station_beam_duplication;                /* True if station beam duplication is allowed. */
     int enable_numerical_patterns;                     /* True if numerical element patterns are enabled. */
+    double station_beam_interp_tolerance;              /* Station beam interpolation tolerance (0 to disable). */
 };
 
 #ifndef OSKAR_TELESCOPE_TYPEDEF_
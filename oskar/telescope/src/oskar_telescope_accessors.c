@@ -134,6 +134,12 @@ int oskar_telescope_allow_station_beam_duplication(
     return model->allow_station_beam_duplication;
 }
 
+double oskar_telescope_station_beam_interp_tolerance(
+        const oskar_Telescope* model)
+{
+    return model->station_beam_interp_tolerance;
+}
+
 char oskar_telescope_ionosphere_screen_type(const oskar_Telescope* model)
 {
     return (char) (model->ionosphere_screen_type);
@@ -266,6 +272,12 @@ void oskar_telescope_set_allow_station_beam_duplication(oskar_Telescope* model,
     model->allow_station_beam_duplication = value;
 }
 
+void oskar_telescope_set_station_beam_interp_tolerance(oskar_Telescope* model,
+        double value)
+{
+    model->station_beam_interp_tolerance = value;
+}
+
 void oskar_telescope_set_ionosphere_screen_type(oskar_Telescope* model,
         const char* type)
 {
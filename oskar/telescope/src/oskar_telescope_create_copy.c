@@ -34,6 +34,8 @@ oskar_Telescope* oskar_telescope_create_copy(const oskar_Telescope* src,
     telescope->max_station_depth = src->max_station_depth;
     telescope->allow_station_beam_duplication = src->allow_station_beam_duplication;
     telescope->enable_numerical_patterns = src->enable_numerical_patterns;
+    telescope->station_beam_interp_tolerance =
+            src->station_beam_interp_tolerance;
     telescope->lon_rad = src->lon_rad;
     telescope->lat_rad = src->lat_rad;
     telescope->alt_metres = src->alt_metres;
@@ -0,0 +1,642 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "telescope/private_telescope.h"
+#include "telescope/oskar_telescope.h"
+#include "telescope/oskar_telescope_snapshot.h"
+#include "telescope/station/private_station.h"
+#include "telescope/station/element/private_element.h"
+#include "telescope/station/element/oskar_element.h"
+#include "splines/private_splines.h"
+#include "splines/oskar_splines.h"
+#include "utility/oskar_dir.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef OSKAR_OS_WIN
+#include <process.h>
+#define getpid _getpid
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNAPSHOT_MAGIC "OSKARTM1"
+#define SNAPSHOT_VERSION 1
+
+static const char* gain_model_file = "gain_model.h5";
+
+/*
+ * File header. Everything before payload_bytes forms the key,
+ * and must match exactly for a snapshot to be used.
+ */
+struct SnapshotHeader
+{
+    char magic[8];
+    int ints[8];
+    unsigned long long source_hash;
+    unsigned long long payload_bytes;
+};
+typedef struct SnapshotHeader SnapshotHeader;
+
+struct Writer
+{
+    FILE* file;
+    unsigned long long bytes;
+    int ok;
+};
+typedef struct Writer Writer;
+
+struct Reader
+{
+    const char* p;
+    const char* end;
+    int* status;
+};
+typedef struct Reader Reader;
+
+/* Fingerprinting of the telescope model directory (64-bit FNV-1a). */
+
+static void hash_bytes(unsigned long long* hash, const void* data, size_t n)
+{
+    size_t i;
+    const unsigned char* p = (const unsigned char*) data;
+    for (i = 0; i < n; ++i)
+    {
+        *hash ^= p[i];
+        *hash *= 1099511628211ULL;
+    }
+}
+
+static void hash_dir(unsigned long long* hash, const char* dir,
+        const char* skip_name)
+{
+    int i, num_items = 0;
+    char** items = 0;
+    oskar_dir_items(dir, NULL, 1, 1, &num_items, &items);
+    for (i = 0; i < num_items; ++i)
+    {
+        struct stat st;
+        if (skip_name && !strcmp(items[i], skip_name)) continue;
+        char* path = oskar_dir_get_path(dir, items[i]);
+        hash_bytes(hash, items[i], strlen(items[i]) + 1);
+        if (oskar_dir_exists(path))
+        {
+            hash_bytes(hash, "/", 1);
+            hash_dir(hash, path, skip_name);
+            hash_bytes(hash, "..", 2);
+        }
+        else if (stat(path, &st) == 0)
+        {
+            const long long info[2] = {
+                    (long long) st.st_size, (long long) st.st_mtime };
+            hash_bytes(hash, info, sizeof(info));
+        }
+        free(path);
+    }
+    for (i = 0; i < num_items; ++i) free(items[i]);
+    free(items);
+}
+
+static void make_header(const oskar_Telescope* tel, const char* filename,
+        const char* source_dir, SnapshotHeader* hdr)
+{
+    memset(hdr, 0, sizeof(SnapshotHeader));
+    memcpy(hdr->magic, SNAPSHOT_MAGIC, sizeof(hdr->magic));
+    hdr->ints[0] = SNAPSHOT_VERSION;
+    hdr->ints[1] = (int) sizeof(SnapshotHeader);
+    hdr->ints[2] = tel->precision;
+    hdr->ints[3] = tel->pol_mode;
+    hdr->ints[4] = tel->noise_enabled;
+    hdr->ints[5] = (int) tel->noise_seed;
+    hdr->ints[6] = tel->allow_station_beam_duplication;
+    hdr->ints[7] = tel->enable_numerical_patterns;
+    hdr->source_hash = 14695981039346656037ULL;
+    hash_dir(&hdr->source_hash, source_dir, oskar_dir_leafname(filename));
+}
+
+/* Writer functions. */
+
+static void w_bytes(Writer* w, const void* data, size_t n)
+{
+    if (!w->ok || n == 0) return;
+    w->ok = (fwrite(data, 1, n, w->file) == n);
+    w->bytes += n;
+}
+
+static void w_int(Writer* w, int value)
+{
+    w_bytes(w, &value, sizeof(int));
+}
+
+static void w_dbl(Writer* w, double value)
+{
+    w_bytes(w, &value, sizeof(double));
+}
+
+/* Arrays are stored as their type, length and contents; NULL as type 0. */
+static void w_mem(Writer* w, const oskar_Mem* mem)
+{
+    const int type = mem ? oskar_mem_type(mem) : 0;
+    const unsigned long long len = mem ? oskar_mem_length(mem) : 0;
+    w_int(w, type);
+    w_bytes(w, &len, sizeof(len));
+    if (mem && len > 0)
+        w_bytes(w, oskar_mem_void_const(mem),
+                (size_t) len * oskar_mem_element_size(type));
+}
+
+static void w_splines(Writer* w, const oskar_Splines* s)
+{
+    w_int(w, s != 0);
+    if (!s) return;
+    w_int(w, s->num_knots_x_theta);
+    w_int(w, s->num_knots_y_phi);
+    w_dbl(w, s->smoothing_factor);
+    w_mem(w, s->knots_x_theta);
+    w_mem(w, s->knots_y_phi);
+    w_mem(w, s->coeff);
+}
+
+static void w_element(Writer* w, const oskar_Element* e)
+{
+    int i;
+    w_int(w, e->x_element_type);
+    w_int(w, e->y_element_type);
+    w_int(w, e->x_taper_type);
+    w_int(w, e->y_taper_type);
+    w_int(w, e->x_dipole_length_units);
+    w_int(w, e->y_dipole_length_units);
+    w_dbl(w, e->x_dipole_length);
+    w_dbl(w, e->y_dipole_length);
+    w_dbl(w, e->x_taper_cosine_power);
+    w_dbl(w, e->y_taper_cosine_power);
+    w_dbl(w, e->x_taper_gaussian_fwhm_rad);
+    w_dbl(w, e->y_taper_gaussian_fwhm_rad);
+    w_dbl(w, e->x_taper_ref_freq_hz);
+    w_dbl(w, e->y_taper_ref_freq_hz);
+    w_int(w, e->element_type);
+    w_int(w, e->taper_type);
+    w_int(w, e->dipole_length_units);
+    w_dbl(w, e->dipole_length);
+    w_dbl(w, e->cosine_power);
+    w_dbl(w, e->gaussian_fwhm_rad);
+    w_int(w, e->coord_sys);
+    w_dbl(w, e->max_radius_rad);
+    w_int(w, e->num_freq);
+    for (i = 0; i < e->num_freq; ++i)
+    {
+        w_dbl(w, e->freqs_hz[i]);
+        w_int(w, e->l_max[i]);
+        w_int(w, e->common_phi_coords[i]);
+        w_mem(w, e->filename_x[i]);
+        w_mem(w, e->filename_y[i]);
+        w_mem(w, e->filename_scalar[i]);
+        w_splines(w, e->x_h_re[i]);
+        w_splines(w, e->x_h_im[i]);
+        w_splines(w, e->x_v_re[i]);
+        w_splines(w, e->x_v_im[i]);
+        w_splines(w, e->y_h_re[i]);
+        w_splines(w, e->y_h_im[i]);
+        w_splines(w, e->y_v_re[i]);
+        w_splines(w, e->y_v_im[i]);
+        w_splines(w, e->scalar_re[i]);
+        w_splines(w, e->scalar_im[i]);
+        w_mem(w, e->sph_wave[i]);
+    }
+}
+
+static void w_station(Writer* w, const oskar_Station* s)
+{
+    int i, feed, dim;
+    w_int(w, s->unique_id);
+    w_int(w, s->station_type);
+    w_int(w, s->normalise_final_beam);
+    for (i = 0; i < 3; ++i) w_dbl(w, s->offset_ecef[i]);
+    w_dbl(w, s->lon_rad);
+    w_dbl(w, s->lat_rad);
+    w_dbl(w, s->alt_metres);
+    w_dbl(w, s->pm_x_rad);
+    w_dbl(w, s->pm_y_rad);
+    w_dbl(w, s->beam_lon_rad);
+    w_dbl(w, s->beam_lat_rad);
+    w_int(w, s->beam_coord_type);
+    w_mem(w, s->noise_freq_hz);
+    w_mem(w, s->noise_rms_jy);
+    w_dbl(w, s->gaussian_beam_fwhm_rad);
+    w_dbl(w, s->gaussian_beam_reference_freq_hz);
+    w_int(w, s->identical_children);
+    w_int(w, s->num_elements);
+    w_int(w, s->normalise_array_pattern);
+    w_int(w, s->normalise_element_pattern);
+    w_int(w, s->enable_array_pattern);
+    w_int(w, s->common_element_orientation);
+    w_int(w, s->common_pol_beams);
+    w_int(w, s->swap_xy);
+    w_int(w, s->array_is_3d);
+    w_int(w, s->apply_element_errors);
+    w_int(w, s->apply_element_weight);
+    w_int(w, (int) s->seed_time_variable_errors);
+    for (feed = 0; feed < 2; feed++)
+    {
+        for (dim = 0; dim < 3; dim++)
+        {
+            w_mem(w, s->element_true_enu_metres[feed][dim]);
+            w_mem(w, s->element_measured_enu_metres[feed][dim]);
+            w_mem(w, s->element_euler_cpu[feed][dim]);
+        }
+        w_mem(w, s->element_gain[feed]);
+        w_mem(w, s->element_gain_error[feed]);
+        w_mem(w, s->element_phase_offset_rad[feed]);
+        w_mem(w, s->element_phase_error_rad[feed]);
+        w_mem(w, s->element_weight[feed]);
+        w_mem(w, s->element_cable_length_error[feed]);
+    }
+    w_mem(w, s->element_types);
+    w_mem(w, s->element_types_cpu);
+    w_mem(w, s->element_mount_types_cpu);
+    w_int(w, s->num_permitted_beams);
+    w_mem(w, s->permitted_beam_az_rad);
+    w_mem(w, s->permitted_beam_el_rad);
+
+    /* Element models, then child stations. */
+    w_int(w, s->element ? s->num_element_types : 0);
+    for (i = 0; s->element && i < s->num_element_types; ++i)
+        w_element(w, s->element[i]);
+    w_int(w, s->child != 0);
+    for (i = 0; s->child && i < s->num_elements; ++i)
+        w_station(w, s->child[i]);
+}
+
+static void w_telescope(Writer* w, const oskar_Telescope* t)
+{
+    int i;
+    w_dbl(w, t->lon_rad);
+    w_dbl(w, t->lat_rad);
+    w_dbl(w, t->alt_metres);
+    w_int(w, t->supplied_coord_type);
+    w_int(w, t->num_stations);
+    w_int(w, t->max_station_size);
+    w_int(w, t->max_station_depth);
+    w_int(w, oskar_gains_defined(t->gains));
+    for (i = 0; i < 3; ++i)
+    {
+        w_mem(w, t->station_true_geodetic_rad[i]);
+        w_mem(w, t->station_true_offset_ecef_metres[i]);
+        w_mem(w, t->station_true_enu_metres[i]);
+        w_mem(w, t->station_measured_offset_ecef_metres[i]);
+        w_mem(w, t->station_measured_enu_metres[i]);
+    }
+    w_mem(w, t->station_type_map);
+    w_int(w, t->num_station_models);
+    for (i = 0; i < t->num_station_models; ++i)
+        w_station(w, t->station[i]);
+}
+
+/* Reader functions. */
+
+static void r_bytes(Reader* r, void* data, size_t n)
+{
+    if (*r->status) return;
+    if ((size_t) (r->end - r->p) < n)
+    {
+        *r->status = OSKAR_ERR_FILE_IO;
+        return;
+    }
+    memcpy(data, r->p, n);
+    r->p += n;
+}
+
+static int r_int(Reader* r)
+{
+    int value = 0;
+    r_bytes(r, &value, sizeof(int));
+    return value;
+}
+
+static double r_dbl(Reader* r)
+{
+    double value = 0.0;
+    r_bytes(r, &value, sizeof(double));
+    return value;
+}
+
+/* Replaces the array with the one in the snapshot. */
+static void r_mem(Reader* r, oskar_Mem** mem)
+{
+    unsigned long long len = 0;
+    const int type = r_int(r);
+    r_bytes(r, &len, sizeof(len));
+    oskar_mem_free(*mem, r->status);
+    *mem = 0;
+    if (*r->status || type == 0) return;
+    const size_t bytes = (size_t) len * oskar_mem_element_size(type);
+    if ((size_t) (r->end - r->p) < bytes)
+    {
+        *r->status = OSKAR_ERR_FILE_IO;
+        return;
+    }
+    *mem = oskar_mem_create(type, OSKAR_CPU, (size_t) len, r->status);
+    if (*r->status) return;
+    if (bytes > 0) memcpy(oskar_mem_void(*mem), r->p, bytes);
+    r->p += bytes;
+}
+
+static oskar_Splines* r_splines(Reader* r, int precision)
+{
+    if (!r_int(r) || *r->status) return 0;
+    oskar_Splines* s = oskar_splines_create(precision, OSKAR_CPU, r->status);
+    if (!s) return 0;
+    s->num_knots_x_theta = r_int(r);
+    s->num_knots_y_phi = r_int(r);
+    s->smoothing_factor = r_dbl(r);
+    r_mem(r, &s->knots_x_theta);
+    r_mem(r, &s->knots_y_phi);
+    r_mem(r, &s->coeff);
+    return s;
+}
+
+static void r_element(Reader* r, oskar_Element* e)
+{
+    int i;
+    const int prec = e->precision;
+    e->x_element_type = r_int(r);
+    e->y_element_type = r_int(r);
+    e->x_taper_type = r_int(r);
+    e->y_taper_type = r_int(r);
+    e->x_dipole_length_units = r_int(r);
+    e->y_dipole_length_units = r_int(r);
+    e->x_dipole_length = r_dbl(r);
+    e->y_dipole_length = r_dbl(r);
+    e->x_taper_cosine_power = r_dbl(r);
+    e->y_taper_cosine_power = r_dbl(r);
+    e->x_taper_gaussian_fwhm_rad = r_dbl(r);
+    e->y_taper_gaussian_fwhm_rad = r_dbl(r);
+    e->x_taper_ref_freq_hz = r_dbl(r);
+    e->y_taper_ref_freq_hz = r_dbl(r);
+    e->element_type = r_int(r);
+    e->taper_type = r_int(r);
+    e->dipole_length_units = r_int(r);
+    e->dipole_length = r_dbl(r);
+    e->cosine_power = r_dbl(r);
+    e->gaussian_fwhm_rad = r_dbl(r);
+    e->coord_sys = r_int(r);
+    e->max_radius_rad = r_dbl(r);
+    oskar_element_resize_freq_data(e, r_int(r), r->status);
+    for (i = 0; i < e->num_freq && !*r->status; ++i)
+    {
+        e->freqs_hz[i] = r_dbl(r);
+        e->l_max[i] = r_int(r);
+        e->common_phi_coords[i] = r_int(r);
+        r_mem(r, &e->filename_x[i]);
+        r_mem(r, &e->filename_y[i]);
+        r_mem(r, &e->filename_scalar[i]);
+        e->x_h_re[i] = r_splines(r, prec);
+        e->x_h_im[i] = r_splines(r, prec);
+        e->x_v_re[i] = r_splines(r, prec);
+        e->x_v_im[i] = r_splines(r, prec);
+        e->y_h_re[i] = r_splines(r, prec);
+        e->y_h_im[i] = r_splines(r, prec);
+        e->y_v_re[i] = r_splines(r, prec);
+        e->y_v_im[i] = r_splines(r, prec);
+        e->scalar_re[i] = r_splines(r, prec);
+        e->scalar_im[i] = r_splines(r, prec);
+        r_mem(r, &e->sph_wave[i]);
+    }
+}
+
+static oskar_Station* r_station(Reader* r, int precision)
+{
+    int i, feed, dim;
+    oskar_Station* s = oskar_station_create(precision, OSKAR_CPU, 0,
+            r->status);
+    if (!s) return 0;
+    s->unique_id = r_int(r);
+    s->station_type = r_int(r);
+    s->normalise_final_beam = r_int(r);
+    for (i = 0; i < 3; ++i) s->offset_ecef[i] = r_dbl(r);
+    s->lon_rad = r_dbl(r);
+    s->lat_rad = r_dbl(r);
+    s->alt_metres = r_dbl(r);
+    s->pm_x_rad = r_dbl(r);
+    s->pm_y_rad = r_dbl(r);
+    s->beam_lon_rad = r_dbl(r);
+    s->beam_lat_rad = r_dbl(r);
+    s->beam_coord_type = r_int(r);
+    r_mem(r, &s->noise_freq_hz);
+    r_mem(r, &s->noise_rms_jy);
+    s->gaussian_beam_fwhm_rad = r_dbl(r);
+    s->gaussian_beam_reference_freq_hz = r_dbl(r);
+    s->identical_children = r_int(r);
+    s->num_elements = r_int(r);
+    s->normalise_array_pattern = r_int(r);
+    s->normalise_element_pattern = r_int(r);
+    s->enable_array_pattern = r_int(r);
+    s->common_element_orientation = r_int(r);
+    s->common_pol_beams = r_int(r);
+    s->swap_xy = r_int(r);
+    s->array_is_3d = r_int(r);
+    s->apply_element_errors = r_int(r);
+    s->apply_element_weight = r_int(r);
+    s->seed_time_variable_errors = (unsigned int) r_int(r);
+    for (feed = 0; feed < 2; feed++)
+    {
+        for (dim = 0; dim < 3; dim++)
+        {
+            r_mem(r, &s->element_true_enu_metres[feed][dim]);
+            r_mem(r, &s->element_measured_enu_metres[feed][dim]);
+            r_mem(r, &s->element_euler_cpu[feed][dim]);
+        }
+        r_mem(r, &s->element_gain[feed]);
+        r_mem(r, &s->element_gain_error[feed]);
+        r_mem(r, &s->element_phase_offset_rad[feed]);
+        r_mem(r, &s->element_phase_error_rad[feed]);
+        r_mem(r, &s->element_weight[feed]);
+        r_mem(r, &s->element_cable_length_error[feed]);
+    }
+    r_mem(r, &s->element_types);
+    r_mem(r, &s->element_types_cpu);
+    r_mem(r, &s->element_mount_types_cpu);
+    s->num_permitted_beams = r_int(r);
+    r_mem(r, &s->permitted_beam_az_rad);
+    r_mem(r, &s->permitted_beam_el_rad);
+
+    /* Element models, then child stations. */
+    oskar_station_resize_element_types(s, r_int(r), r->status);
+    for (i = 0; i < s->num_element_types && !*r->status; ++i)
+        r_element(r, s->element[i]);
+    if (r_int(r) && !*r->status)
+    {
+        s->child = (oskar_Station**) calloc(
+                s->num_elements, sizeof(oskar_Station*));
+        for (i = 0; i < s->num_elements && !*r->status; ++i)
+            s->child[i] = r_station(r, precision);
+    }
+    return s;
+}
+
+static void r_telescope(Reader* r, oskar_Telescope* t, const char* source_dir)
+{
+    int i;
+    t->lon_rad = r_dbl(r);
+    t->lat_rad = r_dbl(r);
+    t->alt_metres = r_dbl(r);
+    t->supplied_coord_type = r_int(r);
+    t->num_stations = r_int(r);
+    t->max_station_size = r_int(r);
+    t->max_station_depth = r_int(r);
+    if (r_int(r))
+    {
+        /* The gain model stays in its HDF5 file, so open it again. */
+        char* path = oskar_dir_get_path(source_dir, gain_model_file);
+        oskar_gains_open_hdf5(t->gains, path, r->status);
+        free(path);
+    }
+    for (i = 0; i < 3; ++i)
+    {
+        r_mem(r, &t->station_true_geodetic_rad[i]);
+        r_mem(r, &t->station_true_offset_ecef_metres[i]);
+        r_mem(r, &t->station_true_enu_metres[i]);
+        r_mem(r, &t->station_measured_offset_ecef_metres[i]);
+        r_mem(r, &t->station_measured_enu_metres[i]);
+    }
+    r_mem(r, &t->station_type_map);
+    const int num_station_models = r_int(r);
+    oskar_telescope_resize_station_array(t, 0, r->status);
+    if (*r->status) return;
+    t->station = (oskar_Station**) calloc(
+            num_station_models, sizeof(oskar_Station*));
+    t->num_station_models = num_station_models;
+    for (i = 0; i < num_station_models && !*r->status; ++i)
+        t->station[i] = r_station(r, t->precision);
+}
+
+void oskar_telescope_save_snapshot(const oskar_Telescope* telescope,
+        const char* filename, const char* source_dir, int* status)
+{
+    SnapshotHeader hdr;
+    Writer w;
+    char* tmp_path;
+    if (*status) return;
+    if (oskar_telescope_mem_location(telescope) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (!filename || !source_dir || !oskar_dir_exists(source_dir))
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return;
+    }
+    make_header(telescope, filename, source_dir, &hdr);
+
+    /* Write to a temporary file first, then rename it, so that
+     * concurrent runs never see a partly written file. */
+    tmp_path = (char*) calloc(strlen(filename) + 32, 1);
+    sprintf(tmp_path, "%s.%d.tmp", filename, (int) getpid());
+    w.file = fopen(tmp_path, "wb");
+    w.bytes = 0;
+    w.ok = (w.file != 0);
+    if (w.ok)
+    {
+        /* Write the payload size into the header when it is known. */
+        w_bytes(&w, &hdr, sizeof(SnapshotHeader));
+        w_telescope(&w, telescope);
+        hdr.payload_bytes = w.bytes - sizeof(SnapshotHeader);
+        if (w.ok) w.ok = (fseek(w.file, 0, SEEK_SET) == 0);
+        w_bytes(&w, &hdr, sizeof(SnapshotHeader));
+        w.ok &= (fclose(w.file) == 0);
+        if (w.ok)
+        {
+            /* Windows will not rename over an existing file. */
+#ifdef OSKAR_OS_WIN
+            remove(filename);
+#endif
+            w.ok = (rename(tmp_path, filename) == 0);
+        }
+        if (!w.ok) remove(tmp_path);
+    }
+    if (!w.ok) *status = OSKAR_ERR_FILE_IO;
+    free(tmp_path);
+}
+
+int oskar_telescope_load_snapshot(oskar_Telescope* telescope,
+        const char* filename, const char* source_dir, int* status)
+{
+    SnapshotHeader hdr;
+    Reader r;
+    char* data = 0;
+    size_t file_size = 0;
+    if (*status || !filename || !*filename) return 0;
+    if (!source_dir || !oskar_dir_exists(source_dir)) return 0;
+    if (oskar_telescope_mem_location(telescope) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return 0;
+    }
+#ifdef OSKAR_OS_WIN
+    /* No memory mapping: read the whole file. */
+    FILE* file = fopen(filename, "rb");
+    if (!file) return 0;
+    fseek(file, 0, SEEK_END);
+    file_size = (size_t) ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (file_size >= sizeof(SnapshotHeader))
+    {
+        data = (char*) malloc(file_size);
+        if (fread(data, 1, file_size, file) != file_size)
+        {
+            free(data);
+            data = 0;
+        }
+    }
+    fclose(file);
+#else
+    struct stat st;
+    const int fd = open(filename, O_RDONLY);
+    if (fd < 0) return 0;
+    if (fstat(fd, &st) == 0 && (size_t) st.st_size >= sizeof(SnapshotHeader))
+    {
+        file_size = (size_t) st.st_size;
+        data = (char*) mmap(0, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == (char*) MAP_FAILED) data = 0;
+    }
+    close(fd);
+#endif
+    if (!data) return 0;
+
+    /* Check the key and the size of the file before changing anything. */
+    const SnapshotHeader* file_hdr = (const SnapshotHeader*) data;
+    make_header(telescope, filename, source_dir, &hdr);
+    const int valid = !memcmp(file_hdr, &hdr,
+            offsetof(SnapshotHeader, payload_bytes)) &&
+            file_size == sizeof(SnapshotHeader) + file_hdr->payload_bytes;
+    if (valid)
+    {
+        r.p = data + sizeof(SnapshotHeader);
+        r.end = data + file_size;
+        r.status = status;
+        r_telescope(&r, telescope, source_dir);
+    }
+#ifdef OSKAR_OS_WIN
+    free(data);
+#else
+    munmap(data, file_size);
+#endif
+    return valid && !*status;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -18,7 +18,7 @@ KERNEL(NAME) (\
         GLOBAL FP2* E_theta,\
         GLOBAL FP2* E_phi)\
 {\
-    KERNEL_LOOP_X(int, i, 0, n)\
+    KERNEL_LOOP_PAR_X(int, i, 0, n)\
     FP sin_phi, cos_phi;\
     const int i_out = i * stride;\
     const int theta_out = i_out + E_theta_offset;\
@@ -40,7 +40,7 @@ KERNEL(NAME) (\
         const int offset,\
         GLOBAL_OUT(FP2, pattern))\
 {\
-    KERNEL_LOOP_X(int, i, 0, n)\
+    KERNEL_LOOP_PAR_X(int, i, 0, n)\
     FP amp, sin_phi, cos_phi, phi_;\
     FP4c val;\
     const int i_out = i * stride + offset;\
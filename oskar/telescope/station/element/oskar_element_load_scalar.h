@@ -61,6 +61,7 @@ extern "C" {
  * @param[in]  closeness_inc   Average fractional error factor increase (> 1).
  * @param[in]  ignore_at_poles If set, ignore data at theta = 0 and theta = 180.
  * @param[in]  ignore_below_horizon If set, ignore data at theta > 90 deg.
+ * @param[in,out] log          Pointer to log structure to use, or NULL.
  * @param[in,out] status       Status return code.
  */
 OSKAR_EXPORT
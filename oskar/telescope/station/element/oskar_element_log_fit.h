@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_ELEMENT_LOG_FIT_H_
+#define OSKAR_ELEMENT_LOG_FIT_H_
+
+/**
+ * @file oskar_element_log_fit.h
+ */
+
+#include <oskar_global.h>
+#include <log/oskar_log.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Writes the results of the spline fits for an element pattern to the log.
+ *
+ * @details
+ * Writes the average fractional error, smoothing factor and number of
+ * knots of each surface fitted at the given frequency to the log.
+ *
+ * This allows the fits to be made in threads which do not write to the log,
+ * and the results to be reported afterwards by the calling thread.
+ *
+ * @param[in] data       Pointer to element model data structure.
+ * @param[in] port       Port number to report: 1 for X dipole; 2 for Y dipole;
+ *                       0 for scalar data.
+ * @param[in] freq_hz    Frequency to select, in Hz.
+ * @param[in,out] log    Pointer to log structure to use.
+ */
+OSKAR_EXPORT
+void oskar_element_log_fit(const oskar_Element* data, int port,
+        double freq_hz, oskar_Log* log);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_ELEMENT_FIT_SURFACES_H_
+#define OSKAR_ELEMENT_FIT_SURFACES_H_
+
+#include <oskar_global.h>
+#include <log/oskar_log.h>
+#include <mem/oskar_mem.h>
+#include <splines/oskar_splines.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Writes the results of spline surface fits to the log.
+ *
+ * @details
+ * Writes the average fractional error, smoothing factor and number of
+ * knots of each fitted surface to the log, in surface order.
+ *
+ * @param[in] num_surfaces    Number of surfaces.
+ * @param[in] splines         Spline handle for each surface (may be NULL).
+ * @param[in] names           Name of each surface.
+ * @param[in,out] log         Pointer to log structure to use.
+ */
+void oskar_element_log_fit_surfaces(int num_surfaces,
+        oskar_Splines* const splines[], const char* const names[],
+        oskar_Log* log);
+
+/**
+ * @brief
+ * Fits spline surfaces to element pattern data concurrently.
+ *
+ * @details
+ * Fits a set of surfaces sampled at the same (theta, phi) points,
+ * one thread per surface. The spline data structures are created if
+ * required. The fit results are written to the log in surface order
+ * once all fits have finished, unless \p log is NULL.
+ *
+ * @param[in] num_surfaces    Number of surfaces to fit.
+ * @param[in,out] splines     Pointers to spline handles for each surface.
+ * @param[in] num_points      Number of data points.
+ * @param[in] theta           Theta coordinates of data points, in radians.
+ * @param[in] phi             Phi coordinates of data points, in radians.
+ * @param[in] data            Data values for each surface.
+ * @param[in] weight          Data point weights.
+ * @param[in] closeness       Target average fractional error.
+ * @param[in] closeness_inc   Factor by which to increase target on failure.
+ * @param[in] names           Name of each surface, for the log.
+ * @param[in,out] log         Pointer to log structure to use, or NULL.
+ * @param[in,out] status      Status return code.
+ */
+void oskar_element_fit_surfaces(int num_surfaces, oskar_Splines** splines[],
+        int num_points, oskar_Mem* theta, oskar_Mem* phi,
+        const oskar_Mem* const data[], const oskar_Mem* weight,
+        double closeness, double closeness_inc, const char* const names[],
+        oskar_Log* log, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
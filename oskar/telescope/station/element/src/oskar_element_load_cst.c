@@ -29,6 +29,7 @@
 #include "log/oskar_log.h"
 #include "math/oskar_cmath.h"
 #include "telescope/station/element/private_element.h"
+#include "telescope/station/element/private_element_fit_surfaces.h"
 #include "telescope/station/element/oskar_element.h"
 #include "utility/oskar_getline.h"
 
@@ -43,11 +44,6 @@ extern "C" {
 
 #define DEG2RAD (M_PI/180.0)
 
-static void fit_splines(oskar_Splines** splines_ptr, int n,
-        oskar_Mem* theta, oskar_Mem* phi, oskar_Mem* data, oskar_Mem* weight,
-        double closeness, double closeness_inc, const char* name,
-        oskar_Log* log, int* status);
-
 void oskar_element_load_cst(oskar_Element* data,
         int port, double freq_hz, const char* filename,
         double closeness, double closeness_inc, int ignore_at_poles,
@@ -247,14 +243,17 @@ void oskar_element_load_cst(oskar_Element* data,
     fclose(file);
 
     /* Fit splines to the surface data. */
-    fit_splines(data_h_re, n, theta, phi, h_re, weight,
-            closeness, closeness_inc, "H [real]", log, status);
-    fit_splines(data_h_im, n, theta, phi, h_im, weight,
-            closeness, closeness_inc, "H [imag]", log, status);
-    fit_splines(data_v_re, n, theta, phi, v_re, weight,
-            closeness, closeness_inc, "V [real]", log, status);
-    fit_splines(data_v_im, n, theta, phi, v_im, weight,
-            closeness, closeness_inc, "V [imag]", log, status);
+    {
+        oskar_Splines** splines[] = {
+                data_h_re, data_h_im, data_v_re, data_v_im
+        };
+        const oskar_Mem* const surfaces[] = {h_re, h_im, v_re, v_im};
+        const char* const names[] = {
+                "H [real]", "H [imag]", "V [real]", "V [imag]"
+        };
+        oskar_element_fit_surfaces(4, splines, n, theta, phi, surfaces,
+                weight, closeness, closeness_inc, names, log, status);
+    }
 
     /* Copy X to Y if both ports are the same. */
     if (port == 0)
@@ -287,33 +286,6 @@ void oskar_element_load_cst(oskar_Element* data,
     oskar_mem_free(weight, status);
 }
 
-
-static void fit_splines(oskar_Splines** splines_ptr, int n,
-        oskar_Mem* theta, oskar_Mem* phi, oskar_Mem* data, oskar_Mem* weight,
-        double closeness, double closeness_inc, const char* name,
-        oskar_Log* log, int* status)
-{
-    double avg_frac_error;
-    if (*status) return;
-    if (!*splines_ptr)
-        *splines_ptr = oskar_splines_create(OSKAR_DOUBLE, OSKAR_CPU, status);
-    oskar_Splines* splines = *splines_ptr;
-    if (*status) return;
-    avg_frac_error = closeness; /* Copy the fitting parameter. */
-    oskar_log_line(log, 'M', ' ');
-    oskar_log_message(log, 'M', 0, "Fitting surface %s...", name);
-    oskar_splines_fit(splines, n, oskar_mem_double(theta, status),
-            oskar_mem_double(phi, status), oskar_mem_double_const(data, status),
-            oskar_mem_double_const(weight, status), OSKAR_SPLINES_SPHERICAL, 1,
-            &avg_frac_error, closeness_inc, 1, 1e-14, status);
-    oskar_log_message(log, 'M', 1, "Surface fitted to %.4f average "
-            "frac. error (s=%.2e).", avg_frac_error,
-            oskar_splines_smoothing_factor(splines));
-    oskar_log_message(log, 'M', 1, "Number of knots (theta, phi) = (%d, %d).",
-            oskar_splines_num_knots_x_theta(splines),
-            oskar_splines_num_knots_y_phi(splines));
-}
-
 #ifdef __cplusplus
 }
 #endif
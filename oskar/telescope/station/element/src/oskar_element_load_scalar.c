@@ -29,6 +29,7 @@
 #include "log/oskar_log.h"
 #include "math/oskar_cmath.h"
 #include "telescope/station/element/private_element.h"
+#include "telescope/station/element/private_element_fit_surfaces.h"
 #include "telescope/station/element/oskar_element.h"
 #include "utility/oskar_getline.h"
 #include "utility/oskar_string_to_array.h"
@@ -44,18 +45,13 @@ extern "C" {
 
 #define DEG2RAD (M_PI/180.0)
 
-static void fit_splines(oskar_Splines* splines, int n,
-        oskar_Mem* theta, oskar_Mem* phi, oskar_Mem* data, oskar_Mem* weight,
-        double closeness, double closeness_inc, const char* name,
-        oskar_Log* log, int* status);
-
 void oskar_element_load_scalar(oskar_Element* data,
         double freq_hz, const char* filename,
         double closeness, double closeness_inc, int ignore_at_poles,
         int ignore_below_horizon, oskar_Log* log, int* status)
 {
     int i, n = 0, type = OSKAR_DOUBLE;
-    oskar_Splines *scalar_re = 0, *scalar_im = 0;
+    oskar_Splines **scalar_re = 0, **scalar_im = 0;
     oskar_Mem *theta = 0, *phi = 0, *re = 0, *im = 0, *weight = 0;
 
     /* Declare the line buffer. */
@@ -97,8 +93,8 @@ void oskar_element_load_scalar(oskar_Element* data,
     }
 
     /* Get pointers to surface data based on frequency index. */
-    scalar_re = data->scalar_re[i];
-    scalar_im = data->scalar_im[i];
+    scalar_re = &data->scalar_re[i];
+    scalar_im = &data->scalar_im[i];
 
     /* Open the file. */
     file = fopen(filename, "r");
@@ -177,12 +173,18 @@ void oskar_element_load_scalar(oskar_Element* data,
     fclose(file);
 
     /* Fit splines to the surface data. */
-    fit_splines(scalar_re, n, theta, phi, re, weight,
-            closeness, closeness_inc, "Scalar [real]", log, status);
-    fit_splines(scalar_im, n, theta, phi, im, weight,
-            closeness, closeness_inc, "Scalar [imag]", log, status);
+    {
+        oskar_Splines** splines[] = {scalar_re, scalar_im};
+        const oskar_Mem* const surfaces[] = {re, im};
+        const char* const names[] = {"Scalar [real]", "Scalar [imag]"};
+        oskar_element_fit_surfaces(2, splines, n, theta, phi, surfaces,
+                weight, closeness, closeness_inc, names, log, status);
+    }
 
     /* Store the filename. */
+    if (!data->filename_scalar[i])
+        data->filename_scalar[i] = oskar_mem_create(
+                OSKAR_CHAR, OSKAR_CPU, 0, status);
     oskar_mem_append_raw(data->filename_scalar[i], filename, OSKAR_CHAR,
                 OSKAR_CPU, 1 + strlen(filename), status);
 
@@ -195,28 +197,6 @@ void oskar_element_load_scalar(oskar_Element* data,
 }
 
 
-static void fit_splines(oskar_Splines* splines, int n,
-        oskar_Mem* theta, oskar_Mem* phi, oskar_Mem* data, oskar_Mem* weight,
-        double closeness, double closeness_inc, const char* name,
-        oskar_Log* log, int* status)
-{
-    double avg_frac_error;
-    if (*status) return;
-    avg_frac_error = closeness; /* Copy the fitting parameter. */
-    oskar_log_message(log, 'M', 0, "");
-    oskar_log_message(log, 'M', 0, "Fitting surface %s...", name);
-    oskar_splines_fit(splines, n, oskar_mem_double(theta, status),
-            oskar_mem_double(phi, status), oskar_mem_double_const(data, status),
-            oskar_mem_double_const(weight, status), OSKAR_SPLINES_SPHERICAL, 1,
-            &avg_frac_error, closeness_inc, 1, 1e-14, status);
-    oskar_log_message(log, 'M', 1, "Surface fitted to %.4f average "
-            "frac. error (s=%.2e).", avg_frac_error,
-            oskar_splines_smoothing_factor(splines));
-    oskar_log_message(log, 'M', 1, "Number of knots (theta, phi) = (%d, %d).",
-            oskar_splines_num_knots_x_theta(splines),
-            oskar_splines_num_knots_y_phi(splines));
-}
-
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "math/oskar_find_closest_match.h"
+#include "telescope/station/element/private_element.h"
+#include "telescope/station/element/private_element_fit_surfaces.h"
+#include "telescope/station/element/oskar_element.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_element_log_fit(const oskar_Element* data, int port,
+        double freq_hz, oskar_Log* log)
+{
+    int freq_id;
+    if (oskar_element_num_freq(data) == 0) return;
+
+    /* Get the frequency ID. */
+    freq_id = oskar_find_closest_match_d(freq_hz,
+            oskar_element_num_freq(data),
+            oskar_element_freqs_hz_const(data));
+
+    /* Report the surfaces for the port. */
+    if (port == 0)
+    {
+        oskar_Splines* const splines[] = {
+                data->scalar_re[freq_id], data->scalar_im[freq_id]
+        };
+        const char* const names[] = {"Scalar [real]", "Scalar [imag]"};
+        oskar_element_log_fit_surfaces(2, splines, names, log);
+    }
+    else if (port == 1 || port == 2)
+    {
+        oskar_Splines* const splines[] = {
+                port == 1 ? data->x_h_re[freq_id] : data->y_h_re[freq_id],
+                port == 1 ? data->x_h_im[freq_id] : data->y_h_im[freq_id],
+                port == 1 ? data->x_v_re[freq_id] : data->y_v_re[freq_id],
+                port == 1 ? data->x_v_im[freq_id] : data->y_v_im[freq_id]
+        };
+        const char* const names[] = {
+                "H [real]", "H [imag]", "V [real]", "V [imag]"
+        };
+        oskar_element_log_fit_surfaces(4, splines, names, log);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "splines/private_splines.h"
+#include "telescope/station/element/private_element_fit_surfaces.h"
+#include "utility/oskar_thread.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct ThreadArgs
+{
+    oskar_Splines* splines;
+    int num_points;
+    double *theta, *phi;
+    const double *data, *weight;
+    double avg_frac_error, closeness_inc;
+    int status;
+};
+typedef struct ThreadArgs ThreadArgs;
+
+static void* fit_surface(void* arg)
+{
+    ThreadArgs* a = (ThreadArgs*) arg;
+    /* The fitting function does not modify the coordinates,
+     * so these can be shared between threads. */
+    oskar_splines_fit(a->splines, a->num_points,
+            a->theta, a->phi, a->data, a->weight,
+            OSKAR_SPLINES_SPHERICAL, 1, &a->avg_frac_error,
+            a->closeness_inc, 1, 1e-14, &a->status);
+    return 0;
+}
+
+void oskar_element_log_fit_surfaces(int num_surfaces,
+        oskar_Splines* const splines[], const char* const names[],
+        oskar_Log* log)
+{
+    int i;
+    for (i = 0; i < num_surfaces; ++i)
+    {
+        if (!splines[i]) continue;
+        oskar_log_message(log, 'M', 0, "Surface %s:", names[i]);
+        oskar_log_message(log, 'M', 1, "Surface fitted to %.4f average "
+                "frac. error (s=%.2e).", splines[i]->avg_frac_error,
+                oskar_splines_smoothing_factor(splines[i]));
+        oskar_log_message(log, 'M', 1, "Number of knots (theta, phi) = "
+                "(%d, %d).", oskar_splines_num_knots_x_theta(splines[i]),
+                oskar_splines_num_knots_y_phi(splines[i]));
+    }
+}
+
+void oskar_element_fit_surfaces(int num_surfaces, oskar_Splines** splines[],
+        int num_points, oskar_Mem* theta, oskar_Mem* phi,
+        const oskar_Mem* const data[], const oskar_Mem* weight,
+        double closeness, double closeness_inc, const char* const names[],
+        oskar_Log* log, int* status)
+{
+    int i;
+    oskar_Thread** threads = 0;
+    ThreadArgs* args = 0;
+    if (*status) return;
+
+    /* Set up the arguments for each fit. */
+    threads = (oskar_Thread**) calloc(num_surfaces, sizeof(oskar_Thread*));
+    args = (ThreadArgs*) calloc(num_surfaces, sizeof(ThreadArgs));
+    for (i = 0; i < num_surfaces; ++i)
+    {
+        if (!*splines[i])
+            *splines[i] = oskar_splines_create(OSKAR_DOUBLE, OSKAR_CPU,
+                    status);
+        args[i].splines = *splines[i];
+        args[i].num_points = num_points;
+        args[i].theta = oskar_mem_double(theta, status);
+        args[i].phi = oskar_mem_double(phi, status);
+        args[i].data = oskar_mem_double_const(data[i], status);
+        args[i].weight = oskar_mem_double_const(weight, status);
+        args[i].avg_frac_error = closeness; /* Copy the fitting parameter. */
+        args[i].closeness_inc = closeness_inc;
+    }
+
+    /* Fit all the surfaces concurrently. */
+    if (!*status)
+    {
+        if (log)
+        {
+            oskar_log_line(log, 'M', ' ');
+            oskar_log_message(log, 'M', 0,
+                    "Fitting %d surfaces...", num_surfaces);
+        }
+        for (i = 0; i < num_surfaces; ++i)
+            threads[i] = oskar_thread_create(fit_surface, (void*)&args[i], 0);
+        for (i = 0; i < num_surfaces; ++i)
+        {
+            oskar_thread_join(threads[i]);
+            oskar_thread_free(threads[i]);
+        }
+    }
+
+    /* Report the results in order. */
+    for (i = 0; i < num_surfaces && !*status; ++i)
+        if (args[i].status) *status = args[i].status;
+    if (!*status && log)
+    {
+        oskar_Splines** fitted = (oskar_Splines**) calloc(
+                num_surfaces, sizeof(oskar_Splines*));
+        for (i = 0; i < num_surfaces; ++i) fitted[i] = args[i].splines;
+        oskar_element_log_fit_surfaces(num_surfaces, fitted, names, log);
+        free(fitted);
+    }
+    free(threads);
+    free(args);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -39,6 +39,7 @@ enum OSKAR_STATION_TYPE
 #include <telescope/station/oskar_station_accessors.h>
 #include <telescope/station/oskar_station_analyse.h>
 #include <telescope/station/oskar_station_beam.h>
+#include <telescope/station/oskar_station_beam_interp.h>
 #include <telescope/station/oskar_station_beam_horizon_direction.h>
 #include <telescope/station/oskar_station_create_child_stations.h>
 #include <telescope/station/oskar_station_create_copy.h>
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_STATION_BEAM_INTERP_H_
+#define OSKAR_STATION_BEAM_INTERP_H_
+
+/**
+ * @file oskar_station_beam_interp.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Evaluate the beam for a station, using interpolation where possible.
+ *
+ * @details
+ * Evaluates the beam of a station at the specified positions, in the
+ * same way as oskar_station_beam(), but may instead evaluate the beam
+ * on a regular grid of direction cosines covering the sources, and use
+ * bicubic interpolation to find the beam at each source.
+ *
+ * Sources which are near grid points below the horizon, or outside the
+ * hemisphere centred on the reference direction, or in grid cells where
+ * the beam is not smooth, always use the exact beam.
+ *
+ * The interpolated beam is checked against the exact beam at a sample of
+ * the sources. The grid is refined until the largest error, relative to
+ * the peak of the beam on the grid, is within \p tolerance, and until the
+ * number of grid points plus the number of sources that need the exact beam
+ * is no more than half the number of sources. If this would need a grid
+ * with more points than a quarter of the number of sources, the beam is
+ * evaluated exactly instead.
+ *
+ * Interpolation is used only for relative direction cosines in CPU memory,
+ * and not with an ionospheric screen. Otherwise, or if \p tolerance is not
+ * positive, this function simply calls oskar_station_beam().
+ *
+ * The number of interpolated beams and the largest sampled error
+ * are recorded in the work buffer
+ * (see oskar_station_work_beam_interp_stats()).
+ *
+ * @param[in] station           Station model.
+ * @param[in] work              Station beam workspace.
+ * @param[in] source_coord_type Type of input/source coordinates
+ *                              (OSKAR_COORD_TYPE enumerator).
+ * @param[in] num_points        Number of points at which to evaluate beam.
+ * @param[in] source_coords     Source coordinate values.
+ * @param[in] ref_lon_rad       Reference longitude in radians,
+ *                              if inputs are direction cosines.
+ * @param[in] ref_lat_rad       Reference latitude in radians,
+ *                              if inputs are direction cosines.
+ * @param[in] norm_coord_type   Type of normalisation source coordinates.
+ * @param[in] norm_lon_rad      Longitude of normalisation source, in radians.
+ * @param[in] norm_lat_rad      Latitude of normalisation source, in radians.
+ * @param[in] time_index        Simulation time index.
+ * @param[in] gast_rad          Greenwich apparent sidereal time, in radians.
+ * @param[in] frequency_hz      Observing frequency, in Hz.
+ * @param[in] tolerance         Maximum allowed error, relative to the peak.
+ * @param[in] offset_out        Start offset into output array.
+ * @param[out] beam             Output beam data.
+ * @param[in,out] status        Status return code.
+ */
+OSKAR_EXPORT
+void oskar_station_beam_interp(
+        const oskar_Station* station,
+        oskar_StationWork* work,
+        int source_coord_type,
+        int num_points,
+        const oskar_Mem* const source_coords[3],
+        double ref_lon_rad,
+        double ref_lat_rad,
+        int norm_coord_type,
+        double norm_lon_rad,
+        double norm_lat_rad,
+        int time_index,
+        double gast_rad,
+        double frequency_hz,
+        double tolerance,
+        int offset_out,
+        oskar_Mem* beam,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -23,6 +23,12 @@ struct oskar_StationWork;
 typedef struct oskar_StationWork oskar_StationWork;
 #endif /* OSKAR_STATION_WORK_TYPEDEF_ */
 
+struct oskar_Station;
+#ifndef OSKAR_STATION_TYPEDEF_
+#define OSKAR_STATION_TYPEDEF_
+typedef struct oskar_Station oskar_Station;
+#endif /* OSKAR_STATION_TYPEDEF_ */
+
 /**
  * @brief Creates a station work buffer structure.
  *
@@ -91,6 +97,79 @@ OSKAR_EXPORT
 oskar_Mem* oskar_station_work_beam(oskar_StationWork* work,
         const oskar_Mem* output_beam, size_t length, int depth, int* status);
 
+/*
+ * Size of the element weights cache used by the simulators, in weights.
+ * Each compute device has its own cache, so this allows up to 64 MB of
+ * complex doubles (32 MB in single precision) per device, which is held
+ * in GPU memory when the device is a GPU.
+ */
+#define OSKAR_STATION_WORK_WEIGHTS_CACHE_SIZE (1 << 22)
+
+/**
+ * @brief Sets the maximum size of the element weights cache.
+ *
+ * @details
+ * Element beamforming weights depend only on the station, the feed,
+ * the time index, the frequency and the beam direction, so they can be
+ * reused when evaluating the beam for different sets of source positions.
+ *
+ * The cache is disabled by default, as it assumes that station models
+ * are not modified while the work buffer is in use.
+ * Setting a size of zero disables the cache and frees all cached weights.
+ *
+ * @param[in,out] work         Pointer to station work buffer structure.
+ * @param[in]     max_elements Maximum total number of weights to cache.
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_station_work_set_weights_cache_size(oskar_StationWork* work,
+        int max_elements, int* status);
+
+/**
+ * @brief Returns element beamforming weights for a station.
+ *
+ * @details
+ * Returns the weights from oskar_station_evaluate_element_weights(),
+ * using a cached copy if they have already been evaluated with the
+ * same parameters.
+ *
+ * The returned array is owned by the work buffer, and is valid only
+ * until the next call to this function.
+ *
+ * @param[in,out] work        Pointer to station work buffer structure.
+ * @param[in]     station     Station model.
+ * @param[in]     feed        Feed index (0 = X, 1 = Y).
+ * @param[in]     wavenumber  Wavenumber (2 pi / wavelength), in radians/metre.
+ * @param[in]     x_beam      Beam direction cosine, horizontal x-component.
+ * @param[in]     y_beam      Beam direction cosine, horizontal y-component.
+ * @param[in]     z_beam      Beam direction cosine, horizontal z-component.
+ * @param[in]     time_index  Simulation time index.
+ * @param[in,out] status      Status return code.
+ */
+OSKAR_EXPORT
+const oskar_Mem* oskar_station_work_element_weights(oskar_StationWork* work,
+        const oskar_Station* station, int feed, double wavenumber,
+        double x_beam, double y_beam, double z_beam, int time_index,
+        int* status);
+
+/**
+ * @brief Returns statistics about station beam interpolation.
+ *
+ * @details
+ * Returns the number of station beams which were interpolated and the
+ * number which were evaluated exactly by oskar_station_beam_interp(),
+ * and the largest error found against the exact beam at sampled sources,
+ * relative to the beam peak.
+ *
+ * @param[in]  work             Pointer to station work buffer structure.
+ * @param[out] num_interpolated Number of interpolated station beams.
+ * @param[out] num_exact        Number of station beams evaluated exactly.
+ * @param[out] max_error        Largest sampled interpolation error.
+ */
+OSKAR_EXPORT
+void oskar_station_work_beam_interp_stats(const oskar_StationWork* work,
+        int* num_interpolated, int* num_exact, double* max_error);
+
 #ifdef __cplusplus
 }
 #endif
@@ -8,6 +8,16 @@
 
 #include <mem/oskar_mem.h>
 
+/* Element weights evaluated for one station, feed, time and frequency. */
+struct WeightsCacheEntry
+{
+    const struct oskar_Station* station;
+    int feed, time_index;
+    double wavenumber, beam[3];
+    oskar_Mem* weights;          /* Complex scalar. */
+};
+typedef struct WeightsCacheEntry WeightsCacheEntry;
+
 struct oskar_StationWork
 {
     oskar_Mem* weights;          /* Complex scalar. */
@@ -35,6 +45,18 @@ struct oskar_StationWork
 
     int num_depths;
     oskar_Mem** beam;            /* For hierarchical stations. */
+
+    /* Element weights cache. */
+    int weights_cache_max_elements, weights_cache_num_elements;
+    int weights_cache_num_entries, weights_cache_misses;
+    WeightsCacheEntry* weights_cache;
+
+    /* Station beam interpolation. */
+    oskar_Mem* interp_dir[3];    /* Real scalar. Grid or sample directions. */
+    oskar_Mem* interp_beam;      /* Beam at grid or sample directions. */
+    oskar_Mem* interp_flags;     /* Integer. */
+    int interp_num_interpolated, interp_num_exact;
+    double interp_max_error;
 };
 
 #ifndef OSKAR_STATION_WORK_TYPEDEF_
@@ -5,7 +5,6 @@
 
 #include "telescope/station/oskar_evaluate_station_beam_aperture_array.h"
 
-#include "telescope/station/oskar_station_evaluate_element_weights.h"
 #include "telescope/station/element/oskar_element_evaluate.h"
 #include "telescope/station/oskar_blank_below_horizon.h"
 #include "telescope/station/private_station_work.h"
@@ -141,10 +140,10 @@ static void oskar_evaluate_station_beam_aperture_array_private(
             {
                 const int eval_x = (i == 0 || num_feeds == 1) ? 1 : 0;
                 const int eval_y = (i == 1 || num_feeds == 1) ? 1 : 0;
-                oskar_station_evaluate_element_weights(s, i, wavenumber,
-                        beam_x, beam_y, beam_z, time_index,
-                        work->weights, work->weights_scratch, status);
-                oskar_dftw(norm_array, num_elements, wavenumber, work->weights,
+                const oskar_Mem* weights = oskar_station_work_element_weights(
+                        work, s, i, wavenumber, beam_x, beam_y, beam_z,
+                        time_index, status);
+                oskar_dftw(norm_array, num_elements, wavenumber, weights,
                         oskar_station_element_true_enu_metres_const(s, i, 0),
                         oskar_station_element_true_enu_metres_const(s, i, 1),
                         oskar_station_element_true_enu_metres_const(s, i, 2),
@@ -199,10 +198,10 @@ static void oskar_evaluate_station_beam_aperture_array_private(
         {
             const int eval_x = (i == 0 || num_feeds == 1) ? 1 : 0;
             const int eval_y = (i == 1 || num_feeds == 1) ? 1 : 0;
-            oskar_station_evaluate_element_weights(s, i, wavenumber,
-                    beam_x, beam_y, beam_z, time_index,
-                    work->weights, work->weights_scratch, status);
-            oskar_dftw(norm_array, num_elements, wavenumber, work->weights,
+            const oskar_Mem* weights = oskar_station_work_element_weights(
+                    work, s, i, wavenumber, beam_x, beam_y, beam_z,
+                    time_index, status);
+            oskar_dftw(norm_array, num_elements, wavenumber, weights,
                     oskar_station_element_true_enu_metres_const(s, i, 0),
                     oskar_station_element_true_enu_metres_const(s, i, 1),
                     oskar_station_element_true_enu_metres_const(s, i, 2),
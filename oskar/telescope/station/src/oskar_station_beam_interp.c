@@ -0,0 +1,450 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "telescope/station/private_station_work.h"
+#include "telescope/station/oskar_station.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MIN_GRID_SIZE 32
+#define MAX_GRID_SIZE 512
+#define NUM_SAMPLES 256
+
+/* Grid cells are too rough to interpolate if the third difference across
+ * them is larger than this multiple of the tolerance (relative to the peak).
+ * This catches discontinuities, such as the polarisation basis at the
+ * zenith, which may be missed by the sampled error check. */
+#define ROUGHNESS_FACTOR 16.0
+
+/* Catmull-Rom cubic interpolation weights. */
+#define CUBIC_WEIGHTS(T, W) \
+        W[0] = ((-T + 2) * T - 1) * T / 2; \
+        W[1] = ((3 * T - 5) * T * T + 2) / 2; \
+        W[2] = ((-3 * T + 4) * T + 1) * T / 2; \
+        W[3] = (T - 1) * T * T / 2;
+
+/* Interpolates the beam at one point from the (grid_size + 3)^2 grid nodes,
+ * where node (i, j) is at (l0 + (i - 1) / inv_cell_l, m0 + (j - 1) /
+ * inv_cell_m). Returns 1 without interpolating if any node used is bad. */
+#define INTERP_POINT(NAME, FP) static int NAME(const FP l, const FP m,\
+        const int grid_size, const FP l0, const FP m0, const FP inv_cell_l,\
+        const FP inv_cell_m, const int num_comp, const FP* grid,\
+        const int* bad, FP* out)\
+{\
+    int c, i, j, il, im;\
+    FP wl[4], wm[4];\
+    const int num_nodes = grid_size + 3;\
+    FP tl = (l - l0) * inv_cell_l, tm = (m - m0) * inv_cell_m;\
+    il = (int) floor(tl);\
+    im = (int) floor(tm);\
+    if (il < 0) il = 0;\
+    if (im < 0) im = 0;\
+    if (il > grid_size - 1) il = grid_size - 1;\
+    if (im > grid_size - 1) im = grid_size - 1;\
+    for (j = 0; j < 4; ++j)\
+        for (i = 0; i < 4; ++i)\
+            if (bad[(im + j) * num_nodes + il + i]) return 1;\
+    tl -= il;\
+    tm -= im;\
+    CUBIC_WEIGHTS(tl, wl)\
+    CUBIC_WEIGHTS(tm, wm)\
+    for (c = 0; c < num_comp; ++c) out[c] = (FP)0;\
+    for (j = 0; j < 4; ++j)\
+    {\
+        for (i = 0; i < 4; ++i)\
+        {\
+            const FP w = wl[i] * wm[j];\
+            const FP* g = &grid[((im + j) * num_nodes + il + i) * num_comp];\
+            for (c = 0; c < num_comp; ++c) out[c] += w * g[c];\
+        }\
+    }\
+    return 0;\
+}
+
+INTERP_POINT(interp_point_f, float)
+INTERP_POINT(interp_point_d, double)
+
+static double component(const oskar_Mem* mem, size_t i, int* status)
+{
+    return oskar_mem_precision(mem) == OSKAR_DOUBLE ?
+            oskar_mem_double_const(mem, status)[i] :
+            oskar_mem_float_const(mem, status)[i];
+}
+
+/* Flags nodes in grid cells where the beam is not smooth enough to be
+ * interpolated, using the third difference across each cell. */
+static void flag_rough_nodes(int num_nodes, int num_comp,
+        const oskar_Mem* grid, double threshold, int* bad, int* status)
+{
+    int axis, i, j, c, k;
+    for (axis = 0; axis < 2; ++axis)
+    {
+        const int stride = axis == 0 ? 1 : num_nodes;
+        for (j = 0; j < num_nodes; ++j)
+        {
+            for (i = 1; i < num_nodes - 2; ++i)
+            {
+                const int k1 = axis == 0 ?
+                        j * num_nodes + i : i * num_nodes + j;
+                const int node[] = {
+                        k1 - stride, k1, k1 + stride, k1 + 2 * stride
+                };
+                for (k = 0; k < 4; ++k) if (bad[node[k]] & 1) break;
+                if (k < 4) continue;
+                for (c = 0; c < num_comp; c += 2)
+                {
+                    double d[] = {0.0, 0.0};
+                    const double coeff[] = {-1.0, 3.0, -3.0, 1.0};
+                    for (k = 0; k < 4; ++k)
+                    {
+                        const size_t g = (size_t)node[k] * num_comp + c;
+                        d[0] += coeff[k] * component(grid, g, status);
+                        d[1] += coeff[k] * component(grid, g + 1, status);
+                    }
+                    if (sqrt(d[0] * d[0] + d[1] * d[1]) > threshold)
+                    {
+                        bad[node[1]] |= 2;
+                        bad[node[2]] |= 2;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void evaluate_exact(const oskar_Station* station,
+        oskar_StationWork* work, int num_points,
+        const oskar_Mem* const source_coords[3], double ref_lon_rad,
+        double ref_lat_rad, int norm_coord_type, double norm_lon_rad,
+        double norm_lat_rad, int time_index, double gast_rad,
+        double frequency_hz, int offset_out, oskar_Mem* beam, int* status)
+{
+    oskar_station_beam(station, work, OSKAR_COORDS_REL_DIR, num_points,
+            source_coords, ref_lon_rad, ref_lat_rad, norm_coord_type,
+            norm_lon_rad, norm_lat_rad, time_index, gast_rad, frequency_hz,
+            offset_out, beam, status);
+}
+
+void oskar_station_beam_interp(
+        const oskar_Station* station,
+        oskar_StationWork* work,
+        int source_coord_type,
+        int num_points,
+        const oskar_Mem* const source_coords[3],
+        double ref_lon_rad,
+        double ref_lat_rad,
+        int norm_coord_type,
+        double norm_lon_rad,
+        double norm_lat_rad,
+        int time_index,
+        double gast_rad,
+        double frequency_hz,
+        double tolerance,
+        int offset_out,
+        oskar_Mem* beam,
+        int* status)
+{
+    int i, j, p, grid_size, num_nodes, num_exact = 0, interpolated = 0;
+    double l_min = 1.0, l_max = -1.0, m_min = 1.0, m_max = -1.0;
+    double error = 0.0;
+    int* flags;
+    char* out;
+    if (*status) return;
+
+    /* Check if interpolation can be used. */
+    const int type = oskar_mem_precision(beam);
+    const size_t coord_size = oskar_mem_element_size(type);
+    const size_t beam_size = oskar_mem_element_size(oskar_mem_type(beam));
+    const int num_comp = oskar_mem_is_matrix(beam) ? 8 : 2;
+    const int min_nodes = (MIN_GRID_SIZE + 3) * (MIN_GRID_SIZE + 3);
+    if (tolerance <= 0.0 || source_coord_type != OSKAR_COORDS_REL_DIR ||
+            num_points < 4 * min_nodes || work->screen_type != 'N' ||
+            oskar_mem_location(beam) != OSKAR_CPU ||
+            oskar_mem_location(source_coords[0]) != OSKAR_CPU ||
+            oskar_station_type(station) == OSKAR_STATION_TYPE_ISOTROPIC)
+    {
+        oskar_station_beam(station, work, source_coord_type, num_points,
+                source_coords, ref_lon_rad, ref_lat_rad, norm_coord_type,
+                norm_lon_rad, norm_lat_rad, time_index, gast_rad,
+                frequency_hz, offset_out, beam, status);
+        if (tolerance > 0.0) work->interp_num_exact++;
+        return;
+    }
+
+    /* Get the extent of the sources in front of the reference direction. */
+    const void* src[] = {
+            oskar_mem_void_const(source_coords[0]),
+            oskar_mem_void_const(source_coords[1]),
+            oskar_mem_void_const(source_coords[2])
+    };
+    for (p = 0; p < num_points; ++p)
+    {
+        double l, m, n;
+        if (type == OSKAR_DOUBLE)
+        {
+            l = ((const double*)src[0])[p];
+            m = ((const double*)src[1])[p];
+            n = ((const double*)src[2])[p];
+        }
+        else
+        {
+            l = ((const float*)src[0])[p];
+            m = ((const float*)src[1])[p];
+            n = ((const float*)src[2])[p];
+        }
+        if (n <= 0.0) continue;
+        if (l < l_min) l_min = l;
+        if (l > l_max) l_max = l;
+        if (m < m_min) m_min = m;
+        if (m > m_max) m_max = m;
+    }
+    if (l_max < l_min) l_max = l_min = m_max = m_min = 0.0;
+
+    /* Create work arrays. */
+    if (work->interp_beam && oskar_mem_type(work->interp_beam) !=
+            oskar_mem_type(beam))
+    {
+        oskar_mem_free(work->interp_beam, status);
+        work->interp_beam = 0;
+    }
+    for (i = 0; i < 3; ++i)
+    {
+        if (work->interp_dir[i] &&
+                oskar_mem_type(work->interp_dir[i]) != type)
+        {
+            oskar_mem_free(work->interp_dir[i], status);
+            work->interp_dir[i] = 0;
+        }
+        if (!work->interp_dir[i])
+            work->interp_dir[i] = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    }
+    if (!work->interp_beam)
+        work->interp_beam = oskar_mem_create(oskar_mem_type(beam),
+                OSKAR_CPU, 0, status);
+    if (!work->interp_flags)
+        work->interp_flags = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, status);
+    oskar_mem_ensure(work->interp_flags,
+            (size_t)num_points + (MAX_GRID_SIZE + 3) * (MAX_GRID_SIZE + 3),
+            status);
+    if (*status) return;
+    flags = oskar_mem_int(work->interp_flags, status);
+    out = oskar_mem_char(beam) + offset_out * beam_size;
+
+    /* Refine the grid until the sampled error is small enough. */
+    for (grid_size = MIN_GRID_SIZE; grid_size <= MAX_GRID_SIZE;
+            grid_size *= 2)
+    {
+        int num_samples = 0, sample_index[NUM_SAMPLES];
+        double peak = 0.0;
+        num_nodes = grid_size + 3;
+        if (4 * num_nodes * num_nodes > num_points) break;
+        double cell_l = (l_max - l_min) / grid_size;
+        double cell_m = (m_max - m_min) / grid_size;
+        if (cell_l <= 0.0) cell_l = 1e-6;
+        if (cell_m <= 0.0) cell_m = 1e-6;
+
+        /* Get the grid node directions, and flag nodes outside the
+         * hemisphere. Bad node flags are stored after the source flags. */
+        int* bad = flags + num_points;
+        const int num_grid = num_nodes * num_nodes;
+        for (i = 0; i < 3; ++i)
+            oskar_mem_ensure(work->interp_dir[i], num_grid, status);
+        oskar_mem_ensure(work->interp_beam, num_grid, status);
+        if (*status) return;
+        for (j = 0; j < num_nodes; ++j)
+        {
+            for (i = 0; i < num_nodes; ++i)
+            {
+                const int k = j * num_nodes + i;
+                double l = l_min + (i - 1) * cell_l;
+                double m = m_min + (j - 1) * cell_m;
+                double n = 1.0 - l * l - m * m;
+                bad[k] = (n <= 0.0);
+                if (bad[k]) l = m = 0.0, n = 1.0;
+                else n = sqrt(n);
+                oskar_mem_set_element_real(work->interp_dir[0], k, l, status);
+                oskar_mem_set_element_real(work->interp_dir[1], k, m, status);
+                oskar_mem_set_element_real(work->interp_dir[2], k, n, status);
+            }
+        }
+
+        /* Evaluate the beam on the grid, and flag nodes below the horizon,
+         * where the beam is blanked. */
+        const oskar_Mem* const grid_dir[] = {
+                work->interp_dir[0], work->interp_dir[1], work->interp_dir[2]
+        };
+        evaluate_exact(station, work, num_grid, grid_dir,
+                ref_lon_rad, ref_lat_rad, norm_coord_type, norm_lon_rad,
+                norm_lat_rad, time_index, gast_rad, frequency_hz,
+                0, work->interp_beam, status);
+        if (*status) return;
+        for (i = 0; i < num_grid; ++i)
+        {
+            int c, blank = 1;
+            if (bad[i]) continue;
+            for (c = 0; c < num_comp; c += 2)
+            {
+                const double re = component(work->interp_beam,
+                        (size_t)i * num_comp + c, status);
+                const double im = component(work->interp_beam,
+                        (size_t)i * num_comp + c + 1, status);
+                const double amp = sqrt(re * re + im * im);
+                if (amp != 0.0) blank = 0;
+                if (amp > peak) peak = amp;
+            }
+            bad[i] = blank;
+        }
+        flag_rough_nodes(num_nodes, num_comp, work->interp_beam,
+                ROUGHNESS_FACTOR * tolerance * peak, bad, status);
+
+        /* Interpolate to the sources. */
+        if (type == OSKAR_DOUBLE)
+        {
+            const double *l = (const double*) src[0];
+            const double *m = (const double*) src[1];
+            const double *n = (const double*) src[2];
+            const double* grid = oskar_mem_double_const(
+                    work->interp_beam, status);
+#pragma omp parallel for private(p)
+            for (p = 0; p < num_points; ++p)
+            {
+                flags[p] = (n[p] <= 0.0) ? 1 : interp_point_d(l[p], m[p],
+                        grid_size, l_min, m_min, 1.0 / cell_l, 1.0 / cell_m,
+                        num_comp, grid, bad, (double*)out + p * num_comp);
+            }
+        }
+        else
+        {
+            const float *l = (const float*) src[0];
+            const float *m = (const float*) src[1];
+            const float *n = (const float*) src[2];
+            const float* grid = oskar_mem_float_const(
+                    work->interp_beam, status);
+#pragma omp parallel for private(p)
+            for (p = 0; p < num_points; ++p)
+            {
+                flags[p] = (n[p] <= 0.0f) ? 1 : interp_point_f(l[p], m[p],
+                        grid_size, (float)l_min, (float)m_min,
+                        (float)(1.0 / cell_l), (float)(1.0 / cell_m),
+                        num_comp, grid, bad, (float*)out + p * num_comp);
+            }
+        }
+
+        /* Refine the grid if too many sources need the exact beam. */
+        for (p = 0, num_exact = 0; p < num_points; ++p)
+            if (flags[p]) num_exact++;
+        if (2 * (num_grid + num_exact) > num_points) continue;
+
+        /* Evaluate the exact beam at a sample of interpolated sources. */
+        for (i = 0; i < NUM_SAMPLES; ++i)
+        {
+            p = (int)((2 * (size_t)i + 1) * num_points / (2 * NUM_SAMPLES));
+            if (flags[p]) continue;
+            for (j = 0; j < 3; ++j)
+                memcpy(oskar_mem_char(work->interp_dir[j]) +
+                        num_samples * coord_size,
+                        (const char*)src[j] + p * coord_size, coord_size);
+            sample_index[num_samples++] = p;
+        }
+        if (num_samples == 0)
+        {
+            interpolated = 1;
+            break;
+        }
+        evaluate_exact(station, work, num_samples, grid_dir,
+                ref_lon_rad, ref_lat_rad, norm_coord_type, norm_lon_rad,
+                norm_lat_rad, time_index, gast_rad, frequency_hz,
+                0, work->interp_beam, status);
+        if (*status) return;
+
+        /* Find the largest error, and use the exact values at the samples. */
+        error = 0.0;
+        for (i = 0; i < num_samples; ++i)
+        {
+            int c;
+            char* out_p = out + sample_index[i] * beam_size;
+            for (c = 0; c < num_comp; c += 2)
+            {
+                double re, im;
+                const size_t k = (size_t)i * num_comp + c;
+                if (type == OSKAR_DOUBLE)
+                {
+                    re = ((const double*)out_p)[c];
+                    im = ((const double*)out_p)[c + 1];
+                }
+                else
+                {
+                    re = ((const float*)out_p)[c];
+                    im = ((const float*)out_p)[c + 1];
+                }
+                re -= component(work->interp_beam, k, status);
+                im -= component(work->interp_beam, k + 1, status);
+                re = sqrt(re * re + im * im);
+                if (re > error) error = re;
+            }
+            memcpy(out_p, oskar_mem_char(work->interp_beam) + i * beam_size,
+                    beam_size);
+        }
+        if (peak > 0.0) error /= peak;
+        if (error <= tolerance)
+        {
+            interpolated = 1;
+            break;
+        }
+    }
+
+    /* Evaluate the exact beam for any sources that were not interpolated. */
+    if (!interpolated)
+    {
+        evaluate_exact(station, work, num_points, source_coords,
+                ref_lon_rad, ref_lat_rad, norm_coord_type, norm_lon_rad,
+                norm_lat_rad, time_index, gast_rad, frequency_hz,
+                offset_out, beam, status);
+        work->interp_num_exact++;
+        return;
+    }
+    if (num_exact > 0)
+    {
+        for (i = 0; i < 3; ++i)
+            oskar_mem_ensure(work->interp_dir[i], num_exact, status);
+        oskar_mem_ensure(work->interp_beam, num_exact, status);
+        if (*status) return;
+        for (p = 0, j = 0; p < num_points; ++p)
+        {
+            if (!flags[p]) continue;
+            for (i = 0; i < 3; ++i)
+                memcpy(oskar_mem_char(work->interp_dir[i]) + j * coord_size,
+                        (const char*)src[i] + p * coord_size, coord_size);
+            j++;
+        }
+        const oskar_Mem* const exact_dir[] = {
+                work->interp_dir[0], work->interp_dir[1], work->interp_dir[2]
+        };
+        evaluate_exact(station, work, num_exact, exact_dir,
+                ref_lon_rad, ref_lat_rad, norm_coord_type, norm_lon_rad,
+                norm_lat_rad, time_index, gast_rad, frequency_hz,
+                0, work->interp_beam, status);
+        for (p = 0, j = 0; p < num_points; ++p)
+        {
+            if (!flags[p]) continue;
+            memcpy(out + p * beam_size,
+                    oskar_mem_char(work->interp_beam) + j * beam_size,
+                    beam_size);
+            j++;
+        }
+    }
+    work->interp_num_interpolated++;
+    if (error > work->interp_max_error) work->interp_max_error = error;
+}
+
+#ifdef __cplusplus
+}
+#endif
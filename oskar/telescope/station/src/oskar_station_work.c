@@ -6,6 +6,7 @@
 #include "telescope/station/oskar_station_work.h"
 #include "telescope/station/private_station_work.h"
 #include "telescope/station/oskar_evaluate_tec_screen.h"
+#include "telescope/station/oskar_station_evaluate_element_weights.h"
 
 #include <string.h>
 
@@ -15,6 +16,7 @@ extern "C" {
 
 static void get_mem_from_template(oskar_Mem** b, const oskar_Mem* a,
         size_t length, int* status);
+static void clear_weights_cache(oskar_StationWork* work, int* status);
 
 oskar_StationWork* oskar_station_work_create(int type,
         int location, int* status)
@@ -64,8 +66,11 @@ void oskar_station_work_free(oskar_StationWork* work, int* status)
     oskar_mem_free(work->tec_screen, status);
     oskar_mem_free(work->tec_screen_path, status);
     oskar_mem_free(work->screen_output, status);
+    oskar_mem_free(work->interp_beam, status);
+    oskar_mem_free(work->interp_flags, status);
     for (i = 0; i < 3; ++i)
     {
+        oskar_mem_free(work->interp_dir[i], status);
         oskar_mem_free(work->enu[i], status);
         oskar_mem_free(work->lmn[i], status);
         oskar_mem_free(work->temp_dir_in[i], status);
@@ -73,6 +78,7 @@ void oskar_station_work_free(oskar_StationWork* work, int* status)
     }
     for (i = 0; i < work->num_depths; ++i)
         oskar_mem_free(work->beam[i], status);
+    clear_weights_cache(work, status);
     free(work);
 }
 
@@ -195,6 +201,99 @@ oskar_Mem* oskar_station_work_beam(oskar_StationWork* work,
     return work->beam[depth];
 }
 
+void oskar_station_work_set_weights_cache_size(oskar_StationWork* work,
+        int max_elements, int* status)
+{
+    if (max_elements < work->weights_cache_num_elements)
+        clear_weights_cache(work, status);
+    work->weights_cache_max_elements = max_elements > 0 ? max_elements : 0;
+}
+
+const oskar_Mem* oskar_station_work_element_weights(oskar_StationWork* work,
+        const oskar_Station* station, int feed, double wavenumber,
+        double x_beam, double y_beam, double z_beam, int time_index,
+        int* status)
+{
+    int i;
+    WeightsCacheEntry* entry = 0;
+    if (*status) return work->weights;
+    const int num_elements = oskar_station_num_elements(station);
+
+    /* Return the weights if they have been cached. */
+    for (i = 0; i < work->weights_cache_num_entries; ++i)
+    {
+        const WeightsCacheEntry* e = &work->weights_cache[i];
+        if (e->station == station && e->feed == feed &&
+                e->time_index == time_index && e->wavenumber == wavenumber &&
+                e->beam[0] == x_beam && e->beam[1] == y_beam &&
+                e->beam[2] == z_beam)
+        {
+            work->weights_cache_misses = 0;
+            return e->weights;
+        }
+    }
+
+    /* Cache the weights if there is space.
+     * If the cache is full and nothing in it has been used for a while,
+     * the working set has changed (for example, to a new block of times),
+     * so clear it and start again. */
+    if (work->weights_cache_max_elements > 0)
+    {
+        if (work->weights_cache_num_elements + num_elements >
+                work->weights_cache_max_elements &&
+                ++work->weights_cache_misses >
+                work->weights_cache_num_entries)
+            clear_weights_cache(work, status);
+        if (work->weights_cache_num_elements + num_elements <=
+                work->weights_cache_max_elements)
+        {
+            i = work->weights_cache_num_entries++;
+            work->weights_cache = (WeightsCacheEntry*) realloc(
+                    work->weights_cache,
+                    work->weights_cache_num_entries *
+                    sizeof(WeightsCacheEntry));
+            entry = &work->weights_cache[i];
+            entry->station = station;
+            entry->feed = feed;
+            entry->time_index = time_index;
+            entry->wavenumber = wavenumber;
+            entry->beam[0] = x_beam;
+            entry->beam[1] = y_beam;
+            entry->beam[2] = z_beam;
+            entry->weights = oskar_mem_create(oskar_mem_type(work->weights),
+                    oskar_mem_location(work->weights), 0, status);
+            work->weights_cache_num_elements += num_elements;
+        }
+    }
+
+    /* Evaluate the weights. */
+    oskar_station_evaluate_element_weights(station, feed, wavenumber,
+            x_beam, y_beam, z_beam, time_index,
+            entry ? entry->weights : work->weights,
+            work->weights_scratch, status);
+    return entry ? entry->weights : work->weights;
+}
+
+void oskar_station_work_beam_interp_stats(const oskar_StationWork* work,
+        int* num_interpolated, int* num_exact, double* max_error)
+{
+    *num_interpolated = work->interp_num_interpolated;
+    *num_exact = work->interp_num_exact;
+    *max_error = work->interp_max_error;
+}
+
+static void clear_weights_cache(oskar_StationWork* work, int* status)
+{
+    int i;
+    for (i = 0; i < work->weights_cache_num_entries; ++i)
+        oskar_mem_free(work->weights_cache[i].weights, status);
+    free(work->weights_cache);
+    work->weights_cache = 0;
+    work->weights_cache_num_entries = 0;
+    work->weights_cache_num_elements = 0;
+    work->weights_cache_misses = 0;
+}
+
 static void get_mem_from_template(oskar_Mem** b, const oskar_Mem* a,
         size_t length, int* status)
 {
@@ -134,6 +134,180 @@ TEST(evaluate_station_beam, test_array_pattern)
 }
 
 
+TEST(evaluate_station_beam, weights_cache)
+{
+    int error = 0;
+    const double frequency = 100e6;
+    const int station_dim = 10, num_points = 1000;
+    const double gast[] = {0.0, 0.1, 0.0, 0.2, 0.1};
+    const int num_times = sizeof(gast) / sizeof(double);
+
+    // Construct a station model with beam not at the zenith.
+    oskar_Station* station = oskar_station_create(OSKAR_DOUBLE,
+            OSKAR_CPU, station_dim * station_dim, &error);
+    oskar_station_resize_element_types(station, 1, &error);
+    oskar_station_set_position(station, 0.0, 0.9, 0.0, 0.0, 0.0, 0.0);
+    double* x_pos = (double*) malloc(station_dim * sizeof(double));
+    oskar_linspace_d(x_pos, -20.0, 20.0, station_dim);
+    oskar_meshgrid_d(
+            oskar_mem_double(oskar_station_element_measured_enu_metres(station, 0, 0), &error),
+            oskar_mem_double(oskar_station_element_measured_enu_metres(station, 0, 1), &error),
+            x_pos, station_dim, x_pos, station_dim);
+    free(x_pos);
+    oskar_station_set_phase_centre(station, OSKAR_COORDS_RADEC, 0.1, 0.6);
+    oskar_element_set_element_type(oskar_station_element(station, 0),
+            "Isotropic", &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+
+    // Generate some direction cosines.
+    oskar_Mem *l, *m, *n, *beam, *beam_ref;
+    l = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &error);
+    m = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &error);
+    n = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &error);
+    oskar_mem_random_range(l, -0.5, 0.5, &error);
+    oskar_mem_random_range(m, -0.5, 0.5, &error);
+    double* n_ = oskar_mem_double(n, &error);
+    const double* l_ = oskar_mem_double_const(l, &error);
+    const double* m_ = oskar_mem_double_const(m, &error);
+    for (int i = 0; i < num_points; ++i)
+        n_[i] = sqrt(1.0 - l_[i] * l_[i] - m_[i] * m_[i]);
+    beam = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_points, &error);
+    beam_ref = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_points, &error);
+
+    // Check that beams evaluated using cached weights are unchanged.
+    oskar_StationWork* work_ref = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &error);
+    oskar_StationWork* work = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &error);
+    oskar_station_work_set_weights_cache_size(work, 1000, &error);
+    for (int i = 0; i < num_times; ++i)
+    {
+        oskar_evaluate_station_beam_aperture_array(station, work_ref,
+                num_points, l, m, n, 0, gast[i], frequency, beam_ref, &error);
+        oskar_evaluate_station_beam_aperture_array(station, work,
+                num_points, l, m, n, 0, gast[i], frequency, beam, &error);
+        ASSERT_EQ(0, error) << oskar_get_error_string(error);
+        EXPECT_FALSE(oskar_mem_different(beam, beam_ref, num_points, &error));
+    }
+
+    // Check that the cache still works when it is too small.
+    oskar_station_work_set_weights_cache_size(work, 150, &error);
+    for (int i = 0; i < num_times; ++i)
+    {
+        oskar_evaluate_station_beam_aperture_array(station, work_ref,
+                num_points, l, m, n, 0, gast[i], frequency, beam_ref, &error);
+        oskar_evaluate_station_beam_aperture_array(station, work,
+                num_points, l, m, n, 0, gast[i], frequency, beam, &error);
+        ASSERT_EQ(0, error) << oskar_get_error_string(error);
+        EXPECT_FALSE(oskar_mem_different(beam, beam_ref, num_points, &error));
+    }
+
+    oskar_station_work_free(work, &error);
+    oskar_station_work_free(work_ref, &error);
+    oskar_station_free(station, &error);
+    oskar_mem_free(l, &error);
+    oskar_mem_free(m, &error);
+    oskar_mem_free(n, &error);
+    oskar_mem_free(beam, &error);
+    oskar_mem_free(beam_ref, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+}
+
+
+TEST(evaluate_station_beam, interpolated)
+{
+    int error = 0;
+    const double frequency = 100e6, tolerance = 5e-3;
+    const double ra0 = 0.1, dec0 = 0.6, gast = 0.0;
+    const int station_dim = 8, num_points = 40000;
+
+    // Construct a station model.
+    oskar_Station* station = oskar_station_create(OSKAR_DOUBLE,
+            OSKAR_CPU, station_dim * station_dim, &error);
+    oskar_station_resize_element_types(station, 1, &error);
+    oskar_station_set_position(station, 0.0, 0.9, 0.0, 0.0, 0.0, 0.0);
+    double* x_pos = (double*) malloc(station_dim * sizeof(double));
+    oskar_linspace_d(x_pos, -7.0, 7.0, station_dim);
+    oskar_meshgrid_d(
+            oskar_mem_double(oskar_station_element_measured_enu_metres(station, 0, 0), &error),
+            oskar_mem_double(oskar_station_element_measured_enu_metres(station, 0, 1), &error),
+            x_pos, station_dim, x_pos, station_dim);
+    free(x_pos);
+    oskar_station_set_phase_centre(station, OSKAR_COORDS_RADEC, ra0, dec0);
+    oskar_element_set_element_type(oskar_station_element(station, 0),
+            "Isotropic", &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+
+    // Generate random source directions relative to the phase centre.
+    oskar_Mem *dir[3], *beam, *beam_ref;
+    for (int i = 0; i < 3; ++i)
+        dir[i] = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &error);
+    oskar_mem_random_range(dir[0], -0.3, 0.3, &error);
+    oskar_mem_random_range(dir[1], -0.3, 0.3, &error);
+    double* n_ = oskar_mem_double(dir[2], &error);
+    const double* l_ = oskar_mem_double_const(dir[0], &error);
+    const double* m_ = oskar_mem_double_const(dir[1], &error);
+    for (int i = 0; i < num_points; ++i)
+        n_[i] = sqrt(1.0 - l_[i] * l_[i] - m_[i] * m_[i]);
+    beam = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_CPU,
+            num_points, &error);
+    beam_ref = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_CPU,
+            num_points, &error);
+
+    // Evaluate the beam exactly and using interpolation.
+    oskar_StationWork* work = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &error);
+    const oskar_Mem* const coords[] = {dir[0], dir[1], dir[2]};
+    oskar_station_beam(station, work, OSKAR_COORDS_REL_DIR, num_points,
+            coords, ra0, dec0, OSKAR_COORDS_RADEC, ra0, dec0,
+            0, gast, frequency, 0, beam_ref, &error);
+    oskar_station_beam_interp(station, work, OSKAR_COORDS_REL_DIR,
+            num_points, coords, ra0, dec0, OSKAR_COORDS_RADEC, ra0, dec0,
+            0, gast, frequency, tolerance, 0, beam, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+    int num_interp = 0, num_exact = 0;
+    double max_error = 0.0;
+    oskar_station_work_beam_interp_stats(work,
+            &num_interp, &num_exact, &max_error);
+    EXPECT_EQ(1, num_interp);
+    EXPECT_EQ(0, num_exact);
+    EXPECT_LE(max_error, tolerance);
+
+    // Check the error at every source, relative to the beam peak.
+    double peak = 0.0, max_diff = 0.0;
+    const double* b = oskar_mem_double_const(beam, &error);
+    const double* b_ref = oskar_mem_double_const(beam_ref, &error);
+    for (int i = 0; i < num_points * 8; i += 2)
+    {
+        const double re = b[i] - b_ref[i], im = b[i + 1] - b_ref[i + 1];
+        const double amp = sqrt(b_ref[i] * b_ref[i] +
+                b_ref[i + 1] * b_ref[i + 1]);
+        const double diff = sqrt(re * re + im * im);
+        if (amp > peak) peak = amp;
+        if (diff > max_diff) max_diff = diff;
+    }
+    EXPECT_LT(max_diff / peak, 2.0 * tolerance);
+
+    // Check that the exact beam is used if there are too few sources.
+    oskar_station_beam_interp(station, work, OSKAR_COORDS_REL_DIR,
+            100, coords, ra0, dec0, OSKAR_COORDS_RADEC, ra0, dec0,
+            0, gast, frequency, tolerance, 0, beam, &error);
+    oskar_station_work_beam_interp_stats(work,
+            &num_interp, &num_exact, &max_error);
+    EXPECT_EQ(1, num_exact);
+    EXPECT_FALSE(oskar_mem_different(beam, beam_ref, 100, &error));
+
+    oskar_station_work_free(work, &error);
+    oskar_station_free(station, &error);
+    for (int i = 0; i < 3; ++i) oskar_mem_free(dir[i], &error);
+    oskar_mem_free(beam, &error);
+    oskar_mem_free(beam_ref, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+}
+
+
 TEST(evaluate_station_beam, gaussian)
 {
     int error = 0;
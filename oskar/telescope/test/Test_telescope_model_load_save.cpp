@@ -429,6 +429,125 @@ TEST(telescope_model_load_save, test_load_telescope_noise_rms)
 }
 
 
+TEST(telescope_model_load_save, test_snapshot)
+{
+    int err = 0;
+    const char* tm = "temp_test_telescope_snapshot";
+    const char* snapshot = "temp_test_telescope_snapshot.bin";
+    int num_stations = 3, num_tiles = 4, num_elements = 8;
+    remove(snapshot);
+
+    // Create and save a two-level telescope model.
+    oskar_Telescope* telescope = oskar_telescope_create(OSKAR_DOUBLE,
+            OSKAR_CPU, num_stations, &err);
+    oskar_telescope_resize_station_array(telescope, num_stations, &err);
+    oskar_telescope_set_unique_stations(telescope, 1, &err);
+    oskar_telescope_set_position(telescope, 0.1, 0.5, 1.0);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        double xyz[] = {1.0 * i, 2.0 * i, 3.0 * i};
+        oskar_Station* st = oskar_telescope_station(telescope, i);
+        oskar_telescope_set_station_coords(telescope, i, xyz,
+                xyz, xyz, xyz, xyz, &err);
+        oskar_station_resize(st, num_tiles, &err);
+        oskar_station_create_child_stations(st, &err);
+        for (int j = 0; j < num_tiles; ++j)
+        {
+            oskar_Station* tile = oskar_station_child(st, j);
+            xyz[0] = 10.0 * i + j;
+            xyz[1] = 20.0 * i - j;
+            oskar_station_set_element_coords(st, 0, j, xyz, xyz, &err);
+            oskar_station_resize(tile, num_elements, &err);
+            for (int k = 0; k < num_elements; ++k)
+            {
+                xyz[0] = 100.0 * i + 10.0 * j + k;
+                xyz[1] = 200.0 * i + 10.0 * j - k;
+                oskar_station_set_element_coords(tile, 0, k, xyz, xyz, &err);
+            }
+        }
+    }
+    oskar_telescope_save(telescope, tm, &err);
+    ASSERT_EQ(0, err) << oskar_get_error_string(err);
+    oskar_telescope_free(telescope, &err);
+
+    // Load the directory, and save a snapshot of it.
+    oskar_Telescope* loaded = oskar_telescope_create(OSKAR_DOUBLE,
+            OSKAR_CPU, 0, &err);
+    oskar_telescope_set_enable_numerical_patterns(loaded, 0);
+    EXPECT_EQ(0, oskar_telescope_load_snapshot(loaded, snapshot, tm, &err));
+    oskar_telescope_load(loaded, tm, NULL, &err);
+    oskar_telescope_save_snapshot(loaded, snapshot, tm, &err);
+    ASSERT_EQ(0, err) << oskar_get_error_string(err);
+
+    // Load the snapshot, and check it matches the directory.
+    oskar_Telescope* snap = oskar_telescope_create(OSKAR_DOUBLE,
+            OSKAR_CPU, 0, &err);
+    oskar_telescope_set_enable_numerical_patterns(snap, 0);
+    ASSERT_EQ(1, oskar_telescope_load_snapshot(snap, snapshot, tm, &err));
+    ASSERT_EQ(0, err) << oskar_get_error_string(err);
+    ASSERT_EQ(num_stations, oskar_telescope_num_stations(snap));
+    ASSERT_EQ(num_stations, oskar_telescope_num_station_models(snap));
+    EXPECT_EQ(oskar_telescope_lon_rad(loaded), oskar_telescope_lon_rad(snap));
+    EXPECT_EQ(oskar_telescope_lat_rad(loaded), oskar_telescope_lat_rad(snap));
+    EXPECT_EQ(oskar_telescope_max_station_size(loaded),
+            oskar_telescope_max_station_size(snap));
+    for (int dim = 0; dim < 3; dim++)
+    {
+        EXPECT_FALSE(oskar_mem_different(
+                oskar_telescope_station_true_enu_metres(loaded, dim),
+                oskar_telescope_station_true_enu_metres(snap, dim), 0, &err));
+    }
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_Station* s1 = oskar_telescope_station(loaded, i);
+        oskar_Station* s2 = oskar_telescope_station(snap, i);
+        ASSERT_TRUE(oskar_station_has_child(s2));
+        for (int j = 0; j < num_tiles; ++j)
+        {
+            oskar_Station* c1 = oskar_station_child(s1, j);
+            oskar_Station* c2 = oskar_station_child(s2, j);
+            ASSERT_EQ(num_elements, oskar_station_num_elements(c2));
+            for (int dim = 0; dim < 3; dim++)
+            {
+                EXPECT_FALSE(oskar_mem_different(
+                        oskar_station_element_measured_enu_metres(c1, 0, dim),
+                        oskar_station_element_measured_enu_metres(c2, 0, dim),
+                        0, &err));
+            }
+        }
+    }
+    ASSERT_EQ(0, err) << oskar_get_error_string(err);
+
+    // Check the snapshot is not used with different load options.
+    oskar_Telescope* other = oskar_telescope_create(OSKAR_SINGLE,
+            OSKAR_CPU, 0, &err);
+    oskar_telescope_set_enable_numerical_patterns(other, 0);
+    EXPECT_EQ(0, oskar_telescope_load_snapshot(other, snapshot, tm, &err));
+    EXPECT_EQ(0, oskar_telescope_num_station_models(other));
+    oskar_telescope_free(other, &err);
+
+    // Check the snapshot is stale after a file in the directory changes.
+    {
+        char* path = oskar_dir_get_path(tm, "position.txt");
+        FILE* f = fopen(path, "a");
+        fprintf(f, "\n");
+        fclose(f);
+        free(path);
+    }
+    other = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &err);
+    oskar_telescope_set_enable_numerical_patterns(other, 0);
+    EXPECT_EQ(0, oskar_telescope_load_snapshot(other, snapshot, tm, &err));
+    EXPECT_EQ(0, oskar_telescope_num_station_models(other));
+    ASSERT_EQ(0, err) << oskar_get_error_string(err);
+
+    // Clean up.
+    oskar_telescope_free(other, &err);
+    oskar_telescope_free(loaded, &err);
+    oskar_telescope_free(snap, &err);
+    oskar_dir_remove(tm);
+    remove(snapshot);
+}
+
 static void generate_noisy_telescope(const char* dir, int num_stations,
         const vector<double>& freqs, const vector<double>& noise)
 {
@@ -211,6 +211,28 @@ void oskar_device_launch_kernel(const char* name, int location,
         size_t num_args, const oskar_Arg* arg,
         size_t num_local_args, const size_t* arg_size_local, int* status);
 
+/**
+ * @brief Returns the free memory and cache size of the specified device.
+ *
+ * @details
+ * This function returns the amount of free global memory on the specified
+ * device, and the size of its global memory cache, both in bytes.
+ * Values which are not known, or which are requested for a CPU location,
+ * are returned as zero.
+ *
+ * OpenCL devices do not report their free memory, so the total size of
+ * global memory is returned for them instead.
+ * For CUDA devices, this makes the specified device the current one.
+ *
+ * @param[in] location    Enumerated device location.
+ * @param[in] id          Device ID.
+ * @param[out] mem_free   Free global memory, in bytes.
+ * @param[out] mem_cache  Global memory cache size, in bytes.
+ */
+OSKAR_EXPORT
+void oskar_device_mem_info(int location, int id,
+        size_t* mem_free, size_t* mem_cache);
+
 /**
  * @brief Returns the name of the specified device.
  *
@@ -24,6 +24,7 @@
 #define ATOMIC_ADD_UPDATE(TYPE, ARRAY, IDX, VAL)\
     M_CAT(ATOMIC_ADD_UPDATE_, TYPE)(ARRAY, IDX, VAL)
 #define ROUND(FP, X) M_CAT(ROUND_, FP)(X)
+#define SINCOS_FP(FP, X, S, C) M_CAT(SINCOS_, FP)(X, S, C)
 
 #ifdef __CUDACC__
 
@@ -55,6 +56,7 @@
     if (I >= N) return;\
 
 #define KERNEL_LOOP_PAR_X(TYPE, I, OFFSET, N) KERNEL_LOOP_X(TYPE, I, OFFSET, N)
+#define KERNEL_LOOP_PAR_Y(TYPE, I, OFFSET, N) KERNEL_LOOP_Y(TYPE, I, OFFSET, N)
 #define KERNEL_LOOP_END \
 
 #define LOCAL __shared__
@@ -78,6 +80,8 @@
 #define ROUND_double(X) __double2int_rn(X)
 #define RSQRT(X) rsqrt(X)
 #define SINCOS(X, S, C) sincos(X, &S, &C)
+#define SINCOS_double(X, S, C) SINCOS(X, S, C)
+#define SINCOS_float(X, S, C) SINCOS(X, S, C)
 #define THREADFENCE_BLOCK __threadfence_block()
 
 #if __CUDA_ARCH__ >= 600
@@ -173,6 +177,7 @@
     if (I >= N) return;\
 
 #define KERNEL_LOOP_PAR_X(TYPE, I, OFFSET, N) KERNEL_LOOP_X(TYPE, I, OFFSET, N)
+#define KERNEL_LOOP_PAR_Y(TYPE, I, OFFSET, N) KERNEL_LOOP_Y(TYPE, I, OFFSET, N)
 #define KERNEL_LOOP_END \
 
 #define LOCAL local
@@ -193,6 +198,8 @@
 #define ROUND_double(X) (int)rint(X)
 #define RSQRT(X) rsqrt(X)
 #define SINCOS(X, S, C) S = sincos(X, &C)
+#define SINCOS_double(X, S, C) SINCOS(X, S, C)
+#define SINCOS_float(X, S, C) SINCOS(X, S, C)
 #define THREADFENCE_BLOCK mem_fence()
 #define WARP_BROADCAST(VAR, SRC_LANE) barrier(CLK_LOCAL_MEM_FENCE)
 #define WARP_DECL(X) local X
@@ -205,6 +212,7 @@
 #elif defined(__cplusplus) || defined(_MSC_VER)
 #include <cmath>
 #endif
+#include "math/oskar_sincos.h"
 
 #define ATOMIC_ADD_CAPTURE_double(ARRAY, IDX, VAL, OLD)\
     DO_PRAGMA(omp atomic capture) { OLD = ARRAY[IDX]; ARRAY[IDX] += VAL; }
@@ -238,6 +246,11 @@
     DO_PRAGMA(omp parallel for private(I))\
     for (I = OFFSET; I < N; I++) {\
 
+#define KERNEL_LOOP_PAR_Y(TYPE, I, OFFSET, N)\
+    TYPE I;\
+    DO_PRAGMA(omp parallel for private(I))\
+    for (I = OFFSET; I < N; I++) {\
+
 #define KERNEL_LOOP_END }\
 
 #define LOCAL
@@ -251,6 +264,8 @@
 #define ROUND_double(X) (int)round(X)
 #define RSQRT(X) (1 / sqrt(X))
 #define SINCOS(X, S, C) S = sin(X); C = cos(X)
+#define SINCOS_double(X, S, C) oskar_sincos_d(X, &S, &C)
+#define SINCOS_float(X, S, C) oskar_sincos_f(X, &S, &C)
 #define THREADFENCE_BLOCK
 
 #endif
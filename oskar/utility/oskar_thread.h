@@ -42,9 +42,11 @@ extern "C" {
 struct oskar_Mutex;
 struct oskar_Thread;
 struct oskar_Barrier;
+struct oskar_ConditionVar;
 typedef struct oskar_Mutex oskar_Mutex;
 typedef struct oskar_Thread oskar_Thread;
 typedef struct oskar_Barrier oskar_Barrier;
+typedef struct oskar_ConditionVar oskar_ConditionVar;
 
 /**
  * @brief Creates a mutex.
@@ -90,6 +92,75 @@ void oskar_mutex_lock(oskar_Mutex* mutex);
 OSKAR_EXPORT
 void oskar_mutex_unlock(oskar_Mutex* mutex);
 
+/**
+ * @brief Creates a condition variable.
+ *
+ * @details
+ * Creates a condition variable, together with its own mutex.
+ */
+OSKAR_EXPORT
+oskar_ConditionVar* oskar_condition_create(void);
+
+/**
+ * @brief Destroys the condition variable.
+ *
+ * @details
+ * Destroys the condition variable.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_free(oskar_ConditionVar* var);
+
+/**
+ * @brief Locks the mutex of the condition variable.
+ *
+ * @details
+ * Locks the mutex of the condition variable.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_lock(oskar_ConditionVar* var);
+
+/**
+ * @brief Unlocks the mutex of the condition variable.
+ *
+ * @details
+ * Unlocks the mutex of the condition variable.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_unlock(oskar_ConditionVar* var);
+
+/**
+ * @brief Wakes all threads waiting on the condition variable.
+ *
+ * @details
+ * Wakes all threads waiting on the condition variable.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_notify_all(oskar_ConditionVar* var);
+
+/**
+ * @brief Waits on the condition variable.
+ *
+ * @details
+ * Releases the mutex of the condition variable and blocks the calling
+ * thread until it is woken. The mutex is locked again on return.
+ *
+ * The mutex must be locked by the calling thread, and the condition
+ * being waited for must be re-checked on return, to allow for spurious
+ * wake-ups.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_wait(oskar_ConditionVar* var);
+
 /**
  * @brief Creates and starts a thread.
  *
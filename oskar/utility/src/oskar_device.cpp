@@ -345,6 +345,31 @@ void oskar_device_launch_kernel(const char* name, int location,
         *status = OSKAR_ERR_BAD_LOCATION;
 }
 
+void oskar_device_mem_info(int location, int id,
+        size_t* mem_free, size_t* mem_cache)
+{
+    *mem_free = *mem_cache = 0;
+    if (location == OSKAR_GPU)
+    {
+        int status = 0;
+        oskar_device_set(location, id, &status);
+        if (status) return;
+        oskar_Device* device = oskar_device_create();
+        device->index = id;
+        oskar_device_get_info_cuda(device);
+        *mem_free = device->global_mem_free_size;
+        *mem_cache = device->global_mem_cache_size;
+        oskar_device_free(device);
+    }
+    else if (location & OSKAR_CL)
+    {
+        if (cl_devices_.size() == 0) oskar_device_init_cl();
+        if (id >= (int) cl_devices_.size()) return;
+        *mem_free = cl_devices_[id]->global_mem_size;
+        *mem_cache = cl_devices_[id]->global_mem_cache_size;
+    }
+}
+
 char* oskar_device_name(int location, int id)
 {
     char* name = 0;
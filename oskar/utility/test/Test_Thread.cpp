@@ -124,3 +124,66 @@ TEST(thread, barriers)
     free(args);
     free(threads);
 }
+
+struct QueueArgs
+{
+    oskar_ConditionVar* var;
+    int* next;
+    int* done;
+    int num_items;
+};
+typedef struct QueueArgs QueueArgs;
+
+void* thread_queue(void* arg)
+{
+    QueueArgs* args = (QueueArgs*) arg;
+    for (;;)
+    {
+        oskar_condition_lock(args->var);
+        const int item = (*args->next)++;
+        oskar_condition_unlock(args->var);
+        if (item >= args->num_items) break;
+        oskar_condition_lock(args->var);
+        (*args->done)++;
+        oskar_condition_notify_all(args->var);
+        oskar_condition_unlock(args->var);
+    }
+    return 0;
+}
+
+TEST(thread, condition_variable)
+{
+    // Set the number of threads and items.
+    const int num_threads = 8, num_items = 1000;
+    int next = 0, done = 0;
+
+    // Create the shared condition variable.
+    oskar_ConditionVar* var = oskar_condition_create();
+    QueueArgs args;
+    args.var = var;
+    args.next = &next;
+    args.done = &done;
+    args.num_items = num_items;
+
+    // Start all the threads.
+    oskar_Thread** threads = (oskar_Thread**)
+            calloc((size_t) num_threads, sizeof(oskar_Thread*));
+    for (int i = 0; i < num_threads; ++i)
+        threads[i] = oskar_thread_create(thread_queue, (void*)(&args), 0);
+
+    // Wait until all items have been processed.
+    oskar_condition_lock(var);
+    while (done < num_items)
+        oskar_condition_wait(var);
+    oskar_condition_unlock(var);
+    EXPECT_EQ(num_items, done);
+
+    // Clean up.
+    for (int i = 0; i < num_threads; ++i)
+    {
+        oskar_thread_join(threads[i]);
+        oskar_thread_free(threads[i]);
+    }
+    oskar_condition_free(var);
+    free(threads);
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_VIS_BDA_H_
+#define OSKAR_VIS_BDA_H_
+
+/**
+ * @file oskar_vis_bda.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+#include <vis/oskar_vis_block.h>
+#include <vis/oskar_vis_header.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_VisBDA;
+#ifndef OSKAR_VIS_BDA_TYPEDEF_
+#define OSKAR_VIS_BDA_TYPEDEF_
+typedef struct oskar_VisBDA oskar_VisBDA;
+#endif /* OSKAR_VIS_BDA_TYPEDEF_ */
+
+/**
+ * @brief Creates a baseline-dependent averaging (BDA) stage.
+ *
+ * @details
+ * Creates a stage which averages cross-correlation visibilities in time
+ * along each baseline, so that the averaged samples are irregularly
+ * spaced in time and have baseline-dependent integration lengths.
+ *
+ * Each visibility block passed to oskar_vis_bda_add_block() must contain
+ * all the channels in the observation, as averages on a baseline are
+ * accumulated over consecutive blocks.
+ *
+ * @param[in] hdr          Visibility header describing the input blocks.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+oskar_VisBDA* oskar_vis_bda_create(const oskar_VisHeader* hdr, int* status);
+
+/**
+ * @brief Destroys the BDA stage.
+ *
+ * @param[in,out] h        Handle to BDA stage.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_bda_free(oskar_VisBDA* h, int* status);
+
+/**
+ * @brief Sets the compression parameters of the BDA stage.
+ *
+ * @details
+ * Sets the maximum change in baseline coordinates allowed within each
+ * average, from the maximum tolerated amplitude loss factor for a source
+ * at the edge of the specified field of view (as in the Python helper
+ * oskar.BDA), and the maximum time allowed within each average.
+ *
+ * The amplitude loss is evaluated at the highest frequency in the
+ * observation.
+ *
+ * @param[in,out] h                 Handle to BDA stage.
+ * @param[in]     max_fact          Maximum amplitude loss factor (> 1).
+ * @param[in]     fov_deg           Field of view radius, in degrees.
+ * @param[in]     max_avg_time_sec  Maximum averaging time, in seconds
+ *                                  (0 for no limit).
+ */
+OSKAR_EXPORT
+void oskar_vis_bda_set_compression(oskar_VisBDA* h, double max_fact,
+        double fov_deg, double max_avg_time_sec);
+
+/**
+ * @brief Adds a visibility block to the BDA stage.
+ *
+ * @details
+ * Adds the time samples in the block to the averages on each baseline.
+ * Averages that are complete are appended to the list of output rows.
+ *
+ * @param[in,out] h        Handle to BDA stage.
+ * @param[in]     blk      Visibility block to add.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_bda_add_block(oskar_VisBDA* h, const oskar_VisBlock* blk,
+        int* status);
+
+/**
+ * @brief Completes all partial averages.
+ *
+ * @details
+ * Appends all partial averages to the list of output rows.
+ * This must be called after the last block has been added.
+ *
+ * @param[in,out] h        Handle to BDA stage.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_bda_flush(oskar_VisBDA* h, int* status);
+
+/**
+ * @brief Clears the list of output rows.
+ *
+ * @param[in,out] h        Handle to BDA stage.
+ */
+OSKAR_EXPORT
+void oskar_vis_bda_clear_rows(oskar_VisBDA* h);
+
+/**
+ * @brief Returns the number of averaged output rows.
+ *
+ * @param[in] h            Handle to BDA stage.
+ */
+OSKAR_EXPORT
+int oskar_vis_bda_num_rows(const oskar_VisBDA* h);
+
+/**
+ * @brief Returns the number of input time samples added so far.
+ *
+ * @param[in] h            Handle to BDA stage.
+ */
+OSKAR_EXPORT
+int oskar_vis_bda_num_input_rows(const oskar_VisBDA* h);
+
+/**
+ * @brief Returns the number of channels in each output row.
+ *
+ * @param[in] h            Handle to BDA stage.
+ */
+OSKAR_EXPORT
+int oskar_vis_bda_num_channels(const oskar_VisBDA* h);
+
+/**
+ * @brief Returns the number of polarisations in each output row.
+ *
+ * @param[in] h            Handle to BDA stage.
+ */
+OSKAR_EXPORT
+int oskar_vis_bda_num_pols(const oskar_VisBDA* h);
+
+/**
+ * @brief Returns the antenna indices of the output rows.
+ *
+ * @param[in] h            Handle to BDA stage.
+ * @param[in] index        Antenna index (0 or 1).
+ */
+OSKAR_EXPORT
+const oskar_Mem* oskar_vis_bda_antenna_const(const oskar_VisBDA* h,
+        int index);
+
+/**
+ * @brief Returns the averaged baseline coordinates of the output rows.
+ *
+ * @param[in] h            Handle to BDA stage.
+ * @param[in] dim          Coordinate dimension (0 = u, 1 = v, 2 = w).
+ */
+OSKAR_EXPORT
+const oskar_Mem* oskar_vis_bda_uvw_metres_const(const oskar_VisBDA* h,
+        int dim);
+
+/**
+ * @brief Returns the time centroids of the output rows, in MJD(UTC) seconds.
+ *
+ * @param[in] h            Handle to BDA stage.
+ */
+OSKAR_EXPORT
+const oskar_Mem* oskar_vis_bda_time_centroid_const(const oskar_VisBDA* h);
+
+/**
+ * @brief Returns the interval lengths of the output rows, in seconds.
+ *
+ * @param[in] h            Handle to BDA stage.
+ */
+OSKAR_EXPORT
+const oskar_Mem* oskar_vis_bda_interval_const(const oskar_VisBDA* h);
+
+/**
+ * @brief Returns the exposure lengths of the output rows, in seconds.
+ *
+ * @param[in] h            Handle to BDA stage.
+ */
+OSKAR_EXPORT
+const oskar_Mem* oskar_vis_bda_exposure_const(const oskar_VisBDA* h);
+
+/**
+ * @brief Returns the weights (number of samples averaged) of output rows.
+ *
+ * @param[in] h            Handle to BDA stage.
+ */
+OSKAR_EXPORT
+const oskar_Mem* oskar_vis_bda_weight_const(const oskar_VisBDA* h);
+
+/**
+ * @brief Returns the averaged visibilities of the output rows.
+ *
+ * @details
+ * The complex double-precision array has dimensions
+ * (num_rows * num_channels * num_pols), with num_pols the fastest varying.
+ *
+ * @param[in] h            Handle to BDA stage.
+ */
+OSKAR_EXPORT
+const oskar_Mem* oskar_vis_bda_vis_const(const oskar_VisBDA* h);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_VIS_BDA_WRITE_MS_H_
+#define OSKAR_VIS_BDA_WRITE_MS_H_
+
+/**
+ * @file oskar_vis_bda_write_ms.h
+ */
+
+#include <oskar_global.h>
+#include <vis/oskar_vis_bda.h>
+#include <ms/oskar_measurement_set.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Appends the rows of baseline-dependent averaged data to a
+ * CASA Measurement Set.
+ *
+ * @details
+ * This function appends the current output rows of the BDA stage to the
+ * main table of a Measurement Set. Scalar visibilities are expanded to
+ * the polarisation dimension of the Measurement Set if required.
+ *
+ * The list of output rows is not cleared by this function.
+ *
+ * @param[in] h            Handle to BDA stage.
+ * @param[in,out] ms       Handle to a Measurement Set open for write.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_bda_write_ms(const oskar_VisBDA* h, oskar_MeasurementSet* ms,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -21,6 +21,11 @@ extern "C" {
 /**
  * @brief Add a random Gaussian noise component to the visibilities.
  *
+ * @details
+ * The random numbers are defined by the telescope noise seed, and by the
+ * baseline, time and channel indices, so the result does not depend on
+ * the number of OpenMP threads used.
+ *
  * @param[in,out] vis             Visibility block to which to add noise.
  * @param[in]     header          Visibility header.
  * @param[in]     telescope       Telescope model in use.
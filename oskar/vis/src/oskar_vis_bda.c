@@ -0,0 +1,361 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "math/oskar_cmath.h"
+#include "vis/oskar_vis_bda.h"
+
+#include <float.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_VisBDA
+{
+    /* Dimensions and options. */
+    int num_stations, num_baselines, num_channels, num_pols;
+    double duvw_max, dt_max, delta_t, exposure, t_start_sec, wavelength;
+
+    /* Output rows. */
+    int num_rows, num_input_rows;
+    oskar_Mem *ant[2], *uvw[3], *time, *interval, *exposure_out, *weight;
+    oskar_Mem *vis;
+
+    /* Current averages on each baseline. */
+    int *count;
+    double *duvw, *last_uvw, *ave_uvw, *ave_time, *ave_vis;
+};
+
+/* arcsinc(x) function from Obit. Uses Newton-Raphson method. */
+static double inv_sinc(double value)
+{
+    int i;
+    double x1 = 0.001;
+    for (i = 0; i < 1000; ++i)
+    {
+        const double x0 = x1;
+        const double a = x0 * M_PI;
+        x1 = x0 - ((sin(a) / a) - value) /
+                ((a * cos(a) - M_PI * sin(a)) / (a * a));
+        if (fabs(x1 - x0) < 1.0e-6) break;
+    }
+    return x1;
+}
+
+static void emit_row(oskar_VisBDA* h, int a1, int a2, int b, int* status)
+{
+    int c, p;
+    if (*status) return;
+
+    /* Expand output arrays if required. */
+    const int row = h->num_rows;
+    const size_t num_elements = (size_t) h->num_channels * h->num_pols;
+    if ((int) oskar_mem_length(h->time) < row + 1)
+    {
+        const size_t size = oskar_mem_length(h->time) + h->num_baselines;
+        oskar_mem_realloc(h->ant[0], size, status);
+        oskar_mem_realloc(h->ant[1], size, status);
+        oskar_mem_realloc(h->uvw[0], size, status);
+        oskar_mem_realloc(h->uvw[1], size, status);
+        oskar_mem_realloc(h->uvw[2], size, status);
+        oskar_mem_realloc(h->time, size, status);
+        oskar_mem_realloc(h->interval, size, status);
+        oskar_mem_realloc(h->exposure_out, size, status);
+        oskar_mem_realloc(h->weight, size, status);
+        oskar_mem_realloc(h->vis, size * num_elements, status);
+        if (*status) return;
+    }
+
+    /* Store the average. */
+    const int n = h->count[b];
+    const double s = 1.0 / n;
+    oskar_mem_int(h->ant[0], status)[row] = a1;
+    oskar_mem_int(h->ant[1], status)[row] = a2;
+    oskar_mem_double(h->uvw[0], status)[row] = h->ave_uvw[3 * b + 0] * s;
+    oskar_mem_double(h->uvw[1], status)[row] = h->ave_uvw[3 * b + 1] * s;
+    oskar_mem_double(h->uvw[2], status)[row] = h->ave_uvw[3 * b + 2] * s;
+    oskar_mem_double(h->time, status)[row] = h->ave_time[b] * s;
+    oskar_mem_double(h->interval, status)[row] = n * h->delta_t;
+    oskar_mem_double(h->exposure_out, status)[row] = n * h->exposure;
+    oskar_mem_double(h->weight, status)[row] = (double) n;
+    double* vis_out = oskar_mem_double(h->vis, status) +
+            2 * (size_t) row * num_elements;
+    double* vis_ave = h->ave_vis + 2 * (size_t) b * num_elements;
+    for (c = 0; c < h->num_channels; ++c)
+    {
+        for (p = 0; p < h->num_pols; ++p)
+        {
+            const int i = 2 * (c * h->num_pols + p);
+            vis_out[i + 0] = vis_ave[i + 0] * s;
+            vis_out[i + 1] = vis_ave[i + 1] * s;
+            vis_ave[i + 0] = 0.0;
+            vis_ave[i + 1] = 0.0;
+        }
+    }
+    h->num_rows++;
+
+    /* Reset the average on this baseline. */
+    h->count[b] = 0;
+    h->duvw[b] = 0.0;
+    h->ave_time[b] = 0.0;
+    h->ave_uvw[3 * b + 0] = 0.0;
+    h->ave_uvw[3 * b + 1] = 0.0;
+    h->ave_uvw[3 * b + 2] = 0.0;
+}
+
+oskar_VisBDA* oskar_vis_bda_create(const oskar_VisHeader* hdr, int* status)
+{
+    int i;
+    oskar_VisBDA* h = 0;
+    if (*status) return 0;
+    h = (oskar_VisBDA*) calloc(1, sizeof(oskar_VisBDA));
+    const int num_stations = oskar_vis_header_num_stations(hdr);
+    const int amp_type = oskar_vis_header_amp_type(hdr);
+    h->num_stations = num_stations;
+    h->num_baselines = num_stations * (num_stations - 1) / 2;
+    h->num_channels = oskar_vis_header_num_channels_total(hdr);
+    h->num_pols = oskar_type_is_matrix(amp_type) ? 4 : 1;
+    h->delta_t = oskar_vis_header_time_inc_sec(hdr);
+    h->exposure = oskar_vis_header_time_average_sec(hdr);
+    if (h->exposure <= 0.0) h->exposure = h->delta_t;
+    h->t_start_sec = oskar_vis_header_time_start_mjd_utc(hdr) * 86400.0;
+    h->wavelength = 299792458.0 / (oskar_vis_header_freq_start_hz(hdr) +
+            (h->num_channels - 1) * oskar_vis_header_freq_inc_hz(hdr));
+    h->duvw_max = DBL_MAX;
+    if (oskar_vis_header_max_channels_per_block(hdr) < h->num_channels)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return h;
+    }
+    for (i = 0; i < 2; ++i)
+        h->ant[i] = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, status);
+    for (i = 0; i < 3; ++i)
+        h->uvw[i] = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->time = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->interval = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->exposure_out = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->weight = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->vis = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, 0, status);
+    const size_t num_baselines = (size_t) h->num_baselines;
+    h->count = (int*) calloc(num_baselines, sizeof(int));
+    h->duvw = (double*) calloc(num_baselines, sizeof(double));
+    h->last_uvw = (double*) calloc(3 * num_baselines, sizeof(double));
+    h->ave_uvw = (double*) calloc(3 * num_baselines, sizeof(double));
+    h->ave_time = (double*) calloc(num_baselines, sizeof(double));
+    h->ave_vis = (double*) calloc(2 * num_baselines * h->num_channels *
+            h->num_pols, sizeof(double));
+    return h;
+}
+
+void oskar_vis_bda_free(oskar_VisBDA* h, int* status)
+{
+    int i;
+    if (!h) return;
+    for (i = 0; i < 2; ++i) oskar_mem_free(h->ant[i], status);
+    for (i = 0; i < 3; ++i) oskar_mem_free(h->uvw[i], status);
+    oskar_mem_free(h->time, status);
+    oskar_mem_free(h->interval, status);
+    oskar_mem_free(h->exposure_out, status);
+    oskar_mem_free(h->weight, status);
+    oskar_mem_free(h->vis, status);
+    free(h->count);
+    free(h->duvw);
+    free(h->last_uvw);
+    free(h->ave_uvw);
+    free(h->ave_time);
+    free(h->ave_vis);
+    free(h);
+}
+
+void oskar_vis_bda_set_compression(oskar_VisBDA* h, double max_fact,
+        double fov_deg, double max_avg_time_sec)
+{
+    h->duvw_max = h->wavelength *
+            inv_sinc(1.0 / max_fact) / (fov_deg * (M_PI / 180.0));
+    h->dt_max = max_avg_time_sec;
+}
+
+void oskar_vis_bda_add_block(oskar_VisBDA* h, const oskar_VisBlock* blk,
+        int* status)
+{
+    int a1, a2, b, c, p, t;
+    if (*status || !oskar_vis_block_has_cross_correlations(blk)) return;
+
+    /* Check dimensions. */
+    const int num_times = oskar_vis_block_num_times(blk);
+    const int num_baselines = oskar_vis_block_num_baselines(blk);
+    const int num_channels = oskar_vis_block_num_channels(blk);
+    const int start_time = oskar_vis_block_start_time_index(blk);
+    if (num_baselines != h->num_baselines ||
+            num_channels != h->num_channels ||
+            oskar_vis_block_num_pols(blk) != h->num_pols)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    const oskar_Mem* xc = oskar_vis_block_cross_correlations_const(blk);
+    const oskar_Mem* uu = oskar_vis_block_baseline_uu_metres_const(blk);
+    const oskar_Mem* vv = oskar_vis_block_baseline_vv_metres_const(blk);
+    const oskar_Mem* ww = oskar_vis_block_baseline_ww_metres_const(blk);
+    const int dbl = oskar_mem_is_double(xc);
+    const double* xc_d = dbl ? (const double*) oskar_mem_void_const(xc) : 0;
+    const float* xc_f = dbl ? 0 : (const float*) oskar_mem_void_const(xc);
+    const double* uvw_d[3] = {0, 0, 0};
+    const float* uvw_f[3] = {0, 0, 0};
+    if (dbl)
+    {
+        uvw_d[0] = oskar_mem_double_const(uu, status);
+        uvw_d[1] = oskar_mem_double_const(vv, status);
+        uvw_d[2] = oskar_mem_double_const(ww, status);
+    }
+    else
+    {
+        uvw_f[0] = oskar_mem_float_const(uu, status);
+        uvw_f[1] = oskar_mem_float_const(vv, status);
+        uvw_f[2] = oskar_mem_float_const(ww, status);
+    }
+    if (*status) return;
+
+    /* Loop over time samples in the block, then baselines. */
+    const size_t num_elements = (size_t) num_channels * h->num_pols;
+    for (t = 0; t < num_times; ++t)
+    {
+        const double time_sec = h->t_start_sec +
+                (start_time + t + 0.5) * h->delta_t;
+        for (a1 = 0, b = 0; a1 < h->num_stations; ++a1)
+        {
+            for (a2 = a1 + 1; a2 < h->num_stations; ++a2, ++b)
+            {
+                double uvw[3];
+                const size_t i_uvw = (size_t) t * num_baselines + b;
+                if (dbl)
+                {
+                    uvw[0] = uvw_d[0][i_uvw];
+                    uvw[1] = uvw_d[1][i_uvw];
+                    uvw[2] = uvw_d[2][i_uvw];
+                }
+                else
+                {
+                    uvw[0] = uvw_f[0][i_uvw];
+                    uvw[1] = uvw_f[1][i_uvw];
+                    uvw[2] = uvw_f[2][i_uvw];
+                }
+
+                /* If this sample would extend the current average
+                 * beyond the limits, save out the average first. */
+                if (h->count[b] > 0)
+                {
+                    const double du = uvw[0] - h->last_uvw[3 * b + 0];
+                    const double dv = uvw[1] - h->last_uvw[3 * b + 1];
+                    const double dw = uvw[2] - h->last_uvw[3 * b + 2];
+                    const double b_duvw = sqrt(du*du + dv*dv + dw*dw);
+                    const double dt = (h->count[b] + 1) * h->delta_t;
+                    if (h->duvw[b] + b_duvw > h->duvw_max ||
+                            (h->dt_max > 0.0 &&
+                                    dt > h->dt_max * (1.0 + 1e-9)))
+                        emit_row(h, a1, a2, b, status);
+                    else
+                        h->duvw[b] += b_duvw;
+                }
+
+                /* Accumulate into the average. */
+                h->count[b]++;
+                h->ave_time[b] += time_sec;
+                for (c = 0; c < 3; ++c)
+                {
+                    h->ave_uvw[3 * b + c] += uvw[c];
+                    h->last_uvw[3 * b + c] = uvw[c];
+                }
+                double* ave = h->ave_vis + 2 * (size_t) b * num_elements;
+                for (c = 0; c < num_channels; ++c)
+                {
+                    const size_t i_in = 2 * (size_t) h->num_pols *
+                            ((size_t) num_baselines *
+                            ((size_t) t * num_channels + c) + b);
+                    const size_t i_out = 2 * (size_t) h->num_pols * c;
+                    for (p = 0; p < 2 * h->num_pols; ++p)
+                        ave[i_out + p] += dbl ?
+                                xc_d[i_in + p] : (double) xc_f[i_in + p];
+                }
+            }
+        }
+        h->num_input_rows += num_baselines;
+    }
+}
+
+void oskar_vis_bda_flush(oskar_VisBDA* h, int* status)
+{
+    int a1, a2, b;
+    for (a1 = 0, b = 0; a1 < h->num_stations; ++a1)
+        for (a2 = a1 + 1; a2 < h->num_stations; ++a2, ++b)
+            if (h->count[b] > 0) emit_row(h, a1, a2, b, status);
+}
+
+void oskar_vis_bda_clear_rows(oskar_VisBDA* h)
+{
+    h->num_rows = 0;
+}
+
+int oskar_vis_bda_num_rows(const oskar_VisBDA* h)
+{
+    return h->num_rows;
+}
+
+int oskar_vis_bda_num_input_rows(const oskar_VisBDA* h)
+{
+    return h->num_input_rows;
+}
+
+int oskar_vis_bda_num_channels(const oskar_VisBDA* h)
+{
+    return h->num_channels;
+}
+
+int oskar_vis_bda_num_pols(const oskar_VisBDA* h)
+{
+    return h->num_pols;
+}
+
+const oskar_Mem* oskar_vis_bda_antenna_const(const oskar_VisBDA* h,
+        int index)
+{
+    return h->ant[index];
+}
+
+const oskar_Mem* oskar_vis_bda_uvw_metres_const(const oskar_VisBDA* h,
+        int dim)
+{
+    return h->uvw[dim];
+}
+
+const oskar_Mem* oskar_vis_bda_time_centroid_const(const oskar_VisBDA* h)
+{
+    return h->time;
+}
+
+const oskar_Mem* oskar_vis_bda_interval_const(const oskar_VisBDA* h)
+{
+    return h->interval;
+}
+
+const oskar_Mem* oskar_vis_bda_exposure_const(const oskar_VisBDA* h)
+{
+    return h->exposure_out;
+}
+
+const oskar_Mem* oskar_vis_bda_weight_const(const oskar_VisBDA* h)
+{
+    return h->weight;
+}
+
+const oskar_Mem* oskar_vis_bda_vis_const(const oskar_VisBDA* h)
+{
+    return h->vis;
+}
+
+#ifdef __cplusplus
+}
+#endif
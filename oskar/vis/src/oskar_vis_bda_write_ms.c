@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "ms/oskar_measurement_set.h"
+#include "vis/oskar_vis_bda_write_ms.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_vis_bda_write_ms(const oskar_VisBDA* h, oskar_MeasurementSet* ms,
+        int* status)
+{
+    int c, p, r;
+    if (*status) return;
+    const int num_rows = oskar_vis_bda_num_rows(h);
+    const int num_channels = oskar_vis_bda_num_channels(h);
+    const int num_pols_in = oskar_vis_bda_num_pols(h);
+    const int num_pols_out = (int) oskar_ms_num_pols(ms);
+    if (num_rows == 0) return;
+    if (num_pols_in > num_pols_out ||
+            (int) oskar_ms_num_channels(ms) != num_channels)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
+    /* Convert visibilities to single precision, expanding
+     * scalar values to the polarisation dimension if required. */
+    const double* in = oskar_mem_double_const(oskar_vis_bda_vis_const(h),
+            status);
+    if (*status) return;
+    float* out = (float*) calloc(2 * (size_t) num_rows * num_channels *
+            num_pols_out, sizeof(float));
+    if (!out)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    for (r = 0; r < num_rows; ++r)
+    {
+        for (c = 0; c < num_channels; ++c)
+        {
+            const size_t i_in = 2 * num_pols_in *
+                    ((size_t) r * num_channels + c);
+            const size_t i_out = 2 * num_pols_out *
+                    ((size_t) r * num_channels + c);
+            if (num_pols_in == num_pols_out)
+            {
+                for (p = 0; p < 2 * num_pols_in; ++p)
+                    out[i_out + p] = (float) in[i_in + p];
+            }
+            else
+            {
+                out[i_out + 0] = out[i_out + 6] = (float) in[i_in + 0];
+                out[i_out + 1] = out[i_out + 7] = (float) in[i_in + 1];
+            }
+        }
+    }
+
+    /* Append the rows to the Measurement Set. */
+    const int* a1 = oskar_mem_int_const(
+            oskar_vis_bda_antenna_const(h, 0), status);
+    const int* a2 = oskar_mem_int_const(
+            oskar_vis_bda_antenna_const(h, 1), status);
+    const double* uu = oskar_mem_double_const(
+            oskar_vis_bda_uvw_metres_const(h, 0), status);
+    const double* vv = oskar_mem_double_const(
+            oskar_vis_bda_uvw_metres_const(h, 1), status);
+    const double* ww = oskar_mem_double_const(
+            oskar_vis_bda_uvw_metres_const(h, 2), status);
+    const double* time = oskar_mem_double_const(
+            oskar_vis_bda_time_centroid_const(h), status);
+    const double* interval = oskar_mem_double_const(
+            oskar_vis_bda_interval_const(h), status);
+    const double* exposure = oskar_mem_double_const(
+            oskar_vis_bda_exposure_const(h), status);
+    const double* weight = oskar_mem_double_const(
+            oskar_vis_bda_weight_const(h), status);
+    if (!*status)
+        oskar_ms_write_rows(ms, oskar_ms_num_rows(ms), (unsigned int) num_rows,
+                a1, a2, uu, vv, ww, time, interval, exposure, weight, out);
+    free(out);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -13,6 +13,9 @@
 extern "C" {
 #endif
 
+/* Index of the first baseline formed by station A1, out of N stations. */
+#define FIRST_BASELINE(A1, N) ((int) ((size_t) (A1) * (2 * (N) - (A1) - 1) / 2))
+
 static void oskar_get_station_std_dev_for_channel(oskar_Mem* station_std_dev,
         double frequency_hz, const oskar_Telescope* tel, int* status)
 {
@@ -38,15 +41,20 @@ static void oskar_get_station_std_dev_for_channel(oskar_Mem* station_std_dev,
     }
 }
 
-/* Applies noise to data in a visibility block, for the given channel. */
+/* Applies noise to data in a visibility block, for the given channel.
+ *
+ * The random numbers for each baseline (and then each station, for the
+ * autocorrelations) are generated using consecutive counter values,
+ * so the counter for any baseline can be found from its index.
+ * The stations are therefore processed in parallel, while the output is
+ * independent of the number of threads used. */
 static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
         const oskar_Mem* station_std_dev, unsigned int seed,
         int global_slice_idx, int local_slice_idx,
         double channel_bandwidth_hz, double time_int_sec, int* status)
 {
-    int a1, a2, b, c = 0;
+    int a1;
     void *acorr_ptr, *xcorr_ptr;
-    double rnd[8];
     const double inv_sqrt2 = 1.0 / sqrt(2.0);
 
     /* Get pointer to start of block, and block dimensions. */
@@ -57,6 +65,12 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
     const int num_baselines  = oskar_vis_block_num_baselines(vis);
     const int num_stations   = oskar_vis_block_num_stations(vis);
 
+    /* Get the first counter value used for the autocorrelations. */
+    const int is_matrix = oskar_type_is_matrix(
+            oskar_mem_type(oskar_vis_block_cross_correlations(vis)));
+    const unsigned int c_auto = have_crosscorr ?
+            (is_matrix ? 2 : 1) * (unsigned int) num_baselines : 0;
+
     /* Get factor for conversion of sigma to SEFD. */
     const double sefd_factor = sqrt(2.0 * channel_bandwidth_hz * time_int_sec);
 
@@ -75,11 +89,14 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
         if (have_crosscorr)
         {
             float2* data = (float2*) xcorr_ptr + (num_baselines * local_slice_idx);
-            for (a1 = 0, b = 0; a1 < num_stations; ++a1)
+#pragma omp parallel for schedule(dynamic, 8)
+            for (a1 = 0; a1 < num_stations; ++a1)
             {
+                int a2, b = FIRST_BASELINE(a1, num_stations);
+                double rnd[2];
                 for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
                 {
-                    oskar_random_gaussian2(seed, c++, global_slice_idx, rnd);
+                    oskar_random_gaussian2(seed, b, global_slice_idx, rnd);
                     const double std = sqrt(st_std[a1] * st_std[a2]) * inv_sqrt2;
                     data[b].x += std * rnd[0];
                     data[b].y += std * rnd[1];
@@ -92,9 +109,11 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
             /* Autocorrelation noise. Phases are all zero after
              * autocorrelation, so ignore the imaginary components. */
             float2* data = (float2*) acorr_ptr + (num_stations * local_slice_idx);
+#pragma omp parallel for
             for (a1 = 0; a1 < num_stations; ++a1)
             {
-                oskar_random_gaussian2(seed, c++, global_slice_idx, rnd);
+                double rnd[2];
+                oskar_random_gaussian2(seed, c_auto + a1, global_slice_idx, rnd);
                 const double std = st_std[a1];
                 const double mean = sqrt(2.0) * st_std[a1];
                 data[a1].x += std * rnd[0] + mean * sefd_factor;
@@ -108,12 +127,16 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
         if (have_crosscorr)
         {
             float4c* data = (float4c*) xcorr_ptr + (num_baselines * local_slice_idx);
-            for (a1 = 0, b = 0; a1 < num_stations; ++a1)
+#pragma omp parallel for schedule(dynamic, 8)
+            for (a1 = 0; a1 < num_stations; ++a1)
             {
+                int a2, b = FIRST_BASELINE(a1, num_stations);
+                double rnd[8];
                 for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
                 {
-                    oskar_random_gaussian4(seed, c++, global_slice_idx, 0, 0, rnd);
-                    oskar_random_gaussian4(seed, c++, global_slice_idx, 0, 0, rnd + 4);
+                    const unsigned int c = 2 * (unsigned int) b;
+                    oskar_random_gaussian4(seed, c, global_slice_idx, 0, 0, rnd);
+                    oskar_random_gaussian4(seed, c + 1, global_slice_idx, 0, 0, rnd + 4);
                     const double std = sqrt(st_std[a1] * st_std[a2]);
                     data[b].a.x += std * rnd[0];
                     data[b].a.y += std * rnd[1];
@@ -132,10 +155,13 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
             /* Autocorrelation noise. Phases are all zero after
              * autocorrelation, so ignore the imaginary components. */
             float4c* data = (float4c*) acorr_ptr + (num_stations * local_slice_idx);
+#pragma omp parallel for
             for (a1 = 0; a1 < num_stations; ++a1)
             {
-                oskar_random_gaussian4(seed, c++, global_slice_idx, 0, 0, rnd);
-                oskar_random_gaussian4(seed, c++, global_slice_idx, 0, 0, rnd + 4);
+                double rnd[8];
+                const unsigned int c = c_auto + 2 * (unsigned int) a1;
+                oskar_random_gaussian4(seed, c, global_slice_idx, 0, 0, rnd);
+                oskar_random_gaussian4(seed, c + 1, global_slice_idx, 0, 0, rnd + 4);
                 const double std = st_std[a1] * sqrt(2.0);
                 const double mean = std * sefd_factor;
                 data[a1].a.x += std * rnd[0] + mean;
@@ -154,11 +180,14 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
         if (have_crosscorr)
         {
             double2* data = (double2*) xcorr_ptr + (num_baselines * local_slice_idx);
-            for (a1 = 0, b = 0; a1 < num_stations; ++a1)
+#pragma omp parallel for schedule(dynamic, 8)
+            for (a1 = 0; a1 < num_stations; ++a1)
             {
+                int a2, b = FIRST_BASELINE(a1, num_stations);
+                double rnd[2];
                 for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
                 {
-                    oskar_random_gaussian2(seed, c++, global_slice_idx, rnd);
+                    oskar_random_gaussian2(seed, b, global_slice_idx, rnd);
                     const double std = sqrt(st_std[a1] * st_std[a2]) * inv_sqrt2;
                     data[b].x += std * rnd[0];
                     data[b].y += std * rnd[1];
@@ -171,9 +200,11 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
             /* Autocorrelation noise. Phases are all zero after
              * autocorrelation, so ignore the imaginary components. */
             double2* data = (double2*) acorr_ptr + (num_stations * local_slice_idx);
+#pragma omp parallel for
             for (a1 = 0; a1 < num_stations; ++a1)
             {
-                oskar_random_gaussian2(seed, c++, global_slice_idx, rnd);
+                double rnd[2];
+                oskar_random_gaussian2(seed, c_auto + a1, global_slice_idx, rnd);
                 const double std  = st_std[a1];
                 const double mean = st_std[a1] * sefd_factor * sqrt(2.0);
                 data[a1].x += std * rnd[0] + mean;
@@ -187,12 +218,16 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
         if (have_crosscorr)
         {
             double4c* data = (double4c*) xcorr_ptr + (num_baselines * local_slice_idx);
-            for (a1 = 0, b = 0; a1 < num_stations; ++a1)
+#pragma omp parallel for schedule(dynamic, 8)
+            for (a1 = 0; a1 < num_stations; ++a1)
             {
+                int a2, b = FIRST_BASELINE(a1, num_stations);
+                double rnd[8];
                 for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
                 {
-                    oskar_random_gaussian4(seed, c++, global_slice_idx, 0, 0, rnd);
-                    oskar_random_gaussian4(seed, c++, global_slice_idx, 0, 0, rnd + 4);
+                    const unsigned int c = 2 * (unsigned int) b;
+                    oskar_random_gaussian4(seed, c, global_slice_idx, 0, 0, rnd);
+                    oskar_random_gaussian4(seed, c + 1, global_slice_idx, 0, 0, rnd + 4);
                     const double std = sqrt(st_std[a1] * st_std[a2]);
                     data[b].a.x += std * rnd[0];
                     data[b].a.y += std * rnd[1];
@@ -211,10 +246,13 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
             /* Autocorrelation noise. Phases are all zero after
              * autocorrelation, so ignore the imaginary components. */
             double4c* data = (double4c*) acorr_ptr + (num_stations * local_slice_idx);
+#pragma omp parallel for
             for (a1 = 0; a1 < num_stations; ++a1)
             {
-                oskar_random_gaussian4(seed, c++, global_slice_idx, 0, 0, rnd);
-                oskar_random_gaussian4(seed, c++, global_slice_idx, 0, 0, rnd + 4);
+                double rnd[8];
+                const unsigned int c = c_auto + 2 * (unsigned int) a1;
+                oskar_random_gaussian4(seed, c, global_slice_idx, 0, 0, rnd);
+                oskar_random_gaussian4(seed, c + 1, global_slice_idx, 0, 0, rnd + 4);
                 const double std  = st_std[a1] * sqrt(2.0);
                 const double mean = std * sefd_factor;
                 data[a1].a.x += std * rnd[0] + mean;
@@ -180,11 +180,11 @@ void oskar_vis_block_write_ms(const oskar_VisBlock* blk,
 
             /* Only write the coordinates for the first channel. */
             if (start_chan_index == 0)
-                oskar_ms_write_coords_d(ms, row0, num_baseln_out,
+                oskar_ms_write_coords_status_d(ms, row0, num_baseln_out,
                         (double*)uu_out, (double*)vv_out, (double*)ww_out,
                         exposure_sec, interval_sec,
                         (start_time_index + t + 0.5) * interval_sec +
-                        t_start_sec);
+                        t_start_sec, status);
         }
     }
     else if (prec == OSKAR_SINGLE)
@@ -200,11 +200,11 @@ void oskar_vis_block_write_ms(const oskar_VisBlock* blk,
 
             /* Only write the coordinates for the first channel. */
             if (start_chan_index == 0)
-                oskar_ms_write_coords_f(ms, row0, num_baseln_out,
+                oskar_ms_write_coords_status_f(ms, row0, num_baseln_out,
                         (float*)uu_out, (float*)vv_out, (float*)ww_out,
                         exposure_sec, interval_sec,
                         (start_time_index + t + 0.5) * interval_sec +
-                        t_start_sec);
+                        t_start_sec, status);
         }
     }
     else
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "vis/oskar_vis_bda.h"
+#include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_header.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <vector>
+
+static void fill_block(oskar_VisBlock* blk, int i_block, double uvw_rate)
+{
+    int status = 0;
+    const int num_times = oskar_vis_block_num_times(blk);
+    const int num_channels = oskar_vis_block_num_channels(blk);
+    const int num_baselines = oskar_vis_block_num_baselines(blk);
+    double2* v = oskar_mem_double2(
+            oskar_vis_block_cross_correlations(blk), &status);
+    double* uu = oskar_mem_double(
+            oskar_vis_block_baseline_uu_metres(blk), &status);
+    double* vv = oskar_mem_double(
+            oskar_vis_block_baseline_vv_metres(blk), &status);
+    double* ww = oskar_mem_double(
+            oskar_vis_block_baseline_ww_metres(blk), &status);
+    oskar_vis_block_set_start_time_index(blk, i_block * num_times);
+    for (int t = 0; t < num_times; ++t)
+    {
+        const int t_global = i_block * num_times + t;
+        for (int b = 0; b < num_baselines; ++b)
+        {
+            // Longer baselines move faster in the (u,v,w) plane.
+            uu[t * num_baselines + b] = uvw_rate * (b + 1) * t_global;
+            vv[t * num_baselines + b] = 0.0;
+            ww[t * num_baselines + b] = 0.0;
+            for (int c = 0; c < num_channels; ++c)
+            {
+                const int i = num_baselines * (t * num_channels + c) + b;
+                v[i].x = b + 10.0 * c;
+                v[i].y = -1.0;
+            }
+        }
+    }
+}
+
+TEST(vis_bda, averaging)
+{
+    int status = 0;
+    const int num_stations = 6, num_channels = 3;
+    const int num_times = 40, max_times_per_block = 8;
+    const int num_baselines = num_stations * (num_stations - 1) / 2;
+    const int num_blocks = num_times / max_times_per_block;
+    const double time_inc_sec = 10.0;
+    oskar_VisHeader* hdr = oskar_vis_header_create(OSKAR_DOUBLE_COMPLEX,
+            OSKAR_DOUBLE, max_times_per_block, num_times,
+            num_channels, num_channels, num_stations, 0, 1, &status);
+    oskar_vis_header_set_freq_start_hz(hdr, 100e6);
+    oskar_vis_header_set_freq_inc_hz(hdr, 1e6);
+    oskar_vis_header_set_time_inc_sec(hdr, time_inc_sec);
+    oskar_VisBlock* blk = oskar_vis_block_create_from_header(
+            OSKAR_CPU, hdr, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Limit averages by time only.
+    {
+        oskar_VisBDA* bda = oskar_vis_bda_create(hdr, &status);
+        oskar_vis_bda_set_compression(bda, 1e9, 1e-9, 5 * time_inc_sec);
+        for (int i = 0; i < num_blocks; ++i)
+        {
+            fill_block(blk, i, 1.0);
+            oskar_vis_bda_add_block(bda, blk, &status);
+        }
+        oskar_vis_bda_flush(bda, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        ASSERT_EQ(num_baselines * num_times / 5, oskar_vis_bda_num_rows(bda));
+        ASSERT_EQ(num_baselines * num_times,
+                oskar_vis_bda_num_input_rows(bda));
+        const double* weight = oskar_mem_double_const(
+                oskar_vis_bda_weight_const(bda), &status);
+        const double* interval = oskar_mem_double_const(
+                oskar_vis_bda_interval_const(bda), &status);
+        for (int r = 0; r < oskar_vis_bda_num_rows(bda); ++r)
+        {
+            EXPECT_DOUBLE_EQ(5.0, weight[r]);
+            EXPECT_DOUBLE_EQ(5.0 * time_inc_sec, interval[r]);
+        }
+        oskar_vis_bda_free(bda, &status);
+    }
+
+    // Limit averages by baseline length change.
+    {
+        oskar_VisBDA* bda = oskar_vis_bda_create(hdr, &status);
+        oskar_vis_bda_set_compression(bda, 1.01, 1.0, 0.0);
+        for (int i = 0; i < num_blocks; ++i)
+        {
+            fill_block(blk, i, 0.1);
+            oskar_vis_bda_add_block(bda, blk, &status);
+        }
+        oskar_vis_bda_flush(bda, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        const int num_rows = oskar_vis_bda_num_rows(bda);
+        ASSERT_LT(num_rows, num_baselines * num_times);
+        const int* a1 = oskar_mem_int_const(
+                oskar_vis_bda_antenna_const(bda, 0), &status);
+        const int* a2 = oskar_mem_int_const(
+                oskar_vis_bda_antenna_const(bda, 1), &status);
+        const double* weight = oskar_mem_double_const(
+                oskar_vis_bda_weight_const(bda), &status);
+        const double2* v = oskar_mem_double2_const(
+                oskar_vis_bda_vis_const(bda), &status);
+        std::vector<int> rows_per_baseline(num_baselines, 0);
+        std::vector<double> weight_per_baseline(num_baselines, 0.0);
+        for (int r = 0; r < num_rows; ++r)
+        {
+            const int b = a1[r] * (num_stations - 1) -
+                    (a1[r] - 1) * a1[r] / 2 + a2[r] - a1[r] - 1;
+            rows_per_baseline[b]++;
+            weight_per_baseline[b] += weight[r];
+            for (int c = 0; c < num_channels; ++c)
+            {
+                EXPECT_NEAR(b + 10.0 * c, v[r * num_channels + c].x, 1e-10);
+                EXPECT_NEAR(-1.0, v[r * num_channels + c].y, 1e-10);
+            }
+        }
+        for (int b = 0; b < num_baselines; ++b)
+        {
+            EXPECT_DOUBLE_EQ((double) num_times, weight_per_baseline[b]);
+            if (b > 0)
+            {
+                EXPECT_LE(rows_per_baseline[b - 1], rows_per_baseline[b]);
+            }
+        }
+        EXPECT_LT(rows_per_baseline[0], rows_per_baseline[num_baselines - 1]);
+        oskar_vis_bda_free(bda, &status);
+    }
+    oskar_vis_block_free(blk, &status);
+    oskar_vis_header_free(hdr, &status);
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "math/oskar_random_gaussian.h"
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_get_error_string.h"
+#include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_header.h"
+
+#include <cmath>
+#include <vector>
+
+// Adds noise to a block one baseline at a time, as a reference.
+static void reference_noise(int num_stations, int num_times,
+        int num_channels, const std::vector<double>& st_std, unsigned int seed,
+        double sefd_factor, double* xc, double* ac)
+{
+    const int num_baselines = num_stations * (num_stations - 1) / 2;
+    for (int c = 0; c < num_channels; ++c)
+    {
+        for (int t = 0; t < num_times; ++t)
+        {
+            double rnd[8];
+            unsigned int counter = 0;
+            const int slice = t * num_channels + c;
+            const double* std_c = &st_std[num_stations * c];
+            double* x = xc + 8 * num_baselines * slice;
+            double* a = ac + 8 * num_stations * slice;
+            for (int a1 = 0, b = 0; a1 < num_stations; ++a1)
+            {
+                for (int a2 = a1 + 1; a2 < num_stations; ++a2, ++b)
+                {
+                    oskar_random_gaussian4(seed, counter++, slice, 0, 0, rnd);
+                    oskar_random_gaussian4(seed, counter++, slice, 0, 0,
+                            rnd + 4);
+                    const double std = sqrt(std_c[a1] * std_c[a2]);
+                    for (int k = 0; k < 8; ++k)
+                        x[8 * b + k] += std * rnd[k];
+                }
+            }
+            for (int a1 = 0; a1 < num_stations; ++a1)
+            {
+                oskar_random_gaussian4(seed, counter++, slice, 0, 0, rnd);
+                oskar_random_gaussian4(seed, counter++, slice, 0, 0, rnd + 4);
+                const double std = std_c[a1] * sqrt(2.0);
+                const double mean = std * sefd_factor;
+                a[8 * a1 + 0] += std * rnd[0] + mean;
+                a[8 * a1 + 2] += std * rnd[1];
+                a[8 * a1 + 3] += std * rnd[2];
+                a[8 * a1 + 4] += std * rnd[3];
+                a[8 * a1 + 5] += std * rnd[4];
+                a[8 * a1 + 6] += std * rnd[5] + mean;
+            }
+        }
+    }
+}
+
+TEST(vis_block_add_system_noise, matches_serial_reference)
+{
+    int status = 0;
+    const int num_stations = 37, num_times = 3, num_channels = 4;
+    const int num_baselines = num_stations * (num_stations - 1) / 2;
+    const double freq_start_hz = 100e6, freq_inc_hz = 1e6;
+    const double bandwidth_hz = 10e3, time_average_sec = 2.0;
+    const unsigned int seed = 7;
+
+    // Create a telescope with two station types,
+    // with noise defined at each channel frequency.
+    oskar_Telescope* tel = oskar_telescope_create(OSKAR_DOUBLE,
+            OSKAR_CPU, num_stations, &status);
+    oskar_telescope_resize_station_array(tel, 2, &status);
+    int* type_map = oskar_mem_int(
+            oskar_telescope_station_type_map(tel), &status);
+    for (int i = 0; i < num_stations; ++i) type_map[i] = i % 3 == 0 ? 1 : 0;
+    oskar_telescope_set_enable_noise(tel, 1, seed);
+    oskar_telescope_set_noise_freq(tel, freq_start_hz, freq_inc_hz,
+            num_channels, &status);
+    oskar_telescope_set_noise_rms(tel, 1.0, 2.0, &status);
+    double* rms = oskar_mem_double(oskar_station_noise_rms_jy(
+            oskar_telescope_station(tel, 1)), &status);
+    for (int i = 0; i < num_channels; ++i) rms[i] *= 3.0;
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Create a block of zeros.
+    oskar_VisHeader* hdr = oskar_vis_header_create(
+            OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_DOUBLE, num_times, num_times,
+            num_channels, num_channels, num_stations, 1, 1, &status);
+    oskar_vis_header_set_freq_start_hz(hdr, freq_start_hz);
+    oskar_vis_header_set_freq_inc_hz(hdr, freq_inc_hz);
+    oskar_vis_header_set_channel_bandwidth_hz(hdr, bandwidth_hz);
+    oskar_vis_header_set_time_average_sec(hdr, time_average_sec);
+    oskar_VisBlock* blk = oskar_vis_block_create_from_header(
+            OSKAR_CPU, hdr, &status);
+    oskar_vis_block_clear(blk, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Add the noise.
+    oskar_Mem* work = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    oskar_vis_block_add_system_noise(blk, hdr, tel, work, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Generate the reference values.
+    std::vector<double> xc(8 * num_baselines * num_times * num_channels, 0.0);
+    std::vector<double> ac(8 * num_stations * num_times * num_channels, 0.0);
+    std::vector<double> st_std(num_stations * num_channels);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        const double* st_rms = oskar_mem_double_const(
+                oskar_station_noise_rms_jy_const(
+                oskar_telescope_station_const(tel, type_map[i])), &status);
+        for (int c = 0; c < num_channels; ++c)
+            st_std[num_stations * c + i] = st_rms[c];
+    }
+    reference_noise(num_stations, num_times, num_channels, st_std, seed,
+            sqrt(2.0 * bandwidth_hz * time_average_sec), &xc[0], &ac[0]);
+
+    // Check the results are identical.
+    const double* x = oskar_mem_double_const(
+            oskar_vis_block_cross_correlations_const(blk), &status);
+    const double* a = oskar_mem_double_const(
+            oskar_vis_block_auto_correlations_const(blk), &status);
+    for (size_t i = 0; i < xc.size(); ++i) ASSERT_EQ(xc[i], x[i]);
+    for (size_t i = 0; i < ac.size(); ++i) ASSERT_EQ(ac[i], a[i]);
+
+    // Clean up.
+    oskar_mem_free(work, &status);
+    oskar_vis_block_free(blk, &status);
+    oskar_vis_header_free(hdr, &status);
+    oskar_telescope_free(tel, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
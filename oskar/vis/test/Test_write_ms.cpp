@@ -8,10 +8,13 @@
 #include "convert/oskar_convert_date_time_to_mjd.h"
 #include "utility/oskar_dir.h"
 #include "utility/oskar_get_error_string.h"
+#include "vis/oskar_vis_bda.h"
+#include "vis/oskar_vis_bda_write_ms.h"
 #include "vis/oskar_vis_block.h"
 #include "vis/oskar_vis_header.h"
 
 #include <cstdio>
+#include <vector>
 
 TEST(write_ms, test_write)
 {
@@ -195,3 +198,104 @@ TEST(write_ms, test_write_partial)
     oskar_dir_remove(filename);
 }
 
+
+
+TEST(write_ms, test_write_bda)
+{
+    int status = 0;
+    const int num_stations = 4, num_channels = 3;
+    const int num_times = 12, max_times_per_block = 4;
+    const int num_baselines = num_stations * (num_stations - 1) / 2;
+    const double time_inc_sec = 10.0;
+
+    // Create a header and a block of scalar visibilities.
+    oskar_VisHeader* hdr = oskar_vis_header_create(OSKAR_DOUBLE_COMPLEX,
+            OSKAR_DOUBLE, max_times_per_block, num_times,
+            num_channels, num_channels, num_stations, 0, 1, &status);
+    oskar_vis_header_set_phase_centre(hdr, 0, 160.0, 89.0);
+    oskar_vis_header_set_freq_start_hz(hdr, 100e6);
+    oskar_vis_header_set_freq_inc_hz(hdr, 1e6);
+    oskar_vis_header_set_time_start_mjd_utc(hdr,
+            oskar_convert_date_time_to_mjd(2011, 11, 17, 0.0));
+    oskar_vis_header_set_time_inc_sec(hdr, time_inc_sec);
+    oskar_VisBlock* blk = oskar_vis_block_create_from_header(OSKAR_CPU,
+            hdr, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Average every baseline over two time samples.
+    oskar_VisBDA* bda = oskar_vis_bda_create(hdr, &status);
+    oskar_vis_bda_set_compression(bda, 1e9, 1e-9, 2 * time_inc_sec);
+    for (int i = 0; i < num_times / max_times_per_block; ++i)
+    {
+        double2* v = oskar_mem_double2(
+                oskar_vis_block_cross_correlations(blk), &status);
+        double* uu = oskar_mem_double(
+                oskar_vis_block_baseline_uu_metres(blk), &status);
+        oskar_vis_block_set_start_time_index(blk, i * max_times_per_block);
+        for (int t = 0; t < max_times_per_block; ++t)
+        {
+            for (int b = 0; b < num_baselines; ++b)
+            {
+                uu[t * num_baselines + b] = b + 1.0;
+                for (int c = 0; c < num_channels; ++c)
+                {
+                    const int j = num_baselines * (t * num_channels + c) + b;
+                    v[j].x = b + 10.0 * c;
+                    v[j].y = -1.0;
+                }
+            }
+        }
+        oskar_vis_bda_add_block(bda, blk, &status);
+    }
+    oskar_vis_bda_flush(bda, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const int num_rows = oskar_vis_bda_num_rows(bda);
+    ASSERT_EQ(num_baselines * num_times / 2, num_rows);
+
+    // Write the averaged rows.
+    const char filename[] = "temp_test_write_ms_bda.ms";
+    oskar_MeasurementSet* ms = oskar_vis_header_write_ms(hdr, filename,
+            OSKAR_FALSE, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_vis_bda_write_ms(bda, ms, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ((unsigned int) num_rows, oskar_ms_num_rows(ms));
+
+    // Read back the antenna indices and visibilities, and compare them.
+    size_t required_size = 0;
+    std::vector<int> ant1(num_rows), ant2(num_rows);
+    std::vector<double> vis(2 * num_rows * num_channels);
+    oskar_ms_read_column(ms, "ANTENNA1", 0, num_rows,
+            num_rows * sizeof(int), &ant1[0], &required_size, &status);
+    oskar_ms_read_column(ms, "ANTENNA2", 0, num_rows,
+            num_rows * sizeof(int), &ant2[0], &required_size, &status);
+    oskar_ms_read_vis_d(ms, 0, 0, num_channels, num_rows, "DATA",
+            &vis[0], &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const int* a1 = oskar_mem_int_const(
+            oskar_vis_bda_antenna_const(bda, 0), &status);
+    const int* a2 = oskar_mem_int_const(
+            oskar_vis_bda_antenna_const(bda, 1), &status);
+    const double* v = oskar_mem_double_const(
+            oskar_vis_bda_vis_const(bda), &status);
+    for (int r = 0; r < num_rows; ++r)
+    {
+        EXPECT_EQ(a1[r], ant1[r]);
+        EXPECT_EQ(a2[r], ant2[r]);
+        for (int c = 0; c < num_channels; ++c)
+        {
+            const int i_bda = 2 * (r * num_channels + c);
+            const int i_ms = 2 * (c * num_rows + r);
+            EXPECT_FLOAT_EQ((float) v[i_bda], (float) vis[i_ms]);
+            EXPECT_FLOAT_EQ((float) v[i_bda + 1], (float) vis[i_ms + 1]);
+        }
+    }
+
+    // Clean up.
+    oskar_ms_close(ms);
+    oskar_vis_bda_free(bda, &status);
+    oskar_vis_block_free(blk, &status);
+    oskar_vis_header_free(hdr, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_dir_remove(filename);
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "settings/oskar_option_parser.h"
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_get_num_procs.h"
+#include "utility/oskar_timer.h"
+#include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_header.h"
+#include "oskar_version.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Adds noise to a cleared block and returns the time taken, in seconds.
+static double run(oskar_VisBlock* blk, const oskar_VisHeader* hdr,
+        const oskar_Telescope* tel, oskar_Mem* work, int num_threads,
+        int niter, oskar_Timer* tmr, int* status)
+{
+#ifdef _OPENMP
+    omp_set_num_threads(num_threads);
+#else
+    (void) num_threads;
+#endif
+    double elapsed = 0.0;
+    for (int i = 0; i < niter; ++i)
+    {
+        oskar_vis_block_clear(blk, status);
+        oskar_timer_start(tmr);
+        oskar_vis_block_add_system_noise(blk, hdr, tel, work, status);
+        elapsed += oskar_timer_elapsed(tmr);
+    }
+    return elapsed / niter;
+}
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_system_noise_benchmark", OSKAR_VERSION_STR);
+    opt.add_flag("-nst", "Number of stations.", 1, "512", false);
+    opt.add_flag("-nt", "Number of times in the block.", 1, "8", false);
+    opt.add_flag("-nc", "Number of channels in the block.", 1, "4", false);
+    opt.add_flag("-sp", "Use single precision (default: double precision)");
+    opt.add_flag("-s", "Use scalar visibilities (default: polarised).");
+    opt.add_flag("-nth", "Number of threads (default: number of cores).", 1);
+    opt.add_flag("-n", "Number of iterations", 1, "3", false);
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+    const int num_stations = opt.get_int("-nst");
+    const int num_times = opt.get_int("-nt");
+    const int num_channels = opt.get_int("-nc");
+    const int niter = opt.get_int("-n");
+    const int prec = opt.is_set("-sp") ? OSKAR_SINGLE : OSKAR_DOUBLE;
+    int vis_type = prec | OSKAR_COMPLEX;
+    if (!opt.is_set("-s")) vis_type |= OSKAR_MATRIX;
+    int status = 0;
+
+    // Create a telescope model with noise enabled.
+    oskar_Telescope* tel = oskar_telescope_create(prec,
+            OSKAR_CPU, num_stations, &status);
+    oskar_telescope_resize_station_array(tel, 1, &status);
+    oskar_telescope_set_enable_noise(tel, 1, 1);
+    oskar_telescope_set_noise_freq(tel, 100e6, 1e6, num_channels, &status);
+    oskar_telescope_set_noise_rms(tel, 1.0, 2.0, &status);
+
+    // Create the visibility block.
+    oskar_VisHeader* hdr = oskar_vis_header_create(vis_type, prec,
+            num_times, num_times, num_channels, num_channels,
+            num_stations, 1, 1, &status);
+    oskar_vis_header_set_freq_start_hz(hdr, 100e6);
+    oskar_vis_header_set_freq_inc_hz(hdr, 1e6);
+    oskar_vis_header_set_channel_bandwidth_hz(hdr, 10e3);
+    oskar_vis_header_set_time_average_sec(hdr, 1.0);
+    oskar_VisBlock* blk = oskar_vis_block_create_from_header(
+            OSKAR_CPU, hdr, &status);
+    oskar_Mem* work = oskar_mem_create(prec, OSKAR_CPU, 0, &status);
+    oskar_Timer* tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    if (status)
+    {
+        fprintf(stderr, "Error: %s\n", oskar_get_error_string(status));
+        return EXIT_FAILURE;
+    }
+
+    // Time the noise generation using one thread, and then all threads.
+    const int num_procs = opt.is_set("-nth") ?
+            opt.get_int("-nth") : oskar_get_num_procs();
+    const double t_serial = run(blk, hdr, tel, work, 1, niter, tmr, &status);
+    oskar_Mem* ref = oskar_mem_create_copy(
+            oskar_vis_block_cross_correlations_const(blk), OSKAR_CPU, &status);
+    const double t_par = run(blk, hdr, tel, work, num_procs, niter, tmr,
+            &status);
+    const oskar_Mem* out = oskar_vis_block_cross_correlations_const(blk);
+    const int identical = !memcmp(oskar_mem_void_const(ref),
+            oskar_mem_void_const(out), oskar_mem_length(out) *
+            oskar_mem_element_size(oskar_mem_type(out)));
+    printf("System noise, %d stations, %d times, %d channels:\n",
+            num_stations, num_times, num_channels);
+    printf("  1 thread: %.4f s, %d threads: %.4f s, speed-up %.2fx, %s\n",
+            t_serial, num_procs, t_par, t_serial / t_par,
+            identical ? "output identical" : "OUTPUT DIFFERS");
+
+    // Clean up.
+    oskar_timer_free(tmr);
+    oskar_mem_free(ref, &status);
+    oskar_mem_free(work, &status);
+    oskar_vis_block_free(blk, &status);
+    oskar_vis_header_free(hdr, &status);
+    oskar_telescope_free(tel, &status);
+    if (status)
+    {
+        fprintf(stderr, "Error: %s\n", oskar_get_error_string(status));
+        return EXIT_FAILURE;
+    }
+    return identical ? EXIT_SUCCESS : EXIT_FAILURE;
+}
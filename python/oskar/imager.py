@@ -199,7 +199,8 @@ class Imager(object):
     @property
     def algorithm(self):
         """Returns or sets the algorithm used by the imager.
-        Currently one of 'FFT', 'DFT 2D', 'DFT 3D' or 'W-projection'.
+        Currently one of 'FFT', 'DFT 2D', 'DFT 3D', 'W-projection'
+        or 'W-stacking'.
 
         The default is 'FFT', which corresponds to basic but quick 2D gridding,
         ignoring baseline w-components.
@@ -219,6 +220,13 @@ class Imager(object):
         of image you are making, as an extra copy of the grid
         will be made by the FFT library.
 
+        'W-stacking' is an alternative to W-projection which uses an
+        exponential of semicircle gridding kernel, and is multi-threaded
+        on the CPU. It needs no convolution kernels, but all visibilities
+        are buffered in host memory until the image is finalised, so its
+        memory use grows with the total number of visibilities.
+        This algorithm cannot be used to update a caller-supplied plane.
+
         Type
             str
         """
@@ -612,6 +620,24 @@ class Imager(object):
     def uv_filter_min(self, value):
         self.set_uv_filter_min(value)
 
+    @property
+    def w_kernel_cache_dir(self):
+        """Returns or sets the directory used to cache W-projection kernels.
+
+        If set, W-projection kernels are saved in this directory, and are
+        loaded from it instead of being generated when the same imaging
+        parameters are used again. An empty string disables the cache.
+
+        Type
+            str
+        """
+        self.capsule_ensure()
+        return _imager_lib.w_kernel_cache_dir(self._capsule)
+
+    @w_kernel_cache_dir.setter
+    def w_kernel_cache_dir(self, value):
+        self.set_w_kernel_cache_dir(value)
+
     @property
     def weighting(self):
         """Returns or sets the type of visibility weighting to use.
@@ -1133,6 +1159,15 @@ class Imager(object):
         self.capsule_ensure()
         _imager_lib.set_vis_phase_centre(self._capsule, ra_deg, dec_deg)
 
+    def set_w_kernel_cache_dir(self, dir_path):
+        """Sets the directory used to cache W-projection kernels.
+
+        Args:
+            dir_path (str): Path to cache directory, or empty to disable.
+        """
+        self.capsule_ensure()
+        _imager_lib.set_w_kernel_cache_dir(self._capsule, dir_path)
+
     def set_weighting(self, weighting):
         """Sets the type of visibility weighting to use.
 
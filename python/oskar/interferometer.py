@@ -332,6 +332,8 @@ class Interferometer(object):
     def set_max_sources_per_chunk(self, value):
         """Sets the maximum number of sources processed concurrently on one GPU.
 
+        If zero, the number is chosen automatically.
+
         Args:
             value (int): Number of sources per chunk.
         """
@@ -445,7 +445,7 @@ static PyObject* write_coords(PyObject* self, PyObject* args)
     PyObject *capsule = 0;
     PyObject *obj[] = {0, 0, 0};
     PyArrayObject *uu = 0, *vv = 0, *ww = 0;
-    int start_row = 0, num_baselines = 0;
+    int start_row = 0, num_baselines = 0, status = 0;
     double exposure_sec = 0.0, interval_sec = 0.0, time_stamp = 0.0;
     if (!PyArg_ParseTuple(args, "OiiOOOddd", &capsule,
             &start_row, &num_baselines, &obj[0], &obj[1], &obj[2],
@@ -472,19 +472,27 @@ static PyObject* write_coords(PyObject* self, PyObject* args)
     /* Write the coordinates. */
     Py_BEGIN_ALLOW_THREADS
     if (PyArray_TYPE(uu) == NPY_DOUBLE)
-        oskar_ms_write_coords_d(h, start_row, num_baselines,
+        oskar_ms_write_coords_status_d(h, start_row, num_baselines,
                 (const double*)PyArray_DATA(uu),
                 (const double*)PyArray_DATA(vv),
                 (const double*)PyArray_DATA(ww),
-                exposure_sec, interval_sec, time_stamp);
+                exposure_sec, interval_sec, time_stamp, &status);
     else
-        oskar_ms_write_coords_f(h, start_row, num_baselines,
+        oskar_ms_write_coords_status_f(h, start_row, num_baselines,
                 (const float*)PyArray_DATA(uu),
                 (const float*)PyArray_DATA(vv),
                 (const float*)PyArray_DATA(ww),
-                exposure_sec, interval_sec, time_stamp);
+                exposure_sec, interval_sec, time_stamp, &status);
     Py_END_ALLOW_THREADS
 
+    /* Check for errors. */
+    if (status)
+    {
+        PyErr_Format(PyExc_RuntimeError,
+                "oskar_ms_write_coords() failed with code %d.", status);
+        goto fail;
+    }
+
     Py_XDECREF(uu);
     Py_XDECREF(vv);
     Py_XDECREF(ww);